@@ -33,6 +33,12 @@
 /* include API for MultiCore Management */
 #include "worker_ctrl.h"
 #include "aps_cxx_audio_detect.h"
+#include "aps_pcm_ring.h"
+
+/* Publish sound events to other apps (e.g. security_camera) */
+#ifdef CONFIG_UORB
+#include <event/av_event.h>
+#endif
 
 /* Worker ELF path */
 #define WORKER_FILE "/mnt/spif/aps_cxx_audio_detect"
@@ -61,6 +67,16 @@ using namespace MemMgrLite;
 /* Recording time(sec). */
 #define RECORDER_REC_TIME 10
 
+/* Debug output (per-chunk dump), see APS_AUDIO_DETECT_DEBUG */
+#ifdef APS_AUDIO_DETECT_DEBUG
+#  define dbg_printf(...) printf(__VA_ARGS__)
+#else
+#  define dbg_printf(...)
+#endif
+
+/* Bitmask of all PCM ring slots */
+#define PCM_RING_ALL_SLOTS  ((1u << APS_PCM_RING_SLOTS) - 1)
+
 /** --- enum Definitions */
 enum codec_type_e
 {
@@ -144,7 +160,7 @@ static bool app_finalize_libraries(void);
 static bool app_create_audio_sub_system(void);
 static void app_deact_audio_sub_system(void);
 static bool app_init_simple_fifo(void);
-static int app_pop_simple_fifo(void *dst);
+static int app_pop_simple_fifo(void *dst, size_t maxsize);
 static void app_attention_callback(const ErrorAttentionParam *attparam);
 static bool app_open_file_dir(void);
 static bool app_close_file_dir(void);
@@ -177,8 +193,15 @@ static bool app_write_wav_header(void);
 static bool app_init_wav_header(void);
 /** ASMP **/
 static WorkerCtrl *init_subcore_ctrl(void);
-static int req_subcore_ctrl(WorkerCtrl *pwc, int size);
 static int fini_subcore_ctrl(WorkerCtrl *pwc);
+static void init_pcm_ring(void *shm);
+static int acquire_pcm_slot(WorkerCtrl *pwc);
+static int submit_pcm_block(WorkerCtrl *pwc, int slot, int size);
+static int reap_pcm_blocks(WorkerCtrl *pwc, bool wait);
+static void print_sound_event(uint32_t seq);
+static void init_event_bus(void);
+static void publish_sound_event(const SoundEvent *ev);
+static void fini_event_bus(void);
 
 /** --- Static Variables */
 
@@ -188,6 +211,20 @@ static mpshm_t s_shm;
 static recorder_info_s s_recorder_info;
 static WavContainerFormat* s_container_format = NULL;
 static WAVHEADER  s_wav_header;
+/* For PCM ring on share memory (owned slots = s_ring_busy) */
+static PcmRing *s_ring;
+static uint32_t s_ring_busy;
+static uint32_t s_ring_seq;
+static uint32_t s_ring_peak;
+static uint32_t s_sound_events;
+static uint32_t s_sound_events_lost;
+/* Capture clock: time of the first sample and bytes captured since */
+static uint32_t s_ring_t0_ms;
+static uint64_t s_ring_pos;
+#ifdef CONFIG_UORB
+/* For event bus (uORB "event_audio") */
+static int s_event_fd = -1;
+#endif
 
 /*****************************************************************
  * Public Functions 
@@ -268,6 +305,7 @@ extern "C" int aps_cxx_audio_detect_class(int argc, char *argv[])
     printf("Error: init_subcore_ctrl failure.\n");
     return -1;
   }
+  init_event_bus();
   /** -- TEST CODE END -- */
 
 
@@ -286,24 +324,35 @@ extern "C" int aps_cxx_audio_detect_class(int argc, char *argv[])
     time(&start_time);
 
     do {
-      /* get Shared Memory */
-      void *buf = pwc->getAddrShm();
+      int slot;
       int getsize;
-      /** Check the FIFO every 100 ms and fill if there is space. 
-       * 100ms => 4800points(L+R, 4byte * 4800 = 19200byte)
+      /** Check the FIFO every 50 ms and hand it to worker.
+       * 50ms => 2400points(L+R, 4byte * 2400 = 9600byte)
        */
       usleep(50 * 1000);
-      getsize = app_pop_simple_fifo(buf);
-      
-      /** -- TEST CODE START -- */
-      printf("Start: req_subcore_ctrl with (0x%08x,%dbyte).\n", buf, getsize);
-      ret = req_subcore_ctrl(pwc, getsize);
-      if (ret != 0) {
-        printf("Error: req_subcore_ctrl failure.\n");
-        return -1;
-      }
-      printf("Exit: req_subcore_ctrl.\n");      
-      /** -- TEST CODE END -- */
+
+      /** Pop FIFO directly into a free slot of the PCM ring and
+       * pass it to worker by slot index (no copy on shared memory).
+       * Blocks only when all slots are still owned by worker.
+       */
+      do {
+        slot = acquire_pcm_slot(pwc);
+        if (slot < 0) {
+          printf("Error: acquire_pcm_slot failure.\n");
+          return -1;
+        }
+        getsize = app_pop_simple_fifo((uint8_t *)s_ring +
+                                      s_ring->desc[slot].offset,
+                                      s_ring->block_size);
+        if (getsize == 0) {
+          break;
+        }
+        ret = submit_pcm_block(pwc, slot, getsize);
+        if (ret != 0) {
+          printf("Error: submit_pcm_block failure.\n");
+          return -1;
+        }
+      } while (getsize == (int)s_ring->block_size);
     } while((time(&cur_time) - start_time) < RECORDER_REC_TIME);
   }
 
@@ -313,6 +362,7 @@ extern "C" int aps_cxx_audio_detect_class(int argc, char *argv[])
     printf("Error: fini_subcore_ctrl failure.\n");
     return -1;
   }
+  fini_event_bus();
   /** -- TEST CODE END -- */
 
   /* Stop recorder operation. */
@@ -549,6 +599,7 @@ static bool app_init_simple_fifo(void)
   return true;
 }
 
+#ifdef APS_AUDIO_DETECT_DEBUG
 /** test_print_buf
  * - output write_buffer (Received WAV-DATA)
  * (head+0byte to head+63byte)
@@ -566,14 +617,15 @@ static void test_print_buf (int size, void *buf)
   }
   printf("\n");
 }
+#endif /* APS_AUDIO_DETECT_DEBUG */
 
 /** app_pop_simple_fifo
  * - pop recorded sound from Simple-FIFO
- * - copy to buf[dst]
+ * - copy to buf[dst] (up to maxsize byte)
  * - In app_write_output_file_wav, 
  *   Copy FIFO data and Write data in File.  
  */
-static int app_pop_simple_fifo(void *dst)
+static int app_pop_simple_fifo(void *dst, size_t maxsize)
 {
   int cnt = 0; /* for Dequeue Counter in single app_pop_simple_fifo */
   size_t occupied_simple_fifo_size =
@@ -582,6 +634,10 @@ static int app_pop_simple_fifo(void *dst)
   int offset = 0;
   void *putaddr;
 
+  if (occupied_simple_fifo_size > maxsize) {
+    occupied_simple_fifo_size = maxsize;
+  }
+
   while (occupied_simple_fifo_size > 0) {
     output_size = (occupied_simple_fifo_size > READ_SIMPLE_FIFO_SIZE) ?
       READ_SIMPLE_FIFO_SIZE : occupied_simple_fifo_size;
@@ -600,9 +656,10 @@ static int app_pop_simple_fifo(void *dst)
         break;
       }
       //printf("[%d]GET_WAV:%dbyte(on 0x%08x)\n", cnt, output_size, s_recorder_info.fifo.write_buf);
-      printf("[%d]GET_WAV:%dbyte(on 0x%08x)\n", cnt, output_size, putaddr);
-      //test_print_buf(output_size, s_recorder_info.fifo.write_buf);
+      dbg_printf("[%d]GET_WAV:%dbyte(on 0x%08x)\n", cnt, output_size, putaddr);
+#ifdef APS_AUDIO_DETECT_DEBUG
       test_print_buf(output_size, putaddr);
+#endif
       s_recorder_info.file.size += output_size;
     } while(0);
     offset += output_size;
@@ -965,6 +1022,7 @@ static WorkerCtrl *init_subcore_ctrl(void)
     return NULL;
   }
   printf("attached at %08x\n", (uintptr_t)buf);
+  init_pcm_ring(buf);
 
   ret = pwc->execTask();
   if (ret < 0) {
@@ -975,40 +1033,6 @@ static WorkerCtrl *init_subcore_ctrl(void)
   return pwc;
 }
 
-/** req_subcore_ctrl
- * - Send REQ Message
- * - wait Response Code
- */
-static int req_subcore_ctrl(WorkerCtrl *pwc, int getsize)
-{
-  int ret;
-  uint32_t msgdata;
-  int data = getsize;
-  void *buf = pwc->getAddrShm();
-
-  /* Send command to worker */
-  ret = pwc->send((uint8_t)MSG_ID_APS_CXX_AUDIO_DETECT_ACT, (uint32_t) &data);
-  if (ret < 0) {
-    printf("send() failure. %d\n", ret);
-    return ret;
-  }
-
-  /* Wait for worker message */
-  ret = pwc->receive((uint32_t *)&msgdata);
-  if (ret < 0) {
-    printf("recieve() failure. %d\n", ret);
-    return ret;
-  }
-  printf("Worker response: ID = %d, data = %d\n", ret, *((int *)msgdata));
-            
-  /* Lock mutex for synchronize with worker after it's started */
-  pwc->lock();
-  printf("Worker said: %s\n", buf);
-  pwc->unlock();
-
-  return 0;
-}
-
 /** fini_subcore_ctrl
  * - Send EXIT Message
  * - Destroy all Task Resources
@@ -1020,6 +1044,19 @@ static int fini_subcore_ctrl(WorkerCtrl *pwc)
   uint32_t msgdata;
   int data = 0x1234;
 
+  /* Wait until worker has released all PCM blocks */
+  while (s_ring_busy != 0) {
+    ret = reap_pcm_blocks(pwc, true);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  printf("PCM ring: %lu blocks, peak level %lu, %lu sound events"
+         " (%lu lost)\n",
+         (unsigned long)s_ring_seq, (unsigned long)s_ring_peak,
+         (unsigned long)s_sound_events,
+         (unsigned long)s_sound_events_lost);
+
   /* Send command to worker */
   ret = pwc->send((uint8_t)MSG_ID_APS_CXX_AUDIO_DETECT_EXIT, (uint32_t) &data);
   if (ret < 0) {
@@ -1049,3 +1086,242 @@ static int fini_subcore_ctrl(WorkerCtrl *pwc)
   delete pwc;
   return 0;
 }
+
+/*********************************
+ * PCM Ring API (aps_pcm_ring.h)
+ * Hand off audio blocks by descriptor
+ *********************************/
+/** init_pcm_ring
+ * - ARG = top of shared memory
+ * - setup ring header, all slots are FREE
+ */
+static void init_pcm_ring(void *shm)
+{
+  int i;
+
+  s_ring = (PcmRing *)shm;
+  memset(s_ring, 0, sizeof(PcmRing));
+  s_ring->slots = APS_PCM_RING_SLOTS;
+  s_ring->channels = USE_MIC_CHANNEL_NUM;
+  s_ring->sampling_rate = 48000;
+  s_ring->bitwidth = 16;
+  s_ring->block_size = APS_PCM_RING_BLOCK_SIZE;
+  for (i = 0; i < APS_PCM_RING_SLOTS; i++) {
+    s_ring->desc[i].offset = APS_PCM_RING_SLOT_OFFSET(i);
+    s_ring->desc[i].state = APS_PCM_SLOT_FREE;
+  }
+  s_ring->magic = APS_PCM_RING_MAGIC;
+
+  s_ring_busy = 0;
+  s_ring_seq = 0;
+  s_ring_peak = 0;
+  s_sound_events = 0;
+  s_sound_events_lost = 0;
+  s_ring_t0_ms = 0;
+  s_ring_pos = 0;
+}
+
+/** acquire_pcm_slot
+ * - collect released slots without waiting
+ * - wait for worker only when all slots are in flight
+ * - return free slot index
+ */
+static int acquire_pcm_slot(WorkerCtrl *pwc)
+{
+  int slot;
+  int ret;
+
+  ret = reap_pcm_blocks(pwc, false);
+  while (ret >= 0 && s_ring_busy == PCM_RING_ALL_SLOTS) {
+    ret = reap_pcm_blocks(pwc, true);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+
+  /* Oldest-first is not needed, worker handles them in MQ order */
+  for (slot = 0; slot < APS_PCM_RING_SLOTS; slot++) {
+    if ((s_ring_busy & (1u << slot)) == 0) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+/** submit_pcm_block
+ * - fill descriptor of slot and pass it to worker
+ * - slot belongs to worker until it is reaped
+ */
+static int submit_pcm_block(WorkerCtrl *pwc, int slot, int size)
+{
+  PcmBlockDesc *desc = &s_ring->desc[slot];
+  struct timespec ts;
+  uint32_t bytes_per_sec;
+  int ret;
+
+  bytes_per_sec = s_ring->sampling_rate * s_ring->channels *
+                  (s_ring->bitwidth / 8);
+
+  /* Capture is continuous, so each block starts at its byte position
+   * on the capture clock. The clock is set by the first block: it is
+   * popped after the first 50 ms, less than a block, so the FIFO was
+   * drained and its first sample is "size" old.
+   */
+  if (s_ring_pos == 0) {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    s_ring_t0_ms = ts.tv_sec * 1000 + ts.tv_nsec / 1000000 -
+                   (uint32_t)size * 1000 / bytes_per_sec;
+  }
+  desc->seq = s_ring_seq++;
+  desc->size = size;
+  desc->timestamp_ms = s_ring_t0_ms +
+                       (uint32_t)(s_ring_pos * 1000 / bytes_per_sec);
+  s_ring_pos += (uint32_t)size;
+  desc->result = 0;
+  desc->state = APS_PCM_SLOT_FILLED;
+
+  ret = pwc->send((uint8_t)MSG_ID_APS_CXX_AUDIO_DETECT_BLOCK, (uint32_t)slot);
+  if (ret < 0) {
+    printf("send() failure. %d\n", ret);
+    desc->state = APS_PCM_SLOT_FREE;
+    return ret;
+  }
+  s_ring_busy |= 1u << slot;
+  return 0;
+}
+
+/** reap_pcm_blocks
+ * - receive released slot indexes from worker
+ * - sound events from worker are printed on the way
+ * - wait = true : block until at least one slot is released
+ * - return number of released slots
+ */
+static int reap_pcm_blocks(WorkerCtrl *pwc, bool wait)
+{
+  bool nonblocking = !wait;
+  int reaped = 0;
+  uint32_t slot;
+  int ret;
+
+  while (s_ring_busy != 0) {
+    ret = pwc->receive(&slot, nonblocking);
+    if (ret < 0) {
+      if (nonblocking) {
+        break; /* nothing released yet */
+      }
+      printf("recieve() failure. %d\n", ret);
+      return ret;
+    }
+    if (ret == MSG_ID_APS_CXX_AUDIO_DETECT_EVENT) {
+      print_sound_event(slot); /* value is event seq */
+      continue;
+    }
+    if (slot >= APS_PCM_RING_SLOTS) {
+      printf("Invalid slot from worker. %lu\n", (unsigned long)slot);
+      return -EINVAL;
+    }
+
+    if (ret == MSG_ID_APS_CXX_AUDIO_DETECT_ACK) {
+      PcmBlockDesc *desc = &s_ring->desc[slot];
+      dbg_printf("[%lu]PCM_BLOCK:%lubyte peak %lu\n",
+                 (unsigned long)desc->seq, (unsigned long)desc->size,
+                 (unsigned long)desc->result);
+      if (desc->result > s_ring_peak) {
+        s_ring_peak = desc->result;
+      }
+    } else {
+      printf("Worker NAK for slot %lu\n", (unsigned long)slot);
+      s_ring->desc[slot].state = APS_PCM_SLOT_FREE;
+    }
+    s_ring_busy &= ~(1u << slot);
+    reaped++;
+    nonblocking = true; /* do not wait for more */
+  }
+  return reaped;
+}
+
+/** print_sound_event
+ * - ARG = event seq notified by worker
+ * - event body is on the PCM ring (shared memory)
+ */
+static void print_sound_event(uint32_t seq)
+{
+  static const char *name[APS_SOUND_EVENT_NUM] = {
+    "none", "impulse", "glass", "shout"
+  };
+  const SoundEvent *ev = &s_ring->event[seq % APS_PCM_RING_EVENTS];
+
+  if (ev->seq != seq || ev->type >= APS_SOUND_EVENT_NUM) {
+    /* Overwritten by a newer event before it was read */
+    s_sound_events_lost++;
+    printf("Sound event %lu lost\n", (unsigned long)seq);
+    return;
+  }
+  s_sound_events++;
+  printf("Sound event: %s (score %lu dB) at %lu ms\n", name[ev->type],
+         (unsigned long)ev->score, (unsigned long)ev->timestamp_ms);
+  publish_sound_event(ev);
+}
+
+/*********************************
+ * Event Bus API (uORB)
+ * Sound events to other apps
+ *********************************/
+/** init_event_bus
+ * - advertise "event_audio" topic (no initial data)
+ * - without uORB, events are only printed
+ */
+static void init_event_bus(void)
+{
+#ifdef CONFIG_UORB
+  int instance = 0;
+
+  s_event_fd = orb_advertise_multi_queue(ORB_ID(event_audio), NULL,
+                                         &instance, AV_EVENT_QUEUE_SIZE);
+  if (s_event_fd < 0) {
+    printf("orb_advertise(event_audio) failure. %d\n", errno);
+  }
+#endif
+}
+
+/** publish_sound_event
+ * - convert ms timestamp (32bit, wraps) to orb_absolute_time() base
+ * - publish to "event_audio"
+ */
+static void publish_sound_event(const SoundEvent *ev)
+{
+#ifdef CONFIG_UORB
+  struct av_event msg;
+  orb_abstime now;
+  uint32_t age_ms;
+
+  if (s_event_fd < 0) {
+    return;
+  }
+
+  now = orb_absolute_time();
+  age_ms = (uint32_t)(now / 1000) - ev->timestamp_ms;
+
+  msg.timestamp = now - (orb_abstime)age_ms * 1000;
+  msg.seq = ev->seq;
+  msg.source = AV_EVENT_SOURCE_AUDIO;
+  msg.type = ev->type;
+  msg.score = ev->score;
+  orb_publish(ORB_ID(event_audio), s_event_fd, &msg);
+#else
+  (void)ev;
+#endif
+}
+
+/** fini_event_bus
+ * - unadvertise "event_audio" topic
+ */
+static void fini_event_bus(void)
+{
+#ifdef CONFIG_UORB
+  if (s_event_fd >= 0) {
+    orb_unadvertise(s_event_fd);
+    s_event_fd = -1;
+  }
+#endif
+}
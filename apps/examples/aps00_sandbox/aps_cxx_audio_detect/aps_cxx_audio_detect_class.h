@@ -5,4 +5,7 @@
 #define USE_MEMMGR_FENCE
 #define ATTENTION_USE_FILENAME_LINE
 
+/* Dump every FIFO chunk and PCM block (slow, debug only) */
+/* #define APS_AUDIO_DETECT_DEBUG */
+
 #endif /* _APS_CXX_AUDIO_DETECT_CLASS_H_ */
\ No newline at end of file
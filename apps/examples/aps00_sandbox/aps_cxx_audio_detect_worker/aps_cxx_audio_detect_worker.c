@@ -6,6 +6,8 @@
 
 #include "asmp.h"
 #include "include/aps_cxx_audio_detect.h"
+#include "include/aps_pcm_ring.h"
+#include "aps_sound_detect.h"
 
 /* --- Parameters --- */
 static const char helloworld[] = "Hello, ASMP World!";
@@ -18,6 +20,10 @@ typedef struct _s_task_resource {
   char *buf;
 } TaskResource;
 
+/* Sound event detector (too large for worker stack) */
+static SoundDetect s_detect;
+static int s_detect_ready;
+
 /* prototype definition */
 /** MACRO **/
 #define ASSERT(cond) if (!(cond)) wk_abort()
@@ -29,6 +35,8 @@ static void task_lock(TaskResource *pt);
 static void task_unlock(TaskResource *pt);
 static void fini_task_resource(TaskResource *pt);
 static int init_task_resource(TaskResource *pt);
+/** PCM Ring **/
+static int process_pcm_block(TaskResource *pt, uint32_t slot);
 /** Comodity API **/
 static char *strcopy(char *dest, const char *src);
 
@@ -65,6 +73,12 @@ int main(void)
       strcopy(buf, helloworld);
       task_unlock(&t);
       break;  
+    case MSG_ID_APS_CXX_AUDIO_DETECT_BLOCK:
+      /* Process PCM block in place, reply slot index (= release) */
+      if (process_pcm_block(&t, msgdata) != 0) {
+        nak = 1;
+      }
+      break;
     case MSG_ID_APS_CXX_AUDIO_DETECT_EXIT:
       msgdata = 0xABCD;
       break;
@@ -175,6 +189,64 @@ static void fini_task_resource(TaskResource *pt)
   mpshm_detach(&pt->shm);
 }
 
+/** process_pcm_block
+ * - ARG = TaskResource, slot index of PCM ring
+ * - read PCM data in place (no copy), store peak level to result
+ * - run sound event detector, notify each event via MQ
+ * - set slot state to FREE before reply
+ */
+static int process_pcm_block(TaskResource *pt, uint32_t slot)
+{
+  PcmRing *ring = (PcmRing *)pt->buf;
+  PcmBlockDesc *desc;
+  const int16_t *pcm;
+  SoundEvent ev[APS_PCM_RING_EVENTS];
+  uint32_t samples;
+  int nev;
+  int ret;
+  uint32_t peak = 0;
+  uint32_t i;
+
+  if (ring->magic != APS_PCM_RING_MAGIC || slot >= ring->slots ||
+      ring->channels == 0) {
+    return -1;
+  }
+  desc = &ring->desc[slot];
+  if (desc->state != APS_PCM_SLOT_FILLED ||
+      desc->offset + desc->size > APS_CXX_AUDIO_DETECTKEY_SHM_SIZE) {
+    return -1;
+  }
+
+  /* 16bit interleaved PCM: peak of all channels */
+  pcm = (const int16_t *)(pt->buf + desc->offset);
+  samples = desc->size / sizeof(int16_t);
+  for (i = 0; i < samples; i++) {
+    int32_t v = pcm[i];
+    uint32_t a = (v < 0) ? (uint32_t)-v : (uint32_t)v;
+    if (a > peak) {
+      peak = a;
+    }
+  }
+  desc->result = peak;
+
+  /* Detect sound events (setup on first block) */
+  if (!s_detect_ready) {
+    sd_init(&s_detect, ring->sampling_rate, ring->channels);
+    s_detect_ready = 1;
+  }
+  nev = sd_process(&s_detect, pcm, samples / ring->channels,
+                   desc->timestamp_ms, ev, APS_PCM_RING_EVENTS);
+  for (i = 0; i < (uint32_t)nev; i++) {
+    ring->event[ev[i].seq % APS_PCM_RING_EVENTS] = ev[i];
+    ret = send(pt, MSG_ID_APS_CXX_AUDIO_DETECT_EVENT, ev[i].seq);
+    ASSERT(ret == 0);
+  }
+
+  /* Hand the slot back to supervisor */
+  desc->state = APS_PCM_SLOT_FREE;
+  return 0;
+}
+
 /** strcopy
  * - copy src -> dst
  */
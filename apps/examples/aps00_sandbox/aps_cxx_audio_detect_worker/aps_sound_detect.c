@@ -0,0 +1,358 @@
+#include <stdint.h>
+
+#include "aps_sound_detect.h"
+
+/* --- Parameters --- */
+#define SD_PI               (3.14159265358979)
+#define SD_DB_PER_LOG2      (3.0103f)   /* 10 * log10(2) */
+#define SD_ENERGY_MIN       (1.0f)      /* avoid log(0) on digital silence */
+#define SD_FLOOR_DOWN       (0.5f)      /* noise floor follows quiet fast */
+#define SD_FLOOR_UP         (0.005f)    /* and loud slowly (~2s @48kHz) */
+
+/* Band edges (Hz), octave-like */
+static const uint16_t band_edge_hz[SD_NUM_BANDS + 1] = {
+  0, 250, 500, 1000, 2000, 4000, 8000, 12000, 24000
+};
+
+/* prototype definition */
+static double sd_sin(double x);
+static double sd_cos(double x);
+static float sd_log2(float x);
+static void sd_fft(SoundDetect *sd);
+static int sd_emit(SoundDetect *sd, uint32_t type, float score,
+                   uint32_t timestamp_ms, SoundEvent *events, int max_events);
+static int sd_frame(SoundDetect *sd, uint32_t timestamp_ms,
+                    SoundEvent *events, int max_events);
+
+/*****************************************************************
+ * Public Functions
+ *****************************************************************/
+/** sd_init
+ * - set default param
+ * - build window, twiddle and band tables (only here uses double)
+ */
+void sd_init(SoundDetect *sd, uint32_t rate, uint32_t channels)
+{
+  SoundDetectParam *p = &sd->param;
+  uint32_t i;
+  int b;
+
+  p->impulse_db = 15.0f;
+  p->glass_db = 20.0f;
+  p->glass_margin_db = 10.0f;
+  p->shout_db = 15.0f;
+  p->shout_margin_db = 6.0f;
+  p->shout_ms = 150;
+  p->holdoff_ms = 1000;
+  p->warmup_ms = 300;
+
+  sd->rate = rate;
+  sd->channels = (channels > 0) ? channels : 1;
+  sd->mix_gain = 1.0f / (float)sd->channels;
+  sd->frame_ms = (float)SD_FFT_SIZE * 1000.0f / (float)rate;
+
+  /* Hann window */
+  for (i = 0; i < SD_FFT_SIZE; i++) {
+    sd->window[i] = (float)(0.5 - 0.5 * sd_cos(2.0 * SD_PI * i / SD_FFT_SIZE));
+  }
+
+  /* Twiddle factors */
+  for (i = 0; i < SD_FFT_SIZE / 2; i++) {
+    double a = 2.0 * SD_PI * i / SD_FFT_SIZE;
+    sd->cos_tbl[i] = (float)sd_cos(a);
+    sd->sin_tbl[i] = (float)sd_sin(a);
+  }
+
+  /* FFT bin range [lo, hi) of each band, DC is skipped */
+  for (b = 0; b < SD_NUM_BANDS; b++) {
+    uint32_t lo = (band_edge_hz[b] * SD_FFT_SIZE + rate / 2) / rate;
+    uint32_t hi = (band_edge_hz[b + 1] * SD_FFT_SIZE + rate / 2) / rate;
+    if (lo < 1) {
+      lo = 1;
+    }
+    if (hi > SD_FFT_SIZE / 2) {
+      hi = SD_FFT_SIZE / 2;
+    }
+    if (lo > hi) {
+      lo = hi;  /* above Nyquist: empty band */
+    }
+    sd->band_lo[b] = lo;
+    sd->band_hi[b] = hi;
+  }
+
+  sd->fill = 0;
+  sd->frames = 0;
+  sd->shout_run = 0;
+  sd->fired = 0;
+  sd->seq = 0;
+  for (i = 0; i < 3; i++) {
+    sd->prev_rise[i] = 0.0f;
+  }
+}
+
+/** sd_process
+ * - mix to mono and cut into FFT frames
+ * - event timestamp is the time of the last sample of the frame
+ */
+int sd_process(SoundDetect *sd, const int16_t *pcm, uint32_t frames,
+               uint32_t timestamp_ms, SoundEvent *events, int max_events)
+{
+  uint32_t ch = sd->channels;
+  uint32_t i;
+  uint32_t c;
+  int n = 0;
+
+  for (i = 0; i < frames; i++) {
+    int32_t sum = 0;
+    for (c = 0; c < ch; c++) {
+      sum += *pcm++;
+    }
+    sd->re[sd->fill++] = (float)sum * sd->mix_gain;
+
+    if (sd->fill == SD_FFT_SIZE) {
+      n += sd_frame(sd, timestamp_ms + ((i + 1) * 1000) / sd->rate,
+                    &events[n], max_events - n);
+      sd->fill = 0;
+    }
+  }
+  return n;
+}
+
+/*****************************************************************
+ * Static Functions
+ *****************************************************************/
+/** sd_sin
+ * - Taylor series, x = [-pi, pi]
+ */
+static double sd_sin(double x)
+{
+  double x2;
+  double term;
+  double sum;
+  int i;
+
+  /* reduce to [-pi/2, pi/2] */
+  if (x > SD_PI / 2) {
+    x = SD_PI - x;
+  } else if (x < -SD_PI / 2) {
+    x = -SD_PI - x;
+  }
+
+  x2 = x * x;
+  term = x;
+  sum = x;
+  for (i = 1; i < 10; i++) {
+    term *= -x2 / ((2 * i) * (2 * i + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+/** sd_cos
+ * - x = [0, 2pi]
+ */
+static double sd_cos(double x)
+{
+  if (x > SD_PI) {
+    x = 2.0 * SD_PI - x;
+  }
+  return sd_sin(SD_PI / 2 - x);
+}
+
+/** sd_log2
+ * - exponent + 2nd order polynomial of mantissa (error < 0.01)
+ */
+static float sd_log2(float x)
+{
+  union {
+    float f;
+    uint32_t i;
+  } u;
+  float e;
+  float m;
+
+  u.f = x;
+  e = (float)((int32_t)((u.i >> 23) & 0xff) - 128);
+  u.i = (u.i & 0x007fffff) | 0x3f800000;
+  m = u.f;
+  return e + (-0.34484843f * m + 2.02466578f) * m - 0.67487759f;
+}
+
+/** sd_fft
+ * - in-place radix-2 complex FFT of re[]/im[]
+ */
+static void sd_fft(SoundDetect *sd)
+{
+  float *re = sd->re;
+  float *im = sd->im;
+  uint32_t len;
+  uint32_t i;
+  uint32_t j;
+  uint32_t k;
+
+  /* bit reversal */
+  for (i = 1, j = 0; i < SD_FFT_SIZE; i++) {
+    uint32_t bit = SD_FFT_SIZE >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      float t = re[i];
+      re[i] = re[j];
+      re[j] = t;
+      t = im[i];
+      im[i] = im[j];
+      im[j] = t;
+    }
+  }
+
+  /* butterflies */
+  for (len = 2; len <= SD_FFT_SIZE; len <<= 1) {
+    uint32_t half = len >> 1;
+    uint32_t step = SD_FFT_SIZE / len;
+    for (i = 0; i < SD_FFT_SIZE; i += len) {
+      for (k = 0; k < half; k++) {
+        float wr = sd->cos_tbl[k * step];
+        float wi = -sd->sin_tbl[k * step];
+        float *ar = &re[i + k];
+        float *ai = &im[i + k];
+        float tr = ar[half] * wr - ai[half] * wi;
+        float ti = ar[half] * wi + ai[half] * wr;
+        ar[half] = *ar - tr;
+        ai[half] = *ai - ti;
+        *ar += tr;
+        *ai += ti;
+      }
+    }
+  }
+}
+
+/** sd_emit
+ * - append event unless same type fired within holdoff_ms
+ * - return number of appended events (0 or 1)
+ */
+static int sd_emit(SoundDetect *sd, uint32_t type, float score,
+                   uint32_t timestamp_ms, SoundEvent *events, int max_events)
+{
+  if (max_events <= 0) {
+    return 0;
+  }
+  if ((sd->fired & (1u << type)) != 0 &&
+      timestamp_ms - sd->last_ms[type] < sd->param.holdoff_ms) {
+    return 0;
+  }
+  sd->fired |= 1u << type;
+  sd->last_ms[type] = timestamp_ms;
+
+  events->seq = sd->seq++;
+  events->type = type;
+  events->score = (score > 0.0f) ? (uint32_t)(score + 0.5f) : 0;
+  events->timestamp_ms = timestamp_ms;
+  return 1;
+}
+
+/** sd_frame
+ * - window, FFT, band energies, noise floor, scoring
+ * - return number of events
+ */
+static int sd_frame(SoundDetect *sd, uint32_t timestamp_ms,
+                    SoundEvent *events, int max_events)
+{
+  static const int group_first[4] = {
+    SD_GROUP_LOW, SD_GROUP_MID, SD_GROUP_HIGH, SD_NUM_BANDS
+  };
+  const SoundDetectParam *p = &sd->param;
+  float *re = sd->re;
+  float *im = sd->im;
+  float rise[3];
+  float low;
+  float mid;
+  float high;
+  int impulse_prev;
+  int n = 0;
+  int b;
+  int g;
+  uint32_t i;
+
+  for (i = 0; i < SD_FFT_SIZE; i++) {
+    re[i] *= sd->window[i];
+    im[i] = 0.0f;
+  }
+  sd_fft(sd);
+
+  /* Band energy (dB) and rise above noise floor */
+  for (b = 0; b < SD_NUM_BANDS; b++) {
+    float energy = SD_ENERGY_MIN;
+    float db;
+    for (i = sd->band_lo[b]; i < sd->band_hi[b]; i++) {
+      energy += re[i] * re[i] + im[i] * im[i];
+    }
+    db = SD_DB_PER_LOG2 * sd_log2(energy);
+
+    if (sd->frames == 0) {
+      sd->floor_db[b] = db;
+    }
+    sd->rise_db[b] = db - sd->floor_db[b];
+    if (db < sd->floor_db[b]) {
+      sd->floor_db[b] += SD_FLOOR_DOWN * (db - sd->floor_db[b]);
+    } else {
+      sd->floor_db[b] += SD_FLOOR_UP * (db - sd->floor_db[b]);
+    }
+  }
+
+  /* Mean rise of each group (empty bands are ignored) */
+  for (g = 0; g < 3; g++) {
+    float sum = 0.0f;
+    int cnt = 0;
+    for (b = group_first[g]; b < group_first[g + 1]; b++) {
+      if (sd->band_lo[b] < sd->band_hi[b]) {
+        sum += sd->rise_db[b];
+        cnt++;
+      }
+    }
+    rise[g] = (cnt > 0) ? sum / cnt : 0.0f;
+  }
+  low = rise[0];
+  mid = rise[1];
+  high = rise[2];
+
+  sd->frames++;
+  if (sd->frames * sd->frame_ms < p->warmup_ms) {
+    goto out;
+  }
+
+  /* IMPULSE: every group rises at once */
+  impulse_prev = sd->prev_rise[0] >= p->impulse_db &&
+                 sd->prev_rise[1] >= p->impulse_db &&
+                 sd->prev_rise[2] >= p->impulse_db;
+  if (low >= p->impulse_db && mid >= p->impulse_db &&
+      high >= p->impulse_db && !impulse_prev) {
+    n += sd_emit(sd, APS_SOUND_EVENT_IMPULSE, (low + mid + high) / 3.0f,
+                 timestamp_ms, &events[n], max_events - n);
+  }
+  /* GLASS: high group rises well above low and mid groups */
+  else if (high >= p->glass_db && high - low >= p->glass_margin_db &&
+           high - mid >= p->glass_margin_db) {
+    n += sd_emit(sd, APS_SOUND_EVENT_GLASS, high,
+                 timestamp_ms, &events[n], max_events - n);
+  }
+
+  /* SHOUT: voice band stays up for shout_ms */
+  if (mid >= p->shout_db && mid - high >= p->shout_margin_db) {
+    sd->shout_run++;
+    if (sd->shout_run * sd->frame_ms >= p->shout_ms &&
+        (sd->shout_run - 1) * sd->frame_ms < p->shout_ms) {
+      n += sd_emit(sd, APS_SOUND_EVENT_SHOUT, mid,
+                   timestamp_ms, &events[n], max_events - n);
+    }
+  } else {
+    sd->shout_run = 0;
+  }
+
+out:
+  for (g = 0; g < 3; g++) {
+    sd->prev_rise[g] = rise[g];
+  }
+  return n;
+}
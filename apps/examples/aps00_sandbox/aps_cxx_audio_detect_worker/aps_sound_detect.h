@@ -0,0 +1,88 @@
+#ifndef __APS_SOUND_DETECT_H__
+#define __APS_SOUND_DETECT_H__
+
+#include <stdint.h>
+
+#include "include/aps_sound_event.h"
+
+/** Sound event detector
+ * - mono mix -> Hann window -> FFT (SD_FFT_SIZE, no overlap)
+ * - band energies (SD_NUM_BANDS, octave-like) in dB
+ * - adaptive noise floor per band (fast down, slow up)
+ * - score rise above floor per band group (low/mid/high)
+ *   IMPULSE : all groups rise together at an onset
+ *   GLASS   : high group rises well above low and mid groups
+ *   SHOUT   : mid group stays up (high quiet) for shout_ms
+ *
+ * No libc/libm is used, so it runs on the worker as is
+ * and is also built on host (see host/Makefile.host).
+ */
+
+/* --- Parameters --- */
+#define SD_FFT_ORDER        (9)
+#define SD_FFT_SIZE         (1 << SD_FFT_ORDER)
+#define SD_NUM_BANDS        (8)
+
+/* Band groups (index of first band) */
+#define SD_GROUP_LOW        (0)  /* 0 - 500Hz */
+#define SD_GROUP_MID        (2)  /* 500 - 4kHz */
+#define SD_GROUP_HIGH       (5)  /* 4k - 24kHz */
+
+/* --- define typed --- */
+typedef struct _s_sound_detect_param {
+  float impulse_db;             /* every group rises over this */
+  float glass_db;               /* high group rises over this */
+  float glass_margin_db;        /* high group exceeds low/mid by this */
+  float shout_db;               /* mid group rises over this */
+  float shout_margin_db;        /* mid group exceeds high group by this */
+  uint32_t shout_ms;            /* duration of mid group rise */
+  uint32_t holdoff_ms;          /* min interval of same event type */
+  uint32_t warmup_ms;           /* learn noise floor, no detection */
+} SoundDetectParam;
+
+typedef struct _s_sound_detect {
+  SoundDetectParam param;
+  uint32_t rate;                /* sampling rate (Hz) */
+  uint32_t channels;            /* interleaved channels */
+  float mix_gain;               /* 1 / channels */
+  float frame_ms;               /* duration of one FFT frame */
+
+  /* Tables (init) */
+  float window[SD_FFT_SIZE];
+  float cos_tbl[SD_FFT_SIZE / 2];
+  float sin_tbl[SD_FFT_SIZE / 2];
+  uint16_t band_lo[SD_NUM_BANDS];
+  uint16_t band_hi[SD_NUM_BANDS];
+
+  /* Work area */
+  float re[SD_FFT_SIZE];
+  float im[SD_FFT_SIZE];
+  uint32_t fill;                /* samples in re[] */
+
+  /* Features and scoring state */
+  float floor_db[SD_NUM_BANDS];
+  float rise_db[SD_NUM_BANDS];
+  float prev_rise[3];           /* previous low/mid/high rise */
+  uint32_t frames;              /* processed FFT frames */
+  uint32_t shout_run;           /* frames in a row with shout condition */
+  uint32_t fired;               /* bitmask, last_ms[type] is valid */
+  uint32_t last_ms[APS_SOUND_EVENT_NUM];
+  uint32_t seq;                 /* next event sequence number */
+} SoundDetect;
+
+/* --- Prototype --- */
+/** sd_init
+ * - set default param and build tables
+ * - ARG = sampling rate (Hz), interleaved channels (1 or more)
+ */
+void sd_init(SoundDetect *sd, uint32_t rate, uint32_t channels);
+
+/** sd_process
+ * - feed 16bit interleaved PCM (frames = samples per channel)
+ * - timestamp_ms = capture time of the first sample
+ * - store detected events (up to max_events), return the count
+ */
+int sd_process(SoundDetect *sd, const int16_t *pcm, uint32_t frames,
+               uint32_t timestamp_ms, SoundEvent *events, int max_events);
+
+#endif /* __APS_SOUND_DETECT_H__ */
@@ -0,0 +1,166 @@
+/** sd_gen_vectors
+ * - write WAV test vectors for the sound event detector
+ *   (48kHz, 16bit, stereo, same format as the recorder)
+ * - every vector has low level background noise, a test sound at 1.0s
+ * - deterministic (own LCG), so results are reproducible
+ *
+ *   quiet.wav  : background only                 -> none
+ *   bang.wav   : 40ms broadband noise burst        -> impulse
+ *   glass.wav  : decaying 5-15kHz partials        -> glass
+ *   shout.wav  : 220Hz harmonic voice for 0.8s    -> shout
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/* --- Parameters --- */
+#define RATE          (48000)
+#define CHANNELS      (2)
+#define LENGTH_SEC    (3)
+#define EVENT_SEC     (1.0)
+#define NOISE_LEVEL   (100.0)
+
+/* --- define typed --- */
+typedef double (*SoundFunc)(double t);
+
+/*****************************************************************
+ * Static Functions
+ *****************************************************************/
+static uint32_t s_seed = 1;
+
+/** noise
+ * - uniform white noise [-1, 1)
+ */
+static double noise(void)
+{
+  s_seed = s_seed * 1664525u + 1013904223u;
+  return (double)(int32_t)s_seed / 2147483648.0;
+}
+
+static double sound_none(double t)
+{
+  (void)t;
+  return 0.0;
+}
+
+static double sound_bang(double t)
+{
+  return (t < 0.04) ? 12000.0 * noise() : 0.0;
+}
+
+static double sound_glass(double t)
+{
+  static const double freq[] = { 5200.0, 7300.0, 9100.0, 12500.0, 15300.0 };
+  double attack = (t < 0.002) ? t / 0.002 : 1.0;
+  double v = 0.0;
+  size_t i;
+
+  for (i = 0; i < sizeof(freq) / sizeof(freq[0]); i++) {
+    v += sin(2.0 * M_PI * freq[i] * t) * exp(-t / (0.05 + 0.02 * i));
+  }
+  return 3000.0 * attack * v;
+}
+
+static double sound_shout(double t)
+{
+  double f0 = 220.0 * (1.0 + 0.02 * sin(2.0 * M_PI * 5.0 * t));
+  double env;
+  double v = 0.0;
+  int k;
+
+  if (t >= 0.8) {
+    return 0.0;
+  }
+  env = (t < 0.03) ? t / 0.03 : 1.0;
+  for (k = 1; k <= 14; k++) {
+    v += sin(2.0 * M_PI * f0 * k * t) / k;
+  }
+  return 4000.0 * env * v;
+}
+
+static void wr16(uint8_t *p, uint16_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+static void wr32(uint8_t *p, uint32_t v)
+{
+  wr16(p, v);
+  wr16(p + 2, v >> 16);
+}
+
+/** write_vector
+ * - background noise + func(t - EVENT_SEC) to path
+ */
+static int write_vector(const char *dir, const char *name, SoundFunc func)
+{
+  uint32_t frames = RATE * LENGTH_SEC;
+  uint32_t data_size = frames * CHANNELS * 2;
+  uint8_t hdr[44];
+  char path[256];
+  uint32_t i;
+  FILE *fp;
+
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  fp = fopen(path, "wb");
+  if (fp == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  memcpy(hdr, "RIFF", 4);
+  wr32(hdr + 4, 36 + data_size);
+  memcpy(hdr + 8, "WAVEfmt ", 8);
+  wr32(hdr + 16, 16);
+  wr16(hdr + 20, 1);
+  wr16(hdr + 22, CHANNELS);
+  wr32(hdr + 24, RATE);
+  wr32(hdr + 28, RATE * CHANNELS * 2);
+  wr16(hdr + 32, CHANNELS * 2);
+  wr16(hdr + 34, 16);
+  memcpy(hdr + 36, "data", 4);
+  wr32(hdr + 40, data_size);
+  fwrite(hdr, 1, sizeof(hdr), fp);
+
+  s_seed = 1;
+  for (i = 0; i < frames; i++) {
+    double t = (double)i / RATE;
+    double s = (t >= EVENT_SEC) ? func(t - EVENT_SEC) : 0.0;
+    uint8_t out[CHANNELS * 2];
+    int c;
+
+    for (c = 0; c < CHANNELS; c++) {
+      double v = s + NOISE_LEVEL * noise();
+      if (v > 32767.0) {
+        v = 32767.0;
+      } else if (v < -32768.0) {
+        v = -32768.0;
+      }
+      wr16(out + c * 2, (uint16_t)(int16_t)lrint(v));
+    }
+    fwrite(out, 1, sizeof(out), fp);
+  }
+
+  fclose(fp);
+  printf("%s\n", path);
+  return 0;
+}
+
+/*****************************************************************
+ * Public Functions
+ *****************************************************************/
+int main(int argc, char *argv[])
+{
+  const char *dir = (argc > 1) ? argv[1] : ".";
+
+  if (write_vector(dir, "quiet.wav", sound_none) != 0 ||
+      write_vector(dir, "bang.wav", sound_bang) != 0 ||
+      write_vector(dir, "glass.wav", sound_glass) != 0 ||
+      write_vector(dir, "shout.wav", sound_shout) != 0) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+/** sd_wav_test
+ * - run the sound event detector (aps_sound_detect.c) on a WAV file
+ * - 16bit PCM, any channels and sampling rate
+ * - with -e <type>, exit 0 only if <type> events (and no others) fired
+ *   (-e none: no event at all). Used by "make -f Makefile.host check".
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "aps_sound_detect.h"
+
+/* --- Parameters --- */
+#define CHUNK_FRAMES  (1024)
+#define MAX_EVENTS    (8)
+
+static const char *event_name[APS_SOUND_EVENT_NUM] = {
+  "none", "impulse", "glass", "shout"
+};
+
+/* --- define typed --- */
+typedef struct _s_wav_info {
+  uint16_t fmt;
+  uint16_t channels;
+  uint32_t rate;
+  uint16_t bitwidth;
+  uint32_t data_size;
+} WavInfo;
+
+/*****************************************************************
+ * Static Functions
+ *****************************************************************/
+/** rd16/rd32
+ * - little endian field
+ */
+static uint16_t rd16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t rd32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** read_wav_header
+ * - walk RIFF chunks until "data", fill WavInfo
+ * - file position is at the top of PCM data on success
+ */
+static int read_wav_header(FILE *fp, WavInfo *info)
+{
+  uint8_t hdr[12];
+  uint8_t chunk[8];
+  uint8_t fmt[16];
+  int have_fmt = 0;
+
+  if (fread(hdr, 1, 12, fp) != 12 ||
+      memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+    return -1;
+  }
+
+  while (fread(chunk, 1, 8, fp) == 8) {
+    uint32_t size = rd32(chunk + 4);
+    if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+      if (fread(fmt, 1, 16, fp) != 16) {
+        return -1;
+      }
+      info->fmt = rd16(fmt);
+      info->channels = rd16(fmt + 2);
+      info->rate = rd32(fmt + 4);
+      info->bitwidth = rd16(fmt + 14);
+      have_fmt = 1;
+      size -= 16;
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      info->data_size = size;
+      return have_fmt ? 0 : -1;
+    }
+    if (fseek(fp, size + (size & 1), SEEK_CUR) != 0) {
+      return -1;
+    }
+  }
+  return -1;
+}
+
+/** parse_type
+ * - event name -> APS_SOUND_EVENT_xxx
+ */
+static int parse_type(const char *name)
+{
+  int i;
+  for (i = 0; i < APS_SOUND_EVENT_NUM; i++) {
+    if (strcmp(name, event_name[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr,
+          "Usage: %s [-e none|impulse|glass|shout] [-q] file.wav\n"
+          "  -e  Expected event type (exit status reflects the result)\n"
+          "  -q  Do not print each event\n",
+          progname);
+}
+
+/*****************************************************************
+ * Public Functions
+ *****************************************************************/
+int main(int argc, char *argv[])
+{
+  static SoundDetect sd;
+  static int16_t pcm[CHUNK_FRAMES * 8];
+  SoundEvent ev[MAX_EVENTS];
+  unsigned long count[APS_SOUND_EVENT_NUM] = { 0 };
+  uint32_t done = 0;
+  uint32_t total;
+  WavInfo info = { 0 };
+  int expect = -1;
+  int quiet = 0;
+  FILE *fp;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "e:q")) != -1) {
+    switch (opt) {
+    case 'e':
+      expect = parse_type(optarg);
+      if (expect < 0) {
+        show_usage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    default:
+      show_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind >= argc) {
+    show_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  fp = fopen(argv[optind], "rb");
+  if (fp == NULL) {
+    perror(argv[optind]);
+    return EXIT_FAILURE;
+  }
+  if (read_wav_header(fp, &info) != 0 || info.fmt != 1 ||
+      info.bitwidth != 16 || info.rate == 0 ||
+      info.channels == 0 || info.channels > 8) {
+    fprintf(stderr, "%s: not a 16bit PCM WAV file\n", argv[optind]);
+    fclose(fp);
+    return EXIT_FAILURE;
+  }
+
+  sd_init(&sd, info.rate, info.channels);
+
+  /* Feed in chunks, like PCM ring blocks on target */
+  total = info.data_size / (2 * info.channels);
+  while (done < total) {
+    uint32_t frames = total - done;
+    uint32_t ts = (uint32_t)(((uint64_t)done * 1000) / info.rate);
+    int n;
+
+    if (frames > CHUNK_FRAMES) {
+      frames = CHUNK_FRAMES;
+    }
+    frames = fread(pcm, 2 * info.channels, frames, fp);
+    if (frames == 0) {
+      break;
+    }
+
+    n = sd_process(&sd, pcm, frames, ts, ev, MAX_EVENTS);
+    for (i = 0; i < n; i++) {
+      count[ev[i].type]++;
+      if (!quiet) {
+        printf("%8.3f s  %-8s score %2lu dB\n", ev[i].timestamp_ms / 1000.0,
+               event_name[ev[i].type], (unsigned long)ev[i].score);
+      }
+    }
+    done += frames;
+  }
+  fclose(fp);
+
+  if (expect < 0) {
+    return EXIT_SUCCESS;
+  }
+
+  /* Check: only expected type fired (none = nothing fired) */
+  for (i = 1; i < APS_SOUND_EVENT_NUM; i++) {
+    if ((i == expect) != (count[i] > 0)) {
+      fprintf(stderr, "%s: FAIL (expected %s)\n",
+              argv[optind], event_name[expect]);
+      return EXIT_FAILURE;
+    }
+  }
+  printf("%s: OK (%s)\n", argv[optind], event_name[expect]);
+  return EXIT_SUCCESS;
+}
@@ -7,6 +7,8 @@
 #define MSG_ID_APS_CXX_AUDIO_DETECT_INIT   (1)
 #define MSG_ID_APS_CXX_AUDIO_DETECT_EXIT   (2)
 #define MSG_ID_APS_CXX_AUDIO_DETECT_ACT    (3)
+#define MSG_ID_APS_CXX_AUDIO_DETECT_BLOCK  (4) /* value = PCM ring slot index */
+#define MSG_ID_APS_CXX_AUDIO_DETECT_EVENT  (5) /* value = sound event seq */
 
 #define MSG_ID_APS_CXX_AUDIO_DETECT_ACK    (0)
 #define MSG_ID_APS_CXX_AUDIO_DETECT_NAK    (127)
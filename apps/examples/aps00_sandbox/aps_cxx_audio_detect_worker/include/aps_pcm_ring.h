@@ -0,0 +1,75 @@
+#ifndef __APS_PCM_RING_H__
+#define __APS_PCM_RING_H__
+
+#include <stdint.h>
+
+#include "aps_cxx_audio_detect.h"
+#include "aps_sound_event.h"
+
+/** PCM block ring in the ASMP shared memory.
+ * Must be synchronized with supervisor.
+ *
+ * - The supervisor polls the recorder FIFO straight into a FREE slot,
+ *   fills in the descriptor and sends MSG_ID_APS_CXX_AUDIO_DETECT_BLOCK
+ *   with the slot index. PCM data is never copied again after that.
+ * - The worker processes the slot in place, sets it back to FREE and
+ *   replies ACK with the same slot index (= release).
+ * - The supervisor keeps filling the other slots meanwhile, so capture
+ *   and processing overlap (double buffering with APS_PCM_RING_SLOTS >= 2).
+ * - Sound events found in a block are stored in event[seq % EVENTS] and
+ *   notified by MSG_ID_APS_CXX_AUDIO_DETECT_EVENT (value = seq) before
+ *   the block is released. Only events cross cores, not PCM.
+ *
+ * Addresses differ between cores (mpshm_attach), so descriptors only
+ * carry offsets from the start of the shared memory.
+ */
+
+/* --- Parameters --- */
+#define APS_PCM_RING_MAGIC        (0x50434d52) /* "PCMR" */
+#define APS_PCM_RING_SLOTS        (4)
+#define APS_PCM_RING_BLOCK_SIZE   (24 * 1024)  /* 128ms of 48kHz/16bit/2ch */
+#define APS_PCM_RING_ALIGN        (32)
+/* Event slots: each type fires at most once per block (holdoff is
+ * longer than a block), and at most all slots are unread at a time,
+ * so no event is overwritten before the supervisor reads it.
+ */
+#define APS_PCM_RING_EVENTS \
+  (APS_PCM_RING_SLOTS * (APS_SOUND_EVENT_NUM - 1))
+
+/* Slot state */
+#define APS_PCM_SLOT_FREE         (0)  /* owned by supervisor */
+#define APS_PCM_SLOT_FILLED       (1)  /* owned by worker */
+
+/* --- define typed --- */
+typedef struct _s_pcm_block_desc {
+  volatile uint32_t state;      /* APS_PCM_SLOT_xxx */
+  uint32_t seq;                 /* block sequence number */
+  uint32_t offset;              /* data offset from shm top (bytes) */
+  uint32_t size;                /* valid data size (bytes) */
+  uint32_t timestamp_ms;        /* capture time of the first sample (ms) */
+  uint32_t result;              /* worker result for this block */
+} PcmBlockDesc;
+
+typedef struct _s_pcm_ring {
+  uint32_t magic;               /* APS_PCM_RING_MAGIC */
+  uint16_t slots;               /* APS_PCM_RING_SLOTS */
+  uint16_t channels;            /* interleaved channels */
+  uint32_t sampling_rate;       /* Hz */
+  uint32_t bitwidth;            /* bits per sample */
+  uint32_t block_size;          /* capacity of each slot (bytes) */
+  PcmBlockDesc desc[APS_PCM_RING_SLOTS];
+  SoundEvent event[APS_PCM_RING_EVENTS];
+} PcmRing;
+
+/* Offset of slot data from the top of the shared memory */
+#define APS_PCM_RING_HDR_SIZE \
+  ((sizeof(PcmRing) + APS_PCM_RING_ALIGN - 1) & ~(APS_PCM_RING_ALIGN - 1))
+#define APS_PCM_RING_SLOT_OFFSET(i) \
+  (APS_PCM_RING_HDR_SIZE + (i) * APS_PCM_RING_BLOCK_SIZE)
+
+/* Static check: the ring must fit in the shared memory */
+typedef char aps_pcm_ring_fits_shm[
+  (APS_PCM_RING_SLOT_OFFSET(APS_PCM_RING_SLOTS) <=
+   APS_CXX_AUDIO_DETECTKEY_SHM_SIZE) ? 1 : -1];
+
+#endif /* __APS_PCM_RING_H__ */
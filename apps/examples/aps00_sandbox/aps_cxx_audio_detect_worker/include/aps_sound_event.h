@@ -0,0 +1,25 @@
+#ifndef __APS_SOUND_EVENT_H__
+#define __APS_SOUND_EVENT_H__
+
+#include <stdint.h>
+
+/** Sound events detected on worker.
+ * Must be synchronized with supervisor.
+ */
+
+/* Event type */
+#define APS_SOUND_EVENT_NONE      (0)
+#define APS_SOUND_EVENT_IMPULSE   (1)  /* broadband onset (bang, knock) */
+#define APS_SOUND_EVENT_GLASS     (2)  /* high band onset (glass break) */
+#define APS_SOUND_EVENT_SHOUT     (3)  /* sustained voice band (shout) */
+#define APS_SOUND_EVENT_NUM       (4)
+
+/* --- define typed --- */
+typedef struct _s_sound_event {
+  uint32_t seq;                 /* event sequence number */
+  uint32_t type;                /* APS_SOUND_EVENT_xxx */
+  uint32_t score;               /* rise above noise floor (dB) */
+  uint32_t timestamp_ms;        /* capture time (supervisor clock, ms) */
+} SoundEvent;
+
+#endif /* __APS_SOUND_EVENT_H__ */
@@ -12,6 +12,9 @@
 #include <nuttx/config.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
@@ -22,6 +25,15 @@
 
 #include "orientation_calc.h"
 #include "position_estimator.h"
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_FAST_FUSION
+#  include "fusion_kernel.h"
+#endif
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_ZUPT
+#  include "zupt_estimator.h"
+#endif
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+#  include "imu_logger.h"
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -37,6 +49,10 @@
 #define ACCEL_SCALE         (16.0f / 32768.0f)                     /* g */
 #define GRAVITY             9.80665f                               /* m/s^2 */
 
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_FAST_FUSION
+#  define FUSION_BATCH      CONFIG_EXAMPLES_BMI160_ORIENTATION_FUSION_BATCH
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -44,6 +60,22 @@
 static struct ahrs_out_s g_ahrs;
 static struct position_state_s g_pos_state;
 
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_FAST_FUSION
+static struct fusion_state_s g_fusion;
+static struct fusion_sample_s g_batch[FUSION_BATCH];
+static int g_batch_count;
+#endif
+
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_ZUPT
+static struct zupt_state_s g_zupt;
+#endif
+
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+static FAR const char *g_log_path;
+static unsigned long g_max_samples;
+static bool g_quiet;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -75,6 +107,13 @@ static void print_orientation_position(uint32_t timestamp,
                                        float roll, float pitch, float yaw,
                                        float x, float y, float z)
 {
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+  if (g_quiet)
+    {
+      return;
+    }
+
+#endif
   printf("[%10u] ", timestamp);
   printf("Roll:%7.2f° Pitch:%7.2f° Yaw:%7.2f° | ",
          roll, pitch, yaw);
@@ -83,6 +122,46 @@ static void print_orientation_position(uint32_t timestamp,
   fflush(stdout);
 }
 
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+/****************************************************************************
+ * parse_args
+ ****************************************************************************/
+
+static int parse_args(int argc, FAR char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "l:n:q")) != -1)
+    {
+      switch (opt)
+        {
+          case 'l':
+            g_log_path = optarg;
+            break;
+
+          case 'n':
+            g_max_samples = strtoul(optarg, NULL, 10);
+            break;
+
+          case 'q':
+            g_quiet = true;
+            break;
+
+          default:
+            fprintf(stderr,
+                    "Usage: %s [-l logfile] [-n samples] [-q]\n"
+                    "  -l  Record raw samples to a binary log\n"
+                    "  -n  Stop after this many samples\n"
+                    "  -q  Do not print orientation/position\n",
+                    argv[0]);
+            return -EINVAL;
+        }
+    }
+
+  return 0;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -94,6 +173,7 @@ static void print_orientation_position(uint32_t timestamp,
 int main(int argc, FAR char *argv[])
 {
   int fd;
+  int ret;
   struct accel_gyro_st_s raw_data;
   uint32_t prev_time = 0;
   float dt = 1.0f / SAMPLE_RATE_HZ;
@@ -101,6 +181,14 @@ int main(int argc, FAR char *argv[])
   float gx, gy, gz;  /* Gyroscope: rad/s */
   float ax, ay, az;  /* Accelerometer: m/s^2 */
   float roll, pitch, yaw;  /* Orientation: degrees */
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+  unsigned long nsamples = 0;
+
+  if (parse_args(argc, argv) < 0)
+    {
+      return -1;
+    }
+#endif
 
   printf("BMI160 Orientation and Position Estimation\n");
   printf("==========================================\n\n");
@@ -110,9 +198,21 @@ int main(int argc, FAR char *argv[])
   printf("Madgwick AHRS initialized (beta=%.2f, rate=%.0fHz)\n",
          MADGWICK_BETA, SAMPLE_RATE_HZ);
 
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_FAST_FUSION
+  fusion_kernel_init(&g_fusion, MADGWICK_BETA);
+  g_batch_count = 0;
+  printf("Fusion kernel enabled (batch=%d)\n", FUSION_BATCH);
+#endif
+
   /* Initialize position estimator */
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_ZUPT
+  zupt_init(&g_zupt, &g_pos_state);
+  printf("Position estimator initialized (ZUPT, window=%d)\n\n",
+         ZUPT_WINDOW);
+#else
   position_estimator_init(&g_pos_state);
   printf("Position estimator initialized\n\n");
+#endif
 
   /* Open BMI160 sensor */
   fd = open(BMI160_DEVPATH, O_RDONLY);
@@ -124,6 +224,24 @@ int main(int argc, FAR char *argv[])
     }
 
   printf("BMI160 sensor opened successfully\n");
+
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+  if (g_log_path != NULL)
+    {
+      ret = imu_logger_start(g_log_path, SAMPLE_RATE_HZ, GYRO_SCALE,
+                             ACCEL_SCALE * GRAVITY);
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR: Failed to start logging to %s: %d\n",
+                  g_log_path, ret);
+          close(fd);
+          return -1;
+        }
+
+      printf("Logging raw samples to %s\n", g_log_path);
+    }
+#endif
+
   printf("Starting data acquisition...\n\n");
   printf("Time(ms)      Roll    Pitch      Yaw   |     X       Y       Z\n");
   printf("                [deg]   [deg]    [deg]  |    [m]     [m]     [m]\n");
@@ -132,8 +250,6 @@ int main(int argc, FAR char *argv[])
   /* Main loop */
   for (;;)
     {
-      int ret;
-
       /* Read sensor data */
       ret = read(fd, &raw_data, sizeof(struct accel_gyro_st_s));
       if (ret != sizeof(struct accel_gyro_st_s))
@@ -145,9 +261,45 @@ int main(int argc, FAR char *argv[])
       /* Process only when timestamp changes */
       if (prev_time != raw_data.sensor_time)
         {
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+          /* Record the raw sample before any processing */
+
+          if (g_log_path != NULL)
+            {
+              imu_logger_push(&raw_data);
+            }
+
+#endif
           /* Convert raw sensor data */
           convert_sensor_data(&raw_data, &gx, &gy, &gz, &ax, &ay, &az);
 
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_FAST_FUSION
+          /* Collect a batch and run the fused kernel once per batch */
+
+          struct fusion_sample_s *s = &g_batch[g_batch_count];
+
+          s->gx = gx;
+          s->gy = gy;
+          s->gz = gz;
+          s->ax = ax;
+          s->ay = ay;
+          s->az = az;
+
+          if (++g_batch_count >= FUSION_BATCH)
+            {
+              fusion_kernel_update(&g_fusion, &g_pos_state,
+                                   g_batch, g_batch_count, dt);
+              g_batch_count = 0;
+
+              memcpy(g_ahrs.q, g_fusion.q, sizeof(g_fusion.q));
+              orientation_get_euler(&g_ahrs, &roll, &pitch, &yaw);
+              print_orientation_position(raw_data.sensor_time,
+                                        roll, pitch, yaw,
+                                        g_pos_state.x,
+                                        g_pos_state.y,
+                                        g_pos_state.z);
+            }
+#else
           /* Update orientation using Madgwick AHRS */
           MadgwickAHRSupdateIMU(&g_ahrs, gx, gy, gz, ax, ay, az, dt);
 
@@ -155,8 +307,13 @@ int main(int argc, FAR char *argv[])
           orientation_get_euler(&g_ahrs, &roll, &pitch, &yaw);
 
           /* Update position estimation */
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_ZUPT
+          zupt_update(&g_zupt, &g_pos_state, &g_ahrs,
+                      gx, gy, gz, ax, ay, az, dt);
+#else
           position_estimator_update(&g_pos_state, &g_ahrs,
                                     ax, ay, az, dt);
+#endif
 
           /* Print results every 10 samples (10Hz output) */
           static int sample_count = 0;
@@ -169,14 +326,35 @@ int main(int argc, FAR char *argv[])
                                         g_pos_state.z);
               sample_count = 0;
             }
+#endif
 
           prev_time = raw_data.sensor_time;
+
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+          if (g_max_samples > 0 && ++nsamples >= g_max_samples)
+            {
+              break;
+            }
+#endif
         }
 
       /* Small delay to prevent CPU overload */
       usleep(1000);  /* 1ms */
     }
 
+#ifdef CONFIG_EXAMPLES_BMI160_ORIENTATION_LOGGER
+  if (g_log_path != NULL)
+    {
+      uint32_t written;
+      uint32_t dropped;
+
+      imu_logger_stop();
+      imu_logger_stats(&written, &dropped);
+      printf("Log closed: %" PRIu32 " samples written, %" PRIu32
+             " dropped\n", written, dropped);
+    }
+#endif
+
   close(fd);
   return 0;
 }
@@ -0,0 +1,233 @@
+/****************************************************************************
+ * bmi160_orientation/fusion_kernel.c
+ *
+ * Single-pass orientation and world-frame acceleration kernel
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "fusion_kernel.h"
+#include "position_estimator.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fusion_madgwick_step
+ *
+ * Description:
+ *   One Madgwick IMU gradient-descent step, written out so the compiler
+ *   can keep the quaternion in registers across the whole batch.
+ *
+ ****************************************************************************/
+
+static void fusion_madgwick_step(float q[4], float beta,
+                                 const struct fusion_sample_s *s,
+                                 float dt)
+{
+  float q0 = q[0];
+  float q1 = q[1];
+  float q2 = q[2];
+  float q3 = q[3];
+  float ax = s->ax;
+  float ay = s->ay;
+  float az = s->az;
+  float norm;
+  float qdot0;
+  float qdot1;
+  float qdot2;
+  float qdot3;
+
+  /* Rate of change of quaternion from gyroscope */
+
+  qdot0 = 0.5f * (-q1 * s->gx - q2 * s->gy - q3 * s->gz);
+  qdot1 = 0.5f * (q0 * s->gx + q2 * s->gz - q3 * s->gy);
+  qdot2 = 0.5f * (q0 * s->gy - q1 * s->gz + q3 * s->gx);
+  qdot3 = 0.5f * (q0 * s->gz + q1 * s->gy - q2 * s->gx);
+
+  /* Accelerometer feedback (skipped on an all-zero sample) */
+
+  norm = ax * ax + ay * ay + az * az;
+  if (norm > 0.0f)
+    {
+      float q0q0 = q0 * q0;
+      float q1q1 = q1 * q1;
+      float q2q2 = q2 * q2;
+      float q3q3 = q3 * q3;
+      float s0;
+      float s1;
+      float s2;
+      float s3;
+
+      norm = fusion_invsqrt(norm);
+      ax *= norm;
+      ay *= norm;
+      az *= norm;
+
+      /* Gradient of the objective function */
+
+      s0 = 4.0f * q0 * (q2q2 + q1q1) + 2.0f * (q2 * ax - q1 * ay);
+      s1 = 4.0f * q1 * (q3q3 + q0q0 - 1.0f + 2.0f * (q1q1 + q2q2) + az)
+           - 2.0f * (q3 * ax + q0 * ay);
+      s2 = 4.0f * q2 * (q3q3 + q0q0 - 1.0f + 2.0f * (q1q1 + q2q2) + az)
+           + 2.0f * (q0 * ax - q3 * ay);
+      s3 = 4.0f * q3 * (q1q1 + q2q2) - 2.0f * (q1 * ax + q2 * ay);
+
+      norm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+      if (norm > 0.0f)
+        {
+          norm = beta * fusion_invsqrt(norm);
+          qdot0 -= norm * s0;
+          qdot1 -= norm * s1;
+          qdot2 -= norm * s2;
+          qdot3 -= norm * s3;
+        }
+    }
+
+  /* Integrate and renormalise */
+
+  q0 += qdot0 * dt;
+  q1 += qdot1 * dt;
+  q2 += qdot2 * dt;
+  q3 += qdot3 * dt;
+
+  norm = fusion_invsqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+  q[0] = q0 * norm;
+  q[1] = q1 * norm;
+  q[2] = q2 * norm;
+  q[3] = q3 * norm;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fusion_kernel_init
+ ****************************************************************************/
+
+void fusion_kernel_init(struct fusion_state_s *fusion, float beta)
+{
+  fusion->q[0] = 1.0f;
+  fusion->q[1] = 0.0f;
+  fusion->q[2] = 0.0f;
+  fusion->q[3] = 0.0f;
+  fusion->beta = beta;
+}
+
+/****************************************************************************
+ * Name: fusion_invsqrt
+ ****************************************************************************/
+
+float fusion_invsqrt(float x)
+{
+  uint32_t i;
+  float y;
+
+  /* Magic-constant seed followed by one Newton step with coefficients
+   * tuned to minimise the maximum relative error (about 6.5e-4).
+   */
+
+  memcpy(&i, &x, sizeof(i));
+  i = 0x5f1ffff9 - (i >> 1);
+  memcpy(&y, &i, sizeof(y));
+
+  return 0.703952253f * y * (2.38924456f - x * y * y);
+}
+
+/****************************************************************************
+ * Name: fusion_rotate_vector
+ ****************************************************************************/
+
+void fusion_rotate_vector(const float q[4], const float v[3], float out[3])
+{
+  float tx;
+  float ty;
+  float tz;
+
+  /* v' = v + q0 * t + u x t, where u = (q1, q2, q3) and t = 2 * (u x v) */
+
+  tx = 2.0f * (q[2] * v[2] - q[3] * v[1]);
+  ty = 2.0f * (q[3] * v[0] - q[1] * v[2]);
+  tz = 2.0f * (q[1] * v[1] - q[2] * v[0]);
+
+  out[0] = v[0] + q[0] * tx + (q[2] * tz - q[3] * ty);
+  out[1] = v[1] + q[0] * ty + (q[3] * tx - q[1] * tz);
+  out[2] = v[2] + q[0] * tz + (q[1] * ty - q[2] * tx);
+}
+
+/****************************************************************************
+ * Name: fusion_kernel_update
+ ****************************************************************************/
+
+void fusion_kernel_update(struct fusion_state_s *fusion,
+                          struct position_state_s *pos,
+                          const struct fusion_sample_s *samples,
+                          int nsamples, float dt)
+{
+  float vx = pos->vx;
+  float vy = pos->vy;
+  float vz = pos->vz;
+  float x = pos->x;
+  float y = pos->y;
+  float z = pos->z;
+  float bias[3];
+  float acc[3];
+  float world[3];
+  int i = 0;
+
+  /* Calibration prefix: the orientation still tracks, but the position
+   * integrator only accumulates bias until enough samples are collected.
+   */
+
+  for (; i < nsamples && !pos->calibrated; i++)
+    {
+      fusion_madgwick_step(fusion->q, fusion->beta, &samples[i], dt);
+      position_estimator_calibrate(pos, samples[i].ax, samples[i].ay,
+                                   samples[i].az);
+    }
+
+  bias[0] = pos->bias_x;
+  bias[1] = pos->bias_y;
+  bias[2] = pos->bias_z;
+
+  /* Steady-state loop */
+
+  for (; i < nsamples; i++)
+    {
+      const struct fusion_sample_s *s = &samples[i];
+
+      fusion_madgwick_step(fusion->q, fusion->beta, s, dt);
+
+      acc[0] = s->ax - bias[0];
+      acc[1] = s->ay - bias[1];
+      acc[2] = s->az - bias[2];
+      fusion_rotate_vector(fusion->q, acc, world);
+
+      vx += world[0] * dt;
+      vy += world[1] * dt;
+      vz += (world[2] - POSITION_GRAVITY) * dt;
+
+      if (fabsf(vx) < POSITION_VELOCITY_THRESHOLD) vx = 0.0f;
+      if (fabsf(vy) < POSITION_VELOCITY_THRESHOLD) vy = 0.0f;
+      if (fabsf(vz) < POSITION_VELOCITY_THRESHOLD) vz = 0.0f;
+
+      x += vx * dt;
+      y += vy * dt;
+      z += vz * dt;
+    }
+
+  pos->vx = vx;
+  pos->vy = vy;
+  pos->vz = vz;
+  pos->x = x;
+  pos->y = y;
+  pos->z = z;
+}
@@ -0,0 +1,113 @@
+/****************************************************************************
+ * bmi160_orientation/fusion_kernel.h
+ *
+ * Single-pass orientation and world-frame acceleration kernel
+ *
+ ****************************************************************************/
+
+#ifndef __FUSION_KERNEL_H
+#define __FUSION_KERNEL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "position_estimator.h"
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One converted IMU sample (gyro in rad/s, accel in m/s^2) */
+
+struct fusion_sample_s
+{
+  float gx;
+  float gy;
+  float gz;
+  float ax;
+  float ay;
+  float az;
+};
+
+/* Kernel state. q[] uses the same [q0, q1, q2, q3] layout as
+ * struct ahrs_out_s so it can be copied over for Euler conversion.
+ */
+
+struct fusion_state_s
+{
+  float q[4];
+  float beta;
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fusion_kernel_init
+ *
+ * Description:
+ *   Initialize the kernel with the identity quaternion
+ *
+ * Input Parameters:
+ *   fusion - Kernel state
+ *   beta   - Madgwick filter gain
+ *
+ ****************************************************************************/
+
+void fusion_kernel_init(struct fusion_state_s *fusion, float beta);
+
+/****************************************************************************
+ * Name: fusion_kernel_update
+ *
+ * Description:
+ *   Run the Madgwick IMU update and the position integration for a batch
+ *   of samples in one pass. The acceleration is rotated into the world
+ *   frame directly from the quaternion, without building a DCM.
+ *   Bias calibration is handled on a leading sub-batch so the steady-state
+ *   loop carries no calibration branch.
+ *
+ * Input Parameters:
+ *   fusion   - Kernel state
+ *   pos      - Position estimator state (shared with the reference path)
+ *   samples  - Array of converted samples
+ *   nsamples - Number of samples in the array
+ *   dt       - Sample period (seconds)
+ *
+ ****************************************************************************/
+
+void fusion_kernel_update(struct fusion_state_s *fusion,
+                          struct position_state_s *pos,
+                          const struct fusion_sample_s *samples,
+                          int nsamples, float dt);
+
+/****************************************************************************
+ * Name: fusion_invsqrt
+ *
+ * Description:
+ *   Fast approximation of 1/sqrt(x) with one Newton-Raphson step
+ *   (relative error below 0.07%)
+ *
+ ****************************************************************************/
+
+float fusion_invsqrt(float x);
+
+/****************************************************************************
+ * Name: fusion_rotate_vector
+ *
+ * Description:
+ *   Rotate a sensor-frame vector into the world frame using q.
+ *   Equivalent to multiplying by the DCM of
+ *   orientation_quaternion_to_dcm() but with fewer operations.
+ *
+ * Input Parameters:
+ *   q   - Quaternion [q0, q1, q2, q3]
+ *   v   - Sensor-frame vector
+ *   out - Output: World-frame vector
+ *
+ ****************************************************************************/
+
+void fusion_rotate_vector(const float q[4], const float v[3], float out[3]);
+
+#endif /* __FUSION_KERNEL_H */
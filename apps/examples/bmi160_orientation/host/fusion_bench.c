@@ -0,0 +1,321 @@
+/****************************************************************************
+ * bmi160_orientation/host/fusion_bench.c
+ *
+ * Host benchmark: accuracy and speed of the fusion kernel against the
+ * reference MadgwickAHRSupdateIMU() + position_estimator_update() path
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <MadgwickAHRS.h>
+
+#include "orientation_calc.h"
+#include "position_estimator.h"
+#include "fusion_kernel.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_RATE_HZ    1000.0f
+#define BENCH_SECONDS    60
+#define BENCH_SAMPLES    ((int)(BENCH_RATE_HZ * BENCH_SECONDS))
+#define BENCH_BATCH      10
+#define MADGWICK_BETA    0.1f
+#define RAD_TO_DEG       (180.0f / M_PI)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: now_ns
+ ****************************************************************************/
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/****************************************************************************
+ * Name: noise
+ ****************************************************************************/
+
+static float noise(float amplitude)
+{
+  return amplitude * ((float)rand() / (float)RAND_MAX - 0.5f);
+}
+
+/****************************************************************************
+ * Name: generate_samples
+ *
+ * Description:
+ *   Synthesize a slowly tumbling, noisy IMU stream. Gravity plus a
+ *   horizontal acceleration pulse is fed through a naive integration of
+ *   the commanded rates, which is enough to keep both filters working on
+ *   realistic inputs. The pulse peaks at 15 m/s^2: at 1 kHz the
+ *   estimators zero any velocity step below POSITION_VELOCITY_THRESHOLD,
+ *   so a weaker pulse would leave both of them at rest.
+ *
+ ****************************************************************************/
+
+static void generate_samples(struct fusion_sample_s *samples, int n,
+                             float dt)
+{
+  float q[4] =
+  {
+    1.0f, 0.0f, 0.0f, 0.0f
+  };
+
+  float g[3];
+  float gw[3];
+
+  float qi[4];
+  int i;
+
+  srand(1);
+
+  for (i = 0; i < n; i++)
+    {
+      float t = (float)i * dt;
+      struct fusion_sample_s *s = &samples[i];
+      float qdot[4];
+      float norm;
+
+      /* Stationary for the first second so calibration completes */
+
+      if (t < 1.0f)
+        {
+          s->gx = 0.0f;
+          s->gy = 0.0f;
+          s->gz = 0.0f;
+        }
+      else
+        {
+          s->gx = 0.6f * sinf(0.7f * t);
+          s->gy = 0.4f * cosf(0.3f * t);
+          s->gz = 0.9f * sinf(0.11f * t);
+        }
+
+      /* World-frame specific force: gravity plus a 2..6 s pulse along X */
+
+      gw[0] = (t >= 2.0f && t < 6.0f) ? 15.0f * sinf(1.57f * (t - 2.0f))
+                                      : 0.0f;
+      gw[1] = 0.0f;
+      gw[2] = POSITION_GRAVITY;
+
+      /* The sensor sees the world vector rotated by q^-1 */
+
+      qi[0] = q[0];
+      qi[1] = -q[1];
+      qi[2] = -q[2];
+      qi[3] = -q[3];
+      fusion_rotate_vector(qi, gw, g);
+
+      s->ax = g[0] + noise(0.05f);
+      s->ay = g[1] + noise(0.05f);
+      s->az = g[2] + noise(0.05f);
+      s->gx += noise(0.01f);
+      s->gy += noise(0.01f);
+      s->gz += noise(0.01f);
+
+      qdot[0] = 0.5f * (-q[1] * s->gx - q[2] * s->gy - q[3] * s->gz);
+      qdot[1] = 0.5f * (q[0] * s->gx + q[2] * s->gz - q[3] * s->gy);
+      qdot[2] = 0.5f * (q[0] * s->gy - q[1] * s->gz + q[3] * s->gx);
+      qdot[3] = 0.5f * (q[0] * s->gz + q[1] * s->gy - q[2] * s->gx);
+
+      q[0] += qdot[0] * dt;
+      q[1] += qdot[1] * dt;
+      q[2] += qdot[2] * dt;
+      q[3] += qdot[3] * dt;
+
+      norm = 1.0f / sqrtf(q[0] * q[0] + q[1] * q[1] +
+                          q[2] * q[2] + q[3] * q[3]);
+      q[0] *= norm;
+      q[1] *= norm;
+      q[2] *= norm;
+      q[3] *= norm;
+    }
+}
+
+/****************************************************************************
+ * Name: quat_angle_deg
+ *
+ * Description:
+ *   Angle between two unit quaternions in degrees
+ *
+ ****************************************************************************/
+
+static float quat_angle_deg(const float a[4], const float b[4])
+{
+  double w;
+  double x;
+  double y;
+  double z;
+
+  /* Relative rotation conj(a) * b; its vector part gives a well
+   * conditioned angle even when the difference is tiny.
+   */
+
+  w = (double)a[0] * b[0] + (double)a[1] * b[1] +
+      (double)a[2] * b[2] + (double)a[3] * b[3];
+  x = (double)a[0] * b[1] - (double)a[1] * b[0] -
+      (double)a[2] * b[3] + (double)a[3] * b[2];
+  y = (double)a[0] * b[2] + (double)a[1] * b[3] -
+      (double)a[2] * b[0] - (double)a[3] * b[1];
+  z = (double)a[0] * b[3] - (double)a[1] * b[2] +
+      (double)a[2] * b[1] - (double)a[3] * b[0];
+
+  return (float)(2.0 * atan2(sqrt(x * x + y * y + z * z), fabs(w)) *
+                 180.0 / M_PI);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+
+int main(void)
+{
+  struct fusion_sample_s *samples;
+  struct ahrs_out_s ahrs;
+  struct position_state_s ref_pos;
+  struct position_state_s fast_pos;
+  struct fusion_state_s fusion;
+  float dt = 1.0f / BENCH_RATE_HZ;
+  float max_angle = 0.0f;
+  float max_dv = 0.0f;
+  float max_v = 0.0f;
+  float max_rot = 0.0f;
+  double ref_ns = 0.0;
+  double fast_ns = 0.0;
+  double t0;
+  int i;
+  int j;
+
+  samples = malloc(sizeof(struct fusion_sample_s) * BENCH_SAMPLES);
+  if (samples == NULL)
+    {
+      fprintf(stderr, "ERROR: out of memory\n");
+      return EXIT_FAILURE;
+    }
+
+  generate_samples(samples, BENCH_SAMPLES, dt);
+
+  INIT_AHRS(&ahrs, MADGWICK_BETA, BENCH_RATE_HZ);
+  position_estimator_init(&ref_pos);
+  fusion_kernel_init(&fusion, MADGWICK_BETA);
+  position_estimator_init(&fast_pos);
+
+  /* Run both paths batch by batch so the orientations and velocities can
+   * be compared at the same points in time, timing each path separately.
+   */
+
+  for (i = 0; i < BENCH_SAMPLES; i += BENCH_BATCH)
+    {
+      int n = BENCH_SAMPLES - i < BENCH_BATCH ? BENCH_SAMPLES - i
+                                              : BENCH_BATCH;
+      float angle;
+      float dv;
+      float v;
+
+      t0 = now_ns();
+      for (j = i; j < i + n; j++)
+        {
+          const struct fusion_sample_s *s = &samples[j];
+
+          MadgwickAHRSupdateIMU(&ahrs, s->gx, s->gy, s->gz,
+                                s->ax, s->ay, s->az, dt);
+          position_estimator_update(&ref_pos, &ahrs,
+                                    s->ax, s->ay, s->az, dt);
+        }
+
+      ref_ns += now_ns() - t0;
+
+      t0 = now_ns();
+      fusion_kernel_update(&fusion, &fast_pos, &samples[i], n, dt);
+      fast_ns += now_ns() - t0;
+
+      angle = quat_angle_deg(ahrs.q, fusion.q);
+      if (angle > max_angle)
+        {
+          max_angle = angle;
+        }
+
+      dv = sqrtf((ref_pos.vx - fast_pos.vx) * (ref_pos.vx - fast_pos.vx) +
+                 (ref_pos.vy - fast_pos.vy) * (ref_pos.vy - fast_pos.vy) +
+                 (ref_pos.vz - fast_pos.vz) * (ref_pos.vz - fast_pos.vz));
+      if (dv > max_dv)
+        {
+          max_dv = dv;
+        }
+
+      v = sqrtf(ref_pos.vx * ref_pos.vx + ref_pos.vy * ref_pos.vy +
+                ref_pos.vz * ref_pos.vz);
+      if (v > max_v)
+        {
+          max_v = v;
+        }
+    }
+
+  /* Check the rotation itself against the DCM path */
+
+  for (i = 0; i < BENCH_SAMPLES; i += 97)
+    {
+      const struct fusion_sample_s *s = &samples[i];
+      float v[3] =
+      {
+        s->ax, s->ay, s->az
+      };
+
+      float dcm[3][3];
+      float out[3];
+      float err;
+      int k;
+
+      orientation_quaternion_to_dcm(fusion.q, dcm);
+      fusion_rotate_vector(fusion.q, v, out);
+
+      for (k = 0; k < 3; k++)
+        {
+          err = fabsf(out[k] - (dcm[k][0] * v[0] + dcm[k][1] * v[1] +
+                                dcm[k][2] * v[2]));
+          if (err > max_rot)
+            {
+              max_rot = err;
+            }
+        }
+    }
+
+  printf("samples            : %d @ %.0f Hz (batch %d)\n",
+         BENCH_SAMPLES, BENCH_RATE_HZ, BENCH_BATCH);
+  printf("reference          : %8.1f ns/sample\n", ref_ns / BENCH_SAMPLES);
+  printf("fusion kernel      : %8.1f ns/sample (x%.2f)\n",
+         fast_ns / BENCH_SAMPLES, ref_ns / fast_ns);
+  printf("max attitude diff  : %8.4f deg\n", max_angle);
+  printf("max velocity diff  : %8.4f m/s (peak %.3f m/s)\n",
+         max_dv, max_v);
+  printf("final position ref : %8.3f %8.3f %8.3f m\n",
+         ref_pos.x, ref_pos.y, ref_pos.z);
+  printf("final position fast: %8.3f %8.3f %8.3f m\n",
+         fast_pos.x, fast_pos.y, fast_pos.z);
+  printf("max rotation error : %8.2e m/s^2\n", max_rot);
+
+  free(samples);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/****************************************************************************
+ * bmi160_orientation/host/imu_replay.c
+ *
+ * Host-side reader for binary IMU logs and fusion pipeline replay
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <MadgwickAHRS.h>
+
+#include "imu_log_format.h"
+#include "position_estimator.h"
+#include "imu_replay.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: imu_log_open
+ ****************************************************************************/
+
+int imu_log_open(struct imu_log_reader_s *log, const char *path)
+{
+  memset(log, 0, sizeof(struct imu_log_reader_s));
+
+  log->fp = fopen(path, "rb");
+  if (log->fp == NULL)
+    {
+      return -1;
+    }
+
+  if (fread(&log->hdr, sizeof(log->hdr), 1, log->fp) != 1 ||
+      log->hdr.magic != IMU_LOG_MAGIC)
+    {
+      goto errout;
+    }
+
+  /* Newer minor layouts may grow the record; older readers cannot
+   * interpret a shorter one.
+   */
+
+  if (log->hdr.version != IMU_LOG_VERSION ||
+      log->hdr.record_size < sizeof(struct imu_log_record_s) ||
+      log->hdr.header_size < sizeof(struct imu_log_header_s) ||
+      log->hdr.sample_rate <= 0.0f)
+    {
+      fprintf(stderr, "%s: unsupported log (version %u, record %u)\n",
+              path, log->hdr.version, log->hdr.record_size);
+      goto errout;
+    }
+
+  if (fseek(log->fp, log->hdr.header_size, SEEK_SET) != 0)
+    {
+      goto errout;
+    }
+
+  return 0;
+
+errout:
+  fclose(log->fp);
+  log->fp = NULL;
+  return -1;
+}
+
+/****************************************************************************
+ * Name: imu_log_read
+ ****************************************************************************/
+
+int imu_log_read(struct imu_log_reader_s *log,
+                 struct imu_log_sample_s *sample)
+{
+  struct imu_log_record_s *raw = &sample->raw;
+  uint32_t delta;
+
+  if (fread(raw, sizeof(*raw), 1, log->fp) != 1)
+    {
+      return feof(log->fp) ? 0 : -1;
+    }
+
+  if (log->hdr.record_size > sizeof(*raw) &&
+      fseek(log->fp, log->hdr.record_size - sizeof(*raw), SEEK_CUR) != 0)
+    {
+      return -1;
+    }
+
+  /* Unwrap the 32-bit microsecond timestamp */
+
+  delta = log->nrecords ? raw->timestamp_us - log->last_us : 0;
+  log->t_us += delta;
+  log->last_us = raw->timestamp_us;
+  log->nrecords++;
+
+  sample->t  = (double)log->t_us * 1e-6;
+  sample->dt = delta > 0 ? (float)delta * 1e-6f
+                         : 1.0f / log->hdr.sample_rate;
+
+  sample->gx = (float)raw->gyro[0] * log->hdr.gyro_scale;
+  sample->gy = (float)raw->gyro[1] * log->hdr.gyro_scale;
+  sample->gz = (float)raw->gyro[2] * log->hdr.gyro_scale;
+  sample->ax = (float)raw->accel[0] * log->hdr.accel_scale;
+  sample->ay = (float)raw->accel[1] * log->hdr.accel_scale;
+  sample->az = (float)raw->accel[2] * log->hdr.accel_scale;
+
+  return 1;
+}
+
+/****************************************************************************
+ * Name: imu_log_close
+ ****************************************************************************/
+
+void imu_log_close(struct imu_log_reader_s *log)
+{
+  if (log->fp != NULL)
+    {
+      fclose(log->fp);
+      log->fp = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: imu_replay_open
+ ****************************************************************************/
+
+int imu_replay_open(struct imu_replay_s *rp, const char *path, float beta)
+{
+  if (imu_log_open(&rp->log, path) < 0)
+    {
+      return -1;
+    }
+
+  INIT_AHRS(&rp->ahrs, beta, rp->log.hdr.sample_rate);
+  position_estimator_init(&rp->pos);
+  rp->use_timestamps = 0;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: imu_replay_step
+ ****************************************************************************/
+
+int imu_replay_step(struct imu_replay_s *rp,
+                    struct imu_log_sample_s *sample)
+{
+  float dt;
+  int ret;
+
+  ret = imu_log_read(&rp->log, sample);
+  if (ret <= 0)
+    {
+      return ret;
+    }
+
+  dt = rp->use_timestamps ? sample->dt : 1.0f / rp->log.hdr.sample_rate;
+
+  MadgwickAHRSupdateIMU(&rp->ahrs, sample->gx, sample->gy, sample->gz,
+                        sample->ax, sample->ay, sample->az, dt);
+  position_estimator_update(&rp->pos, &rp->ahrs,
+                            sample->ax, sample->ay, sample->az, dt);
+  return 1;
+}
+
+/****************************************************************************
+ * Name: imu_replay_close
+ ****************************************************************************/
+
+void imu_replay_close(struct imu_replay_s *rp)
+{
+  imu_log_close(&rp->log);
+}
@@ -0,0 +1,129 @@
+/****************************************************************************
+ * bmi160_orientation/host/imu_replay.h
+ *
+ * Host-side reader for binary IMU logs and fusion pipeline replay
+ *
+ ****************************************************************************/
+
+#ifndef __IMU_REPLAY_H
+#define __IMU_REPLAY_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <MadgwickAHRS.h>
+
+#include "imu_log_format.h"
+#include "position_estimator.h"
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One log record converted to physical units */
+
+struct imu_log_sample_s
+{
+  double t;                        /* Seconds since the first record */
+  float  dt;                       /* Seconds since the previous record */
+  float  gx, gy, gz;               /* rad/s */
+  float  ax, ay, az;               /* m/s^2 */
+  struct imu_log_record_s raw;
+};
+
+struct imu_log_reader_s
+{
+  FILE *fp;
+  struct imu_log_header_s hdr;
+  uint64_t t_us;                   /* Unwrapped timestamp of last record */
+  uint32_t last_us;
+  unsigned long nrecords;
+};
+
+/* Reference fusion pipeline state */
+
+struct imu_replay_s
+{
+  struct imu_log_reader_s log;
+  struct ahrs_out_s ahrs;
+  struct position_state_s pos;
+  int use_timestamps;              /* 0: fixed 1/sample_rate like target */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: imu_log_open
+ *
+ * Description:
+ *   Open a binary log and validate its header
+ *
+ * Returned Value:
+ *   0 on success, -1 on I/O error or unknown format.
+ *
+ ****************************************************************************/
+
+int imu_log_open(struct imu_log_reader_s *log, const char *path);
+
+/****************************************************************************
+ * Name: imu_log_read
+ *
+ * Description:
+ *   Read the next record and convert it with the scales from the header.
+ *   Timestamps are unwrapped; dt falls back to 1/sample_rate for the first
+ *   record or when the timestamp does not advance.
+ *
+ * Returned Value:
+ *   1 when a sample was returned, 0 at end of file, -1 on error.
+ *
+ ****************************************************************************/
+
+int imu_log_read(struct imu_log_reader_s *log,
+                 struct imu_log_sample_s *sample);
+
+/****************************************************************************
+ * Name: imu_log_close
+ ****************************************************************************/
+
+void imu_log_close(struct imu_log_reader_s *log);
+
+/****************************************************************************
+ * Name: imu_replay_open
+ *
+ * Description:
+ *   Open a log and initialize MadgwickAHRS and the position estimator the
+ *   same way bmi160_orientation_main.c does
+ *
+ ****************************************************************************/
+
+int imu_replay_open(struct imu_replay_s *rp, const char *path, float beta);
+
+/****************************************************************************
+ * Name: imu_replay_step
+ *
+ * Description:
+ *   Read one sample and feed it through MadgwickAHRSupdateIMU() and
+ *   position_estimator_update(). The time step is the fixed nominal
+ *   period, as on the target, unless use_timestamps is set.
+ *
+ * Returned Value:
+ *   As imu_log_read().
+ *
+ ****************************************************************************/
+
+int imu_replay_step(struct imu_replay_s *rp,
+                    struct imu_log_sample_s *sample);
+
+/****************************************************************************
+ * Name: imu_replay_close
+ ****************************************************************************/
+
+void imu_replay_close(struct imu_replay_s *rp);
+
+#endif /* __IMU_REPLAY_H */
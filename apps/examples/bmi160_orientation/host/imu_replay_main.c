@@ -0,0 +1,161 @@
+/****************************************************************************
+ * bmi160_orientation/host/imu_replay_main.c
+ *
+ * Replay a binary IMU log through the reference fusion pipeline
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <MadgwickAHRS.h>
+
+#include "orientation_calc.h"
+#include "imu_replay.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MADGWICK_BETA  0.1f
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: show_usage
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr,
+          "Usage: %s [-b beta] [-t] [-v | -c] <log.bin>\n"
+          "  -b  Madgwick filter gain (default %.2f)\n"
+          "  -t  Use recorded timestamps instead of the nominal period\n"
+          "  -v  Print orientation and position for every sample\n"
+          "  -c  Convert to CSV (time_s,gx,gy,gz,ax,ay,az) for zupt_replay\n",
+          progname, MADGWICK_BETA);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  struct imu_replay_s rp;
+  struct imu_log_sample_s sample;
+  float beta = MADGWICK_BETA;
+  float roll, pitch, yaw;
+  int use_timestamps = 0;
+  int verbose = 0;
+  int convert = 0;
+  struct timespec t0;
+  struct timespec t1;
+  double elapsed;
+  int opt;
+  int ret;
+
+  while ((opt = getopt(argc, argv, "b:tvc")) != -1)
+    {
+      switch (opt)
+        {
+          case 'b':
+            beta = strtof(optarg, NULL);
+            break;
+
+          case 't':
+            use_timestamps = 1;
+            break;
+
+          case 'v':
+            verbose = 1;
+            break;
+
+          case 'c':
+            convert = 1;
+            break;
+
+          default:
+            show_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind >= argc)
+    {
+      show_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  if (imu_replay_open(&rp, argv[optind], beta) < 0)
+    {
+      fprintf(stderr, "ERROR: cannot open IMU log %s\n", argv[optind]);
+      return EXIT_FAILURE;
+    }
+
+  rp.use_timestamps = use_timestamps;
+
+  if (convert)
+    {
+      printf("# time_s,gx,gy,gz,ax,ay,az\n");
+    }
+  else if (verbose)
+    {
+      printf("time_s,sensor_time,roll,pitch,yaw,x,y,z\n");
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+
+  while ((ret = imu_replay_step(&rp, &sample)) > 0)
+    {
+      if (convert)
+        {
+          printf("%.6f,%.6f,%.6f,%.6f,%.5f,%.5f,%.5f\n", sample.t,
+                 sample.gx, sample.gy, sample.gz,
+                 sample.ax, sample.ay, sample.az);
+        }
+      else if (verbose)
+        {
+          orientation_get_euler(&rp.ahrs, &roll, &pitch, &yaw);
+          printf("%.6f,%u,%.3f,%.3f,%.3f,%.4f,%.4f,%.4f\n",
+                 sample.t, sample.raw.sensor_time, roll, pitch, yaw,
+                 rp.pos.x, rp.pos.y, rp.pos.z);
+        }
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: read error after %lu records\n",
+              rp.log.nrecords);
+    }
+
+  orientation_get_euler(&rp.ahrs, &roll, &pitch, &yaw);
+
+  fprintf(stderr, "records     : %lu (%.2f s at %.0f Hz nominal)\n",
+          rp.log.nrecords, sample.t, rp.log.hdr.sample_rate);
+  fprintf(stderr, "replay rate : %.0f samples/s\n",
+          elapsed > 0.0 ? rp.log.nrecords / elapsed : 0.0);
+  fprintf(stderr, "quaternion  : %.6f %.6f %.6f %.6f\n",
+          rp.ahrs.q[0], rp.ahrs.q[1], rp.ahrs.q[2], rp.ahrs.q[3]);
+  fprintf(stderr, "euler (deg) : %.3f %.3f %.3f\n", roll, pitch, yaw);
+  fprintf(stderr, "position    : %.4f %.4f %.4f m\n",
+          rp.pos.x, rp.pos.y, rp.pos.z);
+
+  imu_replay_close(&rp);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+/****************************************************************************
+ * bmi160_orientation/host/zupt_replay.c
+ *
+ * Replay a recorded IMU log through the ZUPT position estimator on the host
+ *
+ * Input is either a binary log written by the -l option of
+ * bmi160_orientation (see imu_log_format.h) or CSV, one sample per line,
+ * '#' starts a comment:
+ *
+ *   time_s,gx,gy,gz,ax,ay,az
+ *
+ * with gyro in rad/s and accel in m/s^2 (sensor frame).
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include <MadgwickAHRS.h>
+
+#include "position_estimator.h"
+#include "zupt_estimator.h"
+#include "imu_replay.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DEFAULT_RATE_HZ  100.0f
+#define MADGWICK_BETA    0.1f
+#define LINE_MAX_LEN     256
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: show_usage
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr,
+          "Usage: %s [-r rate_hz] [-a accel_var_th] [-g gyro_energy_th]"
+          " [-b bias_alpha] [-v] <log.bin | log.csv | ->\n"
+          "  -r  Sample rate used when the log has no usable timestamps\n"
+          "  -a  Stationary threshold on sum of per-axis Var(a), (m/s^2)^2\n"
+          "  -g  Stationary threshold on E[|w|^2], (rad/s)^2\n"
+          "  -b  Bias EMA gain while stationary\n"
+          "  -v  Print one CSV line per sample\n",
+          progname);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  struct ahrs_out_s ahrs;
+  struct position_state_s pos;
+  struct zupt_state_s zupt;
+  struct imu_log_reader_s log;
+  struct imu_log_sample_s sample;
+  char line[LINE_MAX_LEN];
+  float rate = DEFAULT_RATE_HZ;
+  float prev_t = NAN;
+  float max_dist = 0.0f;
+  unsigned long nsamples = 0;
+  int verbose = 0;
+  FILE *fp;
+  int opt;
+
+  zupt_init(&zupt, &pos);
+
+  while ((opt = getopt(argc, argv, "r:a:g:b:v")) != -1)
+    {
+      switch (opt)
+        {
+          case 'r':
+            rate = strtof(optarg, NULL);
+            break;
+
+          case 'a':
+            zupt.accel_var_th = strtof(optarg, NULL);
+            break;
+
+          case 'g':
+            zupt.gyro_energy_th = strtof(optarg, NULL);
+            break;
+
+          case 'b':
+            zupt.bias_alpha = strtof(optarg, NULL);
+            break;
+
+          case 'v':
+            verbose = 1;
+            break;
+
+          default:
+            show_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind >= argc || rate <= 0.0f)
+    {
+      show_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  /* Binary logs carry their own sample rate and scales */
+
+  fp = NULL;
+  if (strcmp(argv[optind], "-") != 0 &&
+      imu_log_open(&log, argv[optind]) == 0)
+    {
+      rate = log.hdr.sample_rate;
+    }
+  else if (strcmp(argv[optind], "-") == 0)
+    {
+      fp = stdin;
+    }
+  else
+    {
+      fp = fopen(argv[optind], "r");
+      if (fp == NULL)
+        {
+          perror(argv[optind]);
+          return EXIT_FAILURE;
+        }
+    }
+
+  INIT_AHRS(&ahrs, MADGWICK_BETA, rate);
+
+  if (verbose)
+    {
+      printf("time_s,stationary,x,y,z,vx,vy,vz\n");
+    }
+
+  for (; ; )
+    {
+      float t;
+      float gx, gy, gz;
+      float ax, ay, az;
+      float dt;
+      float dist;
+      int stationary;
+
+      if (fp == NULL)
+        {
+          if (imu_log_read(&log, &sample) <= 0)
+            {
+              break;
+            }
+
+          t  = (float)sample.t;
+          gx = sample.gx;
+          gy = sample.gy;
+          gz = sample.gz;
+          ax = sample.ax;
+          ay = sample.ay;
+          az = sample.az;
+        }
+      else if (fgets(line, sizeof(line), fp) == NULL)
+        {
+          break;
+        }
+      else if (line[0] == '#' ||
+               sscanf(line, "%f,%f,%f,%f,%f,%f,%f",
+                      &t, &gx, &gy, &gz, &ax, &ay, &az) != 7)
+        {
+          continue;
+        }
+
+      /* Use the recorded timestamps when they are monotonic */
+
+      dt = t - prev_t;
+      if (!(dt > 0.0f && dt < 1.0f))
+        {
+          dt = 1.0f / rate;
+        }
+
+      prev_t = t;
+
+      MadgwickAHRSupdateIMU(&ahrs, gx, gy, gz, ax, ay, az, dt);
+      stationary = zupt_update(&zupt, &pos, &ahrs,
+                               gx, gy, gz, ax, ay, az, dt);
+      nsamples++;
+
+      dist = sqrtf(pos.x * pos.x + pos.y * pos.y + pos.z * pos.z);
+      if (dist > max_dist)
+        {
+          max_dist = dist;
+        }
+
+      if (verbose)
+        {
+          printf("%.6f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                 t, stationary, pos.x, pos.y, pos.z,
+                 pos.vx, pos.vy, pos.vz);
+        }
+    }
+
+  if (fp == NULL)
+    {
+      imu_log_close(&log);
+    }
+  else if (fp != stdin)
+    {
+      fclose(fp);
+    }
+
+  fprintf(stderr, "samples        : %lu\n", nsamples);
+  fprintf(stderr, "stationary     : %lu (%.1f%%)\n", zupt.zupt_count,
+          nsamples ? 100.0 * zupt.zupt_count / nsamples : 0.0);
+  fprintf(stderr, "final position : %.3f %.3f %.3f m\n",
+          pos.x, pos.y, pos.z);
+  fprintf(stderr, "max distance   : %.3f m\n", max_dist);
+  fprintf(stderr, "accel bias     : %.4f %.4f %.4f m/s^2\n",
+          pos.bias_x, pos.bias_y, pos.bias_z);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ * bmi160_orientation/imu_log_format.h
+ *
+ * Binary IMU log file format (shared by the target logger and host tools)
+ *
+ * File layout:
+ *
+ *   +---------------------------+  offset 0
+ *   | struct imu_log_header_s   |
+ *   | zero padding              |
+ *   +---------------------------+  offset header_size (512)
+ *   | struct imu_log_record_s   |
+ *   | struct imu_log_record_s   |
+ *   | ...                       |
+ *   +---------------------------+
+ *
+ * The header is padded to one sector and IMU_LOG_BLOCK_RECORDS records
+ * are a whole number of sectors, so every block write stays aligned.
+ * All fields are little-endian.
+ *
+ ****************************************************************************/
+
+#ifndef __IMU_LOG_FORMAT_H
+#define __IMU_LOG_FORMAT_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define IMU_LOG_MAGIC          0x4c554d49u   /* "IMUL" */
+#define IMU_LOG_VERSION        1
+#define IMU_LOG_HEADER_SIZE    512
+
+/* Records per flush block: 512 * 20 bytes = 20 sectors */
+
+#define IMU_LOG_BLOCK_RECORDS  512
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct imu_log_header_s
+{
+  uint32_t magic;          /* IMU_LOG_MAGIC */
+  uint16_t version;        /* IMU_LOG_VERSION */
+  uint16_t header_size;    /* Offset of the first record */
+  uint16_t record_size;    /* sizeof(struct imu_log_record_s) */
+  uint16_t reserved0;
+  float    sample_rate;    /* Nominal sample rate (Hz) */
+  float    gyro_scale;     /* rad/s per LSB */
+  float    accel_scale;    /* m/s^2 per LSB */
+  uint32_t reserved[2];
+};
+
+/* One raw struct accel_gyro_st_s sample plus a host timestamp */
+
+struct imu_log_record_s
+{
+  uint32_t timestamp_us;   /* CLOCK_MONOTONIC, microseconds (wraps) */
+  uint32_t sensor_time;    /* BMI160 sensor time */
+  int16_t  accel[3];       /* Raw accelerometer X/Y/Z */
+  int16_t  gyro[3];        /* Raw gyroscope X/Y/Z */
+};
+
+#endif /* __IMU_LOG_FORMAT_H */
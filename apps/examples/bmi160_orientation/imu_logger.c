@@ -0,0 +1,300 @@
+/****************************************************************************
+ * bmi160_orientation/imu_logger.c
+ *
+ * Binary IMU sample logger with a RAM ring and background SD flushing
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <nuttx/sensors/bmi160.h>
+
+#include "imu_log_format.h"
+#include "imu_logger.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BLOCK_RECORDS   IMU_LOG_BLOCK_RECORDS
+#define RING_RECORDS    (IMU_LOG_BLOCK_RECORDS * \
+                         CONFIG_EXAMPLES_BMI160_ORIENTATION_LOG_BLOCKS)
+
+#define FLUSH_PRIORITY  (CONFIG_EXAMPLES_BMI160_ORIENTATION_PRIORITY - 10)
+#define FLUSH_STACKSIZE 2048
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Preallocated ring. g_head and g_tail are free-running record counters:
+ * g_head is only written by the sampling thread and g_tail only by the
+ * flush thread, so the ring needs no lock.
+ */
+
+static struct imu_log_record_s g_ring[RING_RECORDS];
+static uint32_t g_head;
+static uint32_t g_tail;
+
+static uint32_t g_dropped;
+static uint32_t g_written;
+
+static int g_fd = -1;
+static volatile bool g_running;
+static sem_t g_flush_sem;
+static pthread_t g_flush_thread;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: write_all
+ ****************************************************************************/
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+  const uint8_t *p = buf;
+  ssize_t ret;
+
+  while (len > 0)
+    {
+      ret = write(fd, p, len);
+      if (ret < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      p += ret;
+      len -= ret;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: flush_ring
+ *
+ * Description:
+ *   Write every complete block to the file. Because RING_RECORDS is a
+ *   multiple of BLOCK_RECORDS, a block never straddles the ring end.
+ *   With 'partial' set, the trailing incomplete block is written as well
+ *   (only done on stop, so the tail stays block-aligned while running).
+ *
+ ****************************************************************************/
+
+static int flush_ring(bool partial)
+{
+  uint32_t head = __atomic_load_n(&g_head, __ATOMIC_ACQUIRE);
+  uint32_t tail = g_tail;
+  uint32_t count;
+  int ret;
+
+  while (head - tail >= BLOCK_RECORDS ||
+         (partial && head != tail))
+    {
+      count = head - tail;
+      if (count > BLOCK_RECORDS)
+        {
+          count = BLOCK_RECORDS;
+        }
+
+      ret = write_all(g_fd, &g_ring[tail % RING_RECORDS],
+                      count * sizeof(struct imu_log_record_s));
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      tail += count;
+      g_written += count;
+      __atomic_store_n(&g_tail, tail, __ATOMIC_RELEASE);
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: flush_thread
+ ****************************************************************************/
+
+static void *flush_thread(void *arg)
+{
+  int ret;
+
+  while (g_running)
+    {
+      sem_wait(&g_flush_sem);
+
+      ret = flush_ring(false);
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR: IMU log write failed: %d\n", ret);
+          g_running = false;
+        }
+    }
+
+  flush_ring(true);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: imu_logger_start
+ ****************************************************************************/
+
+int imu_logger_start(const char *path, float sample_rate,
+                     float gyro_scale, float accel_scale)
+{
+  static uint8_t header[IMU_LOG_HEADER_SIZE];
+  struct imu_log_header_s *hdr = (struct imu_log_header_s *)header;
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  g_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (g_fd < 0)
+    {
+      return -errno;
+    }
+
+  memset(header, 0, sizeof(header));
+  hdr->magic       = IMU_LOG_MAGIC;
+  hdr->version     = IMU_LOG_VERSION;
+  hdr->header_size = IMU_LOG_HEADER_SIZE;
+  hdr->record_size = sizeof(struct imu_log_record_s);
+  hdr->sample_rate = sample_rate;
+  hdr->gyro_scale  = gyro_scale;
+  hdr->accel_scale = accel_scale;
+
+  ret = write_all(g_fd, header, sizeof(header));
+  if (ret < 0)
+    {
+      goto errout_with_fd;
+    }
+
+  g_head    = 0;
+  g_tail    = 0;
+  g_dropped = 0;
+  g_written = 0;
+  g_running = true;
+  sem_init(&g_flush_sem, 0, 0);
+
+  /* Flush below the sampling priority so SD latency never delays reads */
+
+  pthread_attr_init(&attr);
+  param.sched_priority = FLUSH_PRIORITY;
+  pthread_attr_setschedparam(&attr, &param);
+  pthread_attr_setstacksize(&attr, FLUSH_STACKSIZE);
+
+  ret = pthread_create(&g_flush_thread, &attr, flush_thread, NULL);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      ret = -ret;
+      g_running = false;
+      sem_destroy(&g_flush_sem);
+      goto errout_with_fd;
+    }
+
+  pthread_setname_np(g_flush_thread, "imu_log");
+  return 0;
+
+errout_with_fd:
+  close(g_fd);
+  g_fd = -1;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: imu_logger_push
+ ****************************************************************************/
+
+int imu_logger_push(const struct accel_gyro_st_s *raw)
+{
+  struct imu_log_record_s *rec;
+  struct timespec ts;
+  uint32_t head = g_head;
+
+  if (head - __atomic_load_n(&g_tail, __ATOMIC_ACQUIRE) >= RING_RECORDS)
+    {
+      g_dropped++;
+      return -ENOSPC;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  rec = &g_ring[head % RING_RECORDS];
+  rec->timestamp_us = (uint32_t)((uint64_t)ts.tv_sec * 1000000 +
+                                 ts.tv_nsec / 1000);
+  rec->sensor_time  = raw->sensor_time;
+  rec->accel[0]     = raw->accel.x;
+  rec->accel[1]     = raw->accel.y;
+  rec->accel[2]     = raw->accel.z;
+  rec->gyro[0]      = raw->gyro.x;
+  rec->gyro[1]      = raw->gyro.y;
+  rec->gyro[2]      = raw->gyro.z;
+
+  __atomic_store_n(&g_head, head + 1, __ATOMIC_RELEASE);
+
+  /* Wake the flush thread once per completed block */
+
+  if (((head + 1) % BLOCK_RECORDS) == 0)
+    {
+      sem_post(&g_flush_sem);
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: imu_logger_stop
+ ****************************************************************************/
+
+void imu_logger_stop(void)
+{
+  if (g_fd < 0)
+    {
+      return;
+    }
+
+  g_running = false;
+  sem_post(&g_flush_sem);
+  pthread_join(g_flush_thread, NULL);
+  sem_destroy(&g_flush_sem);
+
+  fsync(g_fd);
+  close(g_fd);
+  g_fd = -1;
+}
+
+/****************************************************************************
+ * Name: imu_logger_stats
+ ****************************************************************************/
+
+void imu_logger_stats(uint32_t *written, uint32_t *dropped)
+{
+  *written = g_written;
+  *dropped = g_dropped;
+}
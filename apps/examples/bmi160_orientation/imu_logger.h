@@ -0,0 +1,76 @@
+/****************************************************************************
+ * bmi160_orientation/imu_logger.h
+ *
+ * Binary IMU sample logger with a RAM ring and background SD flushing
+ *
+ ****************************************************************************/
+
+#ifndef __IMU_LOGGER_H
+#define __IMU_LOGGER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <nuttx/sensors/bmi160.h>
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: imu_logger_start
+ *
+ * Description:
+ *   Create the log file, write its header and start the flush thread
+ *
+ * Input Parameters:
+ *   path        - Log file path (e.g. on /mnt/sd0)
+ *   sample_rate - Nominal sample rate (Hz), stored in the header
+ *   gyro_scale  - rad/s per gyro LSB, stored in the header
+ *   accel_scale - m/s^2 per accel LSB, stored in the header
+ *
+ * Returned Value:
+ *   0 on success, negated errno on failure.
+ *
+ ****************************************************************************/
+
+int imu_logger_start(const char *path, float sample_rate,
+                     float gyro_scale, float accel_scale);
+
+/****************************************************************************
+ * Name: imu_logger_push
+ *
+ * Description:
+ *   Append one sample to the RAM ring. Never blocks; when the ring is full
+ *   the sample is dropped and counted.
+ *
+ * Returned Value:
+ *   0 on success, -ENOSPC if the sample was dropped.
+ *
+ ****************************************************************************/
+
+int imu_logger_push(const struct accel_gyro_st_s *raw);
+
+/****************************************************************************
+ * Name: imu_logger_stop
+ *
+ * Description:
+ *   Flush everything still in the ring, stop the thread and close the file
+ *
+ ****************************************************************************/
+
+void imu_logger_stop(void);
+
+/****************************************************************************
+ * Name: imu_logger_stats
+ *
+ * Description:
+ *   Return the number of records written to the file and dropped so far
+ *
+ ****************************************************************************/
+
+void imu_logger_stats(uint32_t *written, uint32_t *dropped);
+
+#endif /* __IMU_LOGGER_H */
@@ -19,9 +19,9 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define GRAVITY           9.80665f      /* m/s^2 */
-#define CALIBRATION_COUNT 100           /* Number of samples for calibration */
-#define VELOCITY_THRESHOLD 0.01f        /* m/s - Ignore small velocities */
+#define GRAVITY            POSITION_GRAVITY
+#define CALIBRATION_COUNT  POSITION_CALIBRATION_COUNT
+#define VELOCITY_THRESHOLD POSITION_VELOCITY_THRESHOLD
 
 /****************************************************************************
  * Public Functions
@@ -52,6 +52,29 @@ void position_estimator_reset(struct position_state_s *state)
   state->vz = 0.0f;
 }
 
+/****************************************************************************
+ * Name: position_estimator_calibrate
+ ****************************************************************************/
+
+int position_estimator_calibrate(struct position_state_s *state,
+                                 float ax, float ay, float az)
+{
+  state->bias_x += ax;
+  state->bias_y += ay;
+  state->bias_z += az;
+  state->calib_samples++;
+
+  if (state->calib_samples >= CALIBRATION_COUNT)
+    {
+      state->bias_x /= CALIBRATION_COUNT;
+      state->bias_y /= CALIBRATION_COUNT;
+      state->bias_z /= CALIBRATION_COUNT;
+      state->calibrated = 1;
+    }
+
+  return state->calibrated;
+}
+
 /****************************************************************************
  * Name: position_estimator_update
  ****************************************************************************/
@@ -67,18 +90,7 @@ void position_estimator_update(struct position_state_s *state,
   /* Calibration phase: collect bias samples while stationary */
   if (!state->calibrated)
     {
-      state->bias_x += ax;
-      state->bias_y += ay;
-      state->bias_z += az;
-      state->calib_samples++;
-
-      if (state->calib_samples >= CALIBRATION_COUNT)
-        {
-          state->bias_x /= CALIBRATION_COUNT;
-          state->bias_y /= CALIBRATION_COUNT;
-          state->bias_z /= CALIBRATION_COUNT;
-          state->calibrated = 1;
-        }
+      position_estimator_calibrate(state, ax, ay, az);
       return;
     }
 
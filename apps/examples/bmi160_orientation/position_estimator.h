@@ -14,6 +14,14 @@
 
 #include <MadgwickAHRS.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define POSITION_GRAVITY            9.80665f  /* m/s^2 */
+#define POSITION_CALIBRATION_COUNT  100       /* Samples for calibration */
+#define POSITION_VELOCITY_THRESHOLD 0.01f     /* m/s - Ignore small values */
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -75,6 +83,26 @@ void position_estimator_update(struct position_state_s *state,
                                float ax, float ay, float az,
                                float dt);
 
+/****************************************************************************
+ * Name: position_estimator_calibrate
+ *
+ * Description:
+ *   Accumulate one stationary sample into the startup bias estimate
+ *
+ * Input Parameters:
+ *   state - Position estimator state
+ *   ax    - Accelerometer X (sensor frame, m/s^2)
+ *   ay    - Accelerometer Y (sensor frame, m/s^2)
+ *   az    - Accelerometer Z (sensor frame, m/s^2)
+ *
+ * Returned Value:
+ *   1 once calibration has completed, 0 while still collecting samples.
+ *
+ ****************************************************************************/
+
+int position_estimator_calibrate(struct position_state_s *state,
+                                 float ax, float ay, float az);
+
 /****************************************************************************
  * Name: position_estimator_reset
  *
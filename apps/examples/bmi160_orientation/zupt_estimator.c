@@ -0,0 +1,223 @@
+/****************************************************************************
+ * bmi160_orientation/zupt_estimator.c
+ *
+ * Drift-bounded position estimation with zero-velocity updates (ZUPT)
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include <MadgwickAHRS.h>
+#include "zupt_estimator.h"
+#include "position_estimator.h"
+#include "orientation_calc.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define GRAVITY      POSITION_GRAVITY
+#define WINDOW_MASK  (ZUPT_WINDOW - 1)
+
+#if (ZUPT_WINDOW & WINDOW_MASK) != 0
+#  error "ZUPT_WINDOW must be a power of two"
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zupt_window_push
+ *
+ * Description:
+ *   Add one value to the window, dropping the oldest once it is full.
+ *   The running sums are rebuilt from the buffer each time the head wraps,
+ *   which bounds rounding drift at an amortized cost of one add per sample.
+ *
+ ****************************************************************************/
+
+static void zupt_window_push(struct zupt_window_s *w, float value)
+{
+  float x;
+  float old;
+  int i;
+
+  if (w->count == 0)
+    {
+      w->shift = value;
+    }
+
+  x = value - w->shift;
+
+  if (w->count == ZUPT_WINDOW)
+    {
+      old = w->buf[w->head];
+      w->sum -= old;
+      w->sumsq -= old * old;
+    }
+  else
+    {
+      w->count++;
+    }
+
+  w->buf[w->head] = x;
+  w->sum += x;
+  w->sumsq += x * x;
+  w->head = (w->head + 1) & WINDOW_MASK;
+
+  if (w->head == 0)
+    {
+      w->sum = 0.0f;
+      w->sumsq = 0.0f;
+
+      for (i = 0; i < w->count; i++)
+        {
+          w->sum += w->buf[i];
+          w->sumsq += w->buf[i] * w->buf[i];
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: zupt_window_mean
+ ****************************************************************************/
+
+static float zupt_window_mean(const struct zupt_window_s *w)
+{
+  return w->shift + w->sum / (float)w->count;
+}
+
+/****************************************************************************
+ * Name: zupt_window_var
+ ****************************************************************************/
+
+static float zupt_window_var(const struct zupt_window_s *w)
+{
+  float n = (float)w->count;
+  float var = (w->sumsq - w->sum * w->sum / n) / n;
+
+  return var > 0.0f ? var : 0.0f;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zupt_init
+ ****************************************************************************/
+
+void zupt_init(struct zupt_state_s *zupt, struct position_state_s *pos)
+{
+  memset(zupt, 0, sizeof(struct zupt_state_s));
+  zupt->accel_var_th   = ZUPT_ACCEL_VAR_TH;
+  zupt->gyro_energy_th = ZUPT_GYRO_ENERGY_TH;
+  zupt->bias_alpha     = ZUPT_BIAS_ALPHA;
+
+  position_estimator_init(pos);
+}
+
+/****************************************************************************
+ * Name: zupt_update
+ ****************************************************************************/
+
+int zupt_update(struct zupt_state_s *zupt, struct position_state_s *pos,
+                struct ahrs_out_s *ahrs,
+                float gx, float gy, float gz,
+                float ax, float ay, float az,
+                float dt)
+{
+  float dcm[3][3];
+  float ax_world, ay_world, az_world;
+  float avar;
+  float gmean;
+  float genergy;
+
+  zupt_window_push(&zupt->accel[0], ax);
+  zupt_window_push(&zupt->accel[1], ay);
+  zupt_window_push(&zupt->accel[2], az);
+  zupt_window_push(&zupt->gyro, sqrtf(gx * gx + gy * gy + gz * gz));
+
+  /* Wait for a full window before trusting the detector */
+
+  if (zupt->gyro.count < ZUPT_WINDOW)
+    {
+      zupt->stationary = 0;
+      return 0;
+    }
+
+  /* Stationary when the specific force vector is steady (per-axis, so a
+   * horizontal acceleration that barely changes |a| is still caught) and
+   * the rotation energy E[|w|^2] = Var(|w|) + E[|w|]^2 is small.
+   */
+
+  avar = zupt_window_var(&zupt->accel[0]) +
+         zupt_window_var(&zupt->accel[1]) +
+         zupt_window_var(&zupt->accel[2]);
+
+  gmean = zupt_window_mean(&zupt->gyro);
+  genergy = zupt_window_var(&zupt->gyro) + gmean * gmean;
+
+  zupt->stationary = avar < zupt->accel_var_th &&
+                     genergy < zupt->gyro_energy_th;
+
+  orientation_quaternion_to_dcm(ahrs->q, dcm);
+
+  if (zupt->stationary)
+    {
+      /* Gravity in the sensor frame is the third DCM row; anything else
+       * the accelerometer reports at rest is bias.
+       */
+
+      float bx = ax - GRAVITY * dcm[2][0];
+      float by = ay - GRAVITY * dcm[2][1];
+      float bz = az - GRAVITY * dcm[2][2];
+
+      if (!pos->calibrated)
+        {
+          pos->bias_x = bx;
+          pos->bias_y = by;
+          pos->bias_z = bz;
+          pos->calibrated = 1;
+        }
+      else
+        {
+          pos->bias_x += zupt->bias_alpha * (bx - pos->bias_x);
+          pos->bias_y += zupt->bias_alpha * (by - pos->bias_y);
+          pos->bias_z += zupt->bias_alpha * (bz - pos->bias_z);
+        }
+
+      /* Zero-velocity update */
+
+      pos->vx = 0.0f;
+      pos->vy = 0.0f;
+      pos->vz = 0.0f;
+      zupt->zupt_count++;
+      return 1;
+    }
+
+  /* Moving: integrate bias-corrected, world-frame acceleration */
+
+  ax -= pos->bias_x;
+  ay -= pos->bias_y;
+  az -= pos->bias_z;
+
+  ax_world = dcm[0][0] * ax + dcm[0][1] * ay + dcm[0][2] * az;
+  ay_world = dcm[1][0] * ax + dcm[1][1] * ay + dcm[1][2] * az;
+  az_world = dcm[2][0] * ax + dcm[2][1] * ay + dcm[2][2] * az - GRAVITY;
+
+  pos->vx += ax_world * dt;
+  pos->vy += ay_world * dt;
+  pos->vz += az_world * dt;
+
+  pos->x += pos->vx * dt;
+  pos->y += pos->vy * dt;
+  pos->z += pos->vz * dt;
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+ * bmi160_orientation/zupt_estimator.h
+ *
+ * Drift-bounded position estimation with zero-velocity updates (ZUPT)
+ *
+ ****************************************************************************/
+
+#ifndef __ZUPT_ESTIMATOR_H
+#define __ZUPT_ESTIMATOR_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <MadgwickAHRS.h>
+#include "position_estimator.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Sliding window length in samples (must be a power of two) */
+
+#define ZUPT_WINDOW              32
+
+/* Default detector thresholds */
+
+#define ZUPT_ACCEL_VAR_TH        0.01f   /* Sum of Var(a_i), (m/s^2)^2 */
+#define ZUPT_GYRO_ENERGY_TH      0.01f   /* Mean(|w|^2), (rad/s)^2 */
+#define ZUPT_BIAS_ALPHA          0.01f   /* Bias EMA gain while stationary */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Sliding-window statistics, updated in O(1) per sample. Values are stored
+ * relative to the first sample seen (shifted data) to limit cancellation
+ * in the single-precision running sums.
+ */
+
+struct zupt_window_s
+{
+  float buf[ZUPT_WINDOW];
+  float shift;
+  float sum;
+  float sumsq;
+  int head;
+  int count;
+};
+
+struct zupt_state_s
+{
+  struct zupt_window_s accel[3]; /* a per axis, m/s^2 */
+  struct zupt_window_s gyro;     /* |w|, rad/s */
+
+  /* Detector thresholds */
+
+  float accel_var_th;
+  float gyro_energy_th;
+  float bias_alpha;
+
+  /* Detector output */
+
+  int stationary;
+  unsigned long zupt_count;     /* Samples spent clamped to zero velocity */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zupt_init
+ *
+ * Description:
+ *   Initialize the detector with the default thresholds and clear the
+ *   position state
+ *
+ ****************************************************************************/
+
+void zupt_init(struct zupt_state_s *zupt, struct position_state_s *pos);
+
+/****************************************************************************
+ * Name: zupt_update
+ *
+ * Description:
+ *   Update the stationarity detector and the position estimate with one
+ *   sample. While stationary the velocity is clamped to zero and the
+ *   accelerometer bias is re-estimated against the gravity vector implied
+ *   by the current attitude. While moving the bias-corrected acceleration
+ *   is rotated to the world frame and double-integrated.
+ *
+ * Input Parameters:
+ *   zupt  - Detector state
+ *   pos   - Position estimator state
+ *   ahrs  - AHRS output (already updated with this sample)
+ *   gx    - Gyroscope X (sensor frame, rad/s)
+ *   gy    - Gyroscope Y (sensor frame, rad/s)
+ *   gz    - Gyroscope Z (sensor frame, rad/s)
+ *   ax    - Accelerometer X (sensor frame, m/s^2)
+ *   ay    - Accelerometer Y (sensor frame, m/s^2)
+ *   az    - Accelerometer Z (sensor frame, m/s^2)
+ *   dt    - Time delta (seconds)
+ *
+ * Returned Value:
+ *   1 if the sample was classified as stationary, 0 otherwise.
+ *
+ ****************************************************************************/
+
+int zupt_update(struct zupt_state_s *zupt, struct position_state_s *pos,
+                struct ahrs_out_s *ahrs,
+                float gx, float gy, float gz,
+                float ax, float ay, float az,
+                float dt);
+
+#endif /* __ZUPT_ESTIMATOR_H */
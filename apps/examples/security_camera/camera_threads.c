@@ -50,10 +50,16 @@
 #include "frame_queue.h"
 #include "camera_manager.h"
 #include "mjpeg_protocol.h"
+#include "mjpeg_http.h"
 #include "usb_transport.h"
 #include "perf_logger.h"
 #include "config.h"
 
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+#  include <poll.h>
+#  include <event/av_event.h>
+#endif
+
 /****************************************************************************
  * Performance Optimization Strategy (Step 5)
  ****************************************************************************/
@@ -108,6 +114,32 @@ static struct timespec g_last_metrics_time;
 
 #define METRICS_INTERVAL_MS 1000  /* Send metrics every 1 second */
 
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+
+/* Event triggered frame rate:
+ *   Idle:  EVENT_IDLE_FPS, camera thread sleeps in poll() on "event_audio"
+ *   Burst: CONFIG_CAMERA_FPS for EVENT_BURST_US after the last event
+ *
+ * poll() returns as soon as an audio event is published, so the next
+ * frame is captured right away instead of after the idle interval.
+ */
+
+#define EVENT_IDLE_FPS          CONFIG_EXAMPLES_SECURITY_CAMERA_IDLE_FPS
+#define EVENT_BURST_US          \
+  ((orb_abstime)CONFIG_EXAMPLES_SECURITY_CAMERA_BURST_MS * 1000)
+#define EVENT_MOTION_THRESHOLD  CONFIG_EXAMPLES_SECURITY_CAMERA_MOTION_THRESHOLD
+#define EVENT_MOTION_HOLDOFF_US 1000000  /* Max one motion event per second */
+
+static int g_audio_sub = -1;           /* "event_audio" subscriber */
+static int g_motion_pub = -1;          /* "event_motion" advertiser */
+static orb_abstime g_burst_until;      /* End of current burst */
+static orb_abstime g_last_motion;      /* Last published motion event */
+static uint32_t g_jpeg_size_avg;       /* Running average of JPEG size */
+static uint32_t g_motion_seq;
+static uint32_t g_audio_events;
+
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -198,6 +230,201 @@ static int send_metrics_packet(int usb_fd)
   return 0;
 }
 
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+
+/****************************************************************************
+ * Name: event_trigger_init
+ *
+ * Description:
+ *   Subscribe to audio events and advertise motion events. Either may
+ *   fail (e.g. uORB not ready); the camera then just runs at idle rate.
+ *
+ ****************************************************************************/
+
+static void event_trigger_init(void)
+{
+  int instance = 0;
+
+  g_burst_until = 0;
+  g_last_motion = 0;
+  g_jpeg_size_avg = 0;
+  g_motion_seq = 0;
+  g_audio_events = 0;
+
+  g_audio_sub = orb_subscribe(ORB_ID(event_audio));
+  if (g_audio_sub < 0)
+    {
+      LOG_WARN("Failed to subscribe event_audio: %d", errno);
+    }
+
+  g_motion_pub = orb_advertise_multi_queue(ORB_ID(event_motion), NULL,
+                                           &instance, AV_EVENT_QUEUE_SIZE);
+  if (g_motion_pub < 0)
+    {
+      LOG_WARN("Failed to advertise event_motion: %d", errno);
+    }
+
+  LOG_INFO("Event trigger: idle %d fps, burst %d fps for %d ms",
+           EVENT_IDLE_FPS, CONFIG_CAMERA_FPS,
+           CONFIG_EXAMPLES_SECURITY_CAMERA_BURST_MS);
+}
+
+/****************************************************************************
+ * Name: event_trigger_cleanup
+ ****************************************************************************/
+
+static void event_trigger_cleanup(void)
+{
+  if (g_audio_sub >= 0)
+    {
+      orb_unsubscribe(g_audio_sub);
+      g_audio_sub = -1;
+    }
+
+  if (g_motion_pub >= 0)
+    {
+      orb_unadvertise(g_motion_pub);
+      g_motion_pub = -1;
+    }
+
+  LOG_INFO("Event trigger: audio events=%lu, motion events=%lu",
+           (unsigned long)g_audio_events, (unsigned long)g_motion_seq);
+}
+
+/****************************************************************************
+ * Name: event_trigger_burst
+ *
+ * Description:
+ *   Start (or extend) a full frame rate burst because of an event
+ *
+ ****************************************************************************/
+
+static void event_trigger_burst(const struct av_event *ev)
+{
+  orb_abstime now = orb_absolute_time();
+
+  if (now >= g_burst_until)
+    {
+      LOG_INFO("Burst start: source=%u type=%u score=%u (%lu us after event)",
+               ev->source, ev->type, ev->score,
+               (unsigned long)(now - ev->timestamp));
+    }
+
+  g_burst_until = now + EVENT_BURST_US;
+}
+
+/****************************************************************************
+ * Name: event_trigger_audio
+ *
+ * Description:
+ *   Consume every queued audio event
+ *
+ ****************************************************************************/
+
+static void event_trigger_audio(void)
+{
+  struct av_event ev;
+  bool updated;
+
+  while (orb_check(g_audio_sub, &updated) == 0 && updated)
+    {
+      if (orb_copy(ORB_ID(event_audio), g_audio_sub, &ev) < 0)
+        {
+          break;
+        }
+
+      g_audio_events++;
+      event_trigger_burst(&ev);
+    }
+}
+
+/****************************************************************************
+ * Name: event_trigger_motion
+ *
+ * Description:
+ *   Cheap motion estimate: the JPEG size of a static scene is stable, so a
+ *   large change against the running average means the scene changed.
+ *   Publishes "event_motion" (rate limited) and starts a burst.
+ *
+ ****************************************************************************/
+
+static void event_trigger_motion(uint32_t jpeg_size)
+{
+  struct av_event ev;
+  uint32_t avg = g_jpeg_size_avg;
+  uint32_t change;
+
+  if (avg == 0)
+    {
+      g_jpeg_size_avg = jpeg_size;
+      return;
+    }
+
+  change = (jpeg_size > avg ? jpeg_size - avg : avg - jpeg_size);
+  change = (uint32_t)((uint64_t)change * 100 / avg);
+
+  /* Average over ~8 frames */
+
+  g_jpeg_size_avg = avg + ((int32_t)(jpeg_size - avg)) / 8;
+
+  if (change < EVENT_MOTION_THRESHOLD)
+    {
+      return;
+    }
+
+  ev.timestamp = orb_absolute_time();
+  ev.source    = AV_EVENT_SOURCE_CAMERA;
+  ev.type      = AV_EVENT_MOTION;
+  ev.score     = change > UINT16_MAX ? UINT16_MAX : change;
+
+  if (ev.timestamp - g_last_motion >= EVENT_MOTION_HOLDOFF_US)
+    {
+      g_last_motion = ev.timestamp;
+      ev.seq = g_motion_seq++;
+      if (g_motion_pub >= 0)
+        {
+          orb_publish(ORB_ID(event_motion), g_motion_pub, &ev);
+        }
+    }
+
+  event_trigger_burst(&ev);
+}
+
+/****************************************************************************
+ * Name: event_trigger_wait
+ *
+ * Description:
+ *   Wait for the next frame slot (idle or burst rate). Returns early when
+ *   an audio event arrives, so it is reacted to within one frame.
+ *
+ ****************************************************************************/
+
+static void event_trigger_wait(void)
+{
+  struct pollfd pfd;
+  int timeout_ms;
+
+  timeout_ms = orb_absolute_time() < g_burst_until ?
+               1000 / CONFIG_CAMERA_FPS : 1000 / EVENT_IDLE_FPS;
+
+  if (g_audio_sub < 0)
+    {
+      usleep(timeout_ms * 1000);
+      return;
+    }
+
+  pfd.fd      = g_audio_sub;
+  pfd.events  = POLLIN;
+  pfd.revents = 0;
+
+  if (poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN) != 0)
+    {
+      event_trigger_audio();
+    }
+}
+
+#endif /* CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -352,13 +579,21 @@ void *camera_thread_func(void *arg)
       buffer->used = packet_size;
       total_jpeg_bytes += frame.size;  /* Accumulate JPEG size */
 
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+      event_trigger_motion(frame.size);
+#endif
+
       /* Phase 4.1: Track total frames for metrics */
 
       g_total_camera_frames++;
 
-      /* Step 4: Push filled buffer to action queue */
+      /* Step 4: Push filled buffer to action queue, HTTP viewers share
+       * the same buffer by reference
+       */
 
       pthread_mutex_lock(&g_queue_mutex);
+      buffer->refs = 1;
+      mjpeg_http_publish(buffer);
       frame_queue_push(&g_action_queue, buffer);
       pthread_cond_signal(&g_queue_cond);  /* Wake USB thread/main loop */
 
@@ -394,9 +629,15 @@ void *camera_thread_func(void *arg)
           g_last_metrics_time = now;
         }
 
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+      /* Idle or burst frame rate, woken early by audio events */
+
+      event_trigger_wait();
+#else
       /* Step 2: Maintain frame rate (30 fps = 33333 us per frame) */
 
       usleep(33333);  /* ~30 fps */
+#endif
     }
 
   /* Phase 4.1.1: Final statistics */
@@ -501,7 +742,7 @@ void *usb_thread_func(void *arg)
               /* Return buffer before exiting */
 
               pthread_mutex_lock(&g_queue_mutex);
-              frame_queue_push(&g_empty_queue, buffer);
+              frame_queue_release(buffer);
               pthread_mutex_unlock(&g_queue_mutex);
               break;
             }
@@ -521,7 +762,7 @@ void *usb_thread_func(void *arg)
               /* Return buffer before exiting */
 
               pthread_mutex_lock(&g_queue_mutex);
-              frame_queue_push(&g_empty_queue, buffer);
+              frame_queue_release(buffer);
               pthread_mutex_unlock(&g_queue_mutex);
               break;
             }
@@ -552,11 +793,12 @@ void *usb_thread_func(void *arg)
             }
         }
 
-      /* Step 3: Return buffer to empty queue for camera thread to reuse */
+      /* Step 3: Return buffer to empty queue for camera thread to reuse,
+       * unless HTTP viewers still send it
+       */
 
       pthread_mutex_lock(&g_queue_mutex);
-      frame_queue_push(&g_empty_queue, buffer);
-      pthread_cond_signal(&g_queue_cond);  /* Wake camera thread */
+      frame_queue_release(buffer);
       pthread_mutex_unlock(&g_queue_mutex);
     }
 
@@ -603,7 +845,8 @@ int camera_threads_init(thread_context_t *ctx)
 
   /* Allocate buffer pool (Step 2) */
 
-  ret = frame_queue_allocate_buffers(ctx->packet_buffer_size, MAX_QUEUE_DEPTH);
+  ret = frame_queue_allocate_buffers(ctx->packet_buffer_size,
+                                     MAX_QUEUE_DEPTH + MJPEG_HTTP_BUFFERS);
   if (ret < 0)
     {
       LOG_ERROR("Failed to allocate buffer pool: %d", ret);
@@ -611,6 +854,10 @@ int camera_threads_init(thread_context_t *ctx)
       return ret;
     }
 
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+  event_trigger_init();
+#endif
+
   /* Create camera thread with high priority */
 
   pthread_attr_init(&attr);
@@ -624,6 +871,9 @@ int camera_threads_init(thread_context_t *ctx)
   if (ret != 0)
     {
       LOG_ERROR("Failed to create camera thread: %d", ret);
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+      event_trigger_cleanup();
+#endif
       frame_queue_cleanup();
       return -ret;
     }
@@ -652,11 +902,23 @@ int camera_threads_init(thread_context_t *ctx)
       pthread_mutex_unlock(&g_queue_mutex);
 
       pthread_join(g_camera_thread, NULL);
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+      event_trigger_cleanup();
+#endif
       frame_queue_cleanup();
       return -ret;
     }
 
   LOG_INFO("USB thread created (priority %d)", USB_THREAD_PRIORITY);
+
+  /* The HTTP stream is optional, the USB stream runs without it */
+
+  ret = mjpeg_http_start();
+  if (ret < 0)
+    {
+      LOG_WARN("HTTP stream not available: %d", ret);
+    }
+
   LOG_INFO("Threading system initialized (Step 1: stub threads)");
 
   return 0;
@@ -718,6 +980,14 @@ void camera_threads_cleanup(void)
       LOG_INFO("USB thread joined successfully");
     }
 
+  /* Release the frames still held by HTTP viewers */
+
+  mjpeg_http_stop();
+
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_EVENT_TRIGGER
+  event_trigger_cleanup();
+#endif
+
   /* Cleanup frame queue system */
 
   frame_queue_cleanup();
@@ -49,6 +49,7 @@
 
 #define CAMERA_THREAD_PRIORITY  110  /* Higher priority for camera */
 #define USB_THREAD_PRIORITY     100  /* Lower priority for USB */
+#define HTTP_THREAD_PRIORITY    90   /* Viewers must not delay USB */
 #define THREAD_STACK_SIZE       4096 /* 4KB stack per thread */
 
 /****************************************************************************
@@ -239,6 +239,28 @@ frame_buffer_t *frame_queue_pull(frame_buffer_t **queue)
   return buf;
 }
 
+/****************************************************************************
+ * Name: frame_queue_release
+ *
+ * Description:
+ *   Drop one reference to a filled buffer. The USB thread and each HTTP
+ *   viewer hold one; the buffer is recycled when the last one is dropped.
+ *   Caller must hold g_queue_mutex
+ *
+ ****************************************************************************/
+
+void frame_queue_release(frame_buffer_t *buf)
+{
+  if (buf == NULL || --buf->refs > 0)
+    {
+      return;
+    }
+
+  buf->refs = 0;
+  frame_queue_push(&g_empty_queue, buf);
+  pthread_cond_broadcast(&g_queue_cond);  /* Wake camera thread */
+}
+
 /****************************************************************************
  * Name: frame_queue_is_empty
  *
@@ -61,6 +61,7 @@ typedef struct frame_buffer_s
   uint32_t length;         /* Buffer capacity */
   uint32_t used;           /* Actual data length */
   int id;                  /* Buffer index */
+  int refs;                /* Consumers still using the frame */
   struct frame_buffer_s *next;  /* Linked list pointer */
 } frame_buffer_t;
 
@@ -120,6 +121,14 @@ void frame_queue_push(frame_buffer_t **queue, frame_buffer_t *buf);
 
 frame_buffer_t *frame_queue_pull(frame_buffer_t **queue);
 
+/**
+ * @brief Drop one reference, the last one returns the buffer to the empty
+ *        queue (caller must hold mutex)
+ * @param buf Buffer to release
+ */
+
+void frame_queue_release(frame_buffer_t *buf);
+
 /**
  * @brief Check if queue is empty (caller must hold mutex)
  * @param queue Queue head
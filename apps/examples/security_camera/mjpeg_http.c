@@ -0,0 +1,790 @@
+/****************************************************************************
+ * security_camera/mjpeg_http.c
+ *
+ *   Copyright 2025 Security Camera Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <syslog.h>
+
+#include "mjpeg_http.h"
+#include "mjpeg_protocol.h"
+#include "camera_threads.h"
+#include "frame_queue.h"
+#include "config.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HTTP_PORT         CONFIG_EXAMPLES_SECURITY_CAMERA_HTTP_PORT
+#define HTTP_MAX_CLIENTS  CONFIG_EXAMPLES_SECURITY_CAMERA_HTTP_CLIENTS
+#define HTTP_POOL_SIZE    (MAX_QUEUE_DEPTH + MJPEG_HTTP_BUFFERS)
+#define HTTP_HEAD_MAX     256   /* Request, response or part header */
+#define HTTP_BOUNDARY     "mjpegframe"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Viewer state: the response header is sent once, then every frame is one
+ * multipart part sent straight from the packed frame buffer:
+ *
+ *   [part header] [JPEG from buffer->data + MJPEG_HEADER_SIZE] [CRLF]
+ */
+
+typedef enum http_state_e
+{
+  HTTP_FREE = 0,          /* Slot unused */
+  HTTP_REQUEST,           /* Reading the request */
+  HTTP_HEADER,            /* Sending the response header */
+  HTTP_IDLE,              /* Waiting for a newer frame */
+  HTTP_FRAME              /* Sending a frame */
+} http_state_t;
+
+typedef struct http_client_s
+{
+  int fd;
+  http_state_t state;
+  bool close;             /* Close after the response header (errors) */
+  frame_buffer_t *frame;  /* Frame being sent, holds one reference */
+  uint32_t seq;           /* Publish sequence of the last frame taken */
+  uint32_t offset;        /* Bytes of the header or part already sent */
+  uint16_t headlen;
+  char head[HTTP_HEAD_MAX];
+  uint32_t frames;        /* Statistics */
+  uint32_t skipped;
+} http_client_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static http_client_t g_http_clients[HTTP_MAX_CLIENTS];
+static pthread_t g_http_thread;
+static int g_http_listen_fd = -1;
+static int g_http_wake[2] = { -1, -1 };   /* Pipe: new frame published */
+static volatile bool g_http_running = false;
+
+/* Protected by g_queue_mutex */
+
+static frame_buffer_t *g_http_latest;     /* Latest frame, one reference */
+static uint32_t g_http_latest_seq;
+static uint8_t g_http_pins[HTTP_POOL_SIZE];  /* HTTP references per buffer */
+static int g_http_npinned;                /* Buffers with HTTP references */
+static int g_http_nviewers;
+static uint32_t g_http_dropped;           /* Frames not offered to viewers */
+
+static const char g_http_stream_header[] =
+  "HTTP/1.0 200 OK\r\n"
+  "Content-Type: multipart/x-mixed-replace; boundary=" HTTP_BOUNDARY "\r\n"
+  "Cache-Control: no-cache, no-store\r\n"
+  "Pragma: no-cache\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+static const char g_http_not_found[] =
+  "HTTP/1.0 404 Not Found\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+static const char g_http_bad_request[] =
+  "HTTP/1.0 400 Bad Request\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: http_pin / http_unpin
+ *
+ * Description:
+ *   Take or drop an HTTP reference on a frame buffer, counting how many
+ *   distinct buffers the viewers hold. Caller must hold g_queue_mutex
+ *
+ ****************************************************************************/
+
+static void http_pin(frame_buffer_t *buf)
+{
+  if (g_http_pins[buf->id]++ == 0)
+    {
+      g_http_npinned++;
+    }
+
+  buf->refs++;
+}
+
+static void http_unpin(frame_buffer_t *buf)
+{
+  if (--g_http_pins[buf->id] == 0)
+    {
+      g_http_npinned--;
+    }
+
+  frame_queue_release(buf);
+}
+
+/****************************************************************************
+ * Name: http_client_close
+ ****************************************************************************/
+
+static void http_client_close(http_client_t *client)
+{
+  close(client->fd);
+
+  pthread_mutex_lock(&g_queue_mutex);
+  if (client->frame != NULL)
+    {
+      http_unpin(client->frame);
+    }
+
+  if (client->state >= HTTP_HEADER && !client->close)
+    {
+      g_http_nviewers--;
+    }
+
+  pthread_mutex_unlock(&g_queue_mutex);
+
+  if (client->frames > 0)
+    {
+      LOG_INFO("HTTP viewer %d closed: %lu frames sent, %lu skipped",
+               (int)(client - g_http_clients),
+               (unsigned long)client->frames,
+               (unsigned long)client->skipped);
+    }
+
+  memset(client, 0, sizeof(http_client_t));
+  client->fd = -1;
+}
+
+/****************************************************************************
+ * Name: http_client_respond
+ ****************************************************************************/
+
+static void http_client_respond(http_client_t *client, const char *header,
+                                bool close)
+{
+  client->headlen = strlen(header);
+  memcpy(client->head, header, client->headlen);
+  client->offset = 0;
+  client->close  = close;
+  client->state  = HTTP_HEADER;
+
+  if (!close)
+    {
+      pthread_mutex_lock(&g_queue_mutex);
+      g_http_nviewers++;
+      pthread_mutex_unlock(&g_queue_mutex);
+    }
+}
+
+/****************************************************************************
+ * Name: http_client_request
+ *
+ * Description:
+ *   Read the request. "GET /" and "GET /stream" start the stream, the
+ *   request headers are ignored.
+ *
+ ****************************************************************************/
+
+static void http_client_request(http_client_t *client)
+{
+  const char *path;
+  ssize_t n;
+  size_t len;
+
+  n = recv(client->fd, client->head + client->headlen,
+           HTTP_HEAD_MAX - 1 - client->headlen, 0);
+  if (n <= 0)
+    {
+      if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+          http_client_close(client);
+        }
+
+      return;
+    }
+
+  client->headlen += n;
+  client->head[client->headlen] = '\0';
+
+  if (strstr(client->head, "\r\n\r\n") == NULL)
+    {
+      if (client->headlen >= HTTP_HEAD_MAX - 1)
+        {
+          http_client_respond(client, g_http_bad_request, true);
+        }
+
+      return;
+    }
+
+  if (strncmp(client->head, "GET ", 4) != 0)
+    {
+      http_client_respond(client, g_http_bad_request, true);
+      return;
+    }
+
+  path = client->head + 4;
+  len  = strcspn(path, " ?\r\n");
+
+  if ((len == 1 && path[0] == '/') ||
+      (len == 7 && strncmp(path, "/stream", 7) == 0))
+    {
+      http_client_respond(client, g_http_stream_header, false);
+    }
+  else
+    {
+      http_client_respond(client, g_http_not_found, true);
+    }
+}
+
+/****************************************************************************
+ * Name: http_client_next
+ *
+ * Description:
+ *   Take a reference on the latest frame if the viewer has not sent it
+ *   yet. Frames published while the viewer was busy are skipped.
+ *
+ ****************************************************************************/
+
+static bool http_client_next(http_client_t *client)
+{
+  frame_buffer_t *frame = NULL;
+  uint32_t seq;
+
+  pthread_mutex_lock(&g_queue_mutex);
+  seq = g_http_latest_seq;
+  if (g_http_latest != NULL && seq != client->seq)
+    {
+      frame = g_http_latest;
+      http_pin(frame);
+    }
+
+  pthread_mutex_unlock(&g_queue_mutex);
+
+  if (frame == NULL)
+    {
+      return false;
+    }
+
+  if (client->frames > 0)
+    {
+      client->skipped += seq - client->seq - 1;
+    }
+
+  client->frame   = frame;
+  client->seq     = seq;
+  client->offset  = 0;
+  client->headlen = snprintf(client->head, HTTP_HEAD_MAX,
+                             "--" HTTP_BOUNDARY "\r\n"
+                             "Content-Type: image/jpeg\r\n"
+                             "Content-Length: %lu\r\n"
+                             "\r\n",
+                             (unsigned long)(frame->used -
+                                             MJPEG_OVERHEAD_SIZE));
+  client->state   = HTTP_FRAME;
+  return true;
+}
+
+/****************************************************************************
+ * Name: http_client_send
+ *
+ * Description:
+ *   Send as much of the header or part as the socket takes.
+ *
+ * Returns:
+ *   1 when complete, 0 when the socket is full, negative errno on failure
+ *
+ ****************************************************************************/
+
+static int http_client_send(http_client_t *client)
+{
+  const uint8_t *jpeg = NULL;
+  const uint8_t *p;
+  uint32_t jpeglen = 0;
+  uint32_t total;
+  uint32_t len;
+  ssize_t n;
+
+  if (client->frame != NULL)
+    {
+      jpeg    = (const uint8_t *)client->frame->data + MJPEG_HEADER_SIZE;
+      jpeglen = client->frame->used - MJPEG_OVERHEAD_SIZE;
+      total   = client->headlen + jpeglen + 2;
+    }
+  else
+    {
+      total   = client->headlen;
+    }
+
+  while (client->offset < total)
+    {
+      if (client->offset < client->headlen)
+        {
+          p   = (const uint8_t *)client->head + client->offset;
+          len = client->headlen - client->offset;
+        }
+      else if (client->offset < client->headlen + jpeglen)
+        {
+          p   = jpeg + client->offset - client->headlen;
+          len = client->headlen + jpeglen - client->offset;
+        }
+      else
+        {
+          p   = (const uint8_t *)"\r\n" +
+                (client->offset - client->headlen - jpeglen);
+          len = total - client->offset;
+        }
+
+      n = send(client->fd, p, len, 0);
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -errno;
+        }
+
+      client->offset += n;
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Name: http_client_run
+ *
+ * Description:
+ *   Push data to a viewer until its socket is full or it has sent the
+ *   latest frame.
+ *
+ ****************************************************************************/
+
+static void http_client_run(http_client_t *client)
+{
+  int ret;
+
+  for (; ; )
+    {
+      if (client->state == HTTP_IDLE && !http_client_next(client))
+        {
+          return;
+        }
+
+      if (client->state != HTTP_HEADER && client->state != HTTP_FRAME)
+        {
+          return;
+        }
+
+      ret = http_client_send(client);
+      if (ret <= 0)
+        {
+          if (ret < 0)
+            {
+              http_client_close(client);
+            }
+
+          return;
+        }
+
+      if (client->state == HTTP_HEADER && client->close)
+        {
+          http_client_close(client);
+          return;
+        }
+
+      if (client->frame != NULL)
+        {
+          pthread_mutex_lock(&g_queue_mutex);
+          http_unpin(client->frame);
+          pthread_mutex_unlock(&g_queue_mutex);
+
+          client->frame = NULL;
+          client->frames++;
+        }
+
+      client->state = HTTP_IDLE;
+    }
+}
+
+/****************************************************************************
+ * Name: http_accept
+ ****************************************************************************/
+
+static void http_accept(void)
+{
+  http_client_t *client = NULL;
+  int fd;
+  int i;
+
+  fd = accept(g_http_listen_fd, NULL, NULL);
+  if (fd < 0)
+    {
+      return;
+    }
+
+  for (i = 0; i < HTTP_MAX_CLIENTS; i++)
+    {
+      if (g_http_clients[i].state == HTTP_FREE)
+        {
+          client = &g_http_clients[i];
+          break;
+        }
+    }
+
+  if (client == NULL)
+    {
+      LOG_WARN("HTTP: too many viewers, connection refused");
+      close(fd);
+      return;
+    }
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  memset(client, 0, sizeof(http_client_t));
+  client->fd    = fd;
+  client->state = HTTP_REQUEST;
+}
+
+/****************************************************************************
+ * Name: http_thread_func
+ ****************************************************************************/
+
+static void *http_thread_func(void *arg)
+{
+  struct pollfd pfds[HTTP_MAX_CLIENTS + 2];
+  http_client_t *client;
+  char discard[32];
+  ssize_t n;
+  int i;
+
+  (void)arg;
+
+  LOG_INFO("== HTTP thread started ==");
+
+  while (g_http_running)
+    {
+      pfds[0].fd     = g_http_listen_fd;
+      pfds[0].events = POLLIN;
+      pfds[1].fd     = g_http_wake[0];
+      pfds[1].events = POLLIN;
+
+      for (i = 0; i < HTTP_MAX_CLIENTS; i++)
+        {
+          client = &g_http_clients[i];
+
+          pfds[i + 2].fd      = client->state == HTTP_FREE ? -1 : client->fd;
+          pfds[i + 2].events  = (client->state == HTTP_HEADER ||
+                                 client->state == HTTP_FRAME) ?
+                                POLLOUT : POLLIN;
+          pfds[i + 2].revents = 0;
+        }
+
+      pfds[0].revents = 0;
+      pfds[1].revents = 0;
+
+      if (poll(pfds, HTTP_MAX_CLIENTS + 2, 1000) < 0)
+        {
+          if (errno != EINTR)
+            {
+              LOG_ERROR("HTTP: poll failed: %d", errno);
+              usleep(100000);
+            }
+
+          continue;
+        }
+
+      if (pfds[1].revents & POLLIN)
+        {
+          while (read(g_http_wake[0], discard, sizeof(discard)) > 0)
+            {
+            }
+        }
+
+      if (pfds[0].revents & POLLIN)
+        {
+          http_accept();
+        }
+
+      for (i = 0; i < HTTP_MAX_CLIENTS; i++)
+        {
+          client = &g_http_clients[i];
+          if (client->state == HTTP_FREE || pfds[i + 2].fd < 0)
+            {
+              continue;
+            }
+
+          if (pfds[i + 2].revents & (POLLERR | POLLHUP))
+            {
+              http_client_close(client);
+              continue;
+            }
+
+          if (pfds[i + 2].revents & POLLIN)
+            {
+              if (client->state == HTTP_REQUEST)
+                {
+                  http_client_request(client);
+                }
+              else
+                {
+                  /* Browsers send nothing more, only notice the close */
+
+                  n = recv(client->fd, discard, sizeof(discard), 0);
+                  if (n == 0 || (n < 0 && errno != EAGAIN &&
+                                 errno != EWOULDBLOCK))
+                    {
+                      http_client_close(client);
+                    }
+                }
+            }
+
+          if (client->state >= HTTP_HEADER)
+            {
+              http_client_run(client);
+            }
+        }
+    }
+
+  LOG_INFO("== HTTP thread exiting ==");
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mjpeg_http_start
+ *
+ * Description:
+ *   Open the listening socket and start the server thread
+ *
+ ****************************************************************************/
+
+int mjpeg_http_start(void)
+{
+  struct sockaddr_in addr;
+  struct sched_param sparam;
+  pthread_attr_t attr;
+  int optval = 1;
+  int ret;
+  int i;
+
+  for (i = 0; i < HTTP_MAX_CLIENTS; i++)
+    {
+      memset(&g_http_clients[i], 0, sizeof(http_client_t));
+      g_http_clients[i].fd = -1;
+    }
+
+  memset(g_http_pins, 0, sizeof(g_http_pins));
+  g_http_latest     = NULL;
+  g_http_latest_seq = 0;
+  g_http_npinned    = 0;
+  g_http_nviewers   = 0;
+  g_http_dropped    = 0;
+
+  if (pipe(g_http_wake) < 0)
+    {
+      LOG_ERROR("HTTP: failed to create wake pipe: %d", errno);
+      return -errno;
+    }
+
+  fcntl(g_http_wake[0], F_SETFL, fcntl(g_http_wake[0], F_GETFL) | O_NONBLOCK);
+  fcntl(g_http_wake[1], F_SETFL, fcntl(g_http_wake[1], F_GETFL) | O_NONBLOCK);
+
+  g_http_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (g_http_listen_fd < 0)
+    {
+      ret = -errno;
+      LOG_ERROR("HTTP: failed to create socket: %d", ret);
+      goto errout;
+    }
+
+  setsockopt(g_http_listen_fd, SOL_SOCKET, SO_REUSEADDR, &optval,
+             sizeof(optval));
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(HTTP_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+  if (bind(g_http_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(g_http_listen_fd, HTTP_MAX_CLIENTS) < 0)
+    {
+      ret = -errno;
+      LOG_ERROR("HTTP: failed to listen on port %d: %d", HTTP_PORT, ret);
+      goto errout;
+    }
+
+  g_http_running = true;
+
+  pthread_attr_init(&attr);
+  sparam.sched_priority = HTTP_THREAD_PRIORITY;
+  pthread_attr_setschedparam(&attr, &sparam);
+  pthread_attr_setstacksize(&attr, THREAD_STACK_SIZE);
+
+  ret = pthread_create(&g_http_thread, &attr, http_thread_func, NULL);
+  pthread_attr_destroy(&attr);
+
+  if (ret != 0)
+    {
+      LOG_ERROR("Failed to create HTTP thread: %d", ret);
+      g_http_running = false;
+      ret = -ret;
+      goto errout;
+    }
+
+  LOG_INFO("MJPEG HTTP stream on port %d (%d viewers, %d buffers)",
+           HTTP_PORT, HTTP_MAX_CLIENTS, MJPEG_HTTP_BUFFERS);
+  return 0;
+
+errout:
+  if (g_http_listen_fd >= 0)
+    {
+      close(g_http_listen_fd);
+      g_http_listen_fd = -1;
+    }
+
+  close(g_http_wake[0]);
+  close(g_http_wake[1]);
+  g_http_wake[0] = -1;
+  g_http_wake[1] = -1;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mjpeg_http_stop
+ *
+ * Description:
+ *   Stop the server thread, close all viewers and release their frames
+ *
+ ****************************************************************************/
+
+void mjpeg_http_stop(void)
+{
+  char c = 0;
+  int i;
+
+  if (!g_http_running)
+    {
+      return;
+    }
+
+  g_http_running = false;
+  write(g_http_wake[1], &c, 1);
+  pthread_join(g_http_thread, NULL);
+
+  for (i = 0; i < HTTP_MAX_CLIENTS; i++)
+    {
+      if (g_http_clients[i].state != HTTP_FREE)
+        {
+          http_client_close(&g_http_clients[i]);
+        }
+    }
+
+  pthread_mutex_lock(&g_queue_mutex);
+  if (g_http_latest != NULL)
+    {
+      http_unpin(g_http_latest);
+      g_http_latest = NULL;
+    }
+
+  pthread_mutex_unlock(&g_queue_mutex);
+
+  close(g_http_listen_fd);
+  close(g_http_wake[0]);
+  close(g_http_wake[1]);
+  g_http_listen_fd = -1;
+  g_http_wake[0]   = -1;
+  g_http_wake[1]   = -1;
+
+  LOG_INFO("HTTP server stopped (%lu frames not offered to busy viewers)",
+           (unsigned long)g_http_dropped);
+}
+
+/****************************************************************************
+ * Name: mjpeg_http_publish
+ *
+ * Description:
+ *   Make a new frame the latest one. Called by the camera thread with
+ *   g_queue_mutex held, never blocks.
+ *
+ ****************************************************************************/
+
+void mjpeg_http_publish(frame_buffer_t *buf)
+{
+  char c = 0;
+
+  if (g_http_latest != NULL)
+    {
+      http_unpin(g_http_latest);
+      g_http_latest = NULL;
+    }
+
+  if (!g_http_running || g_http_nviewers == 0)
+    {
+      return;
+    }
+
+  /* Viewers busy with MJPEG_HTTP_BUFFERS different frames: taking another
+   * buffer would come out of the camera's share of the pool.
+   */
+
+  if (g_http_npinned >= MJPEG_HTTP_BUFFERS)
+    {
+      g_http_dropped++;
+      return;
+    }
+
+  http_pin(buf);
+  g_http_latest = buf;
+  g_http_latest_seq++;
+
+  write(g_http_wake[1], &c, 1);
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ * security_camera/mjpeg_http.h
+ *
+ *   Copyright 2025 Security Camera Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __SECURITY_CAMERA_MJPEG_HTTP_H
+#define __SECURITY_CAMERA_MJPEG_HTTP_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include "frame_queue.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Buffers added to the pool for HTTP viewers. The server never holds more
+ * than this many frames at once, so the camera and USB threads always keep
+ * their MAX_QUEUE_DEPTH buffers.
+ */
+
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_HTTP
+#  define MJPEG_HTTP_BUFFERS  CONFIG_EXAMPLES_SECURITY_CAMERA_HTTP_BUFFERS
+#else
+#  define MJPEG_HTTP_BUFFERS  0
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef CONFIG_EXAMPLES_SECURITY_CAMERA_HTTP
+
+/**
+ * @brief Start the HTTP MJPEG server thread
+ * @return 0: success, <0: error
+ */
+
+int mjpeg_http_start(void);
+
+/**
+ * @brief Stop the server, close all viewers and release their frames
+ */
+
+void mjpeg_http_stop(void);
+
+/**
+ * @brief Offer a packed frame to the HTTP viewers (caller must hold mutex)
+ *
+ * The frame replaces the previous one; viewers still sending an older
+ * frame pick up whichever frame is latest when they finish. The server
+ * takes a reference on the buffer, it goes back to the empty queue when
+ * the last reference is released.
+ *
+ * @param buf Buffer holding an MJPEG protocol packet
+ */
+
+void mjpeg_http_publish(frame_buffer_t *buf);
+
+#else
+#  define mjpeg_http_start()     (0)
+#  define mjpeg_http_stop()
+#  define mjpeg_http_publish(b)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SECURITY_CAMERA_MJPEG_HTTP_H */
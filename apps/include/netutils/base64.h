@@ -58,6 +58,44 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The most a base64_encode_update() or base64_decode_update() call can
+ * write for n bytes of input.  The final calls write at most 4 and 2 bytes.
+ */
+
+#define BASE64_ENCODE_UPDATE_LEN(n) (((n) + 2) / 3 * 4)
+#define BASE64_DECODE_UPDATE_LEN(n) (((n) + 3) * 3 / 4)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Streaming encoder and decoder state.  Data can be passed in pieces of
+ * any size, the output is the same as for a single call.
+ */
+
+struct base64_encode_s
+{
+  uint8_t  tail[2];     /* Input bytes carried to the next call */
+  uint8_t  ntail;
+  bool     websafe;
+};
+
+struct base64_decode_s
+{
+  uint32_t bits;        /* Sextets carried to the next call */
+  uint8_t  nbits;       /* Number of sextets in bits */
+  bool     websafe;
+  bool     done;        /* Padding seen, the rest is ignored */
+};
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -78,6 +116,17 @@ FAR void *base64w_encode(FAR const void *src, size_t len, FAR void *dst,
                          FAR size_t *out_len);
 FAR void *base64w_decode(FAR const void *src, size_t len, FAR void *dst,
                          FAR size_t *out_len);
+
+void base64_encode_init(FAR struct base64_encode_s *ctx, bool websafe);
+size_t base64_encode_update(FAR struct base64_encode_s *ctx,
+                            FAR const void *src, size_t len,
+                            FAR void *dst);
+size_t base64_encode_final(FAR struct base64_encode_s *ctx, FAR void *dst);
+void base64_decode_init(FAR struct base64_decode_s *ctx, bool websafe);
+ssize_t base64_decode_update(FAR struct base64_decode_s *ctx,
+                             FAR const void *src, size_t len,
+                             FAR void *dst);
+ssize_t base64_decode_final(FAR struct base64_decode_s *ctx, FAR void *dst);
 #endif /* CONFIG_CODECS_BASE64 */
 
 #ifdef __cplusplus
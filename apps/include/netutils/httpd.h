@@ -93,6 +93,7 @@
 #define HTTPD_MAX_CONTENTLEN  32
 #define HTTPD_MAX_HEADERLEN   220
 #define HTTPD_MAX_CHUNKEDLEN  16
+#define HTTPD_MAX_IFNONEMATCH 64
 
 /****************************************************************************
  * Public types
@@ -115,8 +116,14 @@ struct httpd_state
 {
   char ht_buffer[HTTPD_IOBUFFER_SIZE];  /* recv() buffer */
   char ht_filename[HTTPD_MAX_FILENAME]; /* filename from GET command */
+  bool ht_http11;                       /* Request was HTTP/1.1 */
 #ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
   bool ht_keepalive;                    /* Connection: keep-alive */
+  uint16_t ht_buflen;                   /* Pipelined bytes in ht_buffer */
+#endif
+#ifdef CONFIG_NETUTILS_HTTPD_CACHE
+  bool ht_gzip;                         /* Accept-Encoding: gzip */
+  char ht_ifnonematch[HTTPD_MAX_IFNONEMATCH]; /* If-None-Match */
 #endif
 #if defined(CONFIG_NETUTILS_HTTPD_ENABLE_CHUNKED_ENCODING)
   bool ht_chunked;                      /* Server uses chunked encoding for tx */
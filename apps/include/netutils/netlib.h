@@ -148,6 +148,24 @@ struct url_s
 };
 #endif
 
+/* Configuration of netlib_server_pool().  The handler runs on one of
+ * nworkers threads for each accepted connection and must close the
+ * socket.  buffer is the worker's own bufsize bytes, allocated once and
+ * reused for every connection that worker serves.  Up to qdepth accepted
+ * connections wait for a free worker, after that accept() is held off.
+ */
+
+typedef CODE void (*netlib_connhandler_t)(int sockfd, FAR void *buffer);
+
+struct netlib_server_pool_s
+{
+  netlib_connhandler_t handler;   /* Connection handler */
+  size_t bufsize;                 /* Per-worker buffer size, may be 0 */
+  int nworkers;                   /* Number of worker threads */
+  int stacksize;                  /* Stack size of each worker */
+  int qdepth;                     /* Accepted connections queued */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -352,6 +370,8 @@ int netlib_parseurl(FAR const char *str, FAR struct url_s *url);
 int netlib_listenon(uint16_t portno);
 void netlib_server(uint16_t portno, pthread_startroutine_t handler,
                    int stacksize);
+int netlib_server_pool(uint16_t portno,
+                       FAR const struct netlib_server_pool_s *config);
 
 int netlib_getifstatus(FAR const char *ifname, FAR uint8_t *flags);
 int netlib_ifup(FAR const char *ifname);
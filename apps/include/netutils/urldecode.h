@@ -27,6 +27,32 @@
 
 #include <nuttx/config.h>
 
+#include <stddef.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The most urlencode_update() or urldecode_update() can write for n bytes
+ * of input.  urldecode_final() writes at most 2 bytes.
+ */
+
+#define URLENCODE_UPDATE_LEN(n) ((n) * 3)
+#define URLDECODE_UPDATE_LEN(n) ((n) + 2)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Streaming decoder state: a %XX escape split between two calls */
+
+struct urldecode_s
+{
+  uint8_t npending;     /* Characters of the escape seen, '%' included */
+  char    pending[2];
+};
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -48,6 +74,12 @@ char *urldecode(const char *src, const int src_len,
                 char *dest, int *dest_len);
 int urlencode_len(const char *src, const int src_len);
 int urldecode_len(const char *src, const int src_len);
+
+size_t urlencode_update(FAR const char *src, size_t len, FAR char *dst);
+void urldecode_init(FAR struct urldecode_s *ctx);
+size_t urldecode_update(FAR struct urldecode_s *ctx, FAR const char *src,
+                        size_t len, FAR char *dst);
+size_t urldecode_final(FAR struct urldecode_s *ctx, FAR char *dst);
 #endif /* CONFIG_CODECS_URLCODE */
 
 #ifdef CONFIG_CODECS_AVR_URLCODE
@@ -0,0 +1,73 @@
+/****************************************************************************
+ * apps/include/netutils/xxhash.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_NETUTILS_XXHASH_H
+#define __APPS_INCLUDE_NETUTILS_XXHASH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef CONFIG_CODECS_HASH_XXH32
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* XXH32, a fast non-cryptographic hash.  Use it for ETags, deduplication
+ * and checks against accidental corruption, not against tampering.
+ */
+
+struct xxh32_context_s
+{
+  uint32_t v[4];        /* Accumulators */
+  uint32_t seed;
+  uint32_t total;       /* Bytes hashed, modulo 2^32 */
+  uint8_t  large;       /* At least 16 bytes were hashed */
+  uint8_t  nmem;
+  uint8_t  mem[16];     /* Stripe carried to the next call */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+void xxh32_init(FAR struct xxh32_context_s *ctx, uint32_t seed);
+void xxh32_update(FAR struct xxh32_context_s *ctx, FAR const void *buf,
+                  size_t len);
+uint32_t xxh32_final(FAR struct xxh32_context_s *ctx);
+uint32_t xxh32(FAR const void *buf, size_t len, uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_CODECS_HASH_XXH32 */
+#endif /* __APPS_INCLUDE_NETUTILS_XXHASH_H */
@@ -29,6 +29,8 @@
 
 #include <mqueue.h>
 #include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -38,6 +40,20 @@
  * Public Type Declarations
  ****************************************************************************/
 
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+/* Round-trip latency measured by the impulse test, times in us */
+
+struct nxlooper_latency_s
+{
+  uint32_t        nmeasured;                   /* Impulses that came back */
+  uint32_t        nmissed;                     /* Impulses never detected */
+  uint32_t        last;                        /* Latest round trip */
+  uint32_t        min;                         /* Shortest round trip */
+  uint32_t        max;                         /* Longest round trip */
+  uint64_t        total;                       /* Sum, for the average */
+};
+#endif
+
 /* This structure describes the internal state of the NxLooper */
 
 struct nxlooper_s
@@ -67,6 +83,17 @@ struct nxlooper_s
 #ifndef CONFIG_AUDIO_EXCLUDE_VOLUME
   uint16_t        volume;                      /* Volume as a whole percentage (0-100) */
 #endif
+
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  uint32_t        period_bytes;                /* Buffer size, 0 for driver's */
+  uint8_t         nperiods;                    /* Buffer count, 0 for driver's */
+  bool            passthrough;                 /* Forward recorded buffers */
+  bool            latencytest;                 /* Run the impulse test */
+  uint8_t         nchannels;                   /* Format of the loopback */
+  uint8_t         bpsamp;
+  uint32_t        samprate;
+  struct nxlooper_latency_s latency;           /* Impulse test results */
+#endif
 };
 
 /****************************************************************************
@@ -276,6 +303,85 @@ int nxlooper_setvolume(FAR struct nxlooper_s *plooper, uint16_t volume);
 int nxlooper_systemreset(FAR struct nxlooper_s *plooper);
 #endif
 
+/****************************************************************************
+ * Name: nxlooper_setperiod
+ *
+ *   Sets the size and number of the audio buffers used by the next
+ *   loopback.  Smaller and fewer periods lower the latency at the cost of
+ *   more frequent buffer handling.
+ *
+ * Input Parameters:
+ *   plooper   - Pointer to the NxLooper context
+ *   nbytes    - Buffer size in bytes, 0 to use the driver's
+ *   nperiods  - Number of buffers per device, 0 to use the driver's
+ *
+ * Returned Value:
+ *   OK if the setting was accepted, -EBUSY while looping.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+int nxlooper_setperiod(FAR struct nxlooper_s *plooper, uint32_t nbytes,
+                       uint8_t nperiods);
+
+/****************************************************************************
+ * Name: nxlooper_setpassthrough
+ *
+ *   Selects whether the next loopback hands each recorded buffer straight
+ *   to the playback device instead of copying it into a playback buffer.
+ *   Both devices must then accept each other's buffers, which is the case
+ *   for the generic audio buffer allocator.
+ *
+ * Input Parameters:
+ *   plooper   - Pointer to the NxLooper context
+ *   enable    - true to forward buffers, false to copy them
+ *
+ * Returned Value:
+ *   OK if the setting was accepted, -EBUSY while looping.
+ *
+ ****************************************************************************/
+
+int nxlooper_setpassthrough(FAR struct nxlooper_s *plooper, bool enable);
+
+/****************************************************************************
+ * Name: nxlooper_setlatencytest
+ *
+ *   Enables the round-trip latency test for the next loopback.  The input
+ *   is replaced by silence with an impulse every half second, and the time
+ *   between the capture of a buffer carrying an impulse and the capture of
+ *   its return is accumulated.  Needs 16 bit samples and the output wired
+ *   back to the input.
+ *
+ * Input Parameters:
+ *   plooper   - Pointer to the NxLooper context
+ *   enable    - true to run the test
+ *
+ * Returned Value:
+ *   OK if the setting was accepted, -EBUSY while looping.
+ *
+ ****************************************************************************/
+
+int nxlooper_setlatencytest(FAR struct nxlooper_s *plooper, bool enable);
+
+/****************************************************************************
+ * Name: nxlooper_getlatency
+ *
+ *   Returns the results of the latency test so far.  They are reset when
+ *   a loopback with the test enabled starts.
+ *
+ * Input Parameters:
+ *   plooper   - Pointer to the NxLooper context
+ *   latency   - Location to return the results
+ *
+ * Returned Value:
+ *   OK
+ *
+ ****************************************************************************/
+
+int nxlooper_getlatency(FAR struct nxlooper_s *plooper,
+                        FAR struct nxlooper_latency_s *latency);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -34,6 +34,11 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#if defined(CONFIG_NXPLAYER_PLAYLIST) && \
+    !defined(CONFIG_NXPLAYER_PLAYLIST_MAXTRACKS)
+#  define CONFIG_NXPLAYER_PLAYLIST_MAXTRACKS 16
+#endif
+
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
@@ -46,6 +51,48 @@ struct nxplayer_dec_ops_s
   CODE int (*fill_data)(int fd, FAR struct ap_buffer_s *apb);
 };
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+/* Read-ahead statistics of the current (or last) playback.  A minfill of
+ * zero together with late dequeues means the read-ahead ring ran dry and
+ * CONFIG_NXPLAYER_READAHEAD_NBUFFERS should be raised; a minfill that stays
+ * well above zero means it can be lowered.
+ */
+
+struct nxplayer_rastat_s
+{
+  uint32_t nreads;   /* Buffers filled by the read-ahead thread */
+  uint32_t nlate;    /* Dequeues that found no filled buffer */
+  uint32_t maxread;  /* Longest single buffer read in microseconds */
+  uint16_t depth;    /* Buffers read ahead of the device queue */
+  uint16_t minfill;  /* Fewest filled buffers seen at a dequeue */
+};
+#endif
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+/* What the device has to be configured for to play a track.  Consecutive
+ * tracks with the same format continue one stream; any difference ends the
+ * stream and the device is reconfigured for the next track.
+ */
+
+struct nxplayer_fmt_s
+{
+  int      format;     /* AUDIO_FMT_xxx */
+  uint32_t samprate;   /* Zero if not known from the header */
+  uint8_t  nchannels;
+  uint8_t  bpsamp;
+  uint8_t  chmap;
+};
+
+/* Playlist state of the current (or last) playback */
+
+struct nxplayer_plstat_s
+{
+  uint16_t queued;     /* Tracks waiting, including a prefetched one */
+  uint16_t ngapless;   /* Tracks that continued the stream */
+  uint16_t nrestart;   /* Tracks that needed the device reconfigured */
+};
+#endif
+
 /* This structure describes the internal state of the NxPlayer */
 
 struct nxplayer_s
@@ -79,6 +126,19 @@ struct nxplayer_s
   uint16_t        treble;                      /* Treble as a whole % */
   uint16_t        bass;                        /* Bass as a whole % */
 #endif
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  struct nxplayer_rastat_s rastat;             /* Read-ahead statistics */
+#endif
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  FAR char        *playlist[CONFIG_NXPLAYER_PLAYLIST_MAXTRACKS]; /* Queued files */
+  uint8_t         plhead;                      /* Oldest queued file */
+  uint8_t         plcount;                     /* Number of queued files */
+  struct nxplayer_fmt_s curfmt;                /* Format of the track being read */
+  struct nxplayer_fmt_s nextfmt;               /* Format of the prefetched track */
+  int             nextfd;                      /* Prefetched track, -1 if none */
+  FAR const struct nxplayer_dec_ops_s *nextops; /* Parser of the prefetched track */
+  struct nxplayer_plstat_s plstat;             /* Playlist statistics */
+#endif
 
   FAR const struct nxplayer_dec_ops_s *ops;
 };
@@ -244,6 +304,67 @@ int nxplayer_playraw(FAR struct nxplayer_s *pplayer,
 int nxplayer_stop(FAR struct nxplayer_s *pplayer);
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_getrastat
+ *
+ *   Returns the read-ahead statistics of the current or last playback.
+ *
+ * Input Parameters:
+ *   pplayer   - Pointer to the context to initialize
+ *   stat      - Location to return the statistics
+ *
+ * Returned Value:
+ *   OK if the statistics were returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+int nxplayer_getrastat(FAR struct nxplayer_s *pplayer,
+                       FAR struct nxplayer_rastat_s *stat);
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_queuefile
+ *
+ *   Appends a media file to the playlist.  The file plays after the ones
+ *   already queued without closing the device or reallocating its buffers,
+ *   and without a gap if it has the same format as the track before it.
+ *   If nothing is playing, the file starts playing immediately.
+ *
+ * Input Parameters:
+ *   pplayer   - Pointer to the NxPlayer context
+ *   pfilename - Pointer to the filename to queue
+ *
+ * Returned Value:
+ *   OK if the file was queued or is being played, -ENOSPC if the playlist
+ *   is full, or one of the nxplayer_playfile() errors.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+int nxplayer_queuefile(FAR struct nxplayer_s *pplayer,
+                       FAR const char *pfilename);
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_getplstat
+ *
+ *   Returns the playlist state of the current or last playback.
+ *
+ * Input Parameters:
+ *   pplayer   - Pointer to the NxPlayer context
+ *   stat      - Location to return the state
+ *
+ * Returned Value:
+ *   OK if the state was returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+int nxplayer_getplstat(FAR struct nxplayer_s *pplayer,
+                       FAR struct nxplayer_plstat_s *stat);
+#endif
+
 /****************************************************************************
  * Name: nxplayer_pause
  *
@@ -29,6 +29,7 @@
 
 #include <mqueue.h>
 #include <pthread.h>
+#include <stdint.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -38,6 +39,27 @@
  * Public Type Declarations
  ****************************************************************************/
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+/* An encoder stage between the capture device and the file.  It takes
+ * interleaved 16-bit PCM from the captured audio buffers and produces the
+ * file body in whole blocks; header() writes the file header in front of
+ * it, once with a zero size before recording and again at the end.
+ */
+
+struct nxrecorder_enc_ops_s
+{
+  FAR const char *name;
+  CODE int    (*init)(FAR void **priv, uint8_t nchannels, uint8_t bpsamp,
+                      uint32_t samprate);
+  CODE size_t (*bound)(FAR void *priv, size_t nbytes);
+  CODE size_t (*encode)(FAR void *priv, FAR const uint8_t *in,
+                        size_t nbytes, FAR uint8_t *out);
+  CODE size_t (*flush)(FAR void *priv, FAR uint8_t *out);
+  CODE int    (*header)(FAR void *priv, int fd, uint32_t datasize);
+  CODE void   (*release)(FAR void *priv);
+};
+#endif
+
 /* This structure describes the internal state of the NxRecorder */
 
 struct nxrecorder_s
@@ -54,6 +76,10 @@ struct nxrecorder_s
 #ifdef CONFIG_AUDIO_MULTI_SESSION
   FAR void        *session;                /* Session assignment from device */
 #endif
+#ifdef CONFIG_NXRECORDER_ENCODER
+  FAR const struct nxrecorder_enc_ops_s *enc; /* Encoder, NULL for raw */
+  FAR void        *encpriv;                /* Encoder state while recording */
+#endif
 };
 
 typedef int (*nxrecorder_func)(FAR struct nxrecorder_s *precorder,
@@ -178,6 +204,45 @@ int nxrecorder_recordinternal(FAR struct nxrecorder_s *precorder,
                               uint8_t nchannels, uint8_t bpsamp,
                               uint32_t samprate, uint8_t chmap);
 
+/****************************************************************************
+ * Name: nxrecorder_getencoder
+ *
+ *   Finds an encoder by name ("adpcm", ...).
+ *
+ * Input Parameters:
+ *   name      - Name of the encoder
+ *
+ * Returned Value:
+ *   The encoder operations or NULL if there is no such encoder.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ENCODER
+FAR const struct nxrecorder_enc_ops_s *
+nxrecorder_getencoder(FAR const char *name);
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_setencoder
+ *
+ *   Selects the encoder the following recordings of 16-bit PCM are passed
+ *   through before they are written to the file.
+ *
+ * Input Parameters:
+ *   precorder - Pointer to the context to initialize
+ *   name      - Name of the encoder, NULL or "none" to write raw PCM
+ *
+ * Returned Value:
+ *   OK if the encoder was selected, -ENOENT if there is no such encoder,
+ *   -EBUSY while recording.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ENCODER
+int nxrecorder_setencoder(FAR struct nxrecorder_s *precorder,
+                          FAR const char *name);
+#endif
+
 /****************************************************************************
  * Name: nxrecorder_stop
  *
@@ -53,6 +53,8 @@
  * Included Files
  ****************************************************************************/
 
+#include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
@@ -61,6 +63,103 @@
 
 #ifdef CONFIG_CODECS_BASE64
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Decode table entries that are not sextets */
+
+#define BASE64_SPACE    0xfe
+#define BASE64_INVALID  0xff
+
+/* Four output characters as one word, in memory order */
+
+#ifdef CONFIG_ENDIAN_BIG
+#  define BASE64_PACK(a, b, c, d) \
+  ((uint32_t)(a) << 24 | (uint32_t)(b) << 16 | (uint32_t)(c) << 8 | (d))
+#else
+#  define BASE64_PACK(a, b, c, d) \
+  ((uint32_t)(d) << 24 | (uint32_t)(c) << 16 | (uint32_t)(b) << 8 | (a))
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Character to sextet, for the two alphabets of base64_tab() */
+
+static const uint8_t g_base64_dec[256] =
+{
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xfe, 0xfe, 0xff, 0xff, 0xfe, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b,
+  0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+  0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+  0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+  0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+  0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+  0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+static const uint8_t g_base64w_dec[256] =
+{
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xfe, 0xfe, 0xff, 0xff, 0xfe, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b,
+  0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+  0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+  0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+  0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0x3e,
+  0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+  0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+  0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -79,6 +178,77 @@ static FAR const char *base64_tab(bool websafe)
   return websafe ? _tab_w : _tab;
 }
 
+/****************************************************************************
+ * Name: base64_encode_groups
+ *
+ * Description:
+ *   Encode whole groups of three bytes, each as one 24-bit word that is
+ *   stored as one 32-bit word of four characters.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *base64_encode_groups(FAR const uint8_t *in,
+                                         size_t ngroups, FAR uint8_t *out,
+                                         FAR const char *tab)
+{
+  uint32_t v;
+  uint32_t w;
+
+  for (; ngroups > 0; ngroups--)
+    {
+      v = (uint32_t)in[0] << 16 | (uint32_t)in[1] << 8 | in[2];
+      w = BASE64_PACK((uint8_t)tab[v >> 18],
+                      (uint8_t)tab[(v >> 12) & 0x3f],
+                      (uint8_t)tab[(v >> 6) & 0x3f],
+                      (uint8_t)tab[v & 0x3f]);
+      memcpy(out, &w, 4);
+
+      in  += 3;
+      out += 4;
+    }
+
+  return out;
+}
+
+/****************************************************************************
+ * Name: base64_decode_flush
+ *
+ * Description:
+ *   Write out the bytes of an incomplete group at the end of the data.
+ *
+ ****************************************************************************/
+
+static ssize_t base64_decode_flush(FAR struct base64_decode_s *ctx,
+                                   FAR uint8_t *out)
+{
+  ssize_t ret;
+
+  switch (ctx->nbits)
+    {
+      case 0:
+        ret = 0;
+        break;
+
+      case 2:
+        out[0] = ctx->bits >> 4;
+        ret = 1;
+        break;
+
+      case 3:
+        out[0] = ctx->bits >> 10;
+        out[1] = ctx->bits >> 2;
+        ret = 2;
+        break;
+
+      default:
+        return -EINVAL;
+    }
+
+  ctx->bits  = 0;
+  ctx->nbits = 0;
+  return ret;
+}
+
 /****************************************************************************
  * Name: _base64_encode
  *
@@ -106,63 +276,26 @@ static FAR unsigned char *_base64_encode(FAR const unsigned char *src,
                                          FAR size_t *out_len,
                                          bool websafe)
 {
+  struct base64_encode_s ctx;
   FAR unsigned char *out;
   FAR unsigned char *pos;
-  FAR const unsigned char *end;
-  FAR const unsigned char *in;
-  FAR const char *base64_table;
-  char ch = '=';
-  size_t olen;
-
-  if (websafe)
-    {
-      ch = '.';
-    }
-
-  base64_table = base64_tab(websafe);
-  olen = (len + 2) / 3 * 4 + 1; /* 3-byte blocks to 4-byte */
-
-  end = src + len;
-  in = src;
 
   if (dst)
     {
-      pos = out = dst;
+      out = dst;
     }
   else
     {
-      pos = out = malloc(olen);
+      out = malloc(base64_encode_length(len) + 1);
       if (out == NULL)
         {
           return NULL;
         }
     }
 
-  while (end - in >= 3)
-    {
-      *pos++ = base64_table[in[0] >> 2];
-      *pos++ = base64_table[((in[0] & 0x03) << 4) | (in[1] >> 4)];
-      *pos++ = base64_table[((in[1] & 0x0f) << 2) | (in[2] >> 6)];
-      *pos++ = base64_table[in[2] & 0x3f];
-      in += 3;
-    }
-
-  if (end - in != 0)
-    {
-      *pos++ = base64_table[in[0] >> 2];
-      if (end - in == 1)
-        {
-          *pos++ = base64_table[(in[0] & 0x03) << 4];
-          *pos++ = ch;          /* *pos++ = '='; */
-        }
-      else
-        {
-          *pos++ = base64_table[((in[0] & 0x03) << 4) | (in[1] >> 4)];
-          *pos++ = base64_table[(in[1] & 0x0f) << 2];
-        }
-
-      *pos++ = ch;              /* *pos++ = '='; */
-    }
+  base64_encode_init(&ctx, websafe);
+  pos  = out + base64_encode_update(&ctx, src, len, out);
+  pos += base64_encode_final(&ctx, pos);
 
   *pos = '\0';
   if (out_len)
@@ -188,7 +321,7 @@ static FAR unsigned char *_base64_encode(FAR const unsigned char *src,
  *
  * Returned Value:
  *   Returns: Allocated buffer of out_len bytes of decoded data,
- *   or NULL on failure
+ *   or NULL on failure or if src is not base64
  *
  ****************************************************************************/
 
@@ -196,62 +329,42 @@ static unsigned char *_base64_decode(FAR const unsigned char *src,
                                      size_t len, FAR unsigned char *dst,
                                      FAR size_t *out_len, bool websafe)
 {
+  struct base64_decode_s ctx;
   FAR unsigned char *out;
-  FAR unsigned char *pos;
-  FAR unsigned char block[4];
-  FAR const char *base64_table;
-  char ch = '=';
-  FAR char *tmp;
-  size_t count;
-  size_t i;
-
-  if (websafe)
-    {
-      ch = '.';
-    }
+  ssize_t n;
+  ssize_t m;
 
-  base64_table = base64_tab(websafe);
+  *out_len = 0;
 
   if (dst)
     {
-      pos = out = dst;
+      out = dst;
     }
   else
     {
-      pos = out = malloc(len / 4 * 3);
+      out = malloc(base64_decode_length(len));
       if (out == NULL)
         {
           return NULL;
         }
     }
 
-  count = 0;
-  for (i = 0; i < len; i++)
-    {
-      tmp = strchr(base64_table, src[i]);
-      block[count] = tmp ? tmp - base64_table : 0;
-      count++;
+  /* The output of a whole decode never exceeds base64_decode_length() */
 
-      if (count == 4)
+  base64_decode_init(&ctx, websafe);
+  n = base64_decode_update(&ctx, src, len, out);
+  m = n < 0 ? n : base64_decode_final(&ctx, out + n);
+  if (m < 0)
+    {
+      if (out != dst)
         {
-          *pos++ = (block[0] << 2) | (block[1] >> 4);
-          if (src[i - 1] == ch)
-            {
-              break;
-            }
-
-          *pos++ = (block[1] << 4) | (block[2] >> 2);
-          if (src[i] == ch)
-            {
-              break;
-            }
-
-          *pos++ = (block[2] << 6) | block[3];
-          count = 0;
+          free(out);
         }
+
+      return NULL;
     }
 
-  *out_len = pos - out;
+  *out_len = n + m;
   return out;
 }
 
@@ -317,4 +430,243 @@ FAR void *base64w_decode(FAR const void *src, size_t len, FAR void *dst,
   return _base64_decode(src, len, dst, out_len, true);
 }
 
+/****************************************************************************
+ * Name: base64_encode_init
+ *
+ * Description:
+ *   Start encoding with the standard or the websafe alphabet.
+ *
+ ****************************************************************************/
+
+void base64_encode_init(FAR struct base64_encode_s *ctx, bool websafe)
+{
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->websafe = websafe;
+}
+
+/****************************************************************************
+ * Name: base64_encode_update
+ *
+ * Description:
+ *   Encode the next len bytes.  dst must have room for
+ *   BASE64_ENCODE_UPDATE_LEN(len) characters, no NUL terminator is added.
+ *
+ * Returned Value:
+ *   The number of characters written to dst.
+ *
+ ****************************************************************************/
+
+size_t base64_encode_update(FAR struct base64_encode_s *ctx,
+                            FAR const void *src, size_t len,
+                            FAR void *dst)
+{
+  FAR const uint8_t *in = src;
+  FAR const char *tab = base64_tab(ctx->websafe);
+  FAR uint8_t *out = dst;
+  uint8_t group[3];
+  size_t n;
+
+  /* Complete the group left over from the previous call */
+
+  if (ctx->ntail > 0)
+    {
+      if (ctx->ntail + len < 3)
+        {
+          memcpy(ctx->tail + ctx->ntail, in, len);
+          ctx->ntail += len;
+          return 0;
+        }
+
+      n = 3 - ctx->ntail;
+      memcpy(group, ctx->tail, ctx->ntail);
+      memcpy(group + ctx->ntail, in, n);
+      out = base64_encode_groups(group, 1, out, tab);
+
+      in  += n;
+      len -= n;
+    }
+
+  out = base64_encode_groups(in, len / 3, out, tab);
+
+  ctx->ntail = len % 3;
+  memcpy(ctx->tail, in + len - ctx->ntail, ctx->ntail);
+
+  return out - (FAR uint8_t *)dst;
+}
+
+/****************************************************************************
+ * Name: base64_encode_final
+ *
+ * Description:
+ *   Encode the bytes left over, with padding.  dst must have room for 4
+ *   characters.
+ *
+ * Returned Value:
+ *   The number of characters written to dst.
+ *
+ ****************************************************************************/
+
+size_t base64_encode_final(FAR struct base64_encode_s *ctx, FAR void *dst)
+{
+  FAR const char *tab = base64_tab(ctx->websafe);
+  FAR uint8_t *out = dst;
+  FAR uint8_t *tail = ctx->tail;
+
+  if (ctx->ntail == 0)
+    {
+      return 0;
+    }
+
+  out[0] = tab[tail[0] >> 2];
+  if (ctx->ntail == 1)
+    {
+      out[1] = tab[(tail[0] & 0x03) << 4];
+      out[2] = ctx->websafe ? '.' : '=';
+    }
+  else
+    {
+      out[1] = tab[((tail[0] & 0x03) << 4) | (tail[1] >> 4)];
+      out[2] = tab[(tail[1] & 0x0f) << 2];
+    }
+
+  out[3] = ctx->websafe ? '.' : '=';
+
+  ctx->ntail = 0;
+  return 4;
+}
+
+/****************************************************************************
+ * Name: base64_decode_init
+ *
+ * Description:
+ *   Start decoding with the standard or the websafe alphabet.
+ *
+ ****************************************************************************/
+
+void base64_decode_init(FAR struct base64_decode_s *ctx, bool websafe)
+{
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->websafe = websafe;
+}
+
+/****************************************************************************
+ * Name: base64_decode_update
+ *
+ * Description:
+ *   Decode the next len characters.  dst must have room for
+ *   BASE64_DECODE_UPDATE_LEN(len) bytes.  White space is skipped, and
+ *   anything after the padding is ignored.
+ *
+ * Returned Value:
+ *   The number of bytes written to dst, or -EINVAL if the input is not
+ *   base64.
+ *
+ ****************************************************************************/
+
+ssize_t base64_decode_update(FAR struct base64_decode_s *ctx,
+                             FAR const void *src, size_t len,
+                             FAR void *dst)
+{
+  FAR const uint8_t *tab = ctx->websafe ? g_base64w_dec : g_base64_dec;
+  FAR const uint8_t *in = src;
+  FAR const uint8_t *end = in + len;
+  FAR uint8_t *out = dst;
+  uint8_t pad = ctx->websafe ? '.' : '=';
+  uint32_t v;
+  ssize_t ret;
+  uint8_t d;
+
+  while (in < end && !ctx->done)
+    {
+      /* Groups of four sextets, looked up into the bytes of one word and
+       * packed into 24 bits in two steps.  Anything else, i.e. white
+       * space, padding or an invalid character, takes the slow path.
+       */
+
+      if (ctx->nbits == 0)
+        {
+          while (end - in >= 4)
+            {
+              v = (uint32_t)tab[in[0]] << 24 | (uint32_t)tab[in[1]] << 16 |
+                  (uint32_t)tab[in[2]] << 8 | tab[in[3]];
+              if ((v & 0xc0c0c0c0) != 0)
+                {
+                  break;
+                }
+
+              v = (v & 0x003f003f) | ((v & 0x3f003f00) >> 2);
+              v = (v & 0x0000ffff) | ((v & 0xffff0000) >> 4);
+
+              out[0] = v >> 16;
+              out[1] = v >> 8;
+              out[2] = v;
+
+              in  += 4;
+              out += 3;
+            }
+
+          if (in == end)
+            {
+              break;
+            }
+        }
+
+      if (*in == pad)
+        {
+          in++;
+          ret = base64_decode_flush(ctx, out);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          out += ret;
+          ctx->done = true;
+          break;
+        }
+
+      d = tab[*in++];
+      if (d == BASE64_SPACE)
+        {
+          continue;
+        }
+      else if (d == BASE64_INVALID)
+        {
+          return -EINVAL;
+        }
+
+      ctx->bits = ctx->bits << 6 | d;
+      if (++ctx->nbits == 4)
+        {
+          out[0] = ctx->bits >> 16;
+          out[1] = ctx->bits >> 8;
+          out[2] = ctx->bits;
+          out   += 3;
+
+          ctx->bits  = 0;
+          ctx->nbits = 0;
+        }
+    }
+
+  return out - (FAR uint8_t *)dst;
+}
+
+/****************************************************************************
+ * Name: base64_decode_final
+ *
+ * Description:
+ *   Decode the sextets left over when the input was not padded.  dst must
+ *   have room for 2 bytes.
+ *
+ * Returned Value:
+ *   The number of bytes written to dst, or -EINVAL if the input ended in
+ *   the middle of a byte.
+ *
+ ****************************************************************************/
+
+ssize_t base64_decode_final(FAR struct base64_decode_s *ctx, FAR void *dst)
+{
+  return base64_decode_flush(ctx, dst);
+}
+
 #endif /* CONFIG_CODECS_BASE64 */
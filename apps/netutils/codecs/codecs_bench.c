@@ -0,0 +1,555 @@
+/****************************************************************************
+ * apps/netutils/codecs/codecs_bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/stat.h>
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "netutils/base64.h"
+#include "netutils/md5.h"
+#include "netutils/urldecode.h"
+#include "netutils/xxhash.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_DEFAULT_SIZE   65536   /* A small JPEG snapshot */
+#define BENCH_DEFAULT_CHUNK  1024
+#define BENCH_DEFAULT_MSECS  500
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_s
+{
+  FAR const char *name;
+
+  /* Process len bytes of in, return the output length */
+
+  size_t (*run)(FAR const uint8_t *in, size_t len, FAR uint8_t *out);
+
+  /* Which input to use: raw data or its encoding */
+
+  FAR uint8_t **input;
+  FAR size_t *inlen;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_BASE64
+static size_t bench_b64enc(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out);
+static size_t bench_b64enc_stream(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out);
+static size_t bench_b64dec(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out);
+static size_t bench_b64dec_stream(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out);
+#endif
+
+#ifdef CONFIG_CODECS_URLCODE
+static size_t bench_urlenc(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out);
+static size_t bench_urldec(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out);
+static size_t bench_urldec_stream(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out);
+#endif
+
+#ifdef CONFIG_CODECS_HASH_MD5
+static size_t bench_md5(FAR const uint8_t *in, size_t len,
+                        FAR uint8_t *out);
+static size_t bench_md5_unaligned(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out);
+#endif
+
+#ifdef CONFIG_CODECS_HASH_XXH32
+static size_t bench_xxh32(FAR const uint8_t *in, size_t len,
+                          FAR uint8_t *out);
+static size_t bench_xxh32_stream(FAR const uint8_t *in, size_t len,
+                                 FAR uint8_t *out);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static size_t g_chunk = BENCH_DEFAULT_CHUNK;
+
+static FAR uint8_t *g_raw;       /* Random bytes, like a JPEG */
+static size_t g_rawlen;
+static FAR uint8_t *g_text;      /* Text, like a query string */
+static size_t g_textlen;
+
+#ifdef CONFIG_CODECS_BASE64
+static FAR uint8_t *g_b64;
+static size_t g_b64len;
+#endif
+
+#ifdef CONFIG_CODECS_URLCODE
+static FAR uint8_t *g_url;
+static size_t g_urllen;
+#endif
+
+static const struct bench_s g_benches[] =
+{
+#ifdef CONFIG_CODECS_BASE64
+  {
+    "base64_encode", bench_b64enc, &g_raw, &g_rawlen
+  },
+  {
+    "base64_encode_update", bench_b64enc_stream, &g_raw, &g_rawlen
+  },
+  {
+    "base64_decode", bench_b64dec, &g_b64, &g_b64len
+  },
+  {
+    "base64_decode_update", bench_b64dec_stream, &g_b64, &g_b64len
+  },
+#endif
+#ifdef CONFIG_CODECS_URLCODE
+  {
+    "urlencode", bench_urlenc, &g_text, &g_textlen
+  },
+  {
+    "urldecode", bench_urldec, &g_url, &g_urllen
+  },
+  {
+    "urldecode_update", bench_urldec_stream, &g_url, &g_urllen
+  },
+#endif
+#ifdef CONFIG_CODECS_HASH_MD5
+  {
+    "md5_sum", bench_md5, &g_raw, &g_rawlen
+  },
+  {
+    "md5_sum (unaligned)", bench_md5_unaligned, &g_raw, &g_rawlen
+  },
+#endif
+#ifdef CONFIG_CODECS_HASH_XXH32
+  {
+    "xxh32", bench_xxh32, &g_raw, &g_rawlen
+  },
+  {
+    "xxh32_update", bench_xxh32_stream, &g_raw, &g_rawlen
+  },
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#ifdef CONFIG_CODECS_BASE64
+static size_t bench_b64enc(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out)
+{
+  FAR void *buf;
+  size_t outlen;
+
+  /* The allocating form, as the uploaders use it */
+
+  buf = base64_encode(in, len, NULL, &outlen);
+  free(buf);
+  return buf != NULL ? outlen : 0;
+}
+
+static size_t bench_b64enc_stream(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out)
+{
+  struct base64_encode_s ctx;
+  FAR uint8_t *pos = out;
+  size_t n;
+
+  base64_encode_init(&ctx, false);
+  for (; len > 0; in += n, len -= n)
+    {
+      n    = MIN(len, g_chunk);
+      pos += base64_encode_update(&ctx, in, n, pos);
+    }
+
+  pos += base64_encode_final(&ctx, pos);
+  return pos - out;
+}
+
+static size_t bench_b64dec(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out)
+{
+  FAR void *buf;
+  size_t outlen;
+
+  buf = base64_decode(in, len, NULL, &outlen);
+  free(buf);
+  return buf != NULL ? outlen : 0;
+}
+
+static size_t bench_b64dec_stream(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out)
+{
+  struct base64_decode_s ctx;
+  FAR uint8_t *pos = out;
+  ssize_t ret;
+  size_t n;
+
+  base64_decode_init(&ctx, false);
+  for (; len > 0; in += n, len -= n)
+    {
+      n   = MIN(len, g_chunk);
+      ret = base64_decode_update(&ctx, in, n, pos);
+      if (ret < 0)
+        {
+          return 0;
+        }
+
+      pos += ret;
+    }
+
+  ret = base64_decode_final(&ctx, pos);
+  return ret < 0 ? 0 : pos + ret - out;
+}
+#endif
+
+#ifdef CONFIG_CODECS_URLCODE
+static size_t bench_urlenc(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out)
+{
+  int outlen;
+
+  urlencode((FAR const char *)in, len, (FAR char *)out, &outlen);
+  return outlen;
+}
+
+static size_t bench_urldec(FAR const uint8_t *in, size_t len,
+                           FAR uint8_t *out)
+{
+  int outlen;
+
+  urldecode((FAR const char *)in, len, (FAR char *)out, &outlen);
+  return outlen;
+}
+
+static size_t bench_urldec_stream(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out)
+{
+  struct urldecode_s ctx;
+  FAR char *pos = (FAR char *)out;
+  size_t n;
+
+  urldecode_init(&ctx);
+  for (; len > 0; in += n, len -= n)
+    {
+      n    = MIN(len, g_chunk);
+      pos += urldecode_update(&ctx, (FAR const char *)in, n, pos);
+    }
+
+  pos += urldecode_final(&ctx, pos);
+  return pos - (FAR char *)out;
+}
+#endif
+
+#ifdef CONFIG_CODECS_HASH_MD5
+static size_t bench_md5(FAR const uint8_t *in, size_t len,
+                        FAR uint8_t *out)
+{
+  md5_sum(in, len, out);
+  return 16;
+}
+
+static size_t bench_md5_unaligned(FAR const uint8_t *in, size_t len,
+                                  FAR uint8_t *out)
+{
+  md5_sum(in + 1, len - 1, out);
+  return 16;
+}
+#endif
+
+#ifdef CONFIG_CODECS_HASH_XXH32
+static size_t bench_xxh32(FAR const uint8_t *in, size_t len,
+                          FAR uint8_t *out)
+{
+  uint32_t h = xxh32(in, len, 0);
+
+  memcpy(out, &h, sizeof(h));
+  return sizeof(h);
+}
+
+static size_t bench_xxh32_stream(FAR const uint8_t *in, size_t len,
+                                 FAR uint8_t *out)
+{
+  struct xxh32_context_s ctx;
+  uint32_t h;
+  size_t n;
+
+  xxh32_init(&ctx, 0);
+  for (; len > 0; in += n, len -= n)
+    {
+      n = MIN(len, g_chunk);
+      xxh32_update(&ctx, in, n);
+    }
+
+  h = xxh32_final(&ctx);
+  memcpy(out, &h, sizeof(h));
+  return sizeof(h);
+}
+#endif
+
+/****************************************************************************
+ * Name: bench_prepare
+ *
+ * Description:
+ *   Generate the inputs: random bytes, text with some characters to
+ *   escape, and their encodings.
+ *
+ ****************************************************************************/
+
+static int bench_prepare(size_t size)
+{
+  static const char textchars[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+    "-_.~ &=/:";
+  size_t i;
+
+  g_raw  = malloc(size);
+  g_text = malloc(size);
+  if (g_raw == NULL || g_text == NULL)
+    {
+      return -1;
+    }
+
+  srand(size);
+  for (i = 0; i < size; i++)
+    {
+      g_raw[i]  = rand();
+      g_text[i] = textchars[rand() % (sizeof(textchars) - 1)];
+    }
+
+  g_rawlen  = size;
+  g_textlen = size;
+
+#ifdef CONFIG_CODECS_BASE64
+  g_b64 = base64_encode(g_raw, size, NULL, &g_b64len);
+  if (g_b64 == NULL)
+    {
+      return -1;
+    }
+#endif
+
+#ifdef CONFIG_CODECS_URLCODE
+  g_url = malloc(URLENCODE_UPDATE_LEN(size) + 1);
+  if (g_url == NULL)
+    {
+      return -1;
+    }
+
+  g_urllen = urlencode_update((FAR const char *)g_text, size,
+                              (FAR char *)g_url);
+#endif
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: bench_one
+ *
+ * Description:
+ *   Repeat one test for about msecs and report the input rate.
+ *
+ ****************************************************************************/
+
+static void bench_one(FAR const struct bench_s *bench, FAR uint8_t *out,
+                      int msecs)
+{
+  uint64_t start;
+  uint64_t elapsed;
+  uint64_t bytes = 0;
+  unsigned long calls = 0;
+  size_t outlen;
+
+  start = bench_time();
+  do
+    {
+      outlen = bench->run(*bench->input, *bench->inlen, out);
+      bytes += *bench->inlen;
+      calls++;
+      elapsed = bench_time() - start;
+    }
+  while (elapsed < (uint64_t)msecs * 1000000);
+
+  printf("%-22s %8zu %8zu %10.1f %10" PRIu64 "\n", bench->name,
+         *bench->inlen, outlen, bytes * 1000.0 / elapsed,
+         elapsed / calls / 1000);
+}
+
+/****************************************************************************
+ * Name: bench_file
+ *
+ * Description:
+ *   Time md5_file() once, file system included.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_HASH_MD5
+static int bench_file(FAR const char *path)
+{
+  uint8_t digest[16];
+  struct stat st;
+  uint64_t elapsed;
+  int ret;
+
+  if (stat(path, &st) < 0)
+    {
+      perror(path);
+      return -1;
+    }
+
+  elapsed = bench_time();
+  ret = md5_file(path, digest);
+  elapsed = bench_time() - elapsed;
+  if (ret < 0)
+    {
+      fprintf(stderr, "md5_file failed: %d\n", ret);
+      return -1;
+    }
+
+  printf("%-22s %8jd %8d %10.1f %10" PRIu64 "\n", "md5_file",
+         (intmax_t)st.st_size, 16, st.st_size * 1000.0 / elapsed,
+         elapsed / 1000);
+  return 0;
+}
+#endif
+
+static void bench_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-s size] [-c chunk] [-t msecs] [-f file]\n"
+         "Throughput of the codecs and hashes in MB/s of input.\n"
+         "  -s  Input size (default %d)\n"
+         "  -c  Piece size for the streaming calls (default %d)\n"
+         "  -t  Time per test in ms (default %d)\n"
+         "  -f  Also time md5_file() on this file\n",
+         progname, BENCH_DEFAULT_SIZE, BENCH_DEFAULT_CHUNK,
+         BENCH_DEFAULT_MSECS);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  FAR const char *path = NULL;
+  FAR uint8_t *out;
+  size_t size = BENCH_DEFAULT_SIZE;
+  int msecs = BENCH_DEFAULT_MSECS;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "s:c:t:f:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 's':
+            size = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'c':
+            g_chunk = strtoul(optarg, NULL, 0);
+            break;
+
+          case 't':
+            msecs = atoi(optarg);
+            break;
+
+          case 'f':
+            path = optarg;
+            break;
+
+          default:
+            bench_usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+  if (size < 2 || g_chunk == 0 || msecs <= 0)
+    {
+      bench_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  /* The largest output is URL encoding, three characters per byte */
+
+  out = malloc(size * 3 + 16);
+  if (out == NULL || bench_prepare(size) < 0)
+    {
+      fprintf(stderr, "Out of memory\n");
+      return EXIT_FAILURE;
+    }
+
+  printf("%-22s %8s %8s %10s %10s\n",
+         "test", "in", "out", "MB/s", "us/call");
+
+  for (i = 0; i < nitems(g_benches); i++)
+    {
+      bench_one(&g_benches[i], out, msecs);
+    }
+
+#ifdef CONFIG_CODECS_HASH_MD5
+  if (path != NULL)
+    {
+      bench_file(path);
+    }
+#endif
+
+  free(out);
+  free(g_raw);
+  free(g_text);
+#ifdef CONFIG_CODECS_BASE64
+  free(g_b64);
+#endif
+#ifdef CONFIG_CODECS_URLCODE
+  free(g_url);
+#endif
+  return EXIT_SUCCESS;
+}
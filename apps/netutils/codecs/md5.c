@@ -87,9 +87,20 @@
 #  define MD5STEP(f, w, x, y, z, data, s) \
         (w += f(x, y, z) + data,  w = w<<s | w>>(32-s),  w += x)
 
-/* Encoding Memory Block Size */
+/* The same with F2 as the sum of its two terms, which have no bits in
+ * common.  The terms and the data can then be added in any order, which
+ * shortens the dependency chain through w.
+ */
 
-#define MD5_BUFSIZE 1024
+#  define MD5STEP2(w, x, y, z, data, s) \
+        (w += ((y) & ~(z)) + data + ((x) & (z)), \
+         w = w<<s | w>>(32-s),  w += x)
+
+/* md5_file() read size */
+
+#ifndef CONFIG_CODECS_HASH_MD5_BUFSIZE
+#  define CONFIG_CODECS_HASH_MD5_BUFSIZE 4096
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -119,6 +130,39 @@ static void byte_reverse(FAR unsigned char *buf, unsigned longs)
 }
 #endif
 
+/****************************************************************************
+ * Name: md5_blocks
+ *
+ * Description:
+ *   Transform whole 64-byte blocks.  On little-endian targets, word
+ *   aligned data is transformed where it is, the rest is copied to the
+ *   context first.
+ *
+ ****************************************************************************/
+
+static void md5_blocks(FAR struct md5_context_s *ctx,
+                       FAR const unsigned char *buf, size_t nblocks)
+{
+#ifndef CONFIG_ENDIAN_BIG
+  if (((uintptr_t)buf & (sizeof(uint32_t) - 1)) == 0)
+    {
+      for (; nblocks > 0; nblocks--, buf += 64)
+        {
+          md5_transform(ctx->buf, (FAR const uint32_t *)buf);
+        }
+
+      return;
+    }
+#endif
+
+  for (; nblocks > 0; nblocks--, buf += 64)
+    {
+      memcpy(ctx->in, buf, 64);
+      byte_reverse(ctx->in, 16);
+      md5_transform(ctx->buf, (uint32_t *)ctx->in);
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -195,14 +239,9 @@ void md5_update(struct md5_context_s *ctx, unsigned char const *buf,
 
   /* Process data in 64-byte chunks */
 
-  while (len >= 64)
-    {
-      memcpy(ctx->in, buf, 64);
-      byte_reverse(ctx->in, 16);
-      md5_transform(ctx->buf, (uint32_t *)ctx->in);
-      buf += 64;
-      len -= 64;
-    }
+  md5_blocks(ctx, buf, len / 64);
+  buf += len & ~63;
+  len &= 63;
 
   /* Handle any remaining bytes of data. */
 
@@ -311,22 +350,22 @@ void md5_transform(uint32_t buf[4], uint32_t const in[16])
   MD5STEP(F1, c, d, a, b, in[14] + 0xa679438e, 17);
   MD5STEP(F1, b, c, d, a, in[15] + 0x49b40821, 22);
 
-  MD5STEP(F2, a, b, c, d, in[1] + 0xf61e2562, 5);
-  MD5STEP(F2, d, a, b, c, in[6] + 0xc040b340, 9);
-  MD5STEP(F2, c, d, a, b, in[11] + 0x265e5a51, 14);
-  MD5STEP(F2, b, c, d, a, in[0] + 0xe9b6c7aa, 20);
-  MD5STEP(F2, a, b, c, d, in[5] + 0xd62f105d, 5);
-  MD5STEP(F2, d, a, b, c, in[10] + 0x02441453, 9);
-  MD5STEP(F2, c, d, a, b, in[15] + 0xd8a1e681, 14);
-  MD5STEP(F2, b, c, d, a, in[4] + 0xe7d3fbc8, 20);
-  MD5STEP(F2, a, b, c, d, in[9] + 0x21e1cde6, 5);
-  MD5STEP(F2, d, a, b, c, in[14] + 0xc33707d6, 9);
-  MD5STEP(F2, c, d, a, b, in[3] + 0xf4d50d87, 14);
-  MD5STEP(F2, b, c, d, a, in[8] + 0x455a14ed, 20);
-  MD5STEP(F2, a, b, c, d, in[13] + 0xa9e3e905, 5);
-  MD5STEP(F2, d, a, b, c, in[2] + 0xfcefa3f8, 9);
-  MD5STEP(F2, c, d, a, b, in[7] + 0x676f02d9, 14);
-  MD5STEP(F2, b, c, d, a, in[12] + 0x8d2a4c8a, 20);
+  MD5STEP2(a, b, c, d, in[1] + 0xf61e2562, 5);
+  MD5STEP2(d, a, b, c, in[6] + 0xc040b340, 9);
+  MD5STEP2(c, d, a, b, in[11] + 0x265e5a51, 14);
+  MD5STEP2(b, c, d, a, in[0] + 0xe9b6c7aa, 20);
+  MD5STEP2(a, b, c, d, in[5] + 0xd62f105d, 5);
+  MD5STEP2(d, a, b, c, in[10] + 0x02441453, 9);
+  MD5STEP2(c, d, a, b, in[15] + 0xd8a1e681, 14);
+  MD5STEP2(b, c, d, a, in[4] + 0xe7d3fbc8, 20);
+  MD5STEP2(a, b, c, d, in[9] + 0x21e1cde6, 5);
+  MD5STEP2(d, a, b, c, in[14] + 0xc33707d6, 9);
+  MD5STEP2(c, d, a, b, in[3] + 0xf4d50d87, 14);
+  MD5STEP2(b, c, d, a, in[8] + 0x455a14ed, 20);
+  MD5STEP2(a, b, c, d, in[13] + 0xa9e3e905, 5);
+  MD5STEP2(d, a, b, c, in[2] + 0xfcefa3f8, 9);
+  MD5STEP2(c, d, a, b, in[7] + 0x676f02d9, 14);
+  MD5STEP2(b, c, d, a, in[12] + 0x8d2a4c8a, 20);
 
   MD5STEP(F3, a, b, c, d, in[5] + 0xfffa3942, 4);
   MD5STEP(F3, d, a, b, c, in[8] + 0x8771f681, 11);
@@ -436,7 +475,7 @@ int md5_file(const char *path, uint8_t *mac)
       return -errno;
     }
 
-  buf = malloc(MD5_BUFSIZE);
+  buf = malloc(CONFIG_CODECS_HASH_MD5_BUFSIZE);
   if (buf == NULL)
     {
       ret = -ENOMEM;
@@ -449,7 +488,7 @@ int md5_file(const char *path, uint8_t *mac)
     {
       /* Block calculation md5 */
 
-      ret = read(fd, buf, MD5_BUFSIZE);
+      ret = read(fd, buf, CONFIG_CODECS_HASH_MD5_BUFSIZE);
       if (ret <= 0)
         {
           ret = ret < 0 ? -errno : 0;
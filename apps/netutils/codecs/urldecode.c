@@ -37,6 +37,7 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -54,19 +55,35 @@
    (ch >= 'a' && ch <= 'f') || \
    (ch >= 'A' && ch <= 'F'))
 
-#  define HEX_VALUE(ch, value) \
-  if (ch >= '0' && ch <= '9') \
-    { \
-      value = ch - '0'; \
-    } \
-  else if (ch >= 'a' && ch <= 'f') \
-    { \
-      value = ch - 'a' + 10; \
-    } \
-  else \
-    { \
-      value = ch - 'A' + 10; \
-    }
+
+/* Characters that are sent as they are */
+
+#  define URL_UNRESERVED(ch) \
+  ((g_url_unreserved[(ch) >> 3] & (1 << ((ch) & 7))) != 0)
+
+/* Whether any byte of a word is zero */
+
+#  define URL_HASZERO(w)  (((w) - 0x01010101) & ~(w) & 0x80808080)
+
+/* Characters decoded one at a time after a word with a '%' or a '+' */
+
+#  define URL_BYTEWISE    64
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+static const uint8_t g_url_unreserved[32] =
+{
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xff, 0x03,
+  0xfe, 0xff, 0xff, 0x87, 0xfe, 0xff, 0xff, 0x47,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const char g_url_hex[] = "0123456789ABCDEF";
 #endif
 
 /****************************************************************************
@@ -104,6 +121,34 @@ static char to_hex(char code)
 }
 #endif
 
+/****************************************************************************
+ * Name: url_hexval
+ *
+ * Description:
+ *   The value of a hex digit, or -1.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+static int url_hexval(uint8_t ch)
+{
+  if (ch >= '0' && ch <= '9')
+    {
+      return ch - '0';
+    }
+  else if (ch >= 'a' && ch <= 'f')
+    {
+      return ch - 'a' + 10;
+    }
+  else if (ch >= 'A' && ch <= 'F')
+    {
+      return ch - 'A' + 10;
+    }
+
+  return -1;
+}
+#endif
+
 /****************************************************************************
  * Name: int2h
  *
@@ -260,36 +305,8 @@ char *url_decode(char *str)
 #ifdef CONFIG_CODECS_URLCODE
 char *urlencode(const char *src, const int src_len, char *dest, int *dest_len)
 {
-  static const unsigned char hex_chars[] = "0123456789ABCDEF";
-  const unsigned char *pSrc;
-  const unsigned char *pEnd;
-  char *pDest;
-
-  pDest = dest;
-  pEnd = (unsigned char *)src + src_len;
-  for (pSrc = (unsigned char *)src; pSrc < pEnd; pSrc++)
-    {
-      if ((*pSrc >= '0' && *pSrc <= '9') ||
-          (*pSrc >= 'a' && *pSrc <= 'z') ||
-          (*pSrc >= 'A' && *pSrc <= 'Z') ||
-          (*pSrc == '_' || *pSrc == '-' || *pSrc == '.' || *pSrc == '~'))
-        {
-          *pDest++ = *pSrc;
-        }
-      else if (*pSrc == ' ')
-        {
-          *pDest++ = '+';
-        }
-      else
-        {
-          *pDest++ = '%';
-          *pDest++ = hex_chars[(*pSrc) >> 4];
-          *pDest++ = hex_chars[(*pSrc) & 0x0F];
-        }
-    }
-
-  *pDest = '\0';
-  *dest_len = pDest - dest;
+  *dest_len = urlencode_update(src, src_len, dest);
+  dest[*dest_len] = '\0';
   return dest;
 }
 #endif
@@ -301,51 +318,15 @@ char *urlencode(const char *src, const int src_len, char *dest, int *dest_len)
 #ifdef CONFIG_CODECS_URLCODE
 char *urldecode(const char *src, const int src_len, char *dest, int *dest_len)
 {
-  const unsigned char *pSrc;
-  const unsigned char *pEnd;
-  char *pDest;
-  unsigned char cHigh;
-  unsigned char cLow;
-  int valHigh;
-  int valLow;
+  struct urldecode_s ctx;
+  size_t len;
 
-  pDest = dest;
-  pSrc = (unsigned char *)src;
-  pEnd = (unsigned char *)src + src_len;
-  while (pSrc < pEnd)
-    {
-      if (*pSrc == '%' && pSrc + 2 < pEnd)
-        {
-          cHigh = *(pSrc + 1);
-          cLow = *(pSrc + 2);
-
-          if (IS_HEX_CHAR(cHigh) && IS_HEX_CHAR(cLow))
-            {
-              HEX_VALUE(cHigh, valHigh)
-              HEX_VALUE(cLow, valLow)
-              *pDest++ = (valHigh << 4) | valLow;
-              pSrc += 3;
-            }
-          else
-            {
-              *pDest++ = *pSrc;
-              pSrc++;
-            }
-        }
-      else if (*pSrc == '+')
-        {
-          *pDest++ = ' ';
-          pSrc++;
-        }
-      else
-        {
-          *pDest++ = *pSrc;
-          pSrc++;
-        }
-    }
+  urldecode_init(&ctx);
+  len  = urldecode_update(&ctx, src, src_len, dest);
+  len += urldecode_final(&ctx, dest + len);
 
-  *pDest = '\0';
-  *dest_len = pDest - dest;
+  dest[len] = '\0';
+  *dest_len = len;
   return dest;
 }
 #endif
@@ -417,6 +398,222 @@ int urldecode_len(const char *src, const int src_len)
 }
 #endif
 
+/****************************************************************************
+ * Name: urlencode_update
+ *
+ * Description:
+ *   URL encode len bytes into dst, which must have room for
+ *   URLENCODE_UPDATE_LEN(len) characters.  No NUL terminator is added.
+ *   There is no state, so the data can be passed in pieces of any size.
+ *
+ * Returned Value:
+ *   The number of characters written to dst.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+size_t urlencode_update(FAR const char *src, size_t len, FAR char *dst)
+{
+  FAR const uint8_t *in = (FAR const uint8_t *)src;
+  FAR const uint8_t *end = in + len;
+  FAR char *out = dst;
+  uint8_t ch;
+
+  while (in < end)
+    {
+      /* Runs of unreserved characters are copied a word at a time */
+
+      while (end - in >= 4 &&
+             URL_UNRESERVED(in[0]) && URL_UNRESERVED(in[1]) &&
+             URL_UNRESERVED(in[2]) && URL_UNRESERVED(in[3]))
+        {
+          memcpy(out, in, 4);
+          in  += 4;
+          out += 4;
+        }
+
+      if (in == end)
+        {
+          break;
+        }
+
+      ch = *in++;
+      if (URL_UNRESERVED(ch))
+        {
+          *out++ = ch;
+        }
+      else if (ch == ' ')
+        {
+          *out++ = '+';
+        }
+      else
+        {
+          out[0] = '%';
+          out[1] = g_url_hex[ch >> 4];
+          out[2] = g_url_hex[ch & 0x0f];
+          out   += 3;
+        }
+    }
+
+  return out - dst;
+}
+#endif
+
+/****************************************************************************
+ * Name: urldecode_init
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+void urldecode_init(FAR struct urldecode_s *ctx)
+{
+  ctx->npending = 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: urldecode_update
+ *
+ * Description:
+ *   URL decode len characters into dst, which must have room for
+ *   URLDECODE_UPDATE_LEN(len) bytes.  A %XX escape may be split between
+ *   calls.  A '%' that does not start an escape is kept as it is, like
+ *   urldecode() does.
+ *
+ * Returned Value:
+ *   The number of bytes written to dst.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+size_t urldecode_update(FAR struct urldecode_s *ctx, FAR const char *src,
+                        size_t len, FAR char *dst)
+{
+  FAR const uint8_t *in = (FAR const uint8_t *)src;
+  FAR const uint8_t *end = in + len;
+  FAR const uint8_t *stop;
+  FAR char *out = dst;
+  uint32_t w;
+  uint8_t ch;
+  int hi;
+  int lo;
+
+  while (in < end)
+    {
+      if (ctx->npending > 0)
+        {
+          /* An escape split between calls */
+
+          ch = *in;
+          if (url_hexval(ch) < 0)
+            {
+              /* Not an escape after all.  Keep what was held back and
+               * look at this character again.
+               */
+
+              memcpy(out, ctx->pending, ctx->npending);
+              out += ctx->npending;
+              ctx->npending = 0;
+              continue;
+            }
+
+          in++;
+          if (ctx->npending == 1)
+            {
+              ctx->pending[1] = ch;
+              ctx->npending   = 2;
+            }
+          else
+            {
+              *out++ = url_hexval(ctx->pending[1]) << 4 | url_hexval(ch);
+              ctx->npending = 0;
+            }
+
+          continue;
+        }
+
+      /* Words without a '%' or a '+' are copied as they are.  Where one
+       * is found, decode a character at a time for a while: text that is
+       * dense with escapes is faster that way.
+       */
+
+      stop = end;
+      if (end - in >= URL_BYTEWISE)
+        {
+          memcpy(&w, in, 4);
+          if (!URL_HASZERO(w ^ 0x25252525) && !URL_HASZERO(w ^ 0x2b2b2b2b))
+            {
+              memcpy(out, &w, 4);
+              in  += 4;
+              out += 4;
+              continue;
+            }
+
+          stop = in + URL_BYTEWISE;
+        }
+
+      while (in < stop)
+        {
+          ch = *in++;
+          if (ch == '+')
+            {
+              *out++ = ' ';
+            }
+          else if (ch != '%')
+            {
+              *out++ = ch;
+            }
+          else if (end - in >= 2)
+            {
+              /* The whole escape is here, or it is not an escape */
+
+              hi = url_hexval(in[0]);
+              lo = url_hexval(in[1]);
+              if (hi >= 0 && lo >= 0)
+                {
+                  *out++ = hi << 4 | lo;
+                  in    += 2;
+                }
+              else
+                {
+                  *out++ = ch;
+                }
+            }
+          else
+            {
+              ctx->pending[0] = '%';
+              ctx->npending   = 1;
+              break;
+            }
+        }
+    }
+
+  return out - dst;
+}
+#endif
+
+/****************************************************************************
+ * Name: urldecode_final
+ *
+ * Description:
+ *   Write out an escape that the data ended in the middle of, as it is.
+ *   dst must have room for 2 bytes.
+ *
+ * Returned Value:
+ *   The number of bytes written to dst.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+size_t urldecode_final(FAR struct urldecode_s *ctx, FAR char *dst)
+{
+  size_t len = ctx->npending;
+
+  memcpy(dst, ctx->pending, len);
+  ctx->npending = 0;
+  return len;
+}
+#endif
+
 /****************************************************************************
  * Name: urlrawdecode
  *
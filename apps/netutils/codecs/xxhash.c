@@ -0,0 +1,243 @@
+/****************************************************************************
+ * apps/netutils/codecs/xxhash.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "netutils/xxhash.h"
+
+#ifdef CONFIG_CODECS_HASH_XXH32
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define XXH_PRIME32_1  0x9e3779b1u
+#define XXH_PRIME32_2  0x85ebca77u
+#define XXH_PRIME32_3  0xc2b2ae3du
+#define XXH_PRIME32_4  0x27d4eb2fu
+#define XXH_PRIME32_5  0x165667b1u
+
+#define XXH_ROTL32(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: xxh32_read
+ *
+ * Description:
+ *   Read a little-endian word at any alignment.  The memcpy() becomes a
+ *   single load where the CPU allows unaligned access.
+ *
+ ****************************************************************************/
+
+static inline uint32_t xxh32_read(FAR const uint8_t *p)
+{
+#ifdef CONFIG_ENDIAN_BIG
+  return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[1] << 8 | p[0];
+#else
+  uint32_t v;
+
+  memcpy(&v, p, sizeof(v));
+  return v;
+#endif
+}
+
+static inline uint32_t xxh32_round(uint32_t acc, uint32_t input)
+{
+  acc += input * XXH_PRIME32_2;
+  acc  = XXH_ROTL32(acc, 13);
+  return acc * XXH_PRIME32_1;
+}
+
+/****************************************************************************
+ * Name: xxh32_stripes
+ *
+ * Description:
+ *   Consume as many 16-byte stripes as there are, with the four
+ *   accumulators in registers.  Return the first byte not consumed.
+ *
+ ****************************************************************************/
+
+static FAR const uint8_t *xxh32_stripes(FAR struct xxh32_context_s *ctx,
+                                        FAR const uint8_t *p,
+                                        FAR const uint8_t *end)
+{
+  uint32_t v0 = ctx->v[0];
+  uint32_t v1 = ctx->v[1];
+  uint32_t v2 = ctx->v[2];
+  uint32_t v3 = ctx->v[3];
+
+  while (end - p >= 16)
+    {
+      v0 = xxh32_round(v0, xxh32_read(p));
+      v1 = xxh32_round(v1, xxh32_read(p + 4));
+      v2 = xxh32_round(v2, xxh32_read(p + 8));
+      v3 = xxh32_round(v3, xxh32_read(p + 12));
+      p += 16;
+    }
+
+  ctx->v[0] = v0;
+  ctx->v[1] = v1;
+  ctx->v[2] = v2;
+  ctx->v[3] = v3;
+  return p;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: xxh32_init
+ ****************************************************************************/
+
+void xxh32_init(FAR struct xxh32_context_s *ctx, uint32_t seed)
+{
+  memset(ctx, 0, sizeof(*ctx));
+
+  ctx->v[0] = seed + XXH_PRIME32_1 + XXH_PRIME32_2;
+  ctx->v[1] = seed + XXH_PRIME32_2;
+  ctx->v[2] = seed;
+  ctx->v[3] = seed - XXH_PRIME32_1;
+  ctx->seed = seed;
+}
+
+/****************************************************************************
+ * Name: xxh32_update
+ *
+ * Description:
+ *   Add len bytes to the hash.  The data can be passed in pieces of any
+ *   size and alignment, the result is the same as for a single call.
+ *
+ ****************************************************************************/
+
+void xxh32_update(FAR struct xxh32_context_s *ctx, FAR const void *buf,
+                  size_t len)
+{
+  FAR const uint8_t *p = buf;
+  FAR const uint8_t *end = p + len;
+  size_t n;
+
+  ctx->total += len;
+  if (ctx->total >= 16 || len >= 16)
+    {
+      ctx->large = 1;
+    }
+
+  /* Complete the stripe left over from the previous call */
+
+  if (ctx->nmem > 0)
+    {
+      n = 16 - ctx->nmem;
+      if (len < n)
+        {
+          memcpy(ctx->mem + ctx->nmem, p, len);
+          ctx->nmem += len;
+          return;
+        }
+
+      memcpy(ctx->mem + ctx->nmem, p, n);
+      xxh32_stripes(ctx, ctx->mem, ctx->mem + 16);
+      ctx->nmem = 0;
+      p += n;
+    }
+
+  p = xxh32_stripes(ctx, p, end);
+
+  ctx->nmem = end - p;
+  memcpy(ctx->mem, p, ctx->nmem);
+}
+
+/****************************************************************************
+ * Name: xxh32_final
+ *
+ * Description:
+ *   Return the hash of the data added so far.  The context is not
+ *   changed, more data can still be added.
+ *
+ ****************************************************************************/
+
+uint32_t xxh32_final(FAR struct xxh32_context_s *ctx)
+{
+  FAR const uint8_t *p = ctx->mem;
+  FAR const uint8_t *end = p + ctx->nmem;
+  uint32_t h;
+
+  if (ctx->large)
+    {
+      h = XXH_ROTL32(ctx->v[0], 1) + XXH_ROTL32(ctx->v[1], 7) +
+          XXH_ROTL32(ctx->v[2], 12) + XXH_ROTL32(ctx->v[3], 18);
+    }
+  else
+    {
+      h = ctx->seed + XXH_PRIME32_5;
+    }
+
+  h += ctx->total;
+
+  for (; end - p >= 4; p += 4)
+    {
+      h += xxh32_read(p) * XXH_PRIME32_3;
+      h  = XXH_ROTL32(h, 17) * XXH_PRIME32_4;
+    }
+
+  for (; p < end; p++)
+    {
+      h += *p * XXH_PRIME32_5;
+      h  = XXH_ROTL32(h, 11) * XXH_PRIME32_1;
+    }
+
+  h ^= h >> 15;
+  h *= XXH_PRIME32_2;
+  h ^= h >> 13;
+  h *= XXH_PRIME32_3;
+  h ^= h >> 16;
+
+  return h;
+}
+
+/****************************************************************************
+ * Name: xxh32
+ *
+ * Description:
+ *   XXH32 of a data block.
+ *
+ ****************************************************************************/
+
+uint32_t xxh32(FAR const void *buf, size_t len, uint32_t seed)
+{
+  struct xxh32_context_s ctx;
+
+  xxh32_init(&ctx, seed);
+  xxh32_update(&ctx, buf, len);
+  return xxh32_final(&ctx);
+}
+
+#endif /* CONFIG_CODECS_HASH_XXH32 */
@@ -0,0 +1,734 @@
+/****************************************************************************
+ * apps/netutils/netlib/netlib_serverbench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "netutils/netlib.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_DEFAULT_PORT     8080
+#define BENCH_DEFAULT_CLIENTS  4
+#define BENCH_DEFAULT_CONNS    100
+#define BENCH_DEFAULT_WORKERS  4
+#define BENCH_DEFAULT_QDEPTH   8
+#define BENCH_STACKSIZE        2048
+#define BENCH_BUFSIZE          512
+#define BENCH_REQSIZE          256
+#define BENCH_ETAGLEN          64
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum bench_mode_e
+{
+  BENCH_EXTERNAL = 0,             /* Server already running */
+  BENCH_THREAD,                   /* netlib_server(), thread per connection */
+  BENCH_POOL                      /* netlib_server_pool() */
+};
+
+struct bench_client_s
+{
+  pthread_t id;
+  int       nconns;
+  uint32_t  done;
+  uint32_t  failed;
+  uint32_t  requests;
+  uint64_t  bytes;
+  uint64_t  total_us;
+  uint64_t  max_us;
+};
+
+/* Client side of one connection, buf holds what was received but not yet
+ * consumed, which is the start of the next response when pipelining.  The
+ * ETag is kept from one connection of a client to the next.
+ */
+
+struct bench_conn_s
+{
+  int      sd;
+  size_t   len;
+  uint64_t bytes;
+  char     etag[BENCH_ETAGLEN];
+  char     buf[BENCH_BUFSIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char g_bench_response[] =
+  "HTTP/1.0 200 OK\r\n"
+  "Content-Length: 2\r\n"
+  "Connection: close\r\n"
+  "\r\n"
+  "ok";
+static const char g_bench_keepalive[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Length: 2\r\n"
+  "\r\n"
+  "ok";
+
+/* With one request per connection the clients send HTTP/1.0 requests,
+ * otherwise HTTP/1.1 requests and "Connection: close" on the last one.
+ */
+
+static FAR const char *g_bench_path;
+static int g_bench_nreqs;
+static bool g_bench_pipeline;
+static bool g_bench_gzip;
+static bool g_bench_revalidate;
+
+static struct sockaddr_in g_bench_addr;
+static struct netlib_server_pool_s g_bench_pool;
+static uint16_t g_bench_port;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: bench_serve
+ *
+ * Description:
+ *   The test server: read the request header and send a small response,
+ *   like a web server answering a tiny static page.  HTTP/1.1 requests
+ *   keep the connection open until "Connection: close".
+ *
+ ****************************************************************************/
+
+static void bench_serve(int sd, FAR char *buffer)
+{
+  FAR char *eoh;
+  size_t len = 0;
+  ssize_t n;
+  bool keepalive;
+
+  for (; ; )
+    {
+      buffer[len] = '\0';
+      eoh = strstr(buffer, "\r\n\r\n");
+      if (eoh == NULL)
+        {
+          if (len == BENCH_BUFSIZE - 1)
+            {
+              break;
+            }
+
+          n = recv(sd, buffer + len, BENCH_BUFSIZE - 1 - len, 0);
+          if (n <= 0)
+            {
+              break;
+            }
+
+          len += n;
+          continue;
+        }
+
+      /* Look at this request only, the next one may follow it */
+
+      eoh[2] = '\0';
+      keepalive = strstr(buffer, " HTTP/1.1\r\n") != NULL &&
+                  strstr(buffer, "Connection: close") == NULL;
+
+      if (!keepalive)
+        {
+          send(sd, g_bench_response, sizeof(g_bench_response) - 1, 0);
+          break;
+        }
+
+      if (send(sd, g_bench_keepalive, sizeof(g_bench_keepalive) - 1, 0) < 0)
+        {
+          break;
+        }
+
+      eoh += 4;
+      len -= eoh - buffer;
+      memmove(buffer, eoh, len);
+    }
+
+  close(sd);
+}
+
+/* Thread per connection: every connection also allocates its buffer */
+
+static FAR void *bench_thread_handler(FAR void *arg)
+{
+  FAR char *buffer = malloc(BENCH_BUFSIZE);
+
+  if (buffer != NULL)
+    {
+      bench_serve((int)(uintptr_t)arg, buffer);
+      free(buffer);
+    }
+  else
+    {
+      close((int)(uintptr_t)arg);
+    }
+
+  return NULL;
+}
+
+/* Pool: the worker's buffer is reused */
+
+static void bench_pool_handler(int sockfd, FAR void *buffer)
+{
+  bench_serve(sockfd, buffer);
+}
+
+static FAR void *bench_server(FAR void *arg)
+{
+  if ((intptr_t)arg == BENCH_POOL)
+    {
+      netlib_server_pool(htons(g_bench_port), &g_bench_pool);
+    }
+  else
+    {
+      netlib_server(htons(g_bench_port), bench_thread_handler,
+                    BENCH_STACKSIZE);
+    }
+
+  fprintf(stderr, "Server on port %u stopped\n", g_bench_port);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_response
+ *
+ * Description:
+ *   Read one response and skip its body.  Returns 0 if the connection can
+ *   take another request, 1 if the server closed it or a negated errno.
+ *
+ ****************************************************************************/
+
+static int bench_response(FAR struct bench_conn_s *conn)
+{
+  FAR char *eoh = NULL;
+  FAR char *line;
+  ssize_t remaining = -1;
+  size_t hdrlen;
+  ssize_t n;
+
+  for (; ; )
+    {
+      conn->buf[conn->len] = '\0';
+      eoh = strstr(conn->buf, "\r\n\r\n");
+      if (eoh != NULL)
+        {
+          break;
+        }
+
+      if (conn->len == sizeof(conn->buf) - 1)
+        {
+          return -E2BIG;
+        }
+
+      n = recv(conn->sd, conn->buf + conn->len,
+               sizeof(conn->buf) - 1 - conn->len, 0);
+      if (n <= 0)
+        {
+          return n < 0 ? -errno : -ECONNRESET;
+        }
+
+      conn->len += n;
+    }
+
+  hdrlen = eoh + 4 - conn->buf;
+  eoh[2] = '\0';
+
+  /* 304 has no body */
+
+  if (g_bench_revalidate && strncmp(conn->buf + 8, " 304", 4) == 0)
+    {
+      remaining = 0;
+    }
+  else if (strncmp(conn->buf + 8, " 200", 4) != 0)
+    {
+      return -EPROTO;
+    }
+
+  for (line = strstr(conn->buf, "\r\n"); line != NULL;
+       line = strstr(line + 2, "\r\n"))
+    {
+      if (strncasecmp(line + 2, "Content-Length:", 15) == 0 &&
+          remaining < 0)
+        {
+          remaining = atol(line + 17);
+        }
+      else if (strncasecmp(line + 2, "ETag: ", 6) == 0 &&
+               g_bench_revalidate && conn->etag[0] == '\0')
+        {
+          snprintf(conn->etag, sizeof(conn->etag), "%.*s",
+                   (int)strcspn(line + 8, "\r"), line + 8);
+        }
+    }
+
+  conn->bytes += hdrlen + (remaining > 0 ? remaining : 0);
+
+  /* Without a length the body ends when the server closes */
+
+  if (remaining < 0)
+    {
+      conn->bytes += conn->len - hdrlen;
+      while ((n = recv(conn->sd, conn->buf, sizeof(conn->buf), 0)) > 0)
+        {
+          conn->bytes += n;
+        }
+
+      conn->len = 0;
+      return n < 0 ? -errno : 1;
+    }
+
+  /* Drop the header and the body, keep what follows them */
+
+  n = MIN(conn->len - hdrlen, remaining);
+  remaining -= n;
+  conn->len -= hdrlen + n;
+  memmove(conn->buf, conn->buf + hdrlen + n, conn->len);
+
+  while (remaining > 0)
+    {
+      n = recv(conn->sd, conn->buf, MIN(remaining, sizeof(conn->buf)), 0);
+      if (n <= 0)
+        {
+          return n < 0 ? -errno : -ECONNRESET;
+        }
+
+      remaining -= n;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: bench_request
+ *
+ * Description:
+ *   Format a request.  With one request per connection it is HTTP/1.0,
+ *   otherwise HTTP/1.1 with "Connection: close" on the last one.
+ *
+ ****************************************************************************/
+
+static int bench_request(FAR struct bench_conn_s *conn, bool last,
+                         FAR char *buf, size_t size)
+{
+  return snprintf(buf, size,
+                  "GET %s HTTP/1.%d\r\n"
+                  "Host: bench\r\n"
+                  "%s%s%s%s%s"
+                  "\r\n",
+                  g_bench_path, g_bench_nreqs > 1,
+                  g_bench_nreqs > 1 && last ? "Connection: close\r\n" : "",
+                  g_bench_gzip ? "Accept-Encoding: gzip\r\n" : "",
+                  conn->etag[0] != '\0' ? "If-None-Match: " : "",
+                  conn->etag[0] != '\0' ? conn->etag : "",
+                  conn->etag[0] != '\0' ? "\r\n" : "");
+}
+
+/****************************************************************************
+ * Name: bench_connection
+ *
+ * Description:
+ *   Send all requests of one connection, one at a time or pipelined, and
+ *   read the responses.  Returns the number of requests answered.
+ *
+ ****************************************************************************/
+
+static int bench_connection(FAR struct bench_conn_s *conn)
+{
+  char req[BENCH_REQSIZE];
+  int len;
+  int sent = 0;
+  int ret;
+  int i;
+
+  conn->len = 0;
+
+  for (i = 0; i < g_bench_nreqs; i++)
+    {
+      /* Send the next request, all of them up front when pipelining */
+
+      while (sent <= i || (g_bench_pipeline && sent < g_bench_nreqs))
+        {
+          len = bench_request(conn, sent == g_bench_nreqs - 1, req,
+                              sizeof(req));
+          if (len >= sizeof(req) || send(conn->sd, req, len, 0) < 0)
+            {
+              return i;
+            }
+
+          sent++;
+        }
+
+      ret = bench_response(conn);
+      if (ret < 0)
+        {
+          break;
+        }
+      else if (ret > 0)
+        {
+          /* Closed by the server, fine after the last request only */
+
+          i++;
+          break;
+        }
+    }
+
+  return i;
+}
+
+/****************************************************************************
+ * Name: bench_client
+ *
+ * Description:
+ *   Open, send the requests, read the responses and close, nconns times.
+ *
+ ****************************************************************************/
+
+static FAR void *bench_client(FAR void *arg)
+{
+  FAR struct bench_client_s *client = arg;
+  FAR struct bench_conn_s *conn;
+  uint64_t start;
+  uint64_t us;
+  int n;
+  int i;
+
+  conn = calloc(1, sizeof(struct bench_conn_s));
+  if (conn == NULL)
+    {
+      client->failed = client->nconns;
+      return NULL;
+    }
+
+  for (i = 0; i < client->nconns; i++)
+    {
+      start = bench_time();
+
+      conn->sd = socket(AF_INET, SOCK_STREAM, 0);
+      if (conn->sd < 0)
+        {
+          client->failed++;
+          continue;
+        }
+
+      if (connect(conn->sd, (FAR struct sockaddr *)&g_bench_addr,
+                  sizeof(g_bench_addr)) < 0)
+        {
+          close(conn->sd);
+          client->failed++;
+          continue;
+        }
+
+      n = bench_connection(conn);
+      close(conn->sd);
+
+      client->requests += n;
+      client->bytes    += conn->bytes;
+      conn->bytes       = 0;
+      if (n < g_bench_nreqs)
+        {
+          client->failed++;
+          continue;
+        }
+
+      us = bench_time() - start;
+      client->total_us += us;
+      if (us > client->max_us)
+        {
+          client->max_us = us;
+        }
+
+      client->done++;
+    }
+
+  free(conn);
+  return NULL;
+}
+
+static void bench_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-m thread|pool|ext] [-a addr] [-p port] [-c clients]\n"
+         "          [-n conns] [-k reqs] [-P] [-u path] [-z] [-e]\n"
+         "          [-w workers] [-q qdepth]\n"
+         "Measure the connection and request rate of a TCP server with\n"
+         "concurrent local clients, each opening, requesting and closing\n"
+         "conns connections.\n"
+         "  -m  thread: start netlib_server() on port (default)\n"
+         "      pool:   start netlib_server_pool() on port\n"
+         "      ext:    use a server that is already running, e.g. the\n"
+         "              webserver on port 80\n"
+         "  -a  Server address (default 127.0.0.1)\n"
+         "  -p  Server port (default %d)\n"
+         "  -c  Concurrent clients (default %d)\n"
+         "  -n  Connections per client (default %d)\n"
+         "  -k  HTTP/1.1 keep-alive requests per connection (default 1,\n"
+         "      a single HTTP/1.0 request)\n"
+         "  -P  Pipeline the requests of a connection\n"
+         "  -u  Path to request (default /)\n"
+         "  -z  Accept gzip content encoding\n"
+         "  -e  Revalidate with If-None-Match once an ETag was seen\n"
+         "  -w  Pool workers (default %d)\n"
+         "  -q  Pool queue depth (default %d)\n"
+         "Compare -k 1 with e.g. -k 10 to see what keep-alive saves.\n",
+         progname, BENCH_DEFAULT_PORT, BENCH_DEFAULT_CLIENTS,
+         BENCH_DEFAULT_CONNS, BENCH_DEFAULT_WORKERS, BENCH_DEFAULT_QDEPTH);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  FAR struct bench_client_s *clients;
+  enum bench_mode_e mode = BENCH_THREAD;
+  pthread_t server;
+  uint64_t elapsed;
+  uint64_t total_us = 0;
+  uint64_t max_us = 0;
+  uint32_t done = 0;
+  uint32_t failed = 0;
+  int nclients = BENCH_DEFAULT_CLIENTS;
+  int nconns = BENCH_DEFAULT_CONNS;
+  uint32_t requests = 0;
+  uint64_t bytes = 0;
+  int opt;
+  int i;
+
+  g_bench_port = BENCH_DEFAULT_PORT;
+  g_bench_path = "/";
+  g_bench_nreqs = 1;
+  g_bench_pipeline = false;
+  g_bench_gzip = false;
+  g_bench_revalidate = false;
+
+  memset(&g_bench_addr, 0, sizeof(g_bench_addr));
+  g_bench_addr.sin_family      = AF_INET;
+  g_bench_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  g_bench_pool.handler   = bench_pool_handler;
+  g_bench_pool.bufsize   = BENCH_BUFSIZE;
+  g_bench_pool.nworkers  = BENCH_DEFAULT_WORKERS;
+  g_bench_pool.stacksize = BENCH_STACKSIZE;
+  g_bench_pool.qdepth    = BENCH_DEFAULT_QDEPTH;
+
+  while ((opt = getopt(argc, argv, "m:a:p:c:n:k:Pu:zew:q:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 'm':
+            if (strcmp(optarg, "thread") == 0)
+              {
+                mode = BENCH_THREAD;
+              }
+            else if (strcmp(optarg, "pool") == 0)
+              {
+                mode = BENCH_POOL;
+              }
+            else if (strcmp(optarg, "ext") == 0)
+              {
+                mode = BENCH_EXTERNAL;
+              }
+            else
+              {
+                bench_usage(argv[0]);
+                return EXIT_FAILURE;
+              }
+            break;
+
+          case 'a':
+            g_bench_addr.sin_addr.s_addr = inet_addr(optarg);
+            break;
+
+          case 'p':
+            g_bench_port = atoi(optarg);
+            break;
+
+          case 'c':
+            nclients = atoi(optarg);
+            break;
+
+          case 'n':
+            nconns = atoi(optarg);
+            break;
+
+          case 'k':
+            g_bench_nreqs = atoi(optarg);
+            break;
+
+          case 'P':
+            g_bench_pipeline = true;
+            break;
+
+          case 'u':
+            g_bench_path = optarg;
+            break;
+
+          case 'z':
+            g_bench_gzip = true;
+            break;
+
+          case 'e':
+            g_bench_revalidate = true;
+            break;
+
+          case 'w':
+            g_bench_pool.nworkers = atoi(optarg);
+            break;
+
+          case 'q':
+            g_bench_pool.qdepth = atoi(optarg);
+            break;
+
+          default:
+            bench_usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+  if (nclients <= 0 || nconns <= 0 || g_bench_nreqs <= 0)
+    {
+      bench_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  if (strlen(g_bench_path) > BENCH_REQSIZE - 160)
+    {
+      fprintf(stderr, "Path too long\n");
+      return EXIT_FAILURE;
+    }
+
+  g_bench_addr.sin_port = htons(g_bench_port);
+
+  clients = calloc(nclients, sizeof(struct bench_client_s));
+  if (clients == NULL)
+    {
+      fprintf(stderr, "Out of memory\n");
+      return EXIT_FAILURE;
+    }
+
+  /* The server never returns, it goes away when this task exits */
+
+  if (mode != BENCH_EXTERNAL)
+    {
+      if (pthread_create(&server, NULL, bench_server,
+                         (FAR void *)(intptr_t)mode) != 0)
+        {
+          fprintf(stderr, "Failed to start the server\n");
+          free(clients);
+          return EXIT_FAILURE;
+        }
+
+      pthread_detach(server);
+      usleep(100000);
+    }
+
+  elapsed = bench_time();
+
+  for (i = 0; i < nclients; i++)
+    {
+      clients[i].nconns = nconns;
+      if (pthread_create(&clients[i].id, NULL, bench_client,
+                         &clients[i]) != 0)
+        {
+          fprintf(stderr, "Failed to start client %d\n", i);
+          nclients = i;
+          break;
+        }
+    }
+
+  for (i = 0; i < nclients; i++)
+    {
+      pthread_join(clients[i].id, NULL);
+      done     += clients[i].done;
+      failed   += clients[i].failed;
+      requests += clients[i].requests;
+      bytes    += clients[i].bytes;
+      total_us += clients[i].total_us;
+      if (clients[i].max_us > max_us)
+        {
+          max_us = clients[i].max_us;
+        }
+    }
+
+  elapsed = bench_time() - elapsed;
+
+  printf("%s server, %d clients x %d connections x %d requests%s",
+         mode == BENCH_POOL ? "pool" :
+         mode == BENCH_THREAD ? "thread" : "external", nclients, nconns,
+         g_bench_nreqs, g_bench_pipeline ? " pipelined" : "");
+  if (mode == BENCH_POOL)
+    {
+      printf(", %d workers, queue %d", g_bench_pool.nworkers,
+             g_bench_pool.qdepth);
+    }
+
+  printf("\n%" PRIu32 " done, %" PRIu32 " failed in %" PRIu64 " ms\n",
+         done, failed, elapsed / 1000);
+
+  if (done > 0 && elapsed > 0)
+    {
+      printf("%.1f connections/s, latency avg %" PRIu64 " us, "
+             "max %" PRIu64 " us\n",
+             done * 1e6 / elapsed, total_us / done, max_us);
+    }
+
+  if (requests > 0 && elapsed > 0)
+    {
+      printf("%" PRIu32 " requests, %.1f requests/s, "
+             "%" PRIu64 " bytes/request\n",
+             requests, requests * 1e6 / elapsed, bytes / requests);
+    }
+
+  free(clients);
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,290 @@
+/****************************************************************************
+ * apps/netutils/netlib/netlib_serverpool.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <netinet/in.h>
+
+#include "netutils/netlib.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* State shared by the accept loop and the workers */
+
+struct netlib_pool_s
+{
+  FAR const struct netlib_server_pool_s *config;
+  pthread_mutex_t lock;
+  pthread_cond_t  notempty;       /* A connection was queued */
+  pthread_cond_t  notfull;        /* A worker took a connection */
+  FAR int        *queue;          /* Ring of accepted sockets */
+  int             head;
+  int             count;
+  bool            stop;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netlib_pool_worker
+ *
+ * Description:
+ *   Take accepted connections off the queue until the server stops.  The
+ *   queue is drained before the worker exits.
+ *
+ ****************************************************************************/
+
+static FAR void *netlib_pool_worker(FAR void *arg)
+{
+  FAR struct netlib_pool_s *pool = arg;
+  FAR const struct netlib_server_pool_s *config = pool->config;
+  FAR void *buffer = NULL;
+  int sd;
+
+  if (config->bufsize > 0)
+    {
+      buffer = malloc(config->bufsize);
+      if (buffer == NULL)
+        {
+          nerr("ERROR: Failed to allocate the worker buffer\n");
+          return NULL;
+        }
+    }
+
+  for (; ; )
+    {
+      pthread_mutex_lock(&pool->lock);
+      while (pool->count == 0 && !pool->stop)
+        {
+          pthread_cond_wait(&pool->notempty, &pool->lock);
+        }
+
+      if (pool->count == 0)
+        {
+          pthread_mutex_unlock(&pool->lock);
+          break;
+        }
+
+      sd = pool->queue[pool->head];
+      pool->head = (pool->head + 1) % config->qdepth;
+      pool->count--;
+
+      pthread_cond_signal(&pool->notfull);
+      pthread_mutex_unlock(&pool->lock);
+
+      ninfo("Serving sd=%d\n", sd);
+      config->handler(sd, buffer);
+    }
+
+  free(buffer);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netlib_server_pool
+ *
+ * Description:
+ *   Implement basic server logic with a fixed pool of worker threads.
+ *   Unlike netlib_server(), no thread is created per connection, and a
+ *   burst of connections waits in a bounded queue instead of being served
+ *   one after another by a single thread.
+ *
+ * Parameters:
+ *   portno    The port to listen on (in network byte order)
+ *   config    The connection handler and the pool configuration
+ *
+ * Return:
+ *   Does not return unless an error occurs, then a negated errno value.
+ *
+ ****************************************************************************/
+
+int netlib_server_pool(uint16_t portno,
+                       FAR const struct netlib_server_pool_s *config)
+{
+  struct netlib_pool_s pool;
+  struct sockaddr_in myaddr;
+#ifdef CONFIG_NET_SOLINGER
+  struct linger ling;
+#endif
+  FAR pthread_t *workers;
+  pthread_attr_t attr;
+  socklen_t addrlen;
+  int nworkers = 0;
+  int listensd;
+  int acceptsd;
+  int ret;
+  int i;
+
+  if (config == NULL || config->handler == NULL ||
+      config->nworkers <= 0 || config->qdepth <= 0)
+    {
+      return -EINVAL;
+    }
+
+  memset(&pool, 0, sizeof(pool));
+  pool.config = config;
+  pool.queue  = malloc(config->qdepth * sizeof(int));
+  workers     = malloc(config->nworkers * sizeof(pthread_t));
+  if (pool.queue == NULL || workers == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_alloc;
+    }
+
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_cond_init(&pool.notempty, NULL);
+  pthread_cond_init(&pool.notfull, NULL);
+
+  /* Create a new TCP socket to use to listen for connections */
+
+  listensd = netlib_listenon(portno);
+  if (listensd < 0)
+    {
+      ret = -errno;
+      goto errout_with_sync;
+    }
+
+  /* Start the workers, they all wait for the first connection */
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, config->stacksize);
+
+  for (i = 0; i < config->nworkers; i++)
+    {
+      ret = pthread_create(&workers[nworkers], &attr, netlib_pool_worker,
+                           &pool);
+      if (ret != 0)
+        {
+          nerr("ERROR: pthread_create failed: %d\n", ret);
+          continue;
+        }
+
+      nworkers++;
+    }
+
+  pthread_attr_destroy(&attr);
+
+  if (nworkers == 0)
+    {
+      ret = -ENOMEM;
+      goto errout_with_listen;
+    }
+
+  /* Begin serving connections */
+
+  for (; ; )
+    {
+      /* Accept the next connection */
+
+      addrlen = sizeof(struct sockaddr_in);
+      acceptsd = accept(listensd, (FAR struct sockaddr *)&myaddr, &addrlen);
+      if (acceptsd < 0)
+        {
+          ret = -errno;
+          nerr("ERROR: accept failure: %d\n", errno);
+          break;
+        }
+
+      ninfo("Connection accepted -- queueing sd=%d\n", acceptsd);
+
+      /* Configure to "linger" until all data is sent when the socket is
+       * closed.
+       */
+
+#ifdef CONFIG_NET_SOLINGER
+      ling.l_onoff  = 1;
+      ling.l_linger = 30;     /* timeout is seconds */
+
+      if (setsockopt(acceptsd, SOL_SOCKET,
+                     SO_LINGER, &ling, sizeof(struct linger)) < 0)
+        {
+          ret = -errno;
+          close(acceptsd);
+          nerr("ERROR: setsockopt SO_LINGER failure: %d\n", errno);
+          break;
+        }
+#endif
+
+      /* Hand the connection to a worker.  With the queue full, stop
+       * accepting so further connections wait in the listen backlog.
+       */
+
+      pthread_mutex_lock(&pool.lock);
+      while (pool.count == config->qdepth)
+        {
+          pthread_cond_wait(&pool.notfull, &pool.lock);
+        }
+
+      pool.queue[(pool.head + pool.count) % config->qdepth] = acceptsd;
+      pool.count++;
+
+      pthread_cond_signal(&pool.notempty);
+      pthread_mutex_unlock(&pool.lock);
+    }
+
+  /* Let the workers finish the queued connections and exit */
+
+  pthread_mutex_lock(&pool.lock);
+  pool.stop = true;
+  pthread_cond_broadcast(&pool.notempty);
+  pthread_mutex_unlock(&pool.lock);
+
+  for (i = 0; i < nworkers; i++)
+    {
+      pthread_join(workers[i], NULL);
+    }
+
+errout_with_listen:
+  close(listensd);
+
+errout_with_sync:
+  pthread_cond_destroy(&pool.notfull);
+  pthread_cond_destroy(&pool.notempty);
+  pthread_mutex_destroy(&pool.lock);
+
+errout_with_alloc:
+  free(workers);
+  free(pool.queue);
+  return ret;
+}
@@ -159,6 +159,12 @@
 #    error "Can't use uint16_t for buffer size"
 #  endif
 
+/* Largest chunk that a connection sends per sendfile() call */
+
+#  ifndef CONFIG_THTTPD_SENDFILE_CHUNK
+#    define CONFIG_THTTPD_SENDFILE_CHUNK 8192
+#  endif
+
 /* A list of index filenames to check.
  * The files are searched for in this order.
  */
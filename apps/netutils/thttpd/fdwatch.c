@@ -95,7 +95,8 @@ static void fdwatch_dump(const char *msg, FAR struct fdwatch_s *fw)
              fw->pollfds[i].revents, fw->client[i]);
     }
 
-  fwinfo("nactive: %d next: %d\n", fw->nactive, fw->next);
+  fwinfo("nactive: %d next: %d npollndx: %d\n",
+         fw->nactive, fw->next, fw->npollndx);
   for (i = 0; i < fw->nactive; i++)
     {
       fwinfo("%2d. %d active\n", i, fw->ready[i]);
@@ -105,23 +106,49 @@ static void fdwatch_dump(const char *msg, FAR struct fdwatch_s *fw)
 #  define fdwatch_dump(m,f)
 #endif
 
+/* Get the pollfds index associated with the fd, or -1 if the fd is not
+ * being watched.
+ */
+
 static int fdwatch_pollndx(FAR struct fdwatch_s *fw, int fd)
 {
-  int pollndx;
+  if (fd >= 0 && fd < fw->npollndx)
+    {
+      return fw->pollndx[fd];
+    }
 
-  /* Get the index associated with the fd */
+  return -1;
+}
+
+/* Make room for fd in the fd to index map.  Returns -1 on failure. */
+
+static int fdwatch_growndx(FAR struct fdwatch_s *fw, int fd)
+{
+  FAR int *pollndx;
+  int npollndx;
+  int i;
 
-  for (pollndx = 0; pollndx < fw->nwatched; pollndx++)
+  if (fd < fw->npollndx)
     {
-      if (fw->pollfds[pollndx].fd == fd)
-        {
-          fwinfo("pollndx: %d\n", pollndx);
-          return pollndx;
-        }
+      return 0;
     }
 
-  fwerr("ERROR: No poll index for fd %d\n", fd);
-  return -1;
+  npollndx = MAX(fd + 1, 2 * fw->npollndx);
+  pollndx  = RENEW(fw->pollndx, int, fw->npollndx, npollndx);
+  if (!pollndx)
+    {
+      fwerr("ERROR: Failed to grow the index map to %d\n", npollndx);
+      return -1;
+    }
+
+  for (i = fw->npollndx; i < npollndx; i++)
+    {
+      pollndx[i] = -1;
+    }
+
+  fw->pollndx  = pollndx;
+  fw->npollndx = npollndx;
+  return 0;
 }
 
 /****************************************************************************
@@ -159,12 +186,21 @@ struct fdwatch_s *fdwatch_initialize(int nfds)
       goto errout_with_allocations;
     }
 
-  fw->ready = (uint8_t *)httpd_malloc(sizeof(uint8_t) * nfds);
+  fw->ready = (int *)httpd_malloc(sizeof(int) * nfds);
   if (!fw->ready)
     {
       goto errout_with_allocations;
     }
 
+  /* Descriptors are small integers, so start with one map entry per
+   * configured descriptor.  The map grows if a larger fd shows up.
+   */
+
+  if (fdwatch_growndx(fw, nfds - 1) < 0)
+    {
+      goto errout_with_allocations;
+    }
+
   fdwatch_dump("Initial state:", fw);
   return fw;
 
@@ -195,32 +231,52 @@ void fdwatch_uninitialize(struct fdwatch_s *fw)
           httpd_free(fw->ready);
         }
 
+      if (fw->pollndx)
+        {
+          httpd_free(fw->pollndx);
+        }
+
       httpd_free(fw);
     }
 }
 
 /* Add a descriptor to the watch list. rw is either FDW_READ or FDW_WRITE. */
 
-void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data)
+void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data,
+                    int rw)
 {
-  fwinfo("fd: %d client_data: %p\n", fd, client_data);
+  int pollndx;
+
+  fwinfo("fd: %d client_data: %p rw: %d\n", fd, client_data, rw);
   fdwatch_dump("Before adding:", fw);
 
-  if (fw->nwatched >= fw->nfds)
+  /* If the fd is already watched, just update it in place */
+
+  pollndx = fdwatch_pollndx(fw, fd);
+  if (pollndx < 0)
     {
-      fwerr("ERROR: too many fds\n");
-      return;
-    }
+      if (fw->nwatched >= fw->nfds)
+        {
+          fwerr("ERROR: too many fds\n");
+          return;
+        }
 
-  /* Save the new fd at the end of the list */
+      if (fd < 0 || fdwatch_growndx(fw, fd) < 0)
+        {
+          return;
+        }
+
+      /* Save the new fd at the end of the list */
 
-  fw->pollfds[fw->nwatched].fd     = fd;
-  fw->pollfds[fw->nwatched].events = POLLIN;
-  fw->client[fw->nwatched]         = client_data;
+      pollndx = fw->nwatched++;
+      fw->pollndx[fd] = pollndx;
+    }
 
-  /* Increment the count of watched descriptors */
+  fw->pollfds[pollndx].fd      = fd;
+  fw->pollfds[pollndx].events  = rw == FDW_WRITE ? POLLOUT : POLLIN;
+  fw->pollfds[pollndx].revents = 0;
+  fw->client[pollndx]          = client_data;
 
-  fw->nwatched++;
   fdwatch_dump("After adding:", fw);
 }
 
@@ -241,6 +297,7 @@ void fdwatch_del_fd(struct fdwatch_s *fw, int fd)
       /* Decrement the number of fds in the poll table */
 
       fw->nwatched--;
+      fw->pollndx[fd] = -1;
 
       /* Replace the deleted one with the one at the end
        * of the list.
@@ -250,8 +307,13 @@ void fdwatch_del_fd(struct fdwatch_s *fw, int fd)
         {
           fw->pollfds[pollndx] = fw->pollfds[fw->nwatched];
           fw->client[pollndx]  = fw->client[fw->nwatched];
+          fw->pollndx[fw->pollfds[pollndx].fd] = pollndx;
         }
     }
+  else
+    {
+      fwerr("ERROR: No poll index for fd %d\n", fd);
+    }
 
   fdwatch_dump("After deleting:", fw);
 }
@@ -279,7 +341,8 @@ int fdwatch(struct fdwatch_s *fw, long timeout_msecs)
   fwinfo("Awakened: %d\n", ret);
 
   /* Look through all of the descriptors and make a list of all of them than
-   * have activity.
+   * have activity.  poll() leaves no other way to find them, but from here
+   * on only the ready descriptors are visited.
    */
 
   if (ret > 0)
@@ -289,7 +352,7 @@ int fdwatch(struct fdwatch_s *fw, long timeout_msecs)
           /* Is there activity on this descriptor? */
 
           if (fw->pollfds[i].revents &
-              (POLLIN | POLLERR | POLLHUP | POLLNVAL))
+              (POLLIN | POLLOUT | POLLERR | POLLHUP | POLLNVAL))
             {
               /* Yes... save it in a shorter list */
 
@@ -314,7 +377,10 @@ int fdwatch(struct fdwatch_s *fw, long timeout_msecs)
   return ret;
 }
 
-/* Check if a descriptor was ready. */
+/* Check if a descriptor was ready.  An error on a descriptor watched for
+ * writing is reported as ready, so that the failed write clears the
+ * connection instead of poll() waking up for it again and again.
+ */
 
 int fdwatch_check_fd(struct fdwatch_s *fw, int fd)
 {
@@ -326,26 +392,38 @@ int fdwatch_check_fd(struct fdwatch_s *fw, int fd)
   /* Get the index associated with the fd */
 
   pollndx = fdwatch_pollndx(fw, fd);
-  if (pollndx >= 0 && (fw->pollfds[pollndx].revents & POLLERR) == 0)
+  if (pollndx >= 0 && ((fw->pollfds[pollndx].revents & POLLERR) == 0 ||
+                       (fw->pollfds[pollndx].events & POLLOUT) != 0))
     {
-      return fw->pollfds[pollndx].revents & (POLLIN | POLLHUP | POLLNVAL);
+      return fw->pollfds[pollndx].revents &
+             (POLLIN | POLLOUT | POLLERR | POLLHUP | POLLNVAL);
     }
 
   fwinfo("POLLERR fd: %d\n", fd);
   return 0;
 }
 
+/* Get the client data for the next ready descriptor.  Descriptors that
+ * were deleted since fdwatch() returned are skipped.
+ */
+
 void *fdwatch_get_next_client_data(struct fdwatch_s *fw)
 {
+  int pollndx;
+
   fdwatch_dump("Before getting client data:", fw);
-  if (fw->next >= fw->nwatched)
+  while (fw->next < fw->nactive)
     {
-      fwinfo("All client data returned: %d\n", fw->next);
-      return (void *)(uintptr_t)-1;
+      pollndx = fdwatch_pollndx(fw, fw->ready[fw->next++]);
+      if (pollndx >= 0)
+        {
+          fwinfo("client_data[%d]: %p\n", pollndx, fw->client[pollndx]);
+          return fw->client[pollndx];
+        }
     }
 
-  fwinfo("client_data[%d]: %p\n", fw->next, fw->client[fw->next]);
-  return fw->client[fw->next++];
+  fwinfo("All client data returned: %d\n", fw->next);
+  return (void *)(uintptr_t)-1;
 }
 
 #endif /* CONFIG_THTTPD */
@@ -55,19 +55,26 @@
 #  define INFTIM -1
 #endif
 
+/* What a descriptor is watched for */
+
+#define FDW_READ  0
+#define FDW_WRITE 1
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
 struct fdwatch_s
 {
-  struct pollfd *pollfds;          /* Poll data (allocated) */
-  void         **client;           /* Client data (allocated) */
-  uint8_t       *ready;            /* The list of fds with activity (allocated) */
-  uint8_t        nfds;             /* The configured maximum number of fds */
-  uint8_t        nwatched;         /* The number of fds currently watched */
-  uint8_t        nactive;          /* The number of fds with activity */
-  uint8_t        next;             /* The index to the next client data */
+  struct pollfd *pollfds;   /* Poll data (allocated) */
+  void         **client;    /* Client data (allocated) */
+  int           *ready;     /* The list of fds with activity (allocated) */
+  int           *pollndx;   /* fd to pollfds index, or -1 (allocated) */
+  int            npollndx;  /* The number of fds pollndx has room for */
+  int            nfds;      /* The configured maximum number of fds */
+  int            nwatched;  /* The number of fds currently watched */
+  int            nactive;   /* The number of fds with activity */
+  int            next;      /* The index to the next ready fd */
 };
 
 /****************************************************************************
@@ -82,9 +89,10 @@ extern struct fdwatch_s *fdwatch_initialize(int nfds);
 
 extern void fdwatch_uninitialize(struct fdwatch_s *fw);
 
-/* Add a descriptor to the watch list */
+/* Add a descriptor to the watch list.  rw is either FDW_READ or FDW_WRITE */
 
-extern void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data);
+extern void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data,
+                           int rw);
 
 /* Delete a descriptor from the watch list. */
 
@@ -97,12 +105,14 @@ extern void fdwatch_del_fd(struct fdwatch_s *fw, int fd);
 
 extern int fdwatch(struct fdwatch_s *fw, long timeout_msecs);
 
-/* Check if a descriptor was ready. */
+/* Check if a descriptor was ready for what it is watched for.  Errors
+ * count as ready for a descriptor watched for writing.
+ */
 
 extern int fdwatch_check_fd(struct fdwatch_s *fw, int fd);
 
-/* Get the client data for the next returned event.  Returns -1 when there
- * are no more events.
+/* Get the client data for the next returned event.  Only descriptors with
+ * activity are visited.  Returns -1 when there are no more events.
  */
 
 extern void *fdwatch_get_next_client_data(struct fdwatch_s *fw);
@@ -40,8 +40,12 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#ifdef CONFIG_THTTPD_SENDFILE
+#  include <sys/sendfile.h>
+#endif
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -99,8 +103,11 @@ struct connect_s
   Timer *wakeup_timer;
   Timer *linger_timer;
   off_t end_offset;            /* The final offset+1 of the file to send */
-  off_t offset;                /* The current offset into the file to send */
-  bool eof;                    /* Set true when length==0 read from file */
+  off_t offset;                /* The offset of the next byte to read */
+  uint16_t sendidx;            /* The next byte of hc->buffer to send */
+#ifdef CONFIG_THTTPD_SENDFILE
+  bool sendfile;               /* Send the file data with sendfile() */
+#endif
 };
 
 /****************************************************************************
@@ -252,7 +259,7 @@ static int handle_newconnect(FAR struct timeval *tv, int listen_fd)
       /* Set the connection file descriptor to no-delay mode */
 
       httpd_set_ndelay(conn->hc->conn_fd);
-      fdwatch_add_fd(fw, conn->hc->conn_fd, conn);
+      fdwatch_add_fd(fw, conn->hc->conn_fd, conn, FDW_READ);
     }
 }
 
@@ -336,7 +343,7 @@ static void handle_read(struct connect_s *conn, struct timeval *tv)
 
   /* Set up the file offsets to read */
 
-  conn->eof            = false;
+  conn->sendidx        = 0;
   if (hc->got_range)
     {
       conn->offset     = hc->range_start;
@@ -383,10 +390,23 @@ static void handle_read(struct connect_s *conn, struct timeval *tv)
        goto errout_with_400;
     }
 
-  /* We have a valid connection and a file to send to it */
+#ifdef CONFIG_THTTPD_SENDFILE
+  /* Regular files go out with sendfile(), unless they fit behind the
+   * response headers into the buffer and one write sends it all.
+   */
+
+  conn->sendfile = S_ISREG(hc->sb.st_mode) &&
+                   conn->end_offset - conn->offset >
+                   CONFIG_THTTPD_IOBUFFERSIZE - hc->buflen;
+#endif
+
+  /* We have a valid connection and a file to send to it.  From now on the
+   * connection is serviced whenever the socket can take more data.
+   */
 
   conn->conn_state = CNST_SENDING;
   fdwatch_del_fd(fw, hc->conn_fd);
+  fdwatch_add_fd(fw, hc->conn_fd, conn, FDW_WRITE);
   return;
 
 errout_with_400:
@@ -400,45 +420,101 @@ errout_with_connection:
 static inline int read_buffer(struct connect_s *conn)
 {
   httpd_conn *hc = conn->hc;
-  ssize_t nread = 0;
+  ssize_t nread;
+  off_t remaining;
+
+  /* Fill the rest of the buffer, but never past the end of the range */
 
-  if (hc->buflen < CONFIG_THTTPD_IOBUFFERSIZE && !conn->eof)
+  remaining = conn->end_offset - conn->offset;
+  nread = read(hc->file_fd, &hc->buffer[hc->buflen],
+               MIN(CONFIG_THTTPD_IOBUFFERSIZE - hc->buflen, remaining));
+  if (nread == 0)
     {
-      nread = read(hc->file_fd, &hc->buffer[hc->buflen],
-                   CONFIG_THTTPD_IOBUFFERSIZE - hc->buflen);
-      if (nread == 0)
-        {
-          /* Reading zero bytes means we are at the end of file */
+      /* Reading zero bytes means we are at the end of file */
 
-          conn->end_offset = conn->offset;
-          conn->eof        = true;
-        }
-      else if (nread > 0)
-        {
-          hc->buflen      += nread;
-        }
+      conn->end_offset = conn->offset;
+    }
+  else if (nread > 0)
+    {
+      hc->buflen   += nread;
+      conn->offset += nread;
     }
 
   return nread;
 }
 
+/* Send at most one buffer of the file per call, without blocking, so that
+ * a large download gets its turn in the fdwatch() loop like every other
+ * connection instead of holding the loop until it is done.
+ */
+
 static void handle_send(struct connect_s *conn, struct timeval *tv)
 {
   httpd_conn *hc = conn->hc;
-  int nwritten;
+  ssize_t nwritten;
   int nread;
 
-  /* Read until the entire file is sent -- this could take awhile!! */
+  ninfo("offset: %jd end_offset: %jd bytes_sent: %jd\n",
+        (intmax_t)conn->offset,
+        (intmax_t)conn->end_offset,
+        (intmax_t)conn->hc->bytes_sent);
 
-  while (conn->offset < conn->end_offset)
+#ifdef CONFIG_THTTPD_SENDFILE
+  /* Once the buffer with the response headers and the start of the file
+   * is out, the rest goes from the file to the socket without passing
+   * through the buffer.
+   */
+
+  if (conn->sendfile && conn->sendidx >= hc->buflen)
     {
-      ninfo("offset: %jd end_offset: %jd bytes_sent: %jd\n",
-            (intmax_t)conn->offset,
-            (intmax_t)conn->end_offset,
-            (intmax_t)conn->hc->bytes_sent);
+      hc->buflen    = 0;
+      conn->sendidx = 0;
 
-      /* Fill the rest of the response buffer with file data */
+      nwritten = sendfile(hc->conn_fd, hc->file_fd, &conn->offset,
+                          MIN(conn->end_offset - conn->offset,
+                              CONFIG_THTTPD_SENDFILE_CHUNK));
+      if (nwritten < 0)
+        {
+          if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+              return;
+            }
+
+          /* Send the rest through the buffer, the file position is still
+           * where handle_read() put it.
+           */
 
+          nwarn("WARNING: sendfile failed: %d\n", errno);
+          conn->sendfile = false;
+          if (lseek(hc->file_fd, conn->offset, SEEK_SET) != conn->offset)
+            {
+              goto errout_clear_connection;
+            }
+        }
+      else
+        {
+          if (nwritten == 0)
+            {
+              /* The file is shorter than it was */
+
+              conn->end_offset = conn->offset;
+            }
+
+          conn->active_at = tv->tv_sec;
+          hc->bytes_sent += nwritten;
+          ninfo("Sent %zd bytes\n", nwritten);
+          goto done;
+        }
+    }
+#endif
+
+  /* Refill the buffer once all of it went out.  The first time around it
+   * still holds the response headers and the file data goes after them.
+   */
+
+  if (conn->sendidx == 0 && hc->buflen < CONFIG_THTTPD_IOBUFFERSIZE &&
+      conn->offset < conn->end_offset)
+    {
       nread = read_buffer(conn);
       if (nread < 0)
         {
@@ -447,38 +523,49 @@ static void handle_send(struct connect_s *conn, struct timeval *tv)
         }
 
       ninfo("Read %d bytes, buflen %d\n", nread, hc->buflen);
+    }
 
-      /* Send the buffer */
+  /* Send what the socket takes of the buffer */
 
-      if (hc->buflen > 0)
+  if (conn->sendidx < hc->buflen)
+    {
+      nwritten = write(hc->conn_fd, &hc->buffer[conn->sendidx],
+                       hc->buflen - conn->sendidx);
+      if (nwritten < 0)
         {
-          /* httpd_write does not return until all bytes have been sent
-           * (or an error occurs).
-           */
-
-          nwritten = httpd_write(hc->conn_fd, hc->buffer, hc->buflen);
-          if (nwritten < 0)
+          if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
             {
-              nerr("ERROR: Error sending %s: %d\n",
-                   hc->encodedurl, errno);
-              goto errout_clear_connection;
+              return;
             }
 
-          /* We wrote one full buffer of data (httpd_write does not
-           * return until the full buffer is written (or an error occurs).
-           */
-
-          conn->active_at       = tv->tv_sec;
-          hc->buflen            = 0;
+          nerr("ERROR: Error sending %s: %d\n", hc->encodedurl, errno);
+          goto errout_clear_connection;
+        }
 
-          /* And update how much of the file we wrote */
+      conn->active_at  = tv->tv_sec;
+      conn->sendidx   += nwritten;
+      hc->bytes_sent  += nwritten;
+      ninfo("Wrote %zd bytes\n", nwritten);
 
-          conn->offset         += nwritten;
-          conn->hc->bytes_sent += nwritten;
-          ninfo("Wrote %d bytes\n", nwritten);
+      if (conn->sendidx < hc->buflen)
+        {
+          return;
         }
     }
 
+  hc->buflen    = 0;
+  conn->sendidx = 0;
+
+#ifdef CONFIG_THTTPD_SENDFILE
+done:
+#endif
+  if (conn->offset < conn->end_offset)
+    {
+      /* More to send when the socket is writable again */
+
+      return;
+    }
+
   /* The file transfer is complete -- finish the connection */
 
   ninfo("Finish connection\n");
@@ -556,7 +643,7 @@ static void clear_connection(struct connect_s *conn, struct timeval *tv)
     {
       fdwatch_del_fd(fw, conn->hc->conn_fd);
       conn->conn_state = CNST_LINGERING;
-      fdwatch_add_fd(fw, conn->hc->conn_fd, conn);
+      fdwatch_add_fd(fw, conn->hc->conn_fd, conn, FDW_READ);
       client_data.p = conn;
 
       conn->linger_timer = tmr_create(tv, linger_clear_connection,
@@ -765,7 +852,7 @@ int thttpd_main(int argc, char **argv)
     {
       if (hs->listen_fd != -1)
         {
-          fdwatch_add_fd(fw, hs->listen_fd, NULL);
+          fdwatch_add_fd(fw, hs->listen_fd, NULL, FDW_READ);
         }
     }
 
@@ -846,9 +933,9 @@ int thttpd_main(int argc, char **argv)
 
                       case CNST_SENDING:
                         {
-                          /* Send a file -- this really should be performed
-                           * on a separate thread to keep the serve from
-                           * locking up during the write.
+                          /* Send the next buffer of the file.  Every
+                           * sending connection gets one buffer per round,
+                           * so that they share the bandwidth fairly.
                            */
 
                           handle_send(conn, &tv);
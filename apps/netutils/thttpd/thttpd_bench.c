@@ -0,0 +1,410 @@
+/****************************************************************************
+ * apps/netutils/thttpd/thttpd_bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_THTTPD_PORT
+#  define CONFIG_THTTPD_PORT 80
+#endif
+
+#ifndef CONFIG_THTTPD_PATH
+#  define CONFIG_THTTPD_PATH "/mnt/www"
+#endif
+
+#define BENCH_DEFAULT_ADDR   "127.0.0.1"
+#define BENCH_DEFAULT_COUNT  20
+#define BENCH_CALIBRATE_US   500000
+#define BENCH_BUFSIZE        4096
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Counts in a thread below everything else, the count it misses while a
+ * test runs is the CPU time the test took.
+ */
+
+struct bench_idle_s
+{
+  pthread_t              id;
+  volatile unsigned long count;
+  volatile bool          stop;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const size_t g_bench_sizes[] =
+{
+  1024, 4096, 16384, 65536, 262144, 1048576
+};
+
+static char g_bench_buf[BENCH_BUFSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static FAR void *bench_idle_thread(FAR void *arg)
+{
+  FAR struct bench_idle_s *idle = arg;
+
+  while (!idle->stop)
+    {
+      idle->count++;
+    }
+
+  return NULL;
+}
+
+static int bench_idle_start(FAR struct bench_idle_s *idle)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  idle->count = 0;
+  idle->stop  = false;
+
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  pthread_attr_setschedparam(&attr, &param);
+  ret = pthread_create(&idle->id, &attr, bench_idle_thread, idle);
+  pthread_attr_destroy(&attr);
+
+  return -ret;
+}
+
+static void bench_idle_stop(FAR struct bench_idle_s *idle)
+{
+  idle->stop = true;
+  pthread_join(idle->id, NULL);
+}
+
+/****************************************************************************
+ * Name: bench_mkfile
+ *
+ * Description:
+ *   Create the test file of the given size in the document directory,
+ *   unless it is already there.
+ ****************************************************************************/
+
+static int bench_mkfile(FAR const char *path, size_t size)
+{
+  struct stat st;
+  size_t done;
+  ssize_t n;
+  int fd;
+
+  if (stat(path, &st) == 0 && st.st_size == size)
+    {
+      return 0;
+    }
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      return -errno;
+    }
+
+  memset(g_bench_buf, 'x', sizeof(g_bench_buf));
+
+  for (done = 0; done < size; done += n)
+    {
+      n = write(fd, g_bench_buf, MIN(size - done, sizeof(g_bench_buf)));
+      if (n <= 0)
+        {
+          close(fd);
+          return n < 0 ? -errno : -ENOSPC;
+        }
+    }
+
+  close(fd);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: bench_get
+ *
+ * Description:
+ *   Fetch one URL with HTTP/1.0 and return the length of the body, or a
+ *   negated errno.
+ ****************************************************************************/
+
+static ssize_t bench_get(FAR const struct sockaddr_in *addr,
+                         FAR const char *url)
+{
+  static const char eoh[] = "\r\n\r\n";
+  ssize_t body = 0;
+  ssize_t n;
+  bool status = false;
+  int matched = 0;
+  int sd;
+  int i;
+
+  sd = socket(AF_INET, SOCK_STREAM, 0);
+  if (sd < 0)
+    {
+      return -errno;
+    }
+
+  if (connect(sd, (FAR const struct sockaddr *)addr, sizeof(*addr)) < 0)
+    {
+      body = -errno;
+      goto out;
+    }
+
+  n = snprintf(g_bench_buf, sizeof(g_bench_buf),
+               "GET %s HTTP/1.0\r\nHost: bench\r\n\r\n", url);
+  if (write(sd, g_bench_buf, n) != n)
+    {
+      body = -errno;
+      goto out;
+    }
+
+  while ((n = read(sd, g_bench_buf, sizeof(g_bench_buf))) > 0)
+    {
+      /* The status line fits into the first read */
+
+      if (!status)
+        {
+          if (n < 12 || strncmp(g_bench_buf + 9, "200", 3) != 0)
+            {
+              body = -EPROTO;
+              goto out;
+            }
+
+          status = true;
+        }
+
+      /* Skip the header, the rest is body */
+
+      for (i = 0; i < n && matched < 4; i++)
+        {
+          matched = g_bench_buf[i] == eoh[matched] ? matched + 1 :
+                    g_bench_buf[i] == eoh[0];
+        }
+
+      body += n - i;
+    }
+
+  if (n < 0)
+    {
+      body = -errno;
+    }
+
+out:
+  close(sd);
+  return body;
+}
+
+static void bench_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-a addr] [-p port] [-d dir] [-u url] [-n count]\n"
+         "Fetch files of 1 KB to 1 MB from thttpd and report MB/s and\n"
+         "the CPU time per request.\n"
+         "  -a  Server address (default %s)\n"
+         "  -p  Server port (default %d)\n"
+         "  -d  Document directory to create the files in (default %s)\n"
+         "  -u  URL of that directory (default /)\n"
+         "  -n  Requests per file size (default %d)\n"
+         "The CPU time is only meaningful with the server on this board.\n"
+         "It includes the client, which costs the same in every server\n"
+         "configuration.\n",
+         progname, BENCH_DEFAULT_ADDR, CONFIG_THTTPD_PORT,
+         CONFIG_THTTPD_PATH, BENCH_DEFAULT_COUNT);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct bench_idle_s idle;
+  struct sockaddr_in addr;
+  FAR const char *dir = CONFIG_THTTPD_PATH;
+  FAR const char *prefix = "/";
+  char path[128];
+  char url[128];
+  uint64_t start;
+  uint64_t elapsed;
+  uint64_t busy;
+  unsigned long count;
+  double rate;
+  ssize_t n;
+  size_t total;
+  int nreq = BENCH_DEFAULT_COUNT;
+  int ret;
+  int opt;
+  int s;
+  int i;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(CONFIG_THTTPD_PORT);
+  addr.sin_addr.s_addr = inet_addr(BENCH_DEFAULT_ADDR);
+
+  while ((opt = getopt(argc, argv, "a:p:d:u:n:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 'a':
+            addr.sin_addr.s_addr = inet_addr(optarg);
+            break;
+
+          case 'p':
+            addr.sin_port = htons(atoi(optarg));
+            break;
+
+          case 'd':
+            dir = optarg;
+            break;
+
+          case 'u':
+            prefix = optarg;
+            break;
+
+          case 'n':
+            nreq = atoi(optarg);
+            break;
+
+          default:
+            bench_usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+  if (nreq <= 0)
+    {
+      bench_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  /* How far the idle thread counts per us with nothing else running */
+
+  ret = bench_idle_start(&idle);
+  if (ret < 0)
+    {
+      fprintf(stderr, "Failed to start the idle thread: %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  start = bench_time();
+  count = idle.count;
+  usleep(BENCH_CALIBRATE_US);
+  rate  = (double)(idle.count - count) / (bench_time() - start);
+
+  printf("%8s %6s %9s %8s %10s %6s\n",
+         "size", "reqs", "MB/s", "req/s", "CPU us/req", "CPU%");
+
+  for (s = 0; s < nitems(g_bench_sizes); s++)
+    {
+      snprintf(path, sizeof(path), "%s/bench_%zu.bin", dir,
+               g_bench_sizes[s]);
+      snprintf(url, sizeof(url), "%s%sbench_%zu.bin", prefix,
+               prefix[strlen(prefix) - 1] == '/' ? "" : "/",
+               g_bench_sizes[s]);
+
+      ret = bench_mkfile(path, g_bench_sizes[s]);
+      if (ret < 0)
+        {
+          fprintf(stderr, "%s: %d\n", path, ret);
+          break;
+        }
+
+      /* One request to warm up the caches */
+
+      bench_get(&addr, url);
+
+      total = 0;
+      start = bench_time();
+      count = idle.count;
+
+      for (i = 0; i < nreq; i++)
+        {
+          n = bench_get(&addr, url);
+          if (n != g_bench_sizes[s])
+            {
+              fprintf(stderr, "%s: got %zd of %zu bytes\n", url, n,
+                      g_bench_sizes[s]);
+              ret = n < 0 ? n : -EIO;
+              break;
+            }
+
+          total += n;
+        }
+
+      if (ret < 0)
+        {
+          break;
+        }
+
+      elapsed = bench_time() - start;
+      busy    = (uint64_t)((idle.count - count) / rate);
+      busy    = busy < elapsed ? elapsed - busy : 0;
+
+      /* Bytes per us are MB/s */
+
+      printf("%8zu %6d %9.2f %8.1f %10" PRIu64 " %5.1f%%\n",
+             g_bench_sizes[s], nreq, (double)total / elapsed,
+             nreq * 1e6 / elapsed, busy / nreq, busy * 100.0 / elapsed);
+    }
+
+  bench_idle_stop(&idle);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,347 @@
+/****************************************************************************
+ * apps/netutils/thttpd/thttpd_fdwatchbench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/socket.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fdwatch.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_DEFAULT_LOOPS   2000
+#define BENCH_DEFAULT_ACTIVE  4
+#define BENCH_MAX_CONNS       128
+#define BENCH_TIMEOUT_MSECS   1000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One connection, as the server and the client see it */
+
+struct bench_conn_s
+{
+  int server_fd;
+  int client_fd;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const int g_bench_counts[] =
+{
+  16, 32, 64, BENCH_MAX_CONNS
+};
+
+static struct bench_conn_s g_bench_conns[BENCH_MAX_CONNS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_close(int listen_fd, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      close(g_bench_conns[i].client_fd);
+      close(g_bench_conns[i].server_fd);
+    }
+
+  close(listen_fd);
+}
+
+/****************************************************************************
+ * Name: bench_connect
+ *
+ * Description:
+ *   Listen on an ephemeral loopback port and open n connections to it.
+ *   Returns the listening socket, or -1 on failure.
+ *
+ ****************************************************************************/
+
+static int bench_connect(int n)
+{
+  struct sockaddr_in addr;
+  socklen_t addrlen = sizeof(addr);
+  int listen_fd;
+  int i;
+
+  listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+    {
+      perror("socket");
+      return -1;
+    }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = 0;
+
+  if (bind(listen_fd, (FAR struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      getsockname(listen_fd, (FAR struct sockaddr *)&addr, &addrlen) < 0 ||
+      listen(listen_fd, n) < 0)
+    {
+      perror("listen");
+      close(listen_fd);
+      return -1;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      FAR struct bench_conn_s *conn = &g_bench_conns[i];
+
+      conn->client_fd = socket(AF_INET, SOCK_STREAM, 0);
+      if (conn->client_fd < 0)
+        {
+          perror("socket");
+          break;
+        }
+
+      if (connect(conn->client_fd, (FAR struct sockaddr *)&addr,
+                  sizeof(addr)) < 0)
+        {
+          perror("connect");
+          close(conn->client_fd);
+          break;
+        }
+
+      conn->server_fd = accept(listen_fd, NULL, NULL);
+      if (conn->server_fd < 0)
+        {
+          perror("accept");
+          close(conn->client_fd);
+          break;
+        }
+    }
+
+  if (i < n)
+    {
+      bench_close(listen_fd, i);
+      return -1;
+    }
+
+  return listen_fd;
+}
+
+/****************************************************************************
+ * Name: bench_run
+ *
+ * Description:
+ *   Watch n idle connections of which `active' receive a byte per round.
+ *   Each round is timed like one thttpd server loop iteration: fdwatch(),
+ *   then fdwatch_get_next_client_data() and fdwatch_check_fd() for the
+ *   ready connections, each of which reads its byte and is deleted and
+ *   added again as for a switch between reading and sending.
+ *
+ ****************************************************************************/
+
+static int bench_run(int n, int active, int loops)
+{
+  FAR struct fdwatch_s *fw;
+  FAR struct bench_conn_s *conn;
+  unsigned long events = 0;
+  uint64_t elapsed = 0;
+  uint64_t start;
+  int listen_fd;
+  int i;
+  int j;
+  char ch;
+
+  listen_fd = bench_connect(n);
+  if (listen_fd < 0)
+    {
+      printf("%7d  skipped, cannot open the connections\n", n);
+      return 0;
+    }
+
+  fw = fdwatch_initialize(n + 1);
+  if (fw == NULL)
+    {
+      fprintf(stderr, "fdwatch_initialize failed\n");
+      bench_close(listen_fd, n);
+      return -1;
+    }
+
+  srandom(n);
+  fdwatch_add_fd(fw, listen_fd, NULL, FDW_READ);
+  for (i = 0; i < n; i++)
+    {
+      fdwatch_add_fd(fw, g_bench_conns[i].server_fd, &g_bench_conns[i],
+                     FDW_READ);
+    }
+
+  for (i = 0; i < loops; i++)
+    {
+      ch = (char)i;
+      for (j = 0; j < active; j++)
+        {
+          conn = &g_bench_conns[random() % n];
+          if (write(conn->client_fd, &ch, 1) != 1)
+            {
+              perror("write");
+              goto errout;
+            }
+        }
+
+      start = bench_time();
+      if (fdwatch(fw, BENCH_TIMEOUT_MSECS) < 0)
+        {
+          perror("fdwatch");
+          goto errout;
+        }
+
+      while ((conn = fdwatch_get_next_client_data(fw))
+             != (FAR struct bench_conn_s *)-1)
+        {
+          if (conn && fdwatch_check_fd(fw, conn->server_fd))
+            {
+              if (read(conn->server_fd, &ch, 1) != 1)
+                {
+                  perror("read");
+                  goto errout;
+                }
+
+              fdwatch_del_fd(fw, conn->server_fd);
+              fdwatch_add_fd(fw, conn->server_fd, conn, FDW_READ);
+              events++;
+            }
+        }
+
+      elapsed += bench_time() - start;
+    }
+
+  /* Drain what the last rounds left unread */
+
+  while (events < (unsigned long)loops * active &&
+         fdwatch(fw, BENCH_TIMEOUT_MSECS) > 0)
+    {
+      while ((conn = fdwatch_get_next_client_data(fw))
+             != (FAR struct bench_conn_s *)-1)
+        {
+          if (conn && fdwatch_check_fd(fw, conn->server_fd) &&
+              read(conn->server_fd, &ch, 1) == 1)
+            {
+              events++;
+            }
+        }
+    }
+
+  printf("%7d %7d %10" PRIu64 " %10" PRIu64 " %9lu\n", n, active,
+         elapsed / loops, events ? elapsed / events : 0, events);
+
+  fdwatch_uninitialize(fw);
+  bench_close(listen_fd, n);
+  return 0;
+
+errout:
+  fdwatch_uninitialize(fw);
+  bench_close(listen_fd, n);
+  return -1;
+}
+
+static void bench_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-l loops] [-a active]\n"
+         "Time the thttpd fdwatch loop over 16 to %d loopback connections,\n"
+         "a few of which receive a byte per round.  All times in ns.\n"
+         "  -l  Rounds per measurement (default %d)\n"
+         "  -a  Connections written to per round (default %d)\n",
+         progname, BENCH_MAX_CONNS, BENCH_DEFAULT_LOOPS,
+         BENCH_DEFAULT_ACTIVE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  int loops = BENCH_DEFAULT_LOOPS;
+  int active = BENCH_DEFAULT_ACTIVE;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "l:a:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 'l':
+            loops = atoi(optarg);
+            break;
+
+          case 'a':
+            active = atoi(optarg);
+            break;
+
+          default:
+            bench_usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+  if (loops <= 0 || active <= 0)
+    {
+      bench_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  printf("%7s %7s %10s %10s %9s\n",
+         "conns", "active", "round", "event", "events");
+
+  for (i = 0; i < nitems(g_bench_counts); i++)
+    {
+      if (bench_run(g_bench_counts[i], active, loops) < 0)
+        {
+          return EXIT_FAILURE;
+        }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,348 @@
+/****************************************************************************
+ * apps/netutils/thttpd/thttpd_timerbench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/time.h>
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "timers.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_DEFAULT_LOOPS  10000
+#define BENCH_MAX_TIMERS     10000
+#define BENCH_MAX_MSECS      60000   /* Like the idle and linger timeouts */
+#define BENCH_CHECK_LOOPS    2000
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const int g_bench_counts[] =
+{
+  1000, 2000, 5000, 10000
+};
+
+static Timer *g_bench_timers[BENCH_MAX_TIMERS];
+static long g_bench_expires[BENCH_MAX_TIMERS];
+static long g_bench_elapsed;
+static unsigned long g_bench_fired;
+static unsigned long g_bench_early;
+static volatile long g_bench_sink;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_add_ms(FAR struct timeval *tv, long msecs)
+{
+  tv->tv_usec += msecs * 1000;
+  tv->tv_sec  += tv->tv_usec / 1000000;
+  tv->tv_usec %= 1000000;
+}
+
+static void bench_expired(ClientData client_data, FAR struct timeval *nowp)
+{
+  g_bench_timers[client_data.i] = NULL;
+  g_bench_fired++;
+
+  if (g_bench_expires[client_data.i] > g_bench_elapsed)
+    {
+      g_bench_early++;
+    }
+}
+
+static Timer *bench_create(FAR struct timeval *now, int i)
+{
+  ClientData cd;
+  long msecs;
+
+  /* Half of the timers on level 0 and 1, half up to BENCH_MAX_MSECS */
+
+  msecs = 1 + random() % (random() & 1 ? 4096 : BENCH_MAX_MSECS);
+  g_bench_expires[i] = g_bench_elapsed + msecs;
+
+  cd.i = i;
+  return tmr_create(now, bench_expired, cd, msecs, 0);
+}
+
+/****************************************************************************
+ * Name: bench_check
+ *
+ * Description:
+ *   Run the timers as the server loop does, with n timers pending and one
+ *   of them replaced per round.  Each round sleeps for a random part of
+ *   tmr_mstimeout() and runs the timers.  Fail if tmr_mstimeout() is past
+ *   the next timer due, if a timer runs before it is due or if one is due
+ *   but has not run.
+ *
+ ****************************************************************************/
+
+static int bench_check(int n, int loops)
+{
+  struct timeval now;
+  long timeout;
+  long next;
+  int ret = 0;
+  int i;
+  int k;
+
+  srandom(n);
+  tmr_init();
+  gettimeofday(&now, NULL);
+  now.tv_usec     -= now.tv_usec % 1000;
+  g_bench_elapsed = 0;
+  g_bench_fired   = 0;
+  g_bench_early   = 0;
+
+  for (i = 0; i < n; i++)
+    {
+      g_bench_timers[i] = bench_create(&now, i);
+      if (g_bench_timers[i] == NULL)
+        {
+          fprintf(stderr, "tmr_create failed\n");
+          tmr_destroy();
+          return -1;
+        }
+    }
+
+  for (i = 0; i < loops && ret == 0; i++)
+    {
+      next = LONG_MAX;
+      for (k = 0; k < n; k++)
+        {
+          if (g_bench_timers[k] != NULL && g_bench_expires[k] < next)
+            {
+              next = g_bench_expires[k];
+            }
+        }
+
+      next   -= g_bench_elapsed;
+      timeout = tmr_mstimeout(&now);
+      if (timeout < 0 || timeout > MAX(next, 0))
+        {
+          fprintf(stderr, "tmr_mstimeout() is %ld ms, the next timer is "
+                  "due in %ld ms\n", timeout, next);
+          ret = -1;
+        }
+
+      timeout = random() % (timeout + 1);
+      bench_add_ms(&now, timeout);
+      g_bench_elapsed += timeout;
+      tmr_run(&now);
+
+      for (k = 0; k < n; k++)
+        {
+          if (g_bench_timers[k] != NULL &&
+              g_bench_expires[k] <= g_bench_elapsed)
+            {
+              fprintf(stderr, "A timer due %ld ms ago has not run\n",
+                      g_bench_elapsed - g_bench_expires[k]);
+              ret = -1;
+              break;
+            }
+        }
+
+      k = random() % n;
+      if (g_bench_timers[k] != NULL)
+        {
+          tmr_cancel(g_bench_timers[k]);
+        }
+
+      g_bench_timers[k] = bench_create(&now, k);
+    }
+
+  if (g_bench_early > 0)
+    {
+      fprintf(stderr, "%lu timers ran early\n", g_bench_early);
+      ret = -1;
+    }
+
+  tmr_destroy();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_run
+ *
+ * Description:
+ *   Measure with n timers pending:
+ *   - create and cancel, per timer
+ *   - tmr_mstimeout(), per call
+ *   - one server loop iteration: tmr_mstimeout(), one connection replacing
+ *     its timer and tmr_run() one millisecond later.
+ *
+ ****************************************************************************/
+
+static int bench_run(int n, int loops)
+{
+  struct timeval now;
+  uint64_t start;
+  uint64_t create;
+  uint64_t cancel;
+  uint64_t timeout;
+  uint64_t loop;
+  int i;
+
+  srandom(n);
+  tmr_init();
+  gettimeofday(&now, NULL);
+  g_bench_elapsed = 0;
+  g_bench_fired   = 0;
+
+  start = bench_time();
+  for (i = 0; i < n; i++)
+    {
+      g_bench_timers[i] = bench_create(&now, i);
+      if (g_bench_timers[i] == NULL)
+        {
+          fprintf(stderr, "tmr_create failed\n");
+          tmr_destroy();
+          return -1;
+        }
+    }
+
+  create = bench_time() - start;
+
+  start = bench_time();
+  for (i = 0; i < loops; i++)
+    {
+      g_bench_sink = tmr_mstimeout(&now);
+    }
+
+  timeout = bench_time() - start;
+
+  start = bench_time();
+  for (i = 0; i < loops; i++)
+    {
+      int k = random() % n;
+
+      g_bench_sink = tmr_mstimeout(&now);
+
+      if (g_bench_timers[k] != NULL)
+        {
+          tmr_cancel(g_bench_timers[k]);
+        }
+
+      g_bench_timers[k] = bench_create(&now, k);
+
+      bench_add_ms(&now, 1);
+      tmr_run(&now);
+    }
+
+  loop = bench_time() - start;
+
+  start = bench_time();
+  for (i = 0; i < n; i++)
+    {
+      if (g_bench_timers[i] != NULL)
+        {
+          tmr_cancel(g_bench_timers[i]);
+          g_bench_timers[i] = NULL;
+        }
+    }
+
+  cancel = bench_time() - start;
+
+  tmr_destroy();
+
+  printf("%7d %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+         " %7lu\n", n, create / n, cancel / n, timeout / loops,
+         loop / loops, g_bench_fired);
+
+  return 0;
+}
+
+static void bench_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-l loops]\n"
+         "Check and time the thttpd timer operations with 1000 to 10000\n"
+         "one-shot timers of up to %d s pending.  All times in ns.\n"
+         "  -l  Calls per measurement (default %d)\n",
+         progname, BENCH_MAX_MSECS / 1000, BENCH_DEFAULT_LOOPS);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  int loops = BENCH_DEFAULT_LOOPS;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "l:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 'l':
+            loops = atoi(optarg);
+            break;
+
+          default:
+            bench_usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+  if (loops <= 0)
+    {
+      bench_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  printf("%7s %10s %10s %10s %10s %7s\n",
+         "timers", "create", "cancel", "mstimeout", "loop", "fired");
+
+  for (i = 0; i < nitems(g_bench_counts); i++)
+    {
+      if (bench_check(g_bench_counts[i], BENCH_CHECK_LOOPS) < 0 ||
+          bench_run(g_bench_counts[i], loops) < 0)
+        {
+          return EXIT_FAILURE;
+        }
+    }
+
+  tmr_cleanup();
+  return EXIT_SUCCESS;
+}
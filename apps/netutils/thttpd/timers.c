@@ -51,14 +51,35 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
-#define HASH_SIZE 67
+/* The timers are kept in a hierarchical timing wheel with a tick of one
+ * millisecond.  Level 0 has one slot per tick for the next WHEEL_SLOTS
+ * ticks, each higher level has slots WHEEL_SLOTS times as wide.  A timer
+ * goes into the level its distance falls in, and moves down one level
+ * each time the slot it is in comes up.  Adding and cancelling are O(1),
+ * a timer moves at most WHEEL_LEVELS - 1 times before it runs.
+ *
+ * Four levels of 64 slots cover 2^24 ms, about 4.6 hours.  Timers further
+ * out are parked in the last slot and placed again when it comes up.
+ */
+
+#define WHEEL_BITS    6
+#define WHEEL_SLOTS   (1 << WHEEL_BITS)
+#define WHEEL_MASK    (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS  4
+#define WHEEL_MAXTICK ((1ul << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
+#define WHEEL_INDEX(t, level) \
+  (((t) >> ((level) * WHEEL_BITS)) & WHEEL_MASK)
 
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-static Timer *timers[HASH_SIZE];
+static Timer *wheel[WHEEL_LEVELS][WHEEL_SLOTS];
 static Timer *free_timers;
+static unsigned long wheel_now;  /* Next tick to run */
+static time_t wheel_base;        /* Time of tick zero, in seconds */
+static int active_timers;
 
 /****************************************************************************
  * Public Data
@@ -70,82 +91,55 @@ ClientData JunkClientData;
  * Private Functions
  ****************************************************************************/
 
-static unsigned int hash(Timer *tmr)
+static unsigned long tmr_ticks(struct timeval *now)
 {
-  /* We can hash on the trigger time, even though it can change over the
-   * life of a timer via the periodic bit.
-   * This is because both of those guys call l_resort(), which  * recomputes
-   * the hash and moves the timer to the appropriate list.
-   */
-
-  return ((unsigned int)tmr->time.tv_sec ^
-          (unsigned int)tmr->time.tv_usec) % HASH_SIZE;
+  return (unsigned long)(now->tv_sec - wheel_base) * 1000ul +
+         now->tv_usec / 1000;
 }
 
 static void l_add(Timer *tmr)
 {
-  int h = tmr->hash;
-  register Timer *tmr2;
-  register Timer *tmr2prev;
+  unsigned long expires = tmr->expires;
+  long delta = (long)(expires - wheel_now);
+  int level;
 
-  tmr2 = timers[h];
-  if (tmr2 == NULL)
+  if (delta < 0)
     {
-      /* The list is empty. */
+      /* Already due, run it with the next tick */
 
-      timers[h] = tmr;
-      tmr->prev = tmr->next = NULL;
+      expires = wheel_now;
+      delta   = 0;
     }
-  else
+  else if (delta > WHEEL_MAXTICK)
     {
-      if (tmr->time.tv_sec < tmr2->time.tv_sec ||
-          (tmr->time.tv_sec == tmr2->time.tv_sec &&
-           tmr->time.tv_usec <= tmr2->time.tv_usec))
-        {
-          /* The new timer goes at the head of the list. */
+      expires = wheel_now + WHEEL_MAXTICK;
+      delta   = WHEEL_MAXTICK;
+    }
 
-          timers[h] = tmr;
-          tmr->prev = NULL;
-          tmr->next = tmr2;
-          tmr2->prev = tmr;
-        }
-      else
+  for (level = 0; level < WHEEL_LEVELS - 1; level++)
+    {
+      if (delta < (1l << ((level + 1) * WHEEL_BITS)))
         {
-          /* Walk the list to find the insertion point. */
-
-          for (tmr2prev = tmr2, tmr2 = tmr2->next; tmr2 != NULL;
-               tmr2prev = tmr2, tmr2 = tmr2->next)
-            {
-              if (tmr->time.tv_sec < tmr2->time.tv_sec ||
-                  (tmr->time.tv_sec == tmr2->time.tv_sec &&
-                   tmr->time.tv_usec <= tmr2->time.tv_usec))
-                {
-                  /* Found it. */
-
-                  tmr2prev->next = tmr;
-                  tmr->prev = tmr2prev;
-                  tmr->next = tmr2;
-                  tmr2->prev = tmr;
-                  return;
-                }
-            }
-
-          /* Oops, got to the end of the list.  Add to tail. */
-
-          tmr2prev->next = tmr;
-          tmr->prev = tmr2prev;
-          tmr->next = NULL;
+          break;
         }
     }
+
+  tmr->list = &wheel[level][WHEEL_INDEX(expires, level)];
+  tmr->prev = NULL;
+  tmr->next = *tmr->list;
+  if (tmr->next != NULL)
+    {
+      tmr->next->prev = tmr;
+    }
+
+  *tmr->list = tmr;
 }
 
 static void l_remove(Timer *tmr)
 {
-  int h = tmr->hash;
-
   if (tmr->prev == NULL)
     {
-      timers[h] = tmr->next;
+      *tmr->list = tmr->next;
     }
   else
     {
@@ -158,19 +152,59 @@ static void l_remove(Timer *tmr)
     }
 }
 
-static void l_resort(Timer *tmr)
+/* Move the timers of one slot down to the levels below */
+
+static int l_cascade(int level)
 {
-  /* Remove the timer from its old list. */
+  int index = WHEEL_INDEX(wheel_now, level);
+  Timer *tmr;
 
-  l_remove(tmr);
+  while ((tmr = wheel[level][index]) != NULL)
+    {
+      l_remove(tmr);
+      l_add(tmr);
+    }
 
-  /* Recompute the hash. */
+  return index;
+}
 
-  tmr->hash = hash(tmr);
+/* The first tick with something to do.  The first used slot of level 0
+ * holds the next timer to run.  For the higher levels it is when their
+ * first used slot comes up and is moved down, which is never after the
+ * timers in it are due.  The slot of the current block has been moved
+ * down already, unless the block starts at wheel_now and tmr_run() has
+ * not got there yet.
+ */
 
-  /* And add it back in to its new list, sorted correctly. */
+static unsigned long l_next(void)
+{
+  unsigned long next = wheel_now + WHEEL_MAXTICK;
+  unsigned long t;
+  int level;
+  int shift;
+  int i;
 
-  l_add(tmr);
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+      shift = level * WHEEL_BITS;
+
+      for (i = (wheel_now & ((1ul << shift) - 1)) != 0;
+           i <= WHEEL_SLOTS; i++)
+        {
+          t = ((wheel_now >> shift) + i) << shift;
+          if (wheel[level][WHEEL_INDEX(t, level)] != NULL)
+            {
+              if ((long)(t - next) < 0)
+                {
+                  next = t;
+                }
+
+              break;
+            }
+        }
+    }
+
+  return next;
 }
 
 /****************************************************************************
@@ -179,19 +213,29 @@ static void l_resort(Timer *tmr)
 
 void tmr_init(void)
 {
-  int h;
+  struct timeval now;
+  int level;
+  int i;
 
-  for (h = 0; h < HASH_SIZE; ++h)
+  for (level = 0; level < WHEEL_LEVELS; level++)
     {
-      timers[h] = NULL;
+      for (i = 0; i < WHEEL_SLOTS; i++)
+        {
+          wheel[level][i] = NULL;
+        }
     }
 
-  free_timers = NULL;
+  gettimeofday(&now, NULL);
+  wheel_base    = now.tv_sec;
+  wheel_now     = tmr_ticks(&now);
+  active_timers = 0;
+  free_timers   = NULL;
 }
 
 Timer *tmr_create(struct timeval *now, TimerProc *timer_proc,
                   ClientData client_data, long msecs, int periodic)
 {
+  struct timeval tv;
   Timer *tmr;
 
   if (free_timers != NULL)
@@ -213,119 +257,114 @@ Timer *tmr_create(struct timeval *now, TimerProc *timer_proc,
   tmr->msecs       = msecs;
   tmr->periodic    = periodic;
 
-  if (now != NULL)
-    {
-      tmr->time = *now;
-    }
-  else
-    {
-      gettimeofday(&tmr->time, NULL);
-    }
-
-  tmr->time.tv_sec  += msecs / 1000L;
-  tmr->time.tv_usec += (msecs % 1000L) * 1000L;
-  if (tmr->time.tv_usec >= 1000000L)
+  if (now == NULL)
     {
-      tmr->time.tv_sec  += tmr->time.tv_usec / 1000000L;
-      tmr->time.tv_usec %= 1000000L;
+      gettimeofday(&tv, NULL);
+      now = &tv;
     }
 
-  tmr->hash = hash(tmr);
+  tmr->expires = tmr_ticks(now) + msecs;
 
-  /* Add the new timer to the proper active list. */
+  /* Add the new timer to the wheel. */
 
   l_add(tmr);
+  active_timers++;
   return tmr;
 }
 
 long tmr_mstimeout(struct timeval *now)
 {
-  int h;
-  int gotone;
   long msecs;
-  long m;
-  register Timer *tmr;
-
-  gotone = 0;
-  msecs  = 0;
-
-  /* Since the lists are sorted, we only need to look at the first timer
-   * on each one.
-   */
-
-  for (h = 0; h < HASH_SIZE; ++h)
-    {
-      tmr = timers[h];
-      if (tmr != NULL)
-        {
-          m = (tmr->time.tv_sec - now->tv_sec) * 1000L +
-            (tmr->time.tv_usec - now->tv_usec) / 1000L;
-          if (!gotone)
-            {
-              msecs = m;
-              gotone = 1;
-            }
-          else if (m < msecs)
-            {
-              msecs = m;
-            }
-        }
-    }
 
-  if (!gotone)
+  if (active_timers == 0)
     {
       return INFTIM;
     }
 
-  if (msecs <= 0)
-    {
-      msecs = 0;
-    }
-
-  return msecs;
+  msecs = (long)(l_next() - tmr_ticks(now));
+  return msecs > 0 ? msecs : 0;
 }
 
 void tmr_run(struct timeval *now)
 {
-  int h;
+  unsigned long ticks = tmr_ticks(now);
+  unsigned long next;
+  Timer *run;
   Timer *tmr;
-  Timer *next;
+  int level;
+  int index;
 
-  for (h = 0; h < HASH_SIZE; ++h)
+  while ((long)(ticks - wheel_now) >= 0)
     {
-      for (tmr = timers[h]; tmr != NULL; tmr = next)
-        {
-          next = tmr->next;
+      index = WHEEL_INDEX(wheel_now, 0);
 
-          /* Since the lists are sorted, as soon as we find a timer that
-           * isn't ready yet, we can go on to the next list.
-           */
+      /* Skip the ticks with nothing to do, one at a time would take long
+       * after the clock was set forward.
+       */
 
-          if (tmr->time.tv_sec > now->tv_sec ||
-              (tmr->time.tv_sec == now->tv_sec &&
-               tmr->time.tv_usec > now->tv_usec))
+      if (index != 0 && wheel[0][index] == NULL)
+        {
+          next = active_timers > 0 ? l_next() : ticks + 1;
+          if ((long)(next - ticks) > 0)
             {
+              wheel_now = ticks + 1;
               break;
             }
 
+          wheel_now = next;
+          index     = WHEEL_INDEX(wheel_now, 0);
+        }
+
+      /* Entering a new round of a level moves the next slot of the level
+       * above down.
+       */
+
+      for (level = 1; index == 0 && level < WHEEL_LEVELS; level++)
+        {
+          index = l_cascade(level);
+        }
+
+      /* Take the slot off the wheel, the callbacks may add and cancel
+       * timers, this slot's included.
+       */
+
+      index = WHEEL_INDEX(wheel_now, 0);
+      run   = wheel[0][index];
+      wheel[0][index] = NULL;
+      wheel_now++;
+
+      for (tmr = run; tmr != NULL; tmr = tmr->next)
+        {
+          tmr->list = &run;
+        }
+
+      while ((tmr = run) != NULL)
+        {
+          l_remove(tmr);
+          tmr->list = NULL;
+
           (tmr->timer_proc)(tmr->client_data, now);
           if (tmr->periodic)
             {
-              /* Reschedule. */
+              /* Reschedule.  Periods missed while the loop was busy, or
+               * the clock was set forward, are run once only.
+               */
 
-              tmr->time.tv_sec += tmr->msecs / 1000L;
-              tmr->time.tv_usec += (tmr->msecs % 1000L) * 1000L;
-              if (tmr->time.tv_usec >= 1000000L)
+              tmr->expires += tmr->msecs;
+              if ((long)(tmr->expires - ticks) <= 0 && tmr->msecs > 0)
                 {
-                  tmr->time.tv_sec += tmr->time.tv_usec / 1000000L;
-                  tmr->time.tv_usec %= 1000000L;
+                  tmr->expires += ((ticks - tmr->expires) / tmr->msecs + 1) *
+                                  tmr->msecs;
                 }
 
-              l_resort(tmr);
+              l_add(tmr);
             }
           else
             {
-              tmr_cancel(tmr);
+              active_timers--;
+              tmr->next   = free_timers;
+              free_timers = tmr;
+              tmr->prev   = NULL;
             }
         }
     }
@@ -336,6 +375,7 @@ void tmr_cancel(Timer *tmr)
   /* Remove it from its active list. */
 
   l_remove(tmr);
+  active_timers--;
 
   /* And put it on the free list. */
 
@@ -358,13 +398,17 @@ void tmr_cleanup(void)
 
 void tmr_destroy(void)
 {
-  int h;
+  int level;
+  int i;
 
-  for (h = 0; h < HASH_SIZE; ++h)
+  for (level = 0; level < WHEEL_LEVELS; level++)
     {
-      while (timers[h] != NULL)
+      for (i = 0; i < WHEEL_SLOTS; i++)
         {
-          tmr_cancel(timers[h]);
+          while (wheel[level][i] != NULL)
+            {
+              tmr_cancel(wheel[level][i]);
+            }
         }
     }
 
@@ -74,18 +74,20 @@ typedef union
 
 typedef void TimerProc(ClientData client_data, struct timeval *nowp);
 
-/* The Timer struct. */
+/* The Timer struct.  Active timers are kept in a hierarchical timing
+ * wheel, list is the wheel slot (or run list) the timer is linked into.
+ */
 
 typedef struct TimerStruct
 {
-  TimerProc          *timer_proc;
-  ClientData          client_data;
-  long                msecs;
-  int                 periodic;
-  struct timeval      time;
-  struct TimerStruct *prev;
-  struct TimerStruct *next;
-  int hash;
+  TimerProc           *timer_proc;
+  ClientData           client_data;
+  long                 msecs;
+  int                  periodic;
+  unsigned long        expires;      /* In ms ticks since tmr_init() */
+  struct TimerStruct **list;
+  struct TimerStruct  *prev;
+  struct TimerStruct  *next;
 } Timer;
 
 /****************************************************************************
@@ -65,6 +65,10 @@
 #  include <pthread.h>
 #endif
 
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+#  include <poll.h>
+#endif
+
 #include <arpa/inet.h>
 
 #include "netutils/netlib.h"
@@ -111,14 +115,16 @@
 #  define CONFIG_NETUTILS_HTTPD_TIMEOUT 0
 #endif
 
-/* If timeouts are not enabled, then keep-alive is disabled.  This is to
- * prevent a rogue HTTP client from blocking the httpd indefinitely.
+/* An idle persistent connection is closed after the keep-alive timeout,
+ * so a client cannot hold on to the connection between requests.
  */
 
-#if !defined(CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE)
-#  if CONFIG_NETUTILS_HTTPD_TIMEOUT == 0
-#    define CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
-#  endif
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_TIMEOUT
+#  define CONFIG_NETUTILS_HTTPD_KEEPALIVE_TIMEOUT 5
+#endif
+
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_MAX
+#  define CONFIG_NETUTILS_HTTPD_KEEPALIVE_MAX 100
 #endif
 
 #ifdef CONFIG_NETUTILS_HTTPD_CLASSIC
@@ -424,6 +430,69 @@ static int httpd_senderror(struct httpd_state *pstate, int status)
   return ret;
 }
 
+#ifdef CONFIG_NETUTILS_HTTPD_CACHE
+/****************************************************************************
+ * Name: httpd_sendcached
+ *
+ * Description:
+ *   Answer from the cache, with 304 if the client's copy is current.
+ *
+ ****************************************************************************/
+
+static int httpd_sendcached(struct httpd_state *pstate,
+                            FAR struct httpd_cache_entry_s *entry)
+{
+  char header[HTTPD_MAX_HEADERLEN + HTTPD_CACHE_HEADERLEN];
+  bool modified;
+  int hdrlen;
+  int ret;
+
+  modified = strstr(pstate->ht_ifnonematch, entry->etag) == NULL &&
+             strcmp(pstate->ht_ifnonematch, "*") != 0;
+
+  ninfo("[%d] %s '%s' from the cache\n", pstate->ht_sockfd,
+        modified ? "sending" : "validated", pstate->ht_filename);
+
+  hdrlen = snprintf(header, sizeof(header),
+                    "HTTP/1.%d %s\r\n"
+#ifndef CONFIG_NETUTILS_HTTPD_SERVERHEADER_DISABLE
+                    "Server: uIP/NuttX http://nuttx.org/\r\n"
+#endif
+                    "Connection: %s\r\n",
+                    pstate->ht_http11 ? 1 : 0,
+                    modified ? "200 OK" : "304 Not Modified",
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+                    pstate->ht_keepalive ? "keep-alive" : "close"
+#else
+                    "close"
+#endif
+                    );
+
+  if (modified)
+    {
+      hdrlen += snprintf(header + hdrlen, sizeof(header) - hdrlen,
+                         "%s\r\n", entry->headers);
+    }
+  else
+    {
+      hdrlen += snprintf(header + hdrlen, sizeof(header) - hdrlen,
+                         "%sETag: %s\r\n\r\n",
+                         entry->encoded ?
+                         "Vary: Accept-Encoding\r\n" : "",
+                         entry->etag);
+    }
+
+  ret = send_chunk(pstate, header, hdrlen);
+  if (ret == OK && modified && entry->len > 0)
+    {
+      ret = send_chunk(pstate, entry->data, entry->len);
+    }
+
+  httpd_cache_put(entry);
+  return ret;
+}
+#endif
+
 static int httpd_sendfile(struct httpd_state *pstate)
 {
 #ifndef CONFIG_NETUTILS_HTTPD_SCRIPT_DISABLE
@@ -452,6 +521,18 @@ static int httpd_sendfile(struct httpd_state *pstate)
     }
 #endif
 
+#ifdef CONFIG_NETUTILS_HTTPD_CACHE
+    {
+      FAR struct httpd_cache_entry_s *entry;
+
+      entry = httpd_cache_get(pstate->ht_filename, pstate->ht_gzip);
+      if (entry != NULL)
+        {
+          return httpd_sendcached(pstate, entry);
+        }
+    }
+#endif
+
   if (httpd_openindex(pstate) != OK)
     {
       nwarn("WARNING: [%d] '%s' not found\n",
@@ -464,7 +545,10 @@ static int httpd_sendfile(struct httpd_state *pstate)
   if (ptr != NULL &&
       strncmp(ptr, ".shtml", strlen(".shtml")) == 0)
     {
-#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+#if !defined(CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE) && \
+    !defined(CONFIG_NETUTILS_HTTPD_ENABLE_CHUNKED_ENCODING)
+      /* Only chunked encoding can frame the script output */
+
       pstate->ht_keepalive = false;
 #endif
       if (httpd_send_headers(pstate, 200, -1) != OK)
@@ -506,6 +590,7 @@ done:
 static inline int httpd_parse(struct httpd_state *pstate)
 {
   char *o;
+  bool pending = false;
 
   enum
     {
@@ -517,6 +602,19 @@ static inline int httpd_parse(struct httpd_state *pstate)
   state = STATE_METHOD;
   o = pstate->ht_buffer;
 
+#ifdef CONFIG_NETUTILS_HTTPD_CACHE
+  pstate->ht_gzip = false;
+  pstate->ht_ifnonematch[0] = '\0';
+#endif
+
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+  /* Start with what is left of a pipelined request */
+
+  o += pstate->ht_buflen;
+  pending = pstate->ht_buflen > 0;
+  pstate->ht_buflen = 0;
+#endif
+
   do
     {
       char *start;
@@ -528,6 +626,11 @@ static inline int httpd_parse(struct httpd_state *pstate)
           return 413;
         }
 
+      if (pending)
+        {
+          pending = false;
+        }
+      else
         {
           ssize_t r;
 
@@ -562,8 +665,13 @@ static inline int httpd_parse(struct httpd_state *pstate)
        * with each in turn.
        */
 
+      /* Stop at the end of the header, anything after it belongs to the
+       * next, pipelined, request.
+       */
+
       for (start = pstate->ht_buffer;
-           (end = memchr(start, '\r', o - start)), end != NULL;
+           state != STATE_BODY &&
+           (end = memchr(start, '\r', o - start)) != NULL;
            start = end)
         {
           *end = '\0';
@@ -601,6 +709,15 @@ static inline int httpd_parse(struct httpd_state *pstate)
                 return 505;
               }
 
+            /* HTTP/1.1 connections are persistent unless the client asks
+             * otherwise
+             */
+
+            pstate->ht_http11 = strcmp(v, " HTTP/1.1") == 0;
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+            pstate->ht_keepalive = pstate->ht_http11;
+#endif
+
             /* TODO: url decoding */
 
             if (v - start >= sizeof pstate->ht_filename)
@@ -643,10 +760,28 @@ static inline int httpd_parse(struct httpd_state *pstate)
                 return 413;
               }
 #ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
-            else if (0 == strcasecmp(start, "Connection") &&
-                     0 == strcasecmp(v, "keep-alive"))
+            else if (0 == strcasecmp(start, "Connection"))
               {
-                pstate->ht_keepalive = true;
+                if (0 == strcasecmp(v, "keep-alive"))
+                  {
+                    pstate->ht_keepalive = true;
+                  }
+                else if (0 == strcasecmp(v, "close"))
+                  {
+                    pstate->ht_keepalive = false;
+                  }
+              }
+#endif
+#ifdef CONFIG_NETUTILS_HTTPD_CACHE
+            else if (0 == strcasecmp(start, "Accept-Encoding"))
+              {
+                pstate->ht_gzip = strstr(v, "gzip") != NULL;
+              }
+            else if (0 == strcasecmp(start, "If-None-Match") &&
+                     strlen(v) < sizeof(pstate->ht_ifnonematch))
+              {
+                strlcpy(pstate->ht_ifnonematch, v,
+                        sizeof(pstate->ht_ifnonematch));
               }
 #endif
             break;
@@ -666,6 +801,10 @@ static inline int httpd_parse(struct httpd_state *pstate)
     }
   while (state != STATE_BODY);
 
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+  pstate->ht_buflen = o - pstate->ht_buffer;
+#endif
+
 #ifdef CONFIG_NETUTILS_HTTPD_CLASSIC
   if (0 == strcmp(pstate->ht_filename, "/"))
     {
@@ -679,56 +818,129 @@ static inline int httpd_parse(struct httpd_state *pstate)
   return 200;
 }
 
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
 /****************************************************************************
- * Name: httpd_handler
+ * Name: httpd_idle_wait
  *
  * Description:
- *   Each time a new connection to port 80 is made, a new thread is created
- *   that begins at this entry point.  There should be exactly one argument
- *   and it should be the socket descriptor (+1).
+ *   Wait up to the keep-alive timeout for the next request on a persistent
+ *   connection.  Returns false if the connection should be closed.
  *
  ****************************************************************************/
 
-static void *httpd_handler(void *arg)
+static bool httpd_idle_wait(FAR struct httpd_state *pstate)
 {
-  struct httpd_state *pstate =
-    (struct httpd_state *)malloc(sizeof(struct httpd_state));
-  int sockfd = (intptr_t)arg;
+  struct pollfd fds;
 
-  ninfo("[%d] Started\n", sockfd);
+  if (pstate->ht_buflen > 0)
+    {
+      return true;
+    }
 
-  /* Verify that the state structure was successfully allocated */
+  fds.fd      = pstate->ht_sockfd;
+  fds.events  = POLLIN;
+  fds.revents = 0;
 
-  if (pstate)
+  if (poll(&fds, 1, CONFIG_NETUTILS_HTTPD_KEEPALIVE_TIMEOUT * 1000) <= 0)
     {
-      int status;
+      ninfo("[%d] keep-alive timeout\n", pstate->ht_sockfd);
+      return false;
+    }
 
-      /* Re-initialize the thread state structure */
+  return true;
+}
+#endif
 
-      memset(pstate, 0, sizeof(struct httpd_state));
-      pstate->ht_sockfd = sockfd;
+/****************************************************************************
+ * Name: httpd_serve
+ *
+ * Description:
+ *   Serve all requests of one connection using the given state structure.
+ *
+ ****************************************************************************/
 
+static void httpd_serve(FAR struct httpd_state *pstate, int sockfd)
+{
+  int status;
 #ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
-      do
+  int nrequests = 0;
+#endif
+
+  /* Re-initialize the thread state structure */
+
+  memset(pstate, 0, sizeof(struct httpd_state));
+  pstate->ht_sockfd = sockfd;
+
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+  do
+    {
+      pstate->ht_keepalive = false;
+#if defined(CONFIG_NETUTILS_HTTPD_ENABLE_CHUNKED_ENCODING)
+      pstate->ht_chunked = false;
+#endif
+
+      /* Wait for the next request, unless it is already pipelined */
+
+      if (nrequests > 0 && !httpd_idle_wait(pstate))
         {
-          pstate->ht_keepalive = false;
+          break;
+        }
 #endif
-          /* Then handle the next httpd command */
+      /* Then handle the next httpd command */
 
-          status = httpd_parse(pstate);
-          if (status >= 400)
-            {
-              httpd_senderror(pstate, status);
-            }
-          else
-            {
-              httpd_sendfile(pstate);
-            }
+      status = httpd_parse(pstate);
 
 #ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+      /* A malformed request leaves the stream out of step, close after
+       * the error reply.
+       */
+
+      if (++nrequests >= CONFIG_NETUTILS_HTTPD_KEEPALIVE_MAX ||
+          status < 0 || status >= 400)
+        {
+          pstate->ht_keepalive = false;
+        }
+#endif
+
+      if (status >= 400)
+        {
+          httpd_senderror(pstate, status);
+        }
+      else if (status >= 0)
+        {
+          httpd_sendfile(pstate);
         }
-      while (pstate->ht_keepalive);
+
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+    }
+  while (pstate->ht_keepalive);
 #endif
+}
+
+#ifndef CONFIG_NETUTILS_HTTPD_POOL
+/****************************************************************************
+ * Name: httpd_handler
+ *
+ * Description:
+ *   Each time a new connection to port 80 is made, a new thread is created
+ *   that begins at this entry point.  There should be exactly one argument
+ *   and it should be the socket descriptor (+1).
+ *
+ ****************************************************************************/
+
+static void *httpd_handler(void *arg)
+{
+  struct httpd_state *pstate =
+    (struct httpd_state *)malloc(sizeof(struct httpd_state));
+  int sockfd = (intptr_t)arg;
+
+  ninfo("[%d] Started\n", sockfd);
+
+  /* Verify that the state structure was successfully allocated */
+
+  if (pstate)
+    {
+      httpd_serve(pstate, sockfd);
 
       /* End of command processing -- Clean up and exit */
 
@@ -741,6 +953,42 @@ static void *httpd_handler(void *arg)
   close(sockfd);
   return NULL;
 }
+#endif
+
+#ifdef CONFIG_NETUTILS_HTTPD_POOL
+/****************************************************************************
+ * Name: httpd_pool_handler
+ *
+ * Description:
+ *   Serve a connection on a pool worker.  The state structure, with its
+ *   I/O buffer, belongs to the worker and is reused for each connection.
+ *
+ ****************************************************************************/
+
+static void httpd_pool_handler(int sockfd, FAR void *buffer)
+{
+#if CONFIG_NETUTILS_HTTPD_TIMEOUT > 0
+  struct timeval tv;
+
+  /* An idle client would otherwise hold a worker forever */
+
+  tv.tv_sec  = CONFIG_NETUTILS_HTTPD_TIMEOUT;
+  tv.tv_usec = 0;
+  if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv,
+                 sizeof(struct timeval)) < 0)
+    {
+      nerr("ERROR: setsockopt SO_RCVTIMEO failure: %d\n", errno);
+      close(sockfd);
+      return;
+    }
+#endif
+
+  ninfo("[%d] Started\n", sockfd);
+  httpd_serve((FAR struct httpd_state *)buffer, sockfd);
+  ninfo("[%d] Done\n", sockfd);
+  close(sockfd);
+}
+#endif
 
 #ifdef CONFIG_NETUTILS_HTTPD_SINGLECONNECT
 static void single_server(uint16_t portno, pthread_startroutine_t handler,
@@ -843,8 +1091,19 @@ int httpd_listen(void)
 {
   /* Execute httpd_handler on each connection to port 80 */
 
-#ifdef CONFIG_NETUTILS_HTTPD_SINGLECONNECT
+#if defined(CONFIG_NETUTILS_HTTPD_SINGLECONNECT)
   single_server(HTONS(80), httpd_handler, CONFIG_NETUTILS_HTTPDSTACKSIZE);
+#elif defined(CONFIG_NETUTILS_HTTPD_POOL)
+  static const struct netlib_server_pool_s pool =
+  {
+    httpd_pool_handler,
+    sizeof(struct httpd_state),
+    CONFIG_NETUTILS_HTTPD_POOL_WORKERS,
+    CONFIG_NETUTILS_HTTPD_POOL_STACKSIZE,
+    CONFIG_NETUTILS_HTTPD_POOL_QUEUE
+  };
+
+  netlib_server_pool(HTONS(80), &pool);
 #else
   netlib_server(HTONS(80), httpd_handler, CONFIG_NETUTILS_HTTPDSTACKSIZE);
 #endif
@@ -909,20 +1168,16 @@ int httpd_send_datachunk(int sockfd, void *data, int len, bool chunked)
 }
 
 /****************************************************************************
- * Name: httpd_send_headers
+ * Name: httpd_mimetype
+ *
+ * Description:
+ *   Return the content type of a file, based on its extension.
+ *
  ****************************************************************************/
 
-int httpd_send_headers(struct httpd_state *pstate, int status, int len)
+FAR const char *httpd_mimetype(FAR const char *filename)
 {
-  const char *mime;
   const char *ptr;
-  char contentlen[HTTPD_MAX_CONTENTLEN] =
-    {
-      0
-    };
-
-  char header[HTTPD_MAX_HEADERLEN];
-  int hdrlen;
   int i;
 
   static const struct
@@ -980,25 +1235,40 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
     },
     };
 
-  ptr = strrchr(pstate->ht_filename, ISO_PERIOD);
+  ptr = strrchr(filename, ISO_PERIOD);
   if (ptr == NULL)
     {
-      mime = "application/octet-stream";
+      return "application/octet-stream";
     }
-  else
-    {
-      mime = "text/plain";
 
-      for (i = 0; i < nitems(a); i++)
+  for (i = 0; i < nitems(a); i++)
+    {
+      if (strncmp(a[i].ext, ptr + 1, strlen(a[i].ext)) == 0)
         {
-          if (strncmp(a[i].ext, ptr + 1, strlen(a[i].ext)) == 0)
-            {
-              mime = a[i].mime;
-              break;
-            }
+          return a[i].mime;
         }
     }
 
+  return "text/plain";
+}
+
+/****************************************************************************
+ * Name: httpd_send_headers
+ ****************************************************************************/
+
+int httpd_send_headers(struct httpd_state *pstate, int status, int len)
+{
+  const char *mime;
+  char contentlen[HTTPD_MAX_CONTENTLEN] =
+    {
+      0
+    };
+
+  char header[HTTPD_MAX_HEADERLEN];
+  int hdrlen;
+
+  mime = httpd_mimetype(pstate->ht_filename);
+
 #ifdef CONFIG_NETUTILS_HTTPD_DIRLIST
   if (false == httpd_is_file(pstate->ht_filename))
     {
@@ -1015,10 +1285,19 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
     }
   else
     {
-#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
-      /* Length unknown ahead of time */
+#if !defined(CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE)
+      /* Length unknown ahead of time.  Only the chunked encoding, which
+       * HTTP/1.0 clients do not know, tells where the body ends.  The
+       * directory listing is never chunked.
+       */
 
-      pstate->ht_keepalive = false;
+#  if defined(CONFIG_NETUTILS_HTTPD_ENABLE_CHUNKED_ENCODING) && \
+      !defined(CONFIG_NETUTILS_HTTPD_DIRLIST)
+      if (!pstate->ht_http11)
+#  endif
+        {
+          pstate->ht_keepalive = false;
+        }
 #endif
 #if defined(CONFIG_NETUTILS_HTTPD_ENABLE_CHUNKED_ENCODING)
       /* Turn on chunked encoding */
@@ -1041,7 +1320,7 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
    */
 
   hdrlen = snprintf(header, HTTPD_MAX_HEADERLEN,
-                    "HTTP/1.0 %d %s\r\n"
+                    "HTTP/1.%d %d %s\r\n"
 #ifndef CONFIG_NETUTILS_HTTPD_SERVERHEADER_DISABLE
                     "Server: uIP/NuttX http://nuttx.org/\r\n"
 #endif
@@ -1049,6 +1328,7 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
                     "Content-type: %s\r\n"
                     "%s"
                     "\r\n",
+                    pstate->ht_http11 ? 1 : 0,
                     status,
                     status >= 400 ? "Error" : "OK",
 #ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
@@ -45,13 +45,42 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 #include <nuttx/net/netconfig.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HTTPD_CACHE_ETAGLEN    24
+#define HTTPD_CACHE_HEADERLEN  160
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+#ifdef CONFIG_NETUTILS_HTTPD_CACHE
+/* A file held in memory with the entity headers of its responses */
+
+struct httpd_cache_entry_s
+{
+  FAR char *name;                          /* Requested name, NULL if free */
+  FAR char *data;                          /* File contents */
+  int       len;
+  int       refs;                          /* Responses sending it */
+  uint32_t  lastuse;                       /* LRU clock */
+  time_t    checked;                       /* Last compared with the file */
+  time_t    mtime;
+  bool      gzip;                          /* Requested by a gzip client */
+  bool      encoded;                       /* Data is the .gz variant */
+  bool      isdir;                         /* Name is a directory */
+  char      etag[HTTPD_CACHE_ETAGLEN];
+  char      headers[HTTPD_CACHE_HEADERLEN];
+};
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -76,4 +105,19 @@ void httpd_fs_init(void);
 
 #endif
 
+FAR const char *httpd_mimetype(FAR const char *filename);
+
+#ifdef CONFIG_NETUTILS_HTTPD_CACHE
+
+/* Returns the entry with a reference held, or NULL with errno set if the
+ * file is not cached and cannot be.  The reference is dropped with
+ * httpd_cache_put().
+ */
+
+FAR struct httpd_cache_entry_s *httpd_cache_get(FAR const char *name,
+                                                bool gzip);
+void httpd_cache_put(FAR struct httpd_cache_entry_s *entry);
+
+#endif
+
 #endif /* _NETUTILS_WEBSERVER_HTTPD_H */
@@ -0,0 +1,492 @@
+/****************************************************************************
+ * apps/netutils/webserver/httpd_cache.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <debug.h>
+
+#include <nuttx/crc32.h>
+
+#include "netutils/httpd.h"
+
+#include "httpd.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NETUTILS_HTTPD_CACHE_ENTRIES
+#  define CONFIG_NETUTILS_HTTPD_CACHE_ENTRIES 16
+#endif
+
+#ifndef CONFIG_NETUTILS_HTTPD_CACHE_SIZE
+#  define CONFIG_NETUTILS_HTTPD_CACHE_SIZE 65536
+#endif
+
+#ifndef CONFIG_NETUTILS_HTTPD_CACHE_MAXFILE
+#  define CONFIG_NETUTILS_HTTPD_CACHE_MAXFILE 16384
+#endif
+
+#ifndef CONFIG_NETUTILS_HTTPD_CACHE_TTL
+#  define CONFIG_NETUTILS_HTTPD_CACHE_TTL 2
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static pthread_mutex_t g_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct httpd_cache_entry_s
+  g_cache[CONFIG_NETUTILS_HTTPD_CACHE_ENTRIES];
+static size_t g_cache_used;     /* Bytes of file data held */
+static uint32_t g_cache_clock;  /* Bumped on every hit */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static time_t httpd_cache_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
+
+/****************************************************************************
+ * Name: httpd_cache_path
+ *
+ * Description:
+ *   Build the path of the file behind a requested name, the directory
+ *   index and the gzip variant included.
+ *
+ ****************************************************************************/
+
+static int httpd_cache_path(FAR char *path, FAR const char *name,
+                            bool isdir, bool encoded)
+{
+  size_t len = strlen(name);
+
+  if (len > 0 && name[len - 1] == '/')
+    {
+      len--;
+    }
+
+  if (snprintf(path, PATH_MAX, "%s%.*s%s%s",
+               CONFIG_NETUTILS_HTTPD_PATH, (int)len, name,
+#ifdef CONFIG_NETUTILS_HTTPD_INDEX
+               isdir ? "/" CONFIG_NETUTILS_HTTPD_INDEX : "",
+#else
+               "",
+#endif
+               encoded ? ".gz" : "") >= PATH_MAX)
+    {
+      errno = ENAMETOOLONG;
+      return ERROR;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: httpd_cache_free
+ ****************************************************************************/
+
+static void httpd_cache_free(FAR struct httpd_cache_entry_s *entry)
+{
+  g_cache_used -= entry->len;
+
+  free(entry->name);
+  free(entry->data);
+  entry->name = NULL;
+  entry->data = NULL;
+  entry->len  = 0;
+}
+
+/****************************************************************************
+ * Name: httpd_cache_evict
+ *
+ * Description:
+ *   Free least recently used entries until len more bytes fit, and return
+ *   an empty slot.  Entries still being sent are kept.
+ *
+ ****************************************************************************/
+
+static FAR struct httpd_cache_entry_s *httpd_cache_evict(size_t len)
+{
+  FAR struct httpd_cache_entry_s *victim;
+  FAR struct httpd_cache_entry_s *slot;
+  int i;
+
+  for (; ; )
+    {
+      victim = NULL;
+      slot   = NULL;
+
+      for (i = 0; i < CONFIG_NETUTILS_HTTPD_CACHE_ENTRIES; i++)
+        {
+          if (g_cache[i].name == NULL)
+            {
+              slot = &g_cache[i];
+            }
+          else if (g_cache[i].refs == 0 &&
+                   (victim == NULL ||
+                    (int32_t)(g_cache[i].lastuse - victim->lastuse) < 0))
+            {
+              victim = &g_cache[i];
+            }
+        }
+
+      if (slot != NULL &&
+          g_cache_used + len <= CONFIG_NETUTILS_HTTPD_CACHE_SIZE)
+        {
+          return slot;
+        }
+
+      if (victim == NULL)
+        {
+          return NULL;
+        }
+
+      ninfo("Evicting %s\n", victim->name);
+      httpd_cache_free(victim);
+    }
+}
+
+/****************************************************************************
+ * Name: httpd_cache_find
+ ****************************************************************************/
+
+static FAR struct httpd_cache_entry_s *httpd_cache_find(FAR const char *name,
+                                                        bool gzip)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_NETUTILS_HTTPD_CACHE_ENTRIES; i++)
+    {
+      if (g_cache[i].name != NULL && g_cache[i].gzip == gzip &&
+          strcmp(g_cache[i].name, name) == 0)
+        {
+          return &g_cache[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: httpd_cache_load
+ *
+ * Description:
+ *   Read a file and prepare the headers of its responses into an entry
+ *   that is not in the cache yet.  Called without g_cache_lock held, so
+ *   that a slow file system does not stall the other workers.
+ *
+ ****************************************************************************/
+
+static int httpd_cache_load(FAR struct httpd_cache_entry_s *entry,
+                            FAR const char *name, bool gzip)
+{
+  FAR const char *mime;
+  FAR const char *ext;
+  char path[PATH_MAX];
+  struct stat st;
+  bool isdir = false;
+  bool encoded = false;
+  ssize_t n;
+  int done;
+  int fd;
+
+  if (httpd_cache_path(path, name, false, false) < 0 ||
+      stat(path, &st) < 0)
+    {
+      return ERROR;
+    }
+
+  if (S_ISDIR(st.st_mode))
+    {
+#ifdef CONFIG_NETUTILS_HTTPD_INDEX
+      isdir = true;
+      if (httpd_cache_path(path, name, true, false) < 0 ||
+          stat(path, &st) < 0)
+        {
+          return ERROR;
+        }
+#else
+      errno = EISDIR;
+      return ERROR;
+#endif
+    }
+
+  if (!S_ISREG(st.st_mode))
+    {
+      errno = ENOENT;
+      return ERROR;
+    }
+
+  /* Scripts are expanded on every request */
+
+  ext = strrchr(path, '.');
+  if (ext != NULL && strcmp(ext, ".shtml") == 0)
+    {
+      errno = ENOTSUP;
+      return ERROR;
+    }
+
+  mime = httpd_mimetype(path);
+
+  /* Prefer the precompressed variant, if there is one */
+
+  if (gzip)
+    {
+      char gzpath[PATH_MAX];
+      struct stat gzst;
+
+      if (httpd_cache_path(gzpath, name, isdir, true) == OK &&
+          stat(gzpath, &gzst) == 0 && S_ISREG(gzst.st_mode))
+        {
+          strlcpy(path, gzpath, sizeof(path));
+          st      = gzst;
+          encoded = true;
+        }
+    }
+
+  if (st.st_size > CONFIG_NETUTILS_HTTPD_CACHE_MAXFILE)
+    {
+      errno = EFBIG;
+      return ERROR;
+    }
+
+  memset(entry, 0, sizeof(*entry));
+  entry->name = strdup(name);
+  entry->data = malloc(st.st_size > 0 ? st.st_size : 1);
+  if (entry->name == NULL || entry->data == NULL)
+    {
+      goto errout;
+    }
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    {
+      goto errout;
+    }
+
+  for (done = 0; done < st.st_size; done += n)
+    {
+      n = read(fd, entry->data + done, st.st_size - done);
+      if (n <= 0)
+        {
+          close(fd);
+          errno = n < 0 ? errno : EIO;
+          goto errout;
+        }
+    }
+
+  close(fd);
+
+  entry->len     = st.st_size;
+  entry->refs    = 0;
+  entry->checked = httpd_cache_now();
+  entry->mtime   = st.st_mtime;
+  entry->gzip    = gzip;
+  entry->encoded = encoded;
+  entry->isdir   = isdir;
+
+  /* The CRC of the contents is a cheap strong validator */
+
+  snprintf(entry->etag, sizeof(entry->etag), "\"%08" PRIx32 "-%x\"",
+           crc32((FAR const uint8_t *)entry->data, entry->len),
+           entry->len);
+  snprintf(entry->headers, sizeof(entry->headers),
+           "Content-type: %s\r\n"
+           "Content-Length: %d\r\n"
+           "%s"
+           "ETag: %s\r\n",
+           mime, entry->len,
+           encoded ? "Content-Encoding: gzip\r\n"
+                     "Vary: Accept-Encoding\r\n" : "",
+           entry->etag);
+
+  ninfo("Loaded %s (%s, %d bytes)\n", name, path, entry->len);
+  return OK;
+
+errout:
+  free(entry->name);
+  free(entry->data);
+  entry->name = NULL;
+  entry->data = NULL;
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: httpd_cache_changed
+ *
+ * Description:
+ *   Check whether the file behind an entry changed since it was read.
+ *   Called without g_cache_lock held, with a reference on the entry that
+ *   keeps its name and file attributes from changing.
+ *
+ ****************************************************************************/
+
+static bool httpd_cache_changed(FAR struct httpd_cache_entry_s *entry)
+{
+  char path[PATH_MAX];
+  struct stat st;
+
+  return httpd_cache_path(path, entry->name, entry->isdir,
+                          entry->encoded) < 0 ||
+         stat(path, &st) < 0 || st.st_mtime != entry->mtime ||
+         st.st_size != entry->len;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: httpd_cache_get
+ ****************************************************************************/
+
+FAR struct httpd_cache_entry_s *httpd_cache_get(FAR const char *name,
+                                                bool gzip)
+{
+  FAR struct httpd_cache_entry_s *entry;
+  struct httpd_cache_entry_s loaded;
+  time_t now;
+
+  /* A hit only takes the lock for the lookup.  The reference keeps the
+   * entry while it is checked against the file or sent.
+   */
+
+  pthread_mutex_lock(&g_cache_lock);
+
+  now   = httpd_cache_now();
+  entry = httpd_cache_find(name, gzip);
+  if (entry != NULL)
+    {
+      entry->lastuse = ++g_cache_clock;
+      entry->refs++;
+
+      if (now - entry->checked < CONFIG_NETUTILS_HTTPD_CACHE_TTL)
+        {
+          pthread_mutex_unlock(&g_cache_lock);
+          return entry;
+        }
+    }
+
+  pthread_mutex_unlock(&g_cache_lock);
+
+  /* Every CONFIG_NETUTILS_HTTPD_CACHE_TTL seconds check that the file did
+   * not change since it was read.
+   */
+
+  if (entry != NULL)
+    {
+      bool changed = httpd_cache_changed(entry);
+
+      pthread_mutex_lock(&g_cache_lock);
+      if (!changed)
+        {
+          entry->checked = now;
+          pthread_mutex_unlock(&g_cache_lock);
+          return entry;
+        }
+
+      /* Changed on disk.  If it is still being sent, leave it to the
+       * other response and serve this one from the file.
+       */
+
+      if (--entry->refs > 0)
+        {
+          pthread_mutex_unlock(&g_cache_lock);
+          errno = EBUSY;
+          return NULL;
+        }
+
+      httpd_cache_free(entry);
+      pthread_mutex_unlock(&g_cache_lock);
+    }
+
+  if (httpd_cache_load(&loaded, name, gzip) < 0)
+    {
+      return NULL;
+    }
+
+  /* Another worker may have cached the same file meanwhile */
+
+  pthread_mutex_lock(&g_cache_lock);
+
+  entry = httpd_cache_find(name, gzip);
+  if (entry != NULL)
+    {
+      free(loaded.name);
+      free(loaded.data);
+    }
+  else
+    {
+      entry = httpd_cache_evict(loaded.len);
+      if (entry == NULL)
+        {
+          pthread_mutex_unlock(&g_cache_lock);
+          free(loaded.name);
+          free(loaded.data);
+          errno = ENOSPC;
+          return NULL;
+        }
+
+      *entry = loaded;
+      g_cache_used += entry->len;
+      ninfo("Cached %s (%d bytes)\n", name, entry->len);
+    }
+
+  entry->lastuse = ++g_cache_clock;
+  entry->refs++;
+
+  pthread_mutex_unlock(&g_cache_lock);
+  return entry;
+}
+
+/****************************************************************************
+ * Name: httpd_cache_put
+ ****************************************************************************/
+
+void httpd_cache_put(FAR struct httpd_cache_entry_s *entry)
+{
+  pthread_mutex_lock(&g_cache_lock);
+  entry->refs--;
+  pthread_mutex_unlock(&g_cache_lock);
+}
@@ -39,6 +39,7 @@
 #include <sys/ioctl.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <nuttx/audio/audio.h>
@@ -57,6 +58,39 @@
 #define AUDIO_APB_RECORD         (1 << 4)
 #define AUDIO_APB_PLAY           (1 << 5)
 
+#ifndef CONFIG_NXLOOPER_PERIOD_BYTES
+#  define CONFIG_NXLOOPER_PERIOD_BYTES 0
+#endif
+
+#ifndef CONFIG_NXLOOPER_PERIOD_COUNT
+#  define CONFIG_NXLOOPER_PERIOD_COUNT 0
+#endif
+
+/* Latency test: a short full-channel pulse every NXLOOPER_IMPULSE_INTERVAL
+ * us.  It is detected when any returning sample crosses the threshold,
+ * about 18 dB below the pulse, and given up on after the timeout.
+ */
+
+#define NXLOOPER_IMPULSE_LEVEL     16000
+#define NXLOOPER_IMPULSE_THRESHOLD 2000
+#define NXLOOPER_IMPULSE_FRAMES    8
+#define NXLOOPER_IMPULSE_INTERVAL  500000
+#define NXLOOPER_IMPULSE_TIMEOUT   1000000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+/* Latency test state of the loopthread, times in us */
+
+struct nxlooper_impulse_s
+{
+  uint64_t sent;        /* Capture time of the pending impulse, 0 if none */
+  uint64_t next;        /* When to send the next one */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -306,6 +340,185 @@ static int nxlooper_enqueueplaybuffer(FAR struct nxlooper_s *plooper,
   return OK;
 }
 
+/****************************************************************************
+ * Name: nxlooper_getbufferinfo
+ *
+ *   Returns the buffer size and count to use with a device: the period
+ *   settings if given, else what the driver prefers.
+ *
+ ****************************************************************************/
+
+static void nxlooper_getbufferinfo(FAR struct nxlooper_s *plooper, int fd,
+                                   FAR struct ap_buffer_info_s *info)
+{
+#if defined(CONFIG_NXLOOPER_LOWLATENCY) && defined(AUDIOIOC_SETBUFFERINFO)
+  /* Let the driver size its own queues to match, where supported */
+
+  if (plooper->period_bytes != 0 && plooper->nperiods != 0)
+    {
+      info->buffer_size = plooper->period_bytes;
+      info->nbuffers    = plooper->nperiods;
+      ioctl(fd, AUDIOIOC_SETBUFFERINFO, (unsigned long)info);
+    }
+#endif
+
+  if (ioctl(fd, AUDIOIOC_GETBUFFERINFO, (unsigned long)info) != OK)
+    {
+      /* Driver doesn't report its buffer size.  Use our default. */
+
+      info->buffer_size = CONFIG_AUDIO_BUFFER_NUMBYTES;
+      info->nbuffers    = CONFIG_AUDIO_NUM_BUFFERS;
+    }
+
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  if (plooper->period_bytes != 0)
+    {
+      info->buffer_size = plooper->period_bytes;
+    }
+
+  if (plooper->nperiods != 0)
+    {
+      info->nbuffers = plooper->nperiods;
+    }
+
+  /* Forwarded buffers alternate between the devices, one would leave
+   * each of them idle half of the time.
+   */
+
+  if (plooper->passthrough && info->nbuffers < 2)
+    {
+      info->nbuffers = 2;
+    }
+#endif
+}
+
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+/****************************************************************************
+ * Name: nxlooper_time
+ *
+ *   Returns the monotonic time in us.
+ *
+ ****************************************************************************/
+
+static uint64_t nxlooper_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: nxlooper_impulse
+ *
+ *   Runs the latency test on a buffer just dequeued from the record
+ *   device, before it is looped back.  The buffer is searched for the
+ *   return of the pending impulse, then replaced by silence that carries
+ *   the next impulse when one is due.
+ *
+ *   Times are capture times of frames: a buffer is dequeued when its last
+ *   frame has been captured, so frame n of N was captured (N - n) frames
+ *   earlier.  The round trip thus covers the playback queue, the output
+ *   and input paths, and one period of capture, like live audio does.
+ *
+ ****************************************************************************/
+
+static void nxlooper_impulse(FAR struct nxlooper_s *plooper,
+                             FAR struct nxlooper_impulse_s *imp,
+                             FAR struct ap_buffer_s *apb)
+{
+  FAR int16_t *samp = (FAR int16_t *)apb->samp;
+  uint32_t nsamples = apb->nbytes / sizeof(int16_t);
+  uint32_t nframes = nsamples / plooper->nchannels;
+  uint64_t now = nxlooper_time();
+  uint64_t captured;
+  uint32_t latency;
+  uint32_t i;
+
+  if (!plooper->latencytest || nframes == 0)
+    {
+      return;
+    }
+
+  if (imp->sent != 0)
+    {
+      for (i = 0; i < nsamples; i++)
+        {
+          if (samp[i] >= NXLOOPER_IMPULSE_THRESHOLD ||
+              samp[i] <= -NXLOOPER_IMPULSE_THRESHOLD)
+            {
+              break;
+            }
+        }
+
+      if (i < nsamples)
+        {
+          captured = now - (uint64_t)(nframes - i / plooper->nchannels) *
+                           1000000 / plooper->samprate;
+          latency  = captured > imp->sent ? captured - imp->sent : 0;
+
+          pthread_mutex_lock(&plooper->mutex);
+          plooper->latency.last = latency;
+          plooper->latency.min  = MIN(plooper->latency.min, latency);
+          plooper->latency.max  = MAX(plooper->latency.max, latency);
+          plooper->latency.total += latency;
+          plooper->latency.nmeasured++;
+          pthread_mutex_unlock(&plooper->mutex);
+
+          imp->sent = 0;
+          imp->next = now + NXLOOPER_IMPULSE_INTERVAL;
+        }
+      else if (now - imp->sent > NXLOOPER_IMPULSE_TIMEOUT)
+        {
+          pthread_mutex_lock(&plooper->mutex);
+          plooper->latency.nmissed++;
+          pthread_mutex_unlock(&plooper->mutex);
+
+          imp->sent = 0;
+          imp->next = now;
+        }
+    }
+
+  /* Never loop the input back: with the output wired to it, it would
+   * ring and hide the next impulse.
+   */
+
+  memset(apb->samp, 0, apb->nbytes);
+
+  if (imp->sent == 0 && now >= imp->next)
+    {
+      for (i = 0; i < MIN(NXLOOPER_IMPULSE_FRAMES, nframes) *
+                      plooper->nchannels; i++)
+        {
+          samp[i] = NXLOOPER_IMPULSE_LEVEL;
+        }
+
+      imp->sent = now - (uint64_t)nframes * 1000000 / plooper->samprate;
+    }
+}
+
+/****************************************************************************
+ * Name: nxlooper_forwardbuffer
+ *
+ *   Passthrough: a recorded buffer is enqueued as is on the playback
+ *   device, and a played one goes back to the record device.
+ *
+ ****************************************************************************/
+
+static int nxlooper_forwardbuffer(FAR struct nxlooper_s *plooper,
+                                  FAR struct nxlooper_impulse_s *imp,
+                                  FAR struct ap_buffer_s *apb)
+{
+  if ((apb->flags & AUDIO_APB_RECORD) != 0 && apb->nbytes != 0)
+    {
+      nxlooper_impulse(plooper, imp, apb);
+      return nxlooper_enqueueplaybuffer(plooper, apb);
+    }
+
+  return nxlooper_enqueuerecordbuffer(plooper, apb);
+}
+#endif /* CONFIG_NXLOOPER_LOWLATENCY */
+
 /****************************************************************************
  * Name: nxlooper_jointhread
  ****************************************************************************/
@@ -362,21 +575,22 @@ static void *nxlooper_loopthread(pthread_addr_t pvarg)
   bool                    streaming = true;
   int                     x;
   int                     ret;
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  struct nxlooper_impulse_s impulse;
+#endif
 
   audinfo("Entry\n");
   dq_init(&playdq);
   dq_init(&recorddq);
 
-  /* Query the audio device for it's preferred buffer size / qty */
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  impulse.sent = 0;
+  impulse.next = 0;
+#endif
 
-  if ((ret = ioctl(plooper->recorddev_fd, AUDIOIOC_GETBUFFERINFO,
-                   (unsigned long)&recordbuf_info)) != OK)
-    {
-      /* Driver doesn't report it's buffer size.  Use our default. */
+  /* Query the audio device for it's preferred buffer size / qty */
 
-      recordbuf_info.buffer_size = CONFIG_AUDIO_BUFFER_NUMBYTES;
-      recordbuf_info.nbuffers = CONFIG_AUDIO_NUM_BUFFERS;
-    }
+  nxlooper_getbufferinfo(plooper, plooper->recorddev_fd, &recordbuf_info);
 
   /* Create array of pointers to buffers */
 
@@ -426,14 +640,16 @@ static void *nxlooper_loopthread(pthread_addr_t pvarg)
         }
     }
 
-  if ((ret = ioctl(plooper->playdev_fd, AUDIOIOC_GETBUFFERINFO,
-                   (unsigned long)&playbuf_info)) != OK)
-    {
-      /* Driver doesn't report it's buffer size.  Use our default. */
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  /* With passthrough the record buffers are all we need */
 
-      playbuf_info.buffer_size = CONFIG_AUDIO_BUFFER_NUMBYTES;
-      playbuf_info.nbuffers = CONFIG_AUDIO_NUM_BUFFERS;
+  if (plooper->passthrough)
+    {
+      goto start;
     }
+#endif
+
+  nxlooper_getbufferinfo(plooper, plooper->playdev_fd, &playbuf_info);
 
   playbufs = (FAR struct ap_buffer_s **)
     calloc(playbuf_info.nbuffers, sizeof(FAR void *));
@@ -473,6 +689,9 @@ static void *nxlooper_loopthread(pthread_addr_t pvarg)
 
   /* Start the audio device */
 
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+start:
+#endif
 #ifdef CONFIG_AUDIO_MULTI_SESSION
   ret = ioctl(plooper->recorddev_fd, AUDIOIOC_START,
               (unsigned long)plooper->precordses);
@@ -531,12 +750,24 @@ static void *nxlooper_loopthread(pthread_addr_t pvarg)
 
             apb = msg.u.ptr;
             apb->curbyte = 0;
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+            if (plooper->passthrough)
+              {
+                /* Leaves both queues empty, so nothing is copied below */
+
+                ret = nxlooper_forwardbuffer(plooper, &impulse, apb);
+              }
+            else
+#endif
             if (apb->flags & AUDIO_APB_PLAY)
               {
                 dq_addlast(&apb->dq_entry, &playdq);
               }
             else if (apb->flags & AUDIO_APB_RECORD)
               {
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+                nxlooper_impulse(plooper, &impulse, apb);
+#endif
                 dq_addlast(&apb->dq_entry, &recorddq);
               }
 
@@ -772,6 +1003,96 @@ int nxlooper_setvolume(FAR struct nxlooper_s *plooper, uint16_t volume)
 }
 #endif /* CONFIG_AUDIO_EXCLUDE_VOLUME */
 
+/****************************************************************************
+ * Name: nxlooper_setperiod
+ *
+ *   nxlooper_setperiod() sets the buffer size and count of the next
+ *   loopback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+int nxlooper_setperiod(FAR struct nxlooper_s *plooper, uint32_t nbytes,
+                       uint8_t nperiods)
+{
+  int ret = -EBUSY;
+
+  pthread_mutex_lock(&plooper->mutex);
+  if (plooper->loopstate == NXLOOPER_STATE_IDLE)
+    {
+      plooper->period_bytes = nbytes;
+      plooper->nperiods = nperiods;
+      ret = OK;
+    }
+
+  pthread_mutex_unlock(&plooper->mutex);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxlooper_setpassthrough
+ *
+ *   nxlooper_setpassthrough() selects whether the next loopback forwards
+ *   the recorded buffers instead of copying them.
+ *
+ ****************************************************************************/
+
+int nxlooper_setpassthrough(FAR struct nxlooper_s *plooper, bool enable)
+{
+  int ret = -EBUSY;
+
+  pthread_mutex_lock(&plooper->mutex);
+  if (plooper->loopstate == NXLOOPER_STATE_IDLE)
+    {
+      plooper->passthrough = enable;
+      ret = OK;
+    }
+
+  pthread_mutex_unlock(&plooper->mutex);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxlooper_setlatencytest
+ *
+ *   nxlooper_setlatencytest() enables the latency test for the next
+ *   loopback.
+ *
+ ****************************************************************************/
+
+int nxlooper_setlatencytest(FAR struct nxlooper_s *plooper, bool enable)
+{
+  int ret = -EBUSY;
+
+  pthread_mutex_lock(&plooper->mutex);
+  if (plooper->loopstate == NXLOOPER_STATE_IDLE)
+    {
+      plooper->latencytest = enable;
+      ret = OK;
+    }
+
+  pthread_mutex_unlock(&plooper->mutex);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxlooper_getlatency
+ *
+ *   nxlooper_getlatency() returns the latency test results.
+ *
+ ****************************************************************************/
+
+int nxlooper_getlatency(FAR struct nxlooper_s *plooper,
+                        FAR struct nxlooper_latency_s *latency)
+{
+  pthread_mutex_lock(&plooper->mutex);
+  *latency = plooper->latency;
+  pthread_mutex_unlock(&plooper->mutex);
+
+  return OK;
+}
+#endif /* CONFIG_NXLOOPER_LOWLATENCY */
+
 /****************************************************************************
  * Name: nxlooper_pause
  *
@@ -1004,6 +1325,25 @@ int nxlooper_loopback(FAR struct nxlooper_s *plooper, int format,
       return -EBUSY;
     }
 
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  /* Keep the format for the latency test, which handles 16 bit only */
+
+  plooper->nchannels = nchannels ? nchannels : 2;
+  plooper->bpsamp    = bpsamp ? bpsamp : 16;
+  plooper->samprate  = samprate ? samprate : 48000;
+
+  if (plooper->latencytest)
+    {
+      if (plooper->bpsamp != 16)
+        {
+          return -EINVAL;
+        }
+
+      memset(&plooper->latency, 0, sizeof(plooper->latency));
+      plooper->latency.min = UINT32_MAX;
+    }
+#endif
+
   audinfo("==============================\n");
   audinfo("loopback raw data\n");
   audinfo("==============================\n");
@@ -1104,17 +1444,13 @@ int nxlooper_loopback(FAR struct nxlooper_s *plooper, int format,
 
   /* Query the audio device for its preferred buffer size / qty */
 
-  if ((ioctl(plooper->playdev_fd, AUDIOIOC_GETBUFFERINFO,
-             (unsigned long)&buf_info)) != OK)
-    {
-      /* Driver doesn't report its buffer size.  Use our default. */
+  nxlooper_getbufferinfo(plooper, plooper->playdev_fd, &buf_info);
 
-      buf_info.nbuffers = CONFIG_AUDIO_NUM_BUFFERS;
-    }
-
-  /* Create a message queue for the loopthread */
+  /* Create a message queue for the loopthread.  Both devices return their
+   * buffers through it.
+   */
 
-  attr.mq_maxmsg  = buf_info.nbuffers + 8;
+  attr.mq_maxmsg  = 2 * buf_info.nbuffers + 8;
   attr.mq_msgsize = sizeof(struct audio_msg_s);
   attr.mq_curmsgs = 0;
   attr.mq_flags   = 0;
@@ -1240,6 +1576,14 @@ FAR struct nxlooper_s *nxlooper_create(void)
   plooper->volume = 400;
 #endif
 
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  plooper->period_bytes = CONFIG_NXLOOPER_PERIOD_BYTES;
+  plooper->nperiods = CONFIG_NXLOOPER_PERIOD_COUNT;
+  plooper->passthrough = false;
+  plooper->latencytest = false;
+  memset(&plooper->latency, 0, sizeof(plooper->latency));
+#endif
+
 #ifdef CONFIG_AUDIO_MULTI_SESSION
   plooper->pplayses = NULL;
   plooper->precordses = NULL;
@@ -26,6 +26,7 @@
 #include <nuttx/audio/audio.h>
 
 #include <sys/types.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -90,6 +91,13 @@ static int nxlooper_cmd_stop(FAR struct nxlooper_s *plooper, char *parg);
 static int nxlooper_cmd_volume(FAR struct nxlooper_s *plooper, char *parg);
 #endif
 
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+static int nxlooper_cmd_period(FAR struct nxlooper_s *plooper, char *parg);
+static int nxlooper_cmd_passthrough(FAR struct nxlooper_s *plooper,
+                                    char *parg);
+static int nxlooper_cmd_latency(FAR struct nxlooper_s *plooper, char *parg);
+#endif
+
 #ifdef CONFIG_NXLOOPER_INCLUDE_HELP
 static int nxlooper_cmd_help(FAR struct nxlooper_s *plooper, char *parg);
 #endif
@@ -121,6 +129,14 @@ static const struct mp_cmd_s g_nxlooper_cmds[] =
     nxlooper_cmd_help,
     NXLOOPER_HELP_TEXT("Display help for commands")
   },
+#endif
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  {
+    "latency",
+    "[on|off]",
+    nxlooper_cmd_latency,
+    NXLOOPER_HELP_TEXT("Round-trip latency test / show results")
+  },
 #endif
   {
     "loopback",
@@ -128,6 +144,14 @@ static const struct mp_cmd_s g_nxlooper_cmds[] =
     nxlooper_cmd_loopback,
     NXLOOPER_HELP_TEXT("Audio loopback test")
   },
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  {
+    "passthrough",
+    "on|off",
+    nxlooper_cmd_passthrough,
+    NXLOOPER_HELP_TEXT("Forward recorded buffers without copying")
+  },
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
   {
     "pause",
@@ -136,6 +160,14 @@ static const struct mp_cmd_s g_nxlooper_cmds[] =
     NXLOOPER_HELP_TEXT("Pause loopback")
   },
 #endif
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+  {
+    "period",
+    "[bytes count]",
+    nxlooper_cmd_period,
+    NXLOOPER_HELP_TEXT("Set buffer size and count, 0 for driver's")
+  },
+#endif
 #ifdef CONFIG_NXLOOPER_INCLUDE_SYSTEM_RESET
   {
     "reset",
@@ -278,6 +310,89 @@ static int nxlooper_cmd_volume(FAR struct nxlooper_s *plooper, char *parg)
 }
 #endif
 
+/****************************************************************************
+ * Name: nxlooper_cmd_period
+ *
+ *   nxlooper_cmd_period() sets or shows the buffer size and count.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXLOOPER_LOWLATENCY
+static int nxlooper_cmd_period(FAR struct nxlooper_s *plooper, char *parg)
+{
+  unsigned long nbytes;
+  unsigned int nperiods = 0;
+
+  if (parg == NULL || *parg == '\0')
+    {
+      printf("period: %" PRIu32 " bytes x %u%s\n", plooper->period_bytes,
+             plooper->nperiods,
+             plooper->passthrough ? ", passthrough" : "");
+      return OK;
+    }
+
+  if (sscanf(parg, "%lu %u", &nbytes, &nperiods) < 1 || nperiods > 255)
+    {
+      printf("period: bytes count\n");
+      return -EINVAL;
+    }
+
+  return nxlooper_setperiod(plooper, nbytes, nperiods);
+}
+
+/****************************************************************************
+ * Name: nxlooper_cmd_passthrough
+ *
+ *   nxlooper_cmd_passthrough() enables or disables buffer forwarding.
+ *
+ ****************************************************************************/
+
+static int nxlooper_cmd_passthrough(FAR struct nxlooper_s *plooper,
+                                    char *parg)
+{
+  if (parg == NULL || *parg == '\0')
+    {
+      printf("passthrough: %s\n", plooper->passthrough ? "on" : "off");
+      return OK;
+    }
+
+  return nxlooper_setpassthrough(plooper, strcmp(parg, "on") == 0);
+}
+
+/****************************************************************************
+ * Name: nxlooper_cmd_latency
+ *
+ *   nxlooper_cmd_latency() enables or disables the latency test, or shows
+ *   its results.
+ *
+ ****************************************************************************/
+
+static int nxlooper_cmd_latency(FAR struct nxlooper_s *plooper, char *parg)
+{
+  struct nxlooper_latency_s latency;
+
+  if (parg != NULL && *parg != '\0')
+    {
+      return nxlooper_setlatencytest(plooper, strcmp(parg, "on") == 0);
+    }
+
+  nxlooper_getlatency(plooper, &latency);
+  if (latency.nmeasured == 0)
+    {
+      printf("latency: no impulse returned (%" PRIu32 " missed)\n",
+             latency.nmissed);
+      return OK;
+    }
+
+  printf("latency: last %" PRIu32 " us, min %" PRIu32 " us, avg %" PRIu64
+         " us, max %" PRIu32 " us\n", latency.last, latency.min,
+         latency.total / latency.nmeasured, latency.max);
+  printf("         %" PRIu32 " measured, %" PRIu32 " missed\n",
+         latency.nmeasured, latency.nmissed);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxlooper_cmd_reset
  *
@@ -29,6 +29,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <sched.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -39,6 +40,7 @@
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/param.h>
+#include <time.h>
 #include <unistd.h>
 #ifdef CONFIG_NXPLAYER_HTTP_STREAMING_SUPPORT
 #  include <sys/time.h>
@@ -68,6 +70,19 @@
 #  define CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE    1500
 #endif
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+#  ifndef CONFIG_NXPLAYER_READAHEAD_NBUFFERS
+#    define CONFIG_NXPLAYER_READAHEAD_NBUFFERS    4
+#  endif
+#  ifndef CONFIG_NXPLAYER_READAHEAD_STACKSIZE
+#    define CONFIG_NXPLAYER_READAHEAD_STACKSIZE   2048
+#  endif
+
+/* Sent by the read-ahead thread when a dequeue found the ring empty */
+
+#  define NXPLAYER_MSG_READY    (AUDIO_MSG_USER + 0)
+#endif
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -81,6 +96,32 @@ struct nxplayer_ext_fmt_s
 };
 #endif
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+/* The read-ahead ring.  Every audio buffer is either queued in the device,
+ * free (waiting to be filled by the read-ahead thread) or filled (waiting
+ * to be enqueued by the playthread).
+ */
+
+struct nxplayer_readahead_s
+{
+  FAR struct nxplayer_s  *pplayer;
+  pthread_t              id;          /* Read-ahead thread */
+  pthread_mutex_t        lock;        /* Protects everything below */
+  pthread_cond_t         cond;        /* Signals free and filled buffers */
+  FAR struct ap_buffer_s **filled;    /* Filled buffers, oldest at head */
+  FAR struct ap_buffer_s **free;      /* Buffers to fill */
+  int                    nbuffers;    /* Capacity of filled and free */
+  int                    head;        /* Oldest filled buffer */
+  int                    nfilled;
+  int                    nfree;
+  int                    nwait;       /* Dequeues not yet refilled */
+  bool                   started;     /* Thread running, needs a join */
+  bool                   eof;         /* Final buffer read */
+  bool                   stop;        /* Thread asked to exit */
+  bool                   wakeup;      /* NXPLAYER_MSG_READY in flight */
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -562,7 +603,7 @@ int nxplayer_getsbcsubformat(int fd)
  ****************************************************************************/
 
 #ifdef CONFIG_NXPLAYER_FMT_FROM_EXT
-static inline int nxplayer_fmtfromextension(FAR struct nxplayer_s *pplayer,
+static inline int nxplayer_fmtfromextension(int fd,
                                             FAR const char *pfilename,
                                             FAR int *subfmt)
 {
@@ -592,7 +633,7 @@ static inline int nxplayer_fmtfromextension(FAR struct nxplayer_s *pplayer,
 
                   if (subfmt && g_known_ext[c].getsubformat)
                     {
-                      *subfmt = g_known_ext[c].getsubformat(pplayer->fd);
+                      *subfmt = g_known_ext[c].getsubformat(fd);
                     }
 
                   /* Return the format for this extension */
@@ -625,7 +666,7 @@ static inline int nxplayer_fmtfromextension(FAR struct nxplayer_s *pplayer,
  ****************************************************************************/
 
 #ifdef CONFIG_NXPLAYER_FMT_FROM_HEADER
-static int nxplayer_fmtfromheader(FAR struct nxplayer_s *pplayer)
+static int nxplayer_fmtfromheader(int fd, FAR int *subfmt)
 {
   return AUDIO_FMT_UNDEF;
 }
@@ -649,6 +690,277 @@ static int nxplayer_mediasearch(FAR struct nxplayer_s *pplayer,
 }
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_openfile
+ *
+ *   nxplayer_openfile() opens the specified media file, looking for it in
+ *   the mediadir too.  Returns the file descriptor or -ENOENT.
+ *
+ ****************************************************************************/
+
+static int nxplayer_openfile(FAR struct nxplayer_s *pplayer,
+                             FAR const char *pfilename)
+{
+#ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
+  char path[PATH_MAX];
+#endif
+  int  fd;
+
+#ifdef CONFIG_NXPLAYER_HTTP_STREAMING_SUPPORT
+  if ((fd = _open_with_http(pfilename)) >= 0)
+#else
+  if ((fd = open(pfilename, O_RDONLY)) >= 0)
+#endif
+    {
+      return fd;
+    }
+
+  /* File not found.  Test if its in the mediadir */
+
+#ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
+  snprintf(path, sizeof(path), "%s/%s", pplayer->mediadir, pfilename);
+
+  if ((fd = open(path, O_RDONLY)) >= 0)
+    {
+      return fd;
+    }
+
+#ifdef CONFIG_NXPLAYER_MEDIA_SEARCH
+  /* File not found in the media dir.  Do a search */
+
+  if (nxplayer_mediasearch(pplayer, pfilename, path, sizeof(path)) == OK &&
+      (fd = open(path, O_RDONLY)) >= 0)
+    {
+      return fd;
+    }
+
+  auderr("ERROR: Could not find file\n");
+#else
+  auderr("ERROR: Could not open %s or %s\n", pfilename, path);
+#endif /* CONFIG_NXPLAYER_MEDIA_SEARCH */
+
+#else   /* CONFIG_NXPLAYER_INCLUDE_MEDIADIR */
+
+  auderr("ERROR: Could not open %s\n", pfilename);
+#endif /* CONFIG_NXPLAYER_INCLUDE_MEDIADIR */
+
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Name: nxplayer_findops
+ *
+ *   nxplayer_findops() returns the parser for the specified format, or
+ *   NULL if there is none.
+ *
+ ****************************************************************************/
+
+static FAR const struct nxplayer_dec_ops_s *nxplayer_findops(int format)
+{
+  int c;
+
+  for (c = 0; c < nitems(g_dec_ops); c++)
+    {
+      if (g_dec_ops[c].format == format)
+        {
+          return &g_dec_ops[c];
+        }
+    }
+
+  return NULL;
+}
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+/****************************************************************************
+ * Name: nxplayer_prefetch
+ *
+ *   nxplayer_prefetch() opens the next file of the playlist and parses its
+ *   header, so that switching to it at the end of the current track costs
+ *   nothing more than the first read.  Files that cannot be opened or have
+ *   an unknown format are dropped from the playlist.
+ *
+ *   Called by whoever reads the media: the read-ahead thread or the
+ *   playthread.
+ *
+ ****************************************************************************/
+
+static void nxplayer_prefetch(FAR struct nxplayer_s *pplayer)
+{
+  FAR struct nxplayer_fmt_s *fmt = &pplayer->nextfmt;
+  FAR char *pfilename;
+  int subfmt;
+  int fd;
+
+  while (pplayer->nextfd < 0)
+    {
+      pthread_mutex_lock(&pplayer->mutex);
+      if (pplayer->plcount == 0)
+        {
+          pthread_mutex_unlock(&pplayer->mutex);
+          return;
+        }
+
+      pfilename = pplayer->playlist[pplayer->plhead];
+      pplayer->plhead = (pplayer->plhead + 1) %
+                        CONFIG_NXPLAYER_PLAYLIST_MAXTRACKS;
+      pplayer->plcount--;
+      pthread_mutex_unlock(&pplayer->mutex);
+
+      fd = nxplayer_openfile(pplayer, pfilename);
+      if (fd < 0)
+        {
+          free(pfilename);
+          continue;
+        }
+
+      memset(fmt, 0, sizeof(*fmt));
+      fmt->format = AUDIO_FMT_UNDEF;
+      subfmt      = AUDIO_FMT_UNDEF;
+
+#ifdef CONFIG_NXPLAYER_FMT_FROM_EXT
+      fmt->format = nxplayer_fmtfromextension(fd, pfilename, &subfmt);
+#endif
+#ifdef CONFIG_NXPLAYER_FMT_FROM_HEADER
+      if (fmt->format == AUDIO_FMT_UNDEF)
+        {
+          fmt->format = nxplayer_fmtfromheader(fd, &subfmt);
+        }
+#endif
+
+      /* The chmap is not in any header, keep the one of the playback */
+
+      fmt->chmap = pplayer->curfmt.chmap;
+
+      pplayer->nextops = nxplayer_findops(fmt->format);
+      if (pplayer->nextops == NULL ||
+          (pplayer->nextops->pre_parse != NULL &&
+           pplayer->nextops->pre_parse(fd, &fmt->samprate, &fmt->nchannels,
+                                       &fmt->bpsamp) < 0))
+        {
+          auderr("ERROR: Skipping %s, format %d\n", pfilename, fmt->format);
+          close(fd);
+          free(pfilename);
+          continue;
+        }
+
+      audinfo("Prefetched %s\n", pfilename);
+      free(pfilename);
+      pplayer->nextfd = fd;
+    }
+}
+
+/****************************************************************************
+ * Name: nxplayer_switchtrack
+ *
+ *   nxplayer_switchtrack() makes the prefetched track the one being read.
+ *   With gapless set, it only does so if the track can continue the
+ *   current stream as is.
+ *
+ * Returned Value:
+ *   OK if switched, -ENODATA if the playlist is empty or -EAGAIN if the
+ *   next track needs the device to be reconfigured first.
+ *
+ ****************************************************************************/
+
+static int nxplayer_switchtrack(FAR struct nxplayer_s *pplayer,
+                                bool gapless)
+{
+  FAR struct nxplayer_fmt_s *cur = &pplayer->curfmt;
+  FAR struct nxplayer_fmt_s *next = &pplayer->nextfmt;
+
+  nxplayer_prefetch(pplayer);
+  if (pplayer->nextfd < 0)
+    {
+      return -ENODATA;
+    }
+
+  if (gapless && (next->format != cur->format ||
+                  next->samprate != cur->samprate ||
+                  next->nchannels != cur->nchannels ||
+                  next->bpsamp != cur->bpsamp))
+    {
+      return -EAGAIN;
+    }
+
+  if (pplayer->fd >= 0)
+    {
+      close(pplayer->fd);
+    }
+
+  pplayer->fd     = pplayer->nextfd;
+  pplayer->ops    = pplayer->nextops;
+  pplayer->curfmt = *next;
+  pplayer->nextfd = -1;
+
+  if (gapless)
+    {
+      pplayer->plstat.ngapless++;
+    }
+  else
+    {
+      pplayer->plstat.nrestart++;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxplayer_configure
+ *
+ *   nxplayer_configure() configures the device for the format of the track
+ *   being read, if its header told us the format.
+ *
+ ****************************************************************************/
+
+static void nxplayer_configure(FAR struct nxplayer_s *pplayer)
+{
+  FAR struct nxplayer_fmt_s *fmt = &pplayer->curfmt;
+  struct audio_caps_desc_s cap_desc;
+
+  if (fmt->nchannels && fmt->samprate && fmt->bpsamp)
+    {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+      cap_desc.session = pplayer->session;
+#endif
+      cap_desc.caps.ac_len            = sizeof(struct audio_caps_s);
+      cap_desc.caps.ac_type           = AUDIO_TYPE_OUTPUT;
+      cap_desc.caps.ac_channels       = fmt->nchannels;
+      cap_desc.caps.ac_chmap          = fmt->chmap;
+      cap_desc.caps.ac_controls.hw[0] = fmt->samprate;
+      cap_desc.caps.ac_controls.b[3]  = fmt->samprate >> 16;
+      cap_desc.caps.ac_controls.b[2]  = fmt->bpsamp;
+      cap_desc.caps.ac_subtype        = fmt->format;
+
+      ioctl(pplayer->dev_fd, AUDIOIOC_CONFIGURE, (unsigned long)&cap_desc);
+    }
+}
+
+/****************************************************************************
+ * Name: nxplayer_clearplaylist
+ *
+ *   nxplayer_clearplaylist() drops the queued files and the prefetched
+ *   track.  Called with the mutex held once nobody reads the media.
+ *
+ ****************************************************************************/
+
+static void nxplayer_clearplaylist(FAR struct nxplayer_s *pplayer)
+{
+  while (pplayer->plcount > 0)
+    {
+      free(pplayer->playlist[pplayer->plhead]);
+      pplayer->plhead = (pplayer->plhead + 1) %
+                        CONFIG_NXPLAYER_PLAYLIST_MAXTRACKS;
+      pplayer->plcount--;
+    }
+
+  if (pplayer->nextfd >= 0)
+    {
+      close(pplayer->nextfd);
+      pplayer->nextfd = -1;
+    }
+}
+#endif /* CONFIG_NXPLAYER_PLAYLIST */
+
 /****************************************************************************
  * Name: nxplayer_readbuffer
  *
@@ -677,6 +989,34 @@ static int nxplayer_readbuffer(FAR struct nxplayer_s *pplayer,
     }
 
   ret = pplayer->ops->fill_data(pplayer->fd, apb);
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  /* At the end of the track, continue the stream with the next one if it
+   * has the same format: the short last buffer goes out without
+   * AUDIO_APB_FINAL, an empty one is filled from the next track instead.
+   */
+
+  while (ret < 0 && nxplayer_switchtrack(pplayer, true) == OK)
+    {
+      if (apb->nbytes > 0)
+        {
+          apb->flags &= ~AUDIO_APB_FINAL;
+          ret = OK;
+        }
+      else
+        {
+          ret = pplayer->ops->fill_data(pplayer->fd, apb);
+        }
+    }
+
+  /* Get the next track ready while this one plays */
+
+  if (ret == OK && pplayer->nextfd < 0)
+    {
+      nxplayer_prefetch(pplayer);
+    }
+#endif
+
   if (ret < 0)
     {
       /* End of file or read error.. We are finished with this file in any
@@ -776,6 +1116,272 @@ static void nxplayer_jointhread(FAR struct nxplayer_s *pplayer)
     }
 }
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+/****************************************************************************
+ * Name: nxplayer_readahead_thread
+ *
+ *  Fills free audio buffers from the media file ahead of the playback so
+ *  that a slow read (SD card busy, system loaded) is absorbed by the ring
+ *  instead of starving the audio device.  The decoder fills the buffer in
+ *  place, there is no intermediate copy.
+ *
+ ****************************************************************************/
+
+static FAR void *nxplayer_readahead_thread(pthread_addr_t pvarg)
+{
+  FAR struct nxplayer_readahead_s *ra = pvarg;
+  FAR struct nxplayer_s *pplayer = ra->pplayer;
+  FAR struct ap_buffer_s *apb;
+  struct audio_msg_s msg;
+  struct timespec start;
+  struct timespec end;
+  uint32_t elapsed;
+  int ret;
+
+  pthread_mutex_lock(&ra->lock);
+
+  while (!ra->stop && !ra->eof)
+    {
+      if (ra->nfree == 0)
+        {
+          pthread_cond_wait(&ra->cond, &ra->lock);
+          continue;
+        }
+
+      apb = ra->free[--ra->nfree];
+      pthread_mutex_unlock(&ra->lock);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      ret = nxplayer_readbuffer(pplayer, apb);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+
+      elapsed = (end.tv_sec - start.tv_sec) * 1000000 +
+                (end.tv_nsec - start.tv_nsec) / 1000;
+
+      pthread_mutex_lock(&ra->lock);
+
+      if (ret != OK)
+        {
+          ra->free[ra->nfree++] = apb;
+          ra->eof = true;
+        }
+      else
+        {
+          ra->filled[(ra->head + ra->nfilled) % ra->nbuffers] = apb;
+          ra->nfilled++;
+
+          /* nxplayer_readbuffer() closes the file with the final buffer */
+
+          ra->eof = pplayer->fd < 0;
+
+          pplayer->rastat.nreads++;
+          pplayer->rastat.maxread = MAX(pplayer->rastat.maxread, elapsed);
+        }
+
+      /* The playthread only waits on its message queue, so that it still
+       * sees STOP and COMPLETE.  Tell it there is something to enqueue.
+       */
+
+      if (ra->nwait > 0 && !ra->wakeup)
+        {
+          msg.msg_id = NXPLAYER_MSG_READY;
+          msg.u.ptr  = NULL;
+
+          ra->wakeup = mq_send(pplayer->mq, (FAR const char *)&msg,
+                               sizeof(msg), CONFIG_NXPLAYER_MSG_PRIO) == 0;
+        }
+
+      pthread_cond_broadcast(&ra->cond);
+    }
+
+  pthread_mutex_unlock(&ra->lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxplayer_readahead_start
+ *
+ *  Hand all audio buffers to the read-ahead thread and start it.  Also
+ *  used to start it again for the next stream of a playlist, once all
+ *  buffers are back from the device.
+ *
+ ****************************************************************************/
+
+static int nxplayer_readahead_start(FAR struct nxplayer_readahead_s *ra,
+                                    FAR struct ap_buffer_s **buffers,
+                                    int nbuffers)
+{
+  struct sched_param sparam;
+  pthread_attr_t tattr;
+  int policy;
+  int ret;
+
+  if (ra->filled == NULL)
+    {
+      ra->filled = malloc(2 * nbuffers * sizeof(FAR void *));
+      if (ra->filled == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      ra->pplayer->rastat.minfill = nbuffers;
+    }
+
+  ra->free     = ra->filled + nbuffers;
+  ra->nbuffers = nbuffers;
+  ra->nfree    = nbuffers;
+  ra->head     = 0;
+  ra->nfilled  = 0;
+  ra->nwait    = 0;
+  ra->eof      = false;
+  ra->stop     = false;
+  ra->wakeup   = false;
+  memcpy(ra->free, buffers, nbuffers * sizeof(FAR void *));
+
+  /* Run just below the playthread: above everything else, but never in
+   * the way of enqueueing a buffer that is already filled.
+   */
+
+  pthread_getschedparam(pthread_self(), &policy, &sparam);
+  sparam.sched_priority--;
+
+  pthread_attr_init(&tattr);
+  pthread_attr_setschedparam(&tattr, &sparam);
+  pthread_attr_setstacksize(&tattr, CONFIG_NXPLAYER_READAHEAD_STACKSIZE);
+
+  ret = pthread_create(&ra->id, &tattr, nxplayer_readahead_thread, ra);
+  pthread_attr_destroy(&tattr);
+  if (ret != OK)
+    {
+      auderr("ERROR: Failed to create readahead thread: %d\n", ret);
+      return -ret;
+    }
+
+  pthread_setname_np(ra->id, "readahead");
+  ra->started = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxplayer_readahead_stop
+ *
+ *  Stop and join the read-ahead thread.  It finishes the read in progress,
+ *  after which the playthread owns the file again.
+ *
+ ****************************************************************************/
+
+static void nxplayer_readahead_stop(FAR struct nxplayer_readahead_s *ra)
+{
+  pthread_mutex_lock(&ra->lock);
+  ra->stop = true;
+  pthread_cond_broadcast(&ra->cond);
+  pthread_mutex_unlock(&ra->lock);
+
+  if (ra->started)
+    {
+      pthread_join(ra->id, NULL);
+      ra->started = false;
+    }
+}
+
+/****************************************************************************
+ * Name: nxplayer_readahead_get
+ *
+ *  Take the oldest filled buffer, waiting for the read-ahead thread if
+ *  there is none yet.  Returns NULL at the end of the file.
+ *
+ ****************************************************************************/
+
+static FAR struct ap_buffer_s *
+nxplayer_readahead_get(FAR struct nxplayer_readahead_s *ra)
+{
+  FAR struct ap_buffer_s *apb = NULL;
+
+  pthread_mutex_lock(&ra->lock);
+
+  while (ra->nfilled == 0 && !ra->eof && !ra->stop)
+    {
+      pthread_cond_wait(&ra->cond, &ra->lock);
+    }
+
+  if (ra->nfilled > 0)
+    {
+      apb = ra->filled[ra->head];
+      ra->head = (ra->head + 1) % ra->nbuffers;
+      ra->nfilled--;
+    }
+
+  pthread_mutex_unlock(&ra->lock);
+  return apb;
+}
+
+/****************************************************************************
+ * Name: nxplayer_readahead_feed
+ *
+ *  Return a dequeued buffer (if any) to the read-ahead thread and enqueue
+ *  filled buffers for every dequeue that has not been refilled yet.
+ *
+ * Returned Value:
+ *   The number of buffers enqueued, -ENODATA once the final buffer has
+ *   been enqueued, or the error of a failed enqueue.
+ *
+ ****************************************************************************/
+
+static int nxplayer_readahead_feed(FAR struct nxplayer_readahead_s *ra,
+                                   FAR struct ap_buffer_s *dequeued)
+{
+  FAR struct nxplayer_s *pplayer = ra->pplayer;
+  FAR struct ap_buffer_s *apb;
+  int count = 0;
+  int ret;
+
+  pthread_mutex_lock(&ra->lock);
+
+  if (dequeued != NULL)
+    {
+      ra->free[ra->nfree++] = dequeued;
+      ra->nwait++;
+
+      pplayer->rastat.minfill = MIN(pplayer->rastat.minfill, ra->nfilled);
+      if (ra->nfilled == 0 && !ra->eof)
+        {
+          pplayer->rastat.nlate++;
+        }
+
+      pthread_cond_broadcast(&ra->cond);
+    }
+  else
+    {
+      ra->wakeup = false;
+    }
+
+  while (ra->nwait > 0 && ra->nfilled > 0)
+    {
+      apb = ra->filled[ra->head];
+      ra->head = (ra->head + 1) % ra->nbuffers;
+      ra->nfilled--;
+      ra->nwait--;
+
+      pthread_mutex_unlock(&ra->lock);
+      ret = nxplayer_enqueuebuffer(pplayer, apb);
+      pthread_mutex_lock(&ra->lock);
+
+      if (ret < 0)
+        {
+          ra->free[ra->nfree++] = apb;
+          pthread_mutex_unlock(&ra->lock);
+          return ret;
+        }
+
+      count++;
+    }
+
+  ret = count == 0 && ra->eof && ra->nfilled == 0 ? -ENODATA : count;
+  pthread_mutex_unlock(&ra->lock);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_thread_playthread
  *
@@ -795,15 +1401,33 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
   bool                    failed = false;
   struct ap_buffer_info_s buf_info;
   FAR struct ap_buffer_s  **buffers;
+  FAR struct ap_buffer_s  *apb;
   unsigned int            prio;
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  struct nxplayer_readahead_s ra;
+#endif
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  bool                    stopped = false;
+#endif
 #ifdef CONFIG_DEBUG_FEATURES
   int                     outstanding = 0;
 #endif
+  int                     nbuffers;
   int                     x;
   int                     ret;
 
   audinfo("Entry\n");
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  memset(&ra, 0, sizeof(ra));
+  ra.pplayer = pplayer;
+  pthread_mutex_init(&ra.lock, NULL);
+  pthread_cond_init(&ra.cond, NULL);
+
+  memset(&pplayer->rastat, 0, sizeof(pplayer->rastat));
+  pplayer->rastat.depth = CONFIG_NXPLAYER_READAHEAD_NBUFFERS;
+#endif
+
   /* Query the audio device for its preferred buffer size / qty */
 
   if ((ret = ioctl(pplayer->dev_fd, AUDIOIOC_GETBUFFERINFO,
@@ -815,10 +1439,19 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
       buf_info.nbuffers = CONFIG_AUDIO_NUM_BUFFERS;
     }
 
+  /* The device queues buf_info.nbuffers, the read-ahead ring holds the
+   * rest.
+   */
+
+  nbuffers = buf_info.nbuffers;
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  nbuffers += CONFIG_NXPLAYER_READAHEAD_NBUFFERS;
+#endif
+
   /* Create array of pointers to buffers */
 
   buffers = (FAR struct ap_buffer_s **)
-    malloc(buf_info.nbuffers * sizeof(FAR void *));
+    malloc(nbuffers * sizeof(FAR void *));
   if (buffers == NULL)
     {
       /* Error allocating memory for buffer storage! */
@@ -830,12 +1463,12 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
 
   /* Create our audio pipeline buffers to use for queueing up data */
 
-  for (x = 0; x < buf_info.nbuffers; x++)
+  for (x = 0; x < nbuffers; x++)
     {
       buffers[x] = NULL;
     }
 
-  for (x = 0; x < buf_info.nbuffers; x++)
+  for (x = 0; x < nbuffers; x++)
     {
       /* Fill in the buffer descriptor struct to issue an alloc request */
 
@@ -858,13 +1491,31 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
         }
     }
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  ret = nxplayer_readahead_start(&ra, buffers, nbuffers);
+  if (ret < 0)
+    {
+      running = false;
+      goto err_out;
+    }
+#endif
+
   /* Fill up the pipeline with enqueued buffers */
 
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+restart:
+#endif
   for (x = 0; x < buf_info.nbuffers; x++)
     {
       /* Read the next buffer of data */
 
-      ret = nxplayer_readbuffer(pplayer, buffers[x]);
+#ifdef CONFIG_NXPLAYER_READAHEAD
+      apb = nxplayer_readahead_get(&ra);
+      ret = apb != NULL ? OK : -ENODATA;
+#else
+      apb = buffers[x];
+      ret = nxplayer_readbuffer(pplayer, apb);
+#endif
       if (ret != OK)
         {
           /* nxplayer_readbuffer will return an error if there is no further
@@ -893,7 +1544,7 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
 
       else
         {
-          ret = nxplayer_enqueuebuffer(pplayer, buffers[x]);
+          ret = nxplayer_enqueuebuffer(pplayer, apb);
           if (ret != OK)
             {
               /* Failed to enqueue the buffer.
@@ -907,6 +1558,9 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
                * file so that no further data is read.
                */
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+              nxplayer_readahead_stop(&ra);
+#endif
               close(pplayer->fd);
               pplayer->fd = -1;
 
@@ -1020,8 +1674,62 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
 
       switch (msg.msg_id)
         {
-          /* An audio buffer is being dequeued by the driver */
+          /* An audio buffer is being dequeued by the driver, or the
+           * read-ahead thread has filled one that a previous dequeue
+           * could not get.
+           */
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+          case AUDIO_MSG_DEQUEUE:
+          case NXPLAYER_MSG_READY:
+
+#ifdef CONFIG_DEBUG_FEATURES
+            if (msg.msg_id == AUDIO_MSG_DEQUEUE)
+              {
+                DEBUGASSERT(msg.u.ptr && outstanding > 0);
+                outstanding--;
+              }
+#endif
+
+            /* The dequeued buffer goes back to the read-ahead thread even
+             * when we are no longer streaming; it is freed with the rest.
+             */
+
+            ret = nxplayer_readahead_feed(&ra, msg.u.ptr);
+            if (!streaming)
+              {
+                break;
+              }
+
+            if (ret == -ENODATA)
+              {
+                /* Out of data.  Stay in the loop until the device sends
+                 * us a COMPLETE message.
+                 */
+
+                streaming = false;
+              }
+            else if (ret < 0)
+              {
+                /* The audio driver refused a buffer, stop streaming as
+                 * gracefully as possible, see below.
+                 */
+
+                nxplayer_readahead_stop(&ra);
+                close(pplayer->fd);
+                pplayer->fd = -1;
+
+                streaming = false;
+                failed = true;
+              }
+#ifdef CONFIG_DEBUG_FEATURES
+            else
+              {
+                outstanding += ret;
+              }
+#endif
+            break;
+#else
           case AUDIO_MSG_DEQUEUE:
 
 #ifdef CONFIG_DEBUG_FEATURES
@@ -1089,6 +1797,7 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
                   }
               }
             break;
+#endif
 
           /* Someone wants to stop the playback. */
 
@@ -1112,6 +1821,9 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
              */
 
             streaming = false;
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+            stopped = true;
+#endif
             break;
 
           /* Message indicating the playback is complete */
@@ -1131,15 +1843,61 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
         }
     }
 
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  /* The stream ended on a track whose successor could not continue it.
+   * Start a new stream for the successor, on the same device and buffers,
+   * all of which are back from the device now.
+   */
+
+  if (!stopped && !failed)
+    {
+#ifdef CONFIG_NXPLAYER_READAHEAD
+      nxplayer_readahead_stop(&ra);
+#endif
+
+      if (nxplayer_switchtrack(pplayer, false) == OK)
+        {
+          audinfo("Reconfiguring for format %d\n", pplayer->curfmt.format);
+          nxplayer_configure(pplayer);
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+          ret = nxplayer_readahead_start(&ra, buffers, nbuffers);
+          if (ret == OK)
+#endif
+            {
+              running   = true;
+              streaming = true;
+              goto restart;
+            }
+        }
+    }
+#endif
+
   /* Release our audio buffers and unregister / release the device */
 
 err_out:
   audinfo("Clean-up and exit\n");
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  /* All buffers are back from the device, stop reading before the file
+   * and the message queue go away.
+   */
+
+  nxplayer_readahead_stop(&ra);
+  free(ra.filled);
+  pthread_cond_destroy(&ra.cond);
+  pthread_mutex_destroy(&ra.lock);
+
+  audinfo("Readahead: %" PRIu32 " reads, %" PRIu32 " late, "
+          "min fill %u/%u, max read %" PRIu32 " us\n",
+          pplayer->rastat.nreads, pplayer->rastat.nlate,
+          pplayer->rastat.minfill, nbuffers, pplayer->rastat.maxread);
+#endif
+
   if (buffers != NULL)
     {
       audinfo("Freeing buffers\n");
-      for (x = 0; x < buf_info.nbuffers; x++)
+      for (x = 0; x < nbuffers; x++)
         {
           /* Fill in the buffer descriptor struct to issue a free request */
 
@@ -1187,6 +1945,9 @@ err_out:
   mq_unlink(pplayer->mqname);             /* Unlink the message queue */
   pplayer->ops   = NULL;                  /* Clear offload parser */
   pplayer->state = NXPLAYER_STATE_IDLE;   /* Go to IDLE */
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  nxplayer_clearplaylist(pplayer);        /* Drop the rest of the playlist */
+#endif
 
   pthread_mutex_unlock(&pplayer->mutex);
 
@@ -1757,6 +2518,51 @@ int nxplayer_stop(FAR struct nxplayer_s *pplayer)
 }
 #endif /* CONFIG_AUDIO_EXCLUDE_STOP */
 
+/****************************************************************************
+ * Name: nxplayer_getrastat
+ *
+ *   nxplayer_getrastat() returns the read-ahead statistics of the current
+ *   or last playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+int nxplayer_getrastat(FAR struct nxplayer_s *pplayer,
+                       FAR struct nxplayer_rastat_s *stat)
+{
+  DEBUGASSERT(pplayer != NULL && stat != NULL);
+
+  pthread_mutex_lock(&pplayer->mutex);
+  *stat = pplayer->rastat;
+  pthread_mutex_unlock(&pplayer->mutex);
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_getplstat
+ *
+ *   nxplayer_getplstat() returns the playlist state of the current or last
+ *   playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+int nxplayer_getplstat(FAR struct nxplayer_s *pplayer,
+                       FAR struct nxplayer_plstat_s *stat)
+{
+  DEBUGASSERT(pplayer != NULL && stat != NULL);
+
+  pthread_mutex_lock(&pplayer->mutex);
+  *stat = pplayer->plstat;
+  stat->queued = pplayer->plcount + (pplayer->nextfd >= 0);
+  pthread_mutex_unlock(&pplayer->mutex);
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_playinternal
  *
@@ -1798,12 +2604,8 @@ static int nxplayer_playinternal(FAR struct nxplayer_s *pplayer,
   struct ap_buffer_info_s  buf_info;
   struct audio_caps_s      caps;
   int                      min_channels;
-#ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
-  char                path[PATH_MAX];
-#endif
   int                 tmpsubfmt = AUDIO_FMT_UNDEF;
   int                 ret;
-  int                 c;
 
   DEBUGASSERT(pplayer != NULL);
   DEBUGASSERT(pfilename != NULL);
@@ -1819,47 +2621,21 @@ static int nxplayer_playinternal(FAR struct nxplayer_s *pplayer,
 
   /* Test that the specified file exists */
 
-#ifdef CONFIG_NXPLAYER_HTTP_STREAMING_SUPPORT
-  if ((pplayer->fd = _open_with_http(pfilename)) == -1)
-#else
-  if ((pplayer->fd = open(pfilename, O_RDONLY)) == -1)
-#endif
+  ret = nxplayer_openfile(pplayer, pfilename);
+  if (ret < 0)
     {
-      /* File not found.  Test if its in the mediadir */
-
-#ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
-      snprintf(path, sizeof(path), "%s/%s", pplayer->mediadir, pfilename);
-
-      if ((pplayer->fd = open(path, O_RDONLY)) == -1)
-        {
-#ifdef CONFIG_NXPLAYER_MEDIA_SEARCH
-          /* File not found in the media dir.  Do a search */
-
-          if (nxplayer_mediasearch(pplayer, pfilename, path,
-                                   sizeof(path)) != OK)
-            {
-              auderr("ERROR: Could not find file\n");
-              return -ENOENT;
-            }
-#else
-          auderr("ERROR: Could not open %s or %s\n", pfilename, path);
-          return -ENOENT;
-#endif /* CONFIG_NXPLAYER_MEDIA_SEARCH */
-        }
-
-#else   /* CONFIG_NXPLAYER_INCLUDE_MEDIADIR */
-
-      auderr("ERROR: Could not open %s\n", pfilename);
-      return -ENOENT;
-#endif /* CONFIG_NXPLAYER_INCLUDE_MEDIADIR */
+      return ret;
     }
 
+  pplayer->fd = ret;
+
 #ifdef CONFIG_NXPLAYER_FMT_FROM_EXT
   /* Try to determine the format of audio file based on the extension */
 
   if (filefmt == AUDIO_FMT_UNDEF)
     {
-      filefmt = nxplayer_fmtfromextension(pplayer, pfilename, &tmpsubfmt);
+      filefmt = nxplayer_fmtfromextension(pplayer->fd, pfilename,
+                                          &tmpsubfmt);
     }
 #endif
 
@@ -1868,7 +2644,7 @@ static int nxplayer_playinternal(FAR struct nxplayer_s *pplayer,
 
   if (filefmt == AUDIO_FMT_UNDEF)
     {
-      filefmt = nxplayer_fmtfromheader(pplayer, &subfmt, &tmpsubfmt);
+      filefmt = nxplayer_fmtfromheader(pplayer->fd, &tmpsubfmt);
     }
 #endif
 
@@ -1901,15 +2677,7 @@ static int nxplayer_playinternal(FAR struct nxplayer_s *pplayer,
       goto err_out_nodev;
     }
 
-  for (c = 0; c < nitems(g_dec_ops); c++)
-    {
-      if (g_dec_ops[c].format == filefmt)
-        {
-          pplayer->ops = &g_dec_ops[c];
-          break;
-        }
-    }
-
+  pplayer->ops = nxplayer_findops(filefmt);
   if (!pplayer->ops)
     {
       goto err_out;
@@ -1921,6 +2689,18 @@ static int nxplayer_playinternal(FAR struct nxplayer_s *pplayer,
                                     &nchannels, &bpsamp);
     }
 
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  /* Queued tracks of the same format continue this stream */
+
+  pplayer->curfmt.format    = filefmt;
+  pplayer->curfmt.samprate  = samprate;
+  pplayer->curfmt.nchannels = nchannels;
+  pplayer->curfmt.bpsamp    = bpsamp;
+  pplayer->curfmt.chmap     = chmap;
+
+  memset(&pplayer->plstat, 0, sizeof(pplayer->plstat));
+#endif
+
   /* Try to reserve the device */
 
 #ifdef CONFIG_AUDIO_MULTI_SESSION
@@ -2132,6 +2912,67 @@ int nxplayer_playraw(FAR struct nxplayer_s *pplayer,
                                nchannels, bpsamp, samprate, chmap);
 }
 
+/****************************************************************************
+ * Name: nxplayer_queuefile
+ *
+ *   nxplayer_queuefile() appends a media file to the playlist, or plays it
+ *   right away if nothing is playing.
+ *
+ * Input:
+ *   pplayer    Pointer to the initialized MPlayer context
+ *   pfilename  Pointer to the filename to queue
+ *
+ * Returns:
+ *   OK         File is queued or being played
+ *   -ENOSPC    The playlist is full
+ *   -ENOMEM    Out of memory for the filename
+ *   Otherwise the nxplayer_playfile() errors
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+int nxplayer_queuefile(FAR struct nxplayer_s *pplayer,
+                       FAR const char *pfilename)
+{
+  FAR char *name;
+  int ret = OK;
+
+  DEBUGASSERT(pplayer != NULL && pfilename != NULL);
+
+  /* The playthread closes the device and drops the playlist under the
+   * same lock, so a file queued here is either played or we start it.
+   * The state only becomes PLAYING once the playthread started the
+   * device, the device is open as soon as nxplayer_playfile() returns.
+   */
+
+  pthread_mutex_lock(&pplayer->mutex);
+  if (pplayer->dev_fd < 0)
+    {
+      pthread_mutex_unlock(&pplayer->mutex);
+      return nxplayer_playfile(pplayer, pfilename, AUDIO_FMT_UNDEF,
+                               AUDIO_FMT_UNDEF);
+    }
+
+  if (pplayer->plcount >= CONFIG_NXPLAYER_PLAYLIST_MAXTRACKS)
+    {
+      ret = -ENOSPC;
+    }
+  else if ((name = strdup(pfilename)) == NULL)
+    {
+      ret = -ENOMEM;
+    }
+  else
+    {
+      pplayer->playlist[(pplayer->plhead + pplayer->plcount) %
+                        CONFIG_NXPLAYER_PLAYLIST_MAXTRACKS] = name;
+      pplayer->plcount++;
+    }
+
+  pthread_mutex_unlock(&pplayer->mutex);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_setmediadir
  *
@@ -2187,6 +3028,15 @@ FAR struct nxplayer_s *nxplayer_create(void)
   pplayer->play_id = 0;
   pplayer->crefs = 1;
 
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  pplayer->plhead = 0;
+  pplayer->plcount = 0;
+  pplayer->nextfd = -1;
+  pplayer->nextops = NULL;
+  memset(&pplayer->curfmt, 0, sizeof(pplayer->curfmt));
+  memset(&pplayer->plstat, 0, sizeof(pplayer->plstat));
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_TONE
   pplayer->bass = 50;
   pplayer->treble = 50;
@@ -26,6 +26,7 @@
 #include <nuttx/audio/audio.h>
 
 #include <sys/types.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -72,6 +73,14 @@ static int nxplayer_cmd_playraw(FAR struct nxplayer_s *pplayer, char *parg);
 static int nxplayer_cmd_reset(FAR struct nxplayer_s *pplayer, char *parg);
 #endif
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static int nxplayer_cmd_rastat(FAR struct nxplayer_s *pplayer, char *parg);
+#endif
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+static int nxplayer_cmd_queue(FAR struct nxplayer_s *pplayer, char *parg);
+#endif
+
 #ifdef CONFIG_NXPLAYER_INCLUDE_PREFERRED_DEVICE
 static int nxplayer_cmd_device(FAR struct nxplayer_s *pplayer, char *parg);
 #endif
@@ -179,6 +188,22 @@ static struct mp_cmd_s g_nxplayer_cmds[] =
     NXPLAYER_HELP_TEXT("Pause playback")
   },
 #endif
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+  {
+    "queue",
+    "[filename]",
+    nxplayer_cmd_queue,
+    NXPLAYER_HELP_TEXT("Queue a media file, or show the playlist")
+  },
+#endif
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  {
+    "rastat",
+    "",
+    nxplayer_cmd_rastat,
+    NXPLAYER_HELP_TEXT("Show read-ahead statistics")
+  },
+#endif
 #ifdef CONFIG_NXPLAYER_INCLUDE_SYSTEM_RESET
   {
     "reset",
@@ -485,6 +510,80 @@ static int nxplayer_cmd_balance(FAR struct nxplayer_s *pplayer, char *parg)
 #endif
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_cmd_rastat
+ *
+ *   nxplayer_cmd_rastat() shows how close the read-ahead ring came to
+ *   running dry during the current or last playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static int nxplayer_cmd_rastat(FAR struct nxplayer_s *pplayer, char *parg)
+{
+  struct nxplayer_rastat_s stat;
+
+  nxplayer_getrastat(pplayer, &stat);
+
+  printf("depth %u, %" PRIu32 " reads, max read %" PRIu32 " us\n",
+         stat.depth, stat.nreads, stat.maxread);
+  printf("min fill %u, %" PRIu32 " late dequeues\n",
+         stat.minfill, stat.nlate);
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_cmd_queue
+ *
+ *   nxplayer_cmd_queue() appends a media file to the playlist, plays it if
+ *   nothing is playing, or shows the playlist if no file is given.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PLAYLIST
+static int nxplayer_cmd_queue(FAR struct nxplayer_s *pplayer, char *parg)
+{
+  struct nxplayer_plstat_s stat;
+  int ret;
+
+  if (parg == NULL || *parg == '\0')
+    {
+      nxplayer_getplstat(pplayer, &stat);
+
+      printf("%u queued, %u gapless, %u reconfigured\n",
+             stat.queued, stat.ngapless, stat.nrestart);
+      return OK;
+    }
+
+  ret = nxplayer_queuefile(pplayer, parg);
+  switch (-ret)
+    {
+      case OK:
+        break;
+
+      case ENOSPC:
+        printf("Playlist full\n");
+        break;
+
+      case ENOENT:
+        printf("File %s not found\n", parg);
+        break;
+
+      case ENOSYS:
+        printf("Unknown audio format\n");
+        break;
+
+      default:
+        printf("Error queueing file: %d\n", -ret);
+        break;
+    }
+
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_cmd_reset
  *
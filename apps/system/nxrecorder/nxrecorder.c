@@ -29,6 +29,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <sched.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -37,7 +38,9 @@
 #include <string.h>
 #include <strings.h>
 #include <sys/ioctl.h>
+#include <sys/param.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <nuttx/audio/audio.h>
@@ -60,6 +63,15 @@
 #  define CONFIG_NXRECORDER_RECORDTHREAD_STACKSIZE    1500
 #endif
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+#  ifndef CONFIG_NXRECORDER_ENCODER_BUFSIZE
+#    define CONFIG_NXRECORDER_ENCODER_BUFSIZE         8192
+#  endif
+#  ifndef CONFIG_NXRECORDER_ENCODER_STACKSIZE
+#    define CONFIG_NXRECORDER_ENCODER_STACKSIZE       2048
+#  endif
+#endif
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -73,6 +85,33 @@ struct nxrecorder_ext_fmt_s
 };
 #endif
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+/* The encoder stage.  The recordthread encodes each captured buffer into
+ * one half of a double buffer and re-enqueues it at once; a writer thread
+ * writes the other half to the file, so neither the encoding nor a slow
+ * write holds a buffer back from the device.
+ */
+
+struct nxrecorder_encstage_s
+{
+  FAR struct nxrecorder_s *precorder;
+  pthread_t               id;         /* Writer thread */
+  pthread_mutex_t         lock;       /* Protects pending and error */
+  pthread_cond_t          cond;
+  FAR uint8_t             *buf[2];    /* Encoded data */
+  size_t                  bufsize;    /* Size of each half */
+  size_t                  fill;       /* Bytes in buf[cur] */
+  size_t                  pending;    /* Bytes of buf[cur ^ 1] to write */
+  int                     cur;        /* Half being encoded into */
+  int                     error;      /* First write error */
+  uint32_t                written;    /* Encoded bytes in the file */
+  uint32_t                nin;        /* PCM bytes encoded */
+  uint32_t                encode_us;  /* Time spent encoding */
+  bool                    started;    /* Writer running, needs a join */
+  bool                    stop;       /* Writer asked to exit */
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -81,6 +120,14 @@ struct nxrecorder_ext_fmt_s
 int nxrecorder_getmp3subformat(int fd);
 #endif
 
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ENCODER
+extern const struct nxrecorder_enc_ops_s g_nxrecorder_adpcm_ops;
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -116,6 +163,13 @@ static const int g_known_ext_count = sizeof(g_known_ext) /
                     sizeof(struct nxrecorder_ext_fmt_s);
 #endif
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+static FAR const struct nxrecorder_enc_ops_s *const g_encoders[] =
+{
+  &g_nxrecorder_adpcm_ops
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -458,6 +512,269 @@ static void nxrecorder_jointhread(FAR struct nxrecorder_s *precorder)
     }
 }
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+/****************************************************************************
+ * Name: nxrecorder_encwriter
+ *
+ *  Writes the filled half of the double buffer to the file.
+ *
+ ****************************************************************************/
+
+static FAR void *nxrecorder_encwriter(pthread_addr_t pvarg)
+{
+  FAR struct nxrecorder_encstage_s *stage = pvarg;
+  FAR const uint8_t *buf;
+  size_t nbytes;
+  ssize_t ret;
+
+  pthread_mutex_lock(&stage->lock);
+
+  for (; ; )
+    {
+      while (stage->pending == 0 && !stage->stop)
+        {
+          pthread_cond_wait(&stage->cond, &stage->lock);
+        }
+
+      if (stage->pending == 0)
+        {
+          break;
+        }
+
+      buf    = stage->buf[stage->cur ^ 1];
+      nbytes = stage->pending;
+      pthread_mutex_unlock(&stage->lock);
+
+      while (nbytes > 0)
+        {
+          ret = write(stage->precorder->fd, buf, nbytes);
+          if (ret <= 0)
+            {
+              break;
+            }
+
+          buf    += ret;
+          nbytes -= ret;
+        }
+
+      pthread_mutex_lock(&stage->lock);
+
+      if (nbytes > 0 && stage->error == 0)
+        {
+          stage->error = ret < 0 ? -errno : -ENOSPC;
+          auderr("ERROR: Encoded write failed: %d\n", stage->error);
+        }
+
+      stage->written += stage->pending - nbytes;
+      stage->pending  = 0;
+      pthread_cond_broadcast(&stage->cond);
+    }
+
+  pthread_mutex_unlock(&stage->lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_encsubmit
+ *
+ *  Hand the half being encoded into to the writer.  If the writer is still
+ *  busy with the other half, wait: the device keeps capturing into the
+ *  buffers it holds meanwhile.
+ *
+ ****************************************************************************/
+
+static int nxrecorder_encsubmit(FAR struct nxrecorder_encstage_s *stage)
+{
+  int ret;
+
+  pthread_mutex_lock(&stage->lock);
+
+  while (stage->pending != 0)
+    {
+      pthread_cond_wait(&stage->cond, &stage->lock);
+    }
+
+  ret = stage->error;
+  if (ret == 0 && stage->fill > 0)
+    {
+      stage->pending = stage->fill;
+      stage->cur    ^= 1;
+      stage->fill    = 0;
+      pthread_cond_broadcast(&stage->cond);
+    }
+
+  pthread_mutex_unlock(&stage->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_encstart
+ *
+ *  Allocate the double buffer for captured buffers of buffer_size bytes
+ *  and start the writer thread.
+ *
+ ****************************************************************************/
+
+static int nxrecorder_encstart(FAR struct nxrecorder_encstage_s *stage,
+                               size_t buffer_size)
+{
+  FAR struct nxrecorder_s *precorder = stage->precorder;
+  struct sched_param sparam;
+  pthread_attr_t tattr;
+  int policy;
+  int ret;
+
+  /* Each half takes at least two captured buffers worth of output */
+
+  stage->bufsize = MAX(CONFIG_NXRECORDER_ENCODER_BUFSIZE,
+                       2 * precorder->enc->bound(precorder->encpriv,
+                                                 buffer_size));
+
+  stage->buf[0] = malloc(2 * stage->bufsize);
+  if (stage->buf[0] == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  stage->buf[1] = stage->buf[0] + stage->bufsize;
+
+  /* The writer only has to keep up on average, it runs below us */
+
+  pthread_getschedparam(pthread_self(), &policy, &sparam);
+  sparam.sched_priority--;
+
+  pthread_attr_init(&tattr);
+  pthread_attr_setschedparam(&tattr, &sparam);
+  pthread_attr_setstacksize(&tattr, CONFIG_NXRECORDER_ENCODER_STACKSIZE);
+
+  ret = pthread_create(&stage->id, &tattr, nxrecorder_encwriter, stage);
+  pthread_attr_destroy(&tattr);
+  if (ret != OK)
+    {
+      auderr("ERROR: Failed to create encoder writer: %d\n", ret);
+      return -ret;
+    }
+
+  pthread_setname_np(stage->id, "recordwriter");
+  stage->started = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_encstop
+ *
+ *  Join the writer after it wrote what was submitted.  The recordthread
+ *  owns the file again afterwards.
+ *
+ ****************************************************************************/
+
+static void nxrecorder_encstop(FAR struct nxrecorder_encstage_s *stage)
+{
+  pthread_mutex_lock(&stage->lock);
+  stage->stop = true;
+  pthread_cond_broadcast(&stage->cond);
+  pthread_mutex_unlock(&stage->lock);
+
+  if (stage->started)
+    {
+      pthread_join(stage->id, NULL);
+      stage->started = false;
+    }
+}
+
+/****************************************************************************
+ * Name: nxrecorder_encodebuffer
+ *
+ *  Encode a captured buffer into the double buffer, the encoded stage's
+ *  counterpart of nxrecorder_writebuffer().
+ *
+ ****************************************************************************/
+
+static int nxrecorder_encodebuffer(FAR struct nxrecorder_encstage_s *stage,
+                                   FAR struct ap_buffer_s *apb)
+{
+  FAR struct nxrecorder_s *precorder = stage->precorder;
+  FAR const struct nxrecorder_enc_ops_s *enc = precorder->enc;
+  struct timespec start;
+  struct timespec end;
+  int ret;
+
+  if (precorder->fd == -1)
+    {
+      return -ENODATA;
+    }
+
+  if (stage->fill + enc->bound(precorder->encpriv, apb->nbytes) >
+      stage->bufsize)
+    {
+      ret = nxrecorder_encsubmit(stage);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  stage->fill += enc->encode(precorder->encpriv, apb->samp, apb->nbytes,
+                             stage->buf[stage->cur] + stage->fill);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  stage->nin       += apb->nbytes;
+  stage->encode_us += (end.tv_sec - start.tv_sec) * 1000000 +
+                      (end.tv_nsec - start.tv_nsec) / 1000;
+
+  apb->curbyte = 0;
+  apb->flags   = 0;
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_encfinish
+ *
+ *  Flush the encoder, wait for the writer and complete the file header.
+ *
+ ****************************************************************************/
+
+static void nxrecorder_encfinish(FAR struct nxrecorder_encstage_s *stage)
+{
+  FAR struct nxrecorder_s *precorder = stage->precorder;
+  FAR const struct nxrecorder_enc_ops_s *enc = precorder->enc;
+
+  if (stage->started && precorder->fd >= 0)
+    {
+      if (stage->fill + enc->bound(precorder->encpriv, 0) > stage->bufsize)
+        {
+          nxrecorder_encsubmit(stage);
+        }
+
+      stage->fill += enc->flush(precorder->encpriv,
+                                stage->buf[stage->cur] + stage->fill);
+      nxrecorder_encsubmit(stage);
+    }
+
+  nxrecorder_encstop(stage);
+
+  if (precorder->encpriv != NULL)
+    {
+      if (precorder->fd >= 0)
+        {
+          enc->header(precorder->encpriv, precorder->fd, stage->written);
+        }
+
+      enc->release(precorder->encpriv);
+      precorder->encpriv = NULL;
+    }
+
+  audinfo("Encoded %" PRIu32 " bytes into %" PRIu32 " in %" PRIu32 " us\n",
+          stage->nin, stage->written, stage->encode_us);
+
+  free(stage->buf[0]);
+  pthread_cond_destroy(&stage->cond);
+  pthread_mutex_destroy(&stage->lock);
+}
+#endif
+
 /****************************************************************************
  * Name: nxrecorder_thread_recordthread
  *
@@ -478,6 +795,9 @@ static FAR void *nxrecorder_recordthread(pthread_addr_t pvarg)
   struct ap_buffer_info_s buf_info;
   FAR struct ap_buffer_s  **pbuffers;
   unsigned int            prio;
+#ifdef CONFIG_NXRECORDER_ENCODER
+  struct nxrecorder_encstage_s stage;
+#endif
 #ifdef CONFIG_DEBUG_FEATURES
   int                     outstanding = 0;
 #endif
@@ -486,6 +806,13 @@ static FAR void *nxrecorder_recordthread(pthread_addr_t pvarg)
 
   audinfo("Entry\n");
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+  memset(&stage, 0, sizeof(stage));
+  stage.precorder = precorder;
+  pthread_mutex_init(&stage.lock, NULL);
+  pthread_cond_init(&stage.cond, NULL);
+#endif
+
   /* Query the audio device for its preferred buffer size / qty */
 
   if ((ret = ioctl(precorder->dev_fd, AUDIOIOC_GETBUFFERINFO,
@@ -540,6 +867,18 @@ static FAR void *nxrecorder_recordthread(pthread_addr_t pvarg)
         }
     }
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+  if (precorder->enc != NULL)
+    {
+      ret = nxrecorder_encstart(&stage, buf_info.buffer_size);
+      if (ret < 0)
+        {
+          running = false;
+          goto err_out;
+        }
+    }
+#endif
+
   /* Fill up the pipeline with enqueued buffers */
 
   for (x = 0; x < buf_info.nbuffers; x++)
@@ -559,6 +898,9 @@ static FAR void *nxrecorder_recordthread(pthread_addr_t pvarg)
            * file so that no further data is written.
            */
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+          nxrecorder_encstop(&stage);
+#endif
           close(precorder->fd);
           precorder->fd = -1;
 
@@ -675,7 +1017,13 @@ static FAR void *nxrecorder_recordthread(pthread_addr_t pvarg)
               {
                 /* Write the next buffer of data */
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+                ret = stage.started ?
+                      nxrecorder_encodebuffer(&stage, msg.u.ptr) :
+                      nxrecorder_writebuffer(precorder, msg.u.ptr);
+#else
                 ret = nxrecorder_writebuffer(precorder, msg.u.ptr);
+#endif
                 if (ret != OK)
                   {
                     /* Out of data.  Stay in the loop until the device sends
@@ -700,6 +1048,9 @@ static FAR void *nxrecorder_recordthread(pthread_addr_t pvarg)
                          * Close the file so that no further data is written.
                          */
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+                        nxrecorder_encstop(&stage);
+#endif
                         close(precorder->fd);
                         precorder->fd = -1;
 
@@ -768,6 +1119,12 @@ static FAR void *nxrecorder_recordthread(pthread_addr_t pvarg)
 err_out:
   audinfo("Clean-up and exit\n");
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+  /* All buffers are back, write what is left before the file is closed */
+
+  nxrecorder_encfinish(&stage);
+#endif
+
   if (pbuffers != NULL)
     {
       audinfo("Freeing buffers\n");
@@ -982,6 +1339,71 @@ int nxrecorder_stop(FAR struct nxrecorder_s *precorder)
 }
 #endif /* CONFIG_AUDIO_EXCLUDE_STOP */
 
+/****************************************************************************
+ * Name: nxrecorder_getencoder
+ *
+ *   nxrecorder_getencoder() finds an encoder by name.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ENCODER
+FAR const struct nxrecorder_enc_ops_s *
+nxrecorder_getencoder(FAR const char *name)
+{
+  int i;
+
+  for (i = 0; i < nitems(g_encoders); i++)
+    {
+      if (strcasecmp(g_encoders[i]->name, name) == 0)
+        {
+          return g_encoders[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_setencoder
+ *
+ *   nxrecorder_setencoder() selects the encoder of the following
+ *   recordings.
+ *
+ ****************************************************************************/
+
+int nxrecorder_setencoder(FAR struct nxrecorder_s *precorder,
+                          FAR const char *name)
+{
+  FAR const struct nxrecorder_enc_ops_s *enc = NULL;
+  int ret = OK;
+
+  DEBUGASSERT(precorder != NULL);
+
+  if (name != NULL && strcasecmp(name, "none") != 0)
+    {
+      enc = nxrecorder_getencoder(name);
+      if (enc == NULL)
+        {
+          return -ENOENT;
+        }
+    }
+
+  pthread_mutex_lock(&precorder->mutex);
+
+  if (precorder->state != NXRECORDER_STATE_IDLE)
+    {
+      ret = -EBUSY;
+    }
+  else
+    {
+      precorder->enc = enc;
+    }
+
+  pthread_mutex_unlock(&precorder->mutex);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: nxrecorder_recordinteral
  *
@@ -1059,6 +1481,18 @@ int nxrecorder_recordinternal(FAR struct nxrecorder_s *precorder,
       goto err_out_nodev;
     }
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+  /* The encoders take PCM from the device */
+
+  if (precorder->enc != NULL && filefmt != AUDIO_FMT_PCM)
+    {
+      auderr("ERROR: %s needs PCM, not format %d\n", precorder->enc->name,
+             filefmt);
+      ret = -ENOSYS;
+      goto err_out_nodev;
+    }
+#endif
+
   /* Try to open the device */
 
   ret = nxrecorder_opendevice(precorder, filefmt, subfmt);
@@ -1122,6 +1556,31 @@ int nxrecorder_recordinternal(FAR struct nxrecorder_s *precorder,
       goto err_out;
     }
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+  /* Set up the encoder for the format just configured and leave room for
+   * its header, completed when the recording ends.
+   */
+
+  if (precorder->enc != NULL)
+    {
+      ret = precorder->enc->init(&precorder->encpriv,
+                                 cap_desc.caps.ac_channels,
+                                 cap_desc.caps.ac_controls.b[2],
+                                 samprate ? samprate : 48000);
+      if (ret < 0)
+        {
+          auderr("ERROR: %s init failed: %d\n", precorder->enc->name, ret);
+          goto err_out;
+        }
+
+      ret = precorder->enc->header(precorder->encpriv, precorder->fd, 0);
+      if (ret < 0)
+        {
+          goto err_out;
+        }
+    }
+#endif
+
   /* Query the audio device for its preferred buffer count */
 
   if (ioctl(precorder->dev_fd, AUDIOIOC_GETBUFFERINFO,
@@ -1196,6 +1655,14 @@ int nxrecorder_recordinternal(FAR struct nxrecorder_s *precorder,
   return OK;
 
 err_out:
+#ifdef CONFIG_NXRECORDER_ENCODER
+  if (precorder->encpriv != NULL)
+    {
+      precorder->enc->release(precorder->encpriv);
+      precorder->encpriv = NULL;
+    }
+#endif
+
   close(precorder->dev_fd);
   precorder->dev_fd = -1;
 
@@ -0,0 +1,414 @@
+/****************************************************************************
+ * apps/system/nxrecorder/nxrecorder_adpcm.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "system/nxrecorder.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Bytes of one channel in a block, a multiple of 4: a 4 byte header with
+ * the first sample, then 8 samples per 4 bytes.
+ */
+
+#ifndef CONFIG_NXRECORDER_ADPCM_BLOCKSIZE
+#  define CONFIG_NXRECORDER_ADPCM_BLOCKSIZE  512
+#endif
+
+#define ADPCM_MAX_CHANNELS  2
+#define ADPCM_BLOCKSAMPLES  ((CONFIG_NXRECORDER_ADPCM_BLOCKSIZE - 4) * 2 + 1)
+
+#define ADPCM_WAVE_FORMAT   0x0011  /* WAVE_FORMAT_IMA_ADPCM */
+#define ADPCM_HEADER_SIZE   60
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct adpcm_chan_s
+{
+  int16_t predictor;
+  uint8_t index;
+};
+
+struct adpcm_s
+{
+  uint8_t             nchannels;
+  uint32_t            samprate;
+  uint32_t            blockalign;  /* Encoded bytes per block */
+  uint32_t            npcm;        /* Frames waiting for a full block */
+  uint32_t            nframes;     /* Frames encoded, for the fact chunk */
+  struct adpcm_chan_s chan[ADPCM_MAX_CHANNELS];
+  int16_t             pcm[ADPCM_BLOCKSAMPLES * ADPCM_MAX_CHANNELS];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int    adpcm_init(FAR void **priv, uint8_t nchannels, uint8_t bpsamp,
+                         uint32_t samprate);
+static size_t adpcm_bound(FAR void *priv, size_t nbytes);
+static size_t adpcm_encode(FAR void *priv, FAR const uint8_t *in,
+                           size_t nbytes, FAR uint8_t *out);
+static size_t adpcm_flush(FAR void *priv, FAR uint8_t *out);
+static int    adpcm_header(FAR void *priv, int fd, uint32_t datasize);
+static void   adpcm_release(FAR void *priv);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const int8_t g_adpcm_index[16] =
+{
+  -1, -1, -1, -1, 2, 4, 6, 8,
+  -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int16_t g_adpcm_step[89] =
+{
+  7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+  45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190,
+  209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724,
+  796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272,
+  2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132,
+  7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+  22385, 24623, 27086, 29794, 32767
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+const struct nxrecorder_enc_ops_s g_nxrecorder_adpcm_ops =
+{
+  "adpcm",
+  adpcm_init,
+  adpcm_bound,
+  adpcm_encode,
+  adpcm_flush,
+  adpcm_header,
+  adpcm_release
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static FAR uint8_t *adpcm_put16(FAR uint8_t *p, uint16_t v)
+{
+  *p++ = v & 0xff;
+  *p++ = v >> 8;
+  return p;
+}
+
+static FAR uint8_t *adpcm_put32(FAR uint8_t *p, uint32_t v)
+{
+  p = adpcm_put16(p, v & 0xffff);
+  return adpcm_put16(p, v >> 16);
+}
+
+/****************************************************************************
+ * Name: adpcm_sample
+ *
+ * Description:
+ *   Encode one sample into a 4-bit code and step the channel state the
+ *   same way the decoder will.
+ *
+ ****************************************************************************/
+
+static inline uint8_t adpcm_sample(FAR struct adpcm_chan_s *chan,
+                                   int sample)
+{
+  int step = g_adpcm_step[chan->index];
+  int diff = sample - chan->predictor;
+  int vpdiff = step >> 3;
+  int pred;
+  int index;
+  uint8_t code = 0;
+
+  if (diff < 0)
+    {
+      code = 8;
+      diff = -diff;
+    }
+
+  if (diff >= step)
+    {
+      code   |= 4;
+      diff   -= step;
+      vpdiff += step;
+    }
+
+  step >>= 1;
+  if (diff >= step)
+    {
+      code   |= 2;
+      diff   -= step;
+      vpdiff += step;
+    }
+
+  step >>= 1;
+  if (diff >= step)
+    {
+      code   |= 1;
+      vpdiff += step;
+    }
+
+  pred = chan->predictor + ((code & 8) ? -vpdiff : vpdiff);
+  chan->predictor = pred > INT16_MAX ? INT16_MAX :
+                    pred < INT16_MIN ? INT16_MIN : pred;
+
+  index = chan->index + g_adpcm_index[code];
+  chan->index = index < 0 ? 0 : index > 88 ? 88 : index;
+
+  return code;
+}
+
+/****************************************************************************
+ * Name: adpcm_block
+ *
+ * Description:
+ *   Encode the full block of frames in pcm[] in the WAV IMA-ADPCM layout:
+ *   a 4 byte header per channel holding the first sample, then groups of
+ *   4 bytes (8 samples, low nibble first) alternating between channels.
+ *
+ ****************************************************************************/
+
+static void adpcm_block(FAR struct adpcm_s *adpcm, FAR uint8_t *out)
+{
+  FAR const int16_t *pcm = adpcm->pcm;
+  int nch = adpcm->nchannels;
+  int frame;
+  int ch;
+  int i;
+
+  for (ch = 0; ch < nch; ch++)
+    {
+      adpcm->chan[ch].predictor = pcm[ch];
+
+      out    = adpcm_put16(out, (uint16_t)pcm[ch]);
+      *out++ = adpcm->chan[ch].index;
+      *out++ = 0;
+    }
+
+  for (frame = 1; frame < ADPCM_BLOCKSAMPLES; frame += 8)
+    {
+      for (ch = 0; ch < nch; ch++)
+        {
+          FAR struct adpcm_chan_s *chan = &adpcm->chan[ch];
+          FAR const int16_t *src = &pcm[frame * nch + ch];
+
+          for (i = 0; i < 8; i += 2)
+            {
+              *out    = adpcm_sample(chan, src[i * nch]);
+              *out++ |= adpcm_sample(chan, src[(i + 1) * nch]) << 4;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: adpcm_init
+ ****************************************************************************/
+
+static int adpcm_init(FAR void **priv, uint8_t nchannels, uint8_t bpsamp,
+                      uint32_t samprate)
+{
+  FAR struct adpcm_s *adpcm;
+
+  if (bpsamp != 16 || nchannels == 0 || nchannels > ADPCM_MAX_CHANNELS)
+    {
+      return -EINVAL;
+    }
+
+  adpcm = zalloc(sizeof(*adpcm));
+  if (adpcm == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  adpcm->nchannels  = nchannels;
+  adpcm->samprate   = samprate;
+  adpcm->blockalign = CONFIG_NXRECORDER_ADPCM_BLOCKSIZE * nchannels;
+
+  *priv = adpcm;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: adpcm_bound
+ *
+ * Description:
+ *   Bytes adpcm_encode() produces at most for nbytes of PCM, whatever is
+ *   pending from earlier calls.  adpcm_bound(priv, 0) bounds adpcm_flush().
+ *
+ ****************************************************************************/
+
+static size_t adpcm_bound(FAR void *priv, size_t nbytes)
+{
+  FAR struct adpcm_s *adpcm = priv;
+  size_t frames = nbytes / (2 * adpcm->nchannels);
+
+  return (frames / ADPCM_BLOCKSAMPLES + 1) * adpcm->blockalign;
+}
+
+/****************************************************************************
+ * Name: adpcm_encode
+ ****************************************************************************/
+
+static size_t adpcm_encode(FAR void *priv, FAR const uint8_t *in,
+                           size_t nbytes, FAR uint8_t *out)
+{
+  FAR struct adpcm_s *adpcm = priv;
+  size_t framesize = 2 * adpcm->nchannels;
+  size_t frames = nbytes / framesize;
+  size_t produced = 0;
+  size_t n;
+
+  adpcm->nframes += frames;
+
+  while (frames > 0)
+    {
+      n = ADPCM_BLOCKSAMPLES - adpcm->npcm;
+      if (n > frames)
+        {
+          n = frames;
+        }
+
+      memcpy(&adpcm->pcm[adpcm->npcm * adpcm->nchannels], in,
+             n * framesize);
+
+      in          += n * framesize;
+      frames      -= n;
+      adpcm->npcm += n;
+
+      if (adpcm->npcm == ADPCM_BLOCKSAMPLES)
+        {
+          adpcm_block(adpcm, out + produced);
+          produced   += adpcm->blockalign;
+          adpcm->npcm = 0;
+        }
+    }
+
+  return produced;
+}
+
+/****************************************************************************
+ * Name: adpcm_flush
+ *
+ * Description:
+ *   Encode the last, partial block.  It is padded with its last frame, the
+ *   fact chunk tells the decoder where the recording really ends.
+ *
+ ****************************************************************************/
+
+static size_t adpcm_flush(FAR void *priv, FAR uint8_t *out)
+{
+  FAR struct adpcm_s *adpcm = priv;
+  int nch = adpcm->nchannels;
+  FAR int16_t *last;
+
+  if (adpcm->npcm == 0)
+    {
+      return 0;
+    }
+
+  last = &adpcm->pcm[(adpcm->npcm - 1) * nch];
+  for (; adpcm->npcm < ADPCM_BLOCKSAMPLES; adpcm->npcm++)
+    {
+      memcpy(&adpcm->pcm[adpcm->npcm * nch], last, nch * sizeof(int16_t));
+    }
+
+  adpcm_block(adpcm, out);
+  adpcm->npcm = 0;
+  return adpcm->blockalign;
+}
+
+/****************************************************************************
+ * Name: adpcm_header
+ *
+ * Description:
+ *   Write the RIFF/WAVE header for datasize bytes of IMA-ADPCM at the start
+ *   of the file, leaving the file position at its end.
+ *
+ ****************************************************************************/
+
+static int adpcm_header(FAR void *priv, int fd, uint32_t datasize)
+{
+  FAR struct adpcm_s *adpcm = priv;
+  uint8_t header[ADPCM_HEADER_SIZE];
+  FAR uint8_t *p = header;
+  int ret;
+
+  memcpy(p, "RIFF", 4);
+  p = adpcm_put32(p + 4, ADPCM_HEADER_SIZE - 8 + datasize);
+  memcpy(p, "WAVEfmt ", 8);
+  p = adpcm_put32(p + 8, 20);
+  p = adpcm_put16(p, ADPCM_WAVE_FORMAT);
+  p = adpcm_put16(p, adpcm->nchannels);
+  p = adpcm_put32(p, adpcm->samprate);
+  p = adpcm_put32(p, (uint64_t)adpcm->samprate * adpcm->blockalign /
+                     ADPCM_BLOCKSAMPLES);
+  p = adpcm_put16(p, adpcm->blockalign);
+  p = adpcm_put16(p, 4);
+  p = adpcm_put16(p, 2);
+  p = adpcm_put16(p, ADPCM_BLOCKSAMPLES);
+  memcpy(p, "fact", 4);
+  p = adpcm_put32(p + 4, 4);
+  p = adpcm_put32(p, adpcm->nframes);
+  memcpy(p, "data", 4);
+  adpcm_put32(p + 4, datasize);
+
+  if (lseek(fd, 0, SEEK_SET) < 0)
+    {
+      return -errno;
+    }
+
+  ret = write(fd, header, sizeof(header));
+  if (ret != sizeof(header))
+    {
+      return ret < 0 ? -errno : -EIO;
+    }
+
+  return lseek(fd, 0, SEEK_END) < 0 ? -errno : OK;
+}
+
+/****************************************************************************
+ * Name: adpcm_release
+ ****************************************************************************/
+
+static void adpcm_release(FAR void *priv)
+{
+  free(priv);
+}
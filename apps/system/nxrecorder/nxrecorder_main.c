@@ -26,9 +26,11 @@
 #include <nuttx/audio/audio.h>
 
 #include <sys/types.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <errno.h>
 #include <assert.h>
@@ -48,6 +50,9 @@
 #  define NXRECORDER_HELP_TEXT(x)
 #endif
 
+#define NXRECORDER_BENCH_CHUNK   4096    /* PCM bytes per encode call */
+#define NXRECORDER_BENCH_SECONDS 10      /* Seconds of audio encoded */
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -73,6 +78,13 @@ static int nxrecorder_cmd_record(FAR struct nxrecorder_s *precorder,
 static int nxrecorder_cmd_device(FAR struct nxrecorder_s *precorder,
                                  FAR char *parg);
 
+#ifdef CONFIG_NXRECORDER_ENCODER
+static int nxrecorder_cmd_encoder(FAR struct nxrecorder_s *precorder,
+                                  FAR char *parg);
+static int nxrecorder_cmd_encbench(FAR struct nxrecorder_s *precorder,
+                                   FAR char *parg);
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
 static int nxrecorder_cmd_pause(FAR struct nxrecorder_s *precorder,
                                 FAR char *parg);
@@ -102,6 +114,20 @@ static const struct mp_cmd_s g_nxrecorder_cmds[] =
     nxrecorder_cmd_device,
     NXRECORDER_HELP_TEXT("Specify a preferred audio device")
   },
+#ifdef CONFIG_NXRECORDER_ENCODER
+  {
+    "encbench",
+    "name rate channels",
+    nxrecorder_cmd_encbench,
+    NXRECORDER_HELP_TEXT("Measure the encode cost per second of audio")
+  },
+  {
+    "encoder",
+    "none|adpcm",
+    nxrecorder_cmd_encoder,
+    NXRECORDER_HELP_TEXT("Select the encoder of 16-bit PCM recordings")
+  },
+#endif
 #ifdef CONFIG_NXRECORDER_INCLUDE_HELP
   {
     "h",
@@ -310,6 +336,138 @@ static int nxrecorder_cmd_record(FAR struct nxrecorder_s *precorder,
   return ret;
 }
 
+/****************************************************************************
+ * Name: nxrecorder_cmd_encoder
+ *
+ *   nxrecorder_cmd_encoder() selects the encoder of the following
+ *   recordings.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ENCODER
+static int nxrecorder_cmd_encoder(FAR struct nxrecorder_s *precorder,
+                                  FAR char *parg)
+{
+  int ret;
+
+  if (parg == NULL || *parg == '\0')
+    {
+      printf("encoder: %s\n", precorder->enc ? precorder->enc->name :
+                                               "none");
+      return OK;
+    }
+
+  ret = nxrecorder_setencoder(precorder, parg);
+  if (ret == -ENOENT)
+    {
+      printf("Unknown encoder %s\n", parg);
+    }
+  else if (ret == -EBUSY)
+    {
+      printf("Recording, stop first\n");
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_cmd_encbench
+ *
+ *   nxrecorder_cmd_encbench() encodes NXRECORDER_BENCH_SECONDS of a
+ *   synthetic 16-bit signal and reports the CPU time it takes per second
+ *   of audio and the size reduction.
+ *
+ ****************************************************************************/
+
+static int nxrecorder_cmd_encbench(FAR struct nxrecorder_s *precorder,
+                                   FAR char *parg)
+{
+  FAR const struct nxrecorder_enc_ops_s *enc;
+  FAR int16_t *pcm;
+  FAR uint8_t *out;
+  FAR void *priv;
+  struct timespec start;
+  struct timespec end;
+  char name[16] = "adpcm";
+  int channels = 1;
+  int samprate = 16000;
+  uint64_t total;
+  uint64_t done = 0;
+  uint64_t encoded = 0;
+  uint64_t elapsed = 0;
+  uint32_t seed = 1;
+  uint32_t phase = 0;
+  int ret;
+  int i;
+
+  sscanf(parg, "%15s %d %d", name, &samprate, &channels);
+
+  enc = nxrecorder_getencoder(name);
+  if (enc == NULL || samprate <= 0)
+    {
+      printf("Unknown encoder %s\n", name);
+      return -EINVAL;
+    }
+
+  ret = enc->init(&priv, channels, 16, samprate);
+  if (ret < 0)
+    {
+      printf("%s: %d channels not supported\n", name, channels);
+      return ret;
+    }
+
+  pcm = malloc(NXRECORDER_BENCH_CHUNK);
+  out = malloc(enc->bound(priv, NXRECORDER_BENCH_CHUNK));
+  if (pcm == NULL || out == NULL)
+    {
+      ret = -ENOMEM;
+      goto out;
+    }
+
+  total = (uint64_t)NXRECORDER_BENCH_SECONDS * samprate * channels * 2;
+
+  while (done < total)
+    {
+      /* A triangle sweep plus noise, so the step size keeps adapting */
+
+      for (i = 0; i < NXRECORDER_BENCH_CHUNK / 2; i++)
+        {
+          seed  = seed * 1103515245 + 12345;
+          phase += 300 + (done >> 12);
+          pcm[i] = (int16_t)((phase & 0x8000 ? 0xffff - (phase & 0xffff) :
+                              (phase & 0xffff)) - 0x4000 +
+                             (int16_t)(seed >> 16) / 16);
+        }
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      encoded += enc->encode(priv, (FAR const uint8_t *)pcm,
+                             NXRECORDER_BENCH_CHUNK, out);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+
+      elapsed += (end.tv_sec - start.tv_sec) * 1000000000ull +
+                 end.tv_nsec - start.tv_nsec;
+      done    += NXRECORDER_BENCH_CHUNK;
+    }
+
+  encoded += enc->flush(priv, out);
+
+  printf("%s: %d Hz, %d ch, %d s of audio\n", name, samprate, channels,
+         NXRECORDER_BENCH_SECONDS);
+  printf("  %" PRIu64 " us per second of audio (%" PRIu64 ".%02" PRIu64
+         "%% CPU)\n", elapsed / 1000 / NXRECORDER_BENCH_SECONDS,
+         elapsed / 10000000 / NXRECORDER_BENCH_SECONDS,
+         elapsed / 100000 / NXRECORDER_BENCH_SECONDS % 100);
+  printf("  %" PRIu64 " -> %" PRIu64 " bytes, %" PRIu64 ".%02" PRIu64
+         ":1\n", done, encoded, done / encoded, done * 100 / encoded % 100);
+
+out:
+  free(out);
+  free(pcm);
+  enc->release(priv);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: nxrecorder_cmd_stop
  *
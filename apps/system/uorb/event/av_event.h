@@ -0,0 +1,77 @@
+/****************************************************************************
+ * apps/system/uorb/event/av_event.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_UORB_EVENT_AV_EVENT_H
+#define __APPS_SYSTEM_UORB_EVENT_AV_EVENT_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <uORB/uORB.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Event sources */
+
+#define AV_EVENT_SOURCE_AUDIO   1
+#define AV_EVENT_SOURCE_CAMERA  2
+
+/* Camera event types (audio types are the detector's own, e.g.
+ * APS_SOUND_EVENT_xxx of aps_cxx_audio_detect)
+ */
+
+#define AV_EVENT_MOTION         1
+
+/* Suggested queue depth for advertisers, so that a burst of events is not
+ * overwritten before a subscriber running at frame rate picks it up.
+ */
+
+#define AV_EVENT_QUEUE_SIZE     4
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Audio/video event shared between applications. Payload is kept small so
+ * that publishing stays cheap on the hot path of either producer.
+ */
+
+struct av_event
+{
+  uint64_t timestamp;   /* Time the event happened (us, CLOCK_MONOTONIC) */
+  uint32_t seq;         /* Per-publisher sequence number */
+  uint8_t  source;      /* AV_EVENT_SOURCE_xxx */
+  uint8_t  type;        /* Source specific event type */
+  uint16_t score;       /* Source specific strength (dB, percent, ...) */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* register this as object request broker structure */
+
+ORB_DECLARE(event_audio);
+ORB_DECLARE(event_motion);
+
+#endif
@@ -0,0 +1,129 @@
+/****************************************************************************
+ * apps/system/uorb/hub/attitude.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <math.h>
+
+#include "attitude.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+void attitude_init(FAR struct attitude_s *att, float beta)
+{
+  att->q[0] = 1.0f;
+  att->q[1] = 0.0f;
+  att->q[2] = 0.0f;
+  att->q[3] = 0.0f;
+  att->beta = beta;
+}
+
+void attitude_update(FAR struct attitude_s *att, FAR const float *gyro,
+                     FAR const float *accel, float dt)
+{
+  float q0 = att->q[0];
+  float q1 = att->q[1];
+  float q2 = att->q[2];
+  float q3 = att->q[3];
+  float ax = accel[0];
+  float ay = accel[1];
+  float az = accel[2];
+  float qdot0;
+  float qdot1;
+  float qdot2;
+  float qdot3;
+  float norm;
+
+  /* Rate of change of the quaternion from the gyroscope */
+
+  qdot0 = 0.5f * (-q1 * gyro[0] - q2 * gyro[1] - q3 * gyro[2]);
+  qdot1 = 0.5f * (q0 * gyro[0] + q2 * gyro[2] - q3 * gyro[1]);
+  qdot2 = 0.5f * (q0 * gyro[1] - q1 * gyro[2] + q3 * gyro[0]);
+  qdot3 = 0.5f * (q0 * gyro[2] + q1 * gyro[1] - q2 * gyro[0]);
+
+  norm = ax * ax + ay * ay + az * az;
+  if (norm > 0.0f)
+    {
+      float q0q0 = q0 * q0;
+      float q1q1 = q1 * q1;
+      float q2q2 = q2 * q2;
+      float q3q3 = q3 * q3;
+      float s0;
+      float s1;
+      float s2;
+      float s3;
+
+      norm = 1.0f / sqrtf(norm);
+      ax *= norm;
+      ay *= norm;
+      az *= norm;
+
+      /* Gradient of the error between measured and predicted gravity */
+
+      s0 = 4.0f * q0 * (q2q2 + q1q1) + 2.0f * (q2 * ax - q1 * ay);
+      s1 = 4.0f * q1 * (q3q3 + q0q0 - 1.0f + 2.0f * (q1q1 + q2q2) + az)
+           - 2.0f * (q3 * ax + q0 * ay);
+      s2 = 4.0f * q2 * (q3q3 + q0q0 - 1.0f + 2.0f * (q1q1 + q2q2) + az)
+           + 2.0f * (q0 * ax - q3 * ay);
+      s3 = 4.0f * q3 * (q1q1 + q2q2) - 2.0f * (q1 * ax + q2 * ay);
+
+      norm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+      if (norm > 0.0f)
+        {
+          norm = att->beta / sqrtf(norm);
+          qdot0 -= norm * s0;
+          qdot1 -= norm * s1;
+          qdot2 -= norm * s2;
+          qdot3 -= norm * s3;
+        }
+    }
+
+  q0 += qdot0 * dt;
+  q1 += qdot1 * dt;
+  q2 += qdot2 * dt;
+  q3 += qdot3 * dt;
+
+  norm = 1.0f / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+  att->q[0] = q0 * norm;
+  att->q[1] = q1 * norm;
+  att->q[2] = q2 * norm;
+  att->q[3] = q3 * norm;
+}
+
+void attitude_euler(FAR const struct attitude_s *att, FAR float *roll,
+                    FAR float *pitch, FAR float *yaw)
+{
+  FAR const float *q = att->q;
+  float sinp;
+
+  *roll = atan2f(2.0f * (q[0] * q[1] + q[2] * q[3]),
+                 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]));
+
+  sinp = 2.0f * (q[0] * q[2] - q[3] * q[1]);
+  *pitch = fabsf(sinp) >= 1.0f ? copysignf((float)M_PI / 2, sinp) :
+                                 asinf(sinp);
+
+  *yaw = atan2f(2.0f * (q[0] * q[3] + q[1] * q[2]),
+                1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3]));
+}
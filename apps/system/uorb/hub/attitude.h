@@ -0,0 +1,77 @@
+/****************************************************************************
+ * apps/system/uorb/hub/attitude.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_UORB_HUB_ATTITUDE_H
+#define __APPS_SYSTEM_UORB_HUB_ATTITUDE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Madgwick IMU filter, the one examples/bmi160_orientation runs */
+
+struct attitude_s
+{
+  float q[4];                   /* Sensor to earth rotation, w x y z */
+  float beta;                   /* Accelerometer correction gain */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: attitude_init
+ *
+ * Description:
+ *   Start from the identity rotation.
+ ****************************************************************************/
+
+void attitude_init(FAR struct attitude_s *att, float beta);
+
+/****************************************************************************
+ * Name: attitude_update
+ *
+ * Description:
+ *   Integrate one gyro sample (rad/s) over dt seconds, pulled towards the
+ *   gravity direction measured by the accelerometer (any unit). An
+ *   all-zero accel sample skips the correction.
+ ****************************************************************************/
+
+void attitude_update(FAR struct attitude_s *att, FAR const float *gyro,
+                     FAR const float *accel, float dt);
+
+/****************************************************************************
+ * Name: attitude_euler
+ *
+ * Description:
+ *   Convert the rotation to roll, pitch and yaw in radians.
+ ****************************************************************************/
+
+void attitude_euler(FAR const struct attitude_s *att, FAR float *roll,
+                    FAR float *pitch, FAR float *yaw);
+
+#endif
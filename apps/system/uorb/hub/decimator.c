@@ -0,0 +1,200 @@
+/****************************************************************************
+ * apps/system/uorb/hub/decimator.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "decimator.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Taps per decimation step. With the Hamming window, aliases from above
+ * 1.2 times the output Nyquist frequency are ~25 dB down, from above 1.4
+ * times it more than 50 dB, as long as CONFIG_UORB_HUB_MAXTAPS doesn't
+ * cut the filter short.
+ */
+
+#define DECIM_TAPS_PER_PHASE  6
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void decim_push(FAR struct decim_s *d, FAR const float *v,
+                       uint64_t ts)
+{
+  unsigned int c;
+
+  for (c = 0; c < d->nch; c++)
+    {
+      d->hist[c][d->pos] = v[c];
+      d->hist[c][d->pos + d->ntaps] = v[c];
+    }
+
+  d->ts[d->pos] = ts;
+
+  if (++d->pos == d->ntaps)
+    {
+      d->pos = 0;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int decim_init(FAR struct decim_s *d, unsigned int factor, size_t offset,
+               unsigned int nch)
+{
+  float fc;
+  float sum = 0.0f;
+  float x;
+  int centre;
+  int k;
+
+  if (factor == 0 || nch == 0 || nch > DECIM_MAX_CHANNELS)
+    {
+      return -EINVAL;
+    }
+
+  memset(d, 0, sizeof(*d));
+  d->factor = factor;
+  d->offset = offset;
+  d->nch    = nch;
+  d->ntaps  = DECIM_TAPS_PER_PHASE * factor + 1;
+
+  if (factor == 1)
+    {
+      d->ntaps   = 1;
+      d->taps[0] = 1.0f;
+      return 0;
+    }
+
+  if (d->ntaps > CONFIG_UORB_HUB_MAXTAPS)
+    {
+      d->ntaps = (CONFIG_UORB_HUB_MAXTAPS - 1) | 1;
+    }
+
+  /* Cutoff in cycles per input sample */
+
+  fc     = 0.4f / factor;
+  centre = d->ntaps / 2;
+
+  for (k = 0; k < d->ntaps; k++)
+    {
+      x = (float)(k - centre);
+      d->taps[k] = k == centre ? 2.0f * fc :
+                   sinf(2.0f * (float)M_PI * fc * x) / ((float)M_PI * x);
+      d->taps[k] *= 0.54f - 0.46f * cosf(2.0f * (float)M_PI * k /
+                                         (d->ntaps - 1));
+      sum += d->taps[k];
+    }
+
+  /* Unity gain at DC */
+
+  for (k = 0; k < d->ntaps; k++)
+    {
+      d->taps[k] /= sum;
+    }
+
+  return 0;
+}
+
+unsigned int decim_process(FAR struct decim_s *d, FAR const void *in,
+                           size_t esize, unsigned int n, FAR void *out)
+{
+  FAR const uint8_t *src = in;
+  FAR uint8_t *dst = out;
+  float v[DECIM_MAX_CHANNELS];
+  FAR const float *h;
+  uint64_t ts;
+  unsigned int nout = 0;
+  unsigned int c;
+  unsigned int i;
+  unsigned int k;
+  float acc;
+
+  for (i = 0; i < n; i++, src += esize)
+    {
+      memcpy(&ts, src, sizeof(ts));
+      memcpy(v, src + d->offset, d->nch * sizeof(float));
+
+      /* Start from a history full of the first sample rather than of
+       * zeros, or e.g. gravity would ramp up through the first outputs.
+       */
+
+      if (!d->primed)
+        {
+          for (k = 0; k < d->ntaps; k++)
+            {
+              decim_push(d, v, ts);
+            }
+
+          d->primed = true;
+          d->phase  = d->factor - 1;
+        }
+      else
+        {
+          decim_push(d, v, ts);
+        }
+
+      if (++d->phase < d->factor)
+        {
+          continue;
+        }
+
+      d->phase = 0;
+
+      /* The taps are symmetric, their order against the window doesn't
+       * matter.
+       */
+
+      for (c = 0; c < d->nch; c++)
+        {
+          h   = &d->hist[c][d->pos];
+          acc = 0.0f;
+
+          for (k = 0; k < d->ntaps; k++)
+            {
+              acc += d->taps[k] * h[k];
+            }
+
+          v[c] = acc;
+        }
+
+      ts = d->ts[(d->pos + d->ntaps / 2) % d->ntaps];
+
+      memcpy(dst, src, esize);
+      memcpy(dst, &ts, sizeof(ts));
+      memcpy(dst + d->offset, v, d->nch * sizeof(float));
+      dst += esize;
+      nout++;
+    }
+
+  return nout;
+}
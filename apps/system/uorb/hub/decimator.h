@@ -0,0 +1,116 @@
+/****************************************************************************
+ * apps/system/uorb/hub/decimator.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_UORB_HUB_DECIMATOR_H
+#define __APPS_SYSTEM_UORB_HUB_DECIMATOR_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_UORB_HUB_MAXTAPS
+#  define CONFIG_UORB_HUB_MAXTAPS 128
+#endif
+
+#define DECIM_MAX_CHANNELS  4
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Low-pass decimating FIR over the float channels of a sensor sample.
+ * Only every factor-th output is computed, which is what the polyphase
+ * form saves; the history is stored twice so that the window of the
+ * newest ntaps samples is always contiguous.
+ */
+
+struct decim_s
+{
+  unsigned int factor;          /* Keep one output per factor inputs */
+  unsigned int ntaps;           /* Odd, so the delay is whole samples */
+  unsigned int nch;             /* Float channels per sample */
+  size_t       offset;          /* Byte offset of the first channel */
+  unsigned int pos;             /* Oldest sample of the window */
+  unsigned int phase;           /* Inputs since the last output */
+  bool         primed;          /* History holds real samples */
+  float        taps[CONFIG_UORB_HUB_MAXTAPS];
+  float        hist[DECIM_MAX_CHANNELS][2 * CONFIG_UORB_HUB_MAXTAPS];
+  uint64_t     ts[CONFIG_UORB_HUB_MAXTAPS];
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: decim_init
+ *
+ * Description:
+ *   Design a Hamming windowed-sinc low-pass with its cutoff at 80% of the
+ *   output Nyquist frequency, as long as CONFIG_UORB_HUB_MAXTAPS allows,
+ *   and reset the history. factor 1 passes samples through.
+ *
+ * Input Parameters:
+ *   d       Decimator state.
+ *   factor  Decimation factor, input rate / output rate.
+ *   offset  Byte offset of the first float channel in a sample.
+ *   nch     Number of consecutive float channels to filter.
+ *
+ * Returned Value:
+ *   0 on success, -EINVAL if nch or factor is out of range.
+ ****************************************************************************/
+
+int decim_init(FAR struct decim_s *d, unsigned int factor, size_t offset,
+               unsigned int nch);
+
+/****************************************************************************
+ * Name: decim_process
+ *
+ * Description:
+ *   Filter a batch of samples. Each output is a copy of the input sample
+ *   it was computed at, with the filtered channels and the timestamp of
+ *   the sample at the centre of the window, so that consumers see the
+ *   filter delay in the time stamp instead of as an error.
+ *
+ * Input Parameters:
+ *   d      Decimator state.
+ *   in     Samples, starting with their uint64_t timestamp.
+ *   esize  Size of one sample.
+ *   n      Number of input samples.
+ *   out    Output samples, room for n / factor + 1 of them.
+ *
+ * Returned Value:
+ *   The number of output samples.
+ ****************************************************************************/
+
+unsigned int decim_process(FAR struct decim_s *d, FAR const void *in,
+                           size_t esize, unsigned int n, FAR void *out);
+
+#endif
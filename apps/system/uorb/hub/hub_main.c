@@ -0,0 +1,514 @@
+/****************************************************************************
+ * apps/system/uorb/hub/hub_main.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <unistd.h>
+
+#include <hub/hub_topics.h>
+#include <sensor/accel.h>
+#include <sensor/baro.h>
+#include <sensor/gyro.h>
+#include <sensor/mag.h>
+#include <uORB/uORB.h>
+
+#include "attitude.h"
+#include "decimator.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_UORB_HUB_RATE
+#  define CONFIG_UORB_HUB_RATE 50
+#endif
+
+#define HUB_BATCH           32
+#define HUB_RATE_SAMPLES    32    /* Timed to measure the input rate */
+#define HUB_FUSION_NACCEL   (2 * HUB_BATCH)
+#define HUB_POLL_TIMEOUT    100   /* ms, granularity of Ctrl+C */
+#define HUB_DEFAULT_BETA    0.1f
+#define HUB_MAX_DT          100000 /* us, longer gaps restart integration */
+
+#define HUB_ACCEL           0
+#define HUB_GYRO            1
+#define HUB_NSTREAMS        4
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+union hub_sample_u
+{
+  struct sensor_accel accel;
+  struct sensor_gyro  gyro;
+  struct sensor_mag   mag;
+  struct sensor_baro  baro;
+};
+
+/* A raw topic and the decimated copy published from it */
+
+struct hub_stream_s
+{
+  FAR const struct orb_metadata *in;
+  FAR const struct orb_metadata *out;
+  size_t            offset;       /* First float channel of a sample */
+  unsigned int      nch;          /* Consecutive float channels */
+  int               fd;           /* Subscription, -1 if not running */
+  int               pub;          /* Advertiser of the derived topic */
+  struct orb_batch  batch;
+  struct decim_s    decim;
+  bool              ready;        /* Input rate known, filter designed */
+  uint64_t          first;        /* Time stamp of the first sample */
+  uint32_t          rate;         /* Measured input rate (Hz) */
+  unsigned long     nin;
+  unsigned long     nout;
+  unsigned long     lost;
+};
+
+/* Attitude from accel and gyro at their full rate */
+
+struct hub_fusion_s
+{
+  struct attitude_s   att;
+  int                 pub;
+  struct sensor_accel accel[HUB_FUSION_NACCEL]; /* Not yet fused */
+  unsigned int        naccel;
+  float               cur[3];     /* Accel in use */
+  uint64_t            last;       /* Time stamp of the last gyro sample */
+  uint64_t            next;       /* When to publish again */
+  uint32_t            period;     /* Output period (us) */
+  unsigned long       nout;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static volatile bool g_hub_exit;
+
+/* Large (filter history), kept off the stack. The x, y, z, temperature
+ * and pressure, temperature members are consecutive floats in
+ * nuttx/sensors/sensor.h.
+ */
+
+static struct hub_stream_s g_hub_streams[HUB_NSTREAMS] =
+{
+  {
+    ORB_ID(sensor_accel), ORB_ID(hub_accel),
+    offsetof(struct sensor_accel, x), 4
+  },
+  {
+    ORB_ID(sensor_gyro), ORB_ID(hub_gyro),
+    offsetof(struct sensor_gyro, x), 4
+  },
+  {
+    ORB_ID(sensor_mag), ORB_ID(hub_mag),
+    offsetof(struct sensor_mag, x), 4
+  },
+  {
+    ORB_ID(sensor_baro), ORB_ID(hub_baro),
+    offsetof(struct sensor_baro, pressure), 2
+  },
+};
+
+static struct hub_fusion_s g_hub_fusion;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void hub_exit_handler(int signo)
+{
+  g_hub_exit = true;
+}
+
+static void hub_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-r rate] [-i instance] [-b beta] [-n]\n"
+         "Publish low-pass filtered, decimated copies of the raw sensor\n"
+         "topics (hub_accel, hub_gyro, hub_mag, hub_baro) and the attitude\n"
+         "fused from accel and gyro (hub_attitude).\n"
+         "  -r  Output rate in Hz (default %d)\n"
+         "  -i  Instance of the raw topics (default 0)\n"
+         "  -b  Madgwick filter gain (default %.2f)\n"
+         "  -n  No attitude\n",
+         progname, CONFIG_UORB_HUB_RATE, HUB_DEFAULT_BETA);
+}
+
+/****************************************************************************
+ * Name: hub_decimate
+ *
+ * Description:
+ *   Filter a batch of raw samples and publish the outputs. The first
+ *   samples only time the input, the filter is designed for the measured
+ *   rate.
+ ****************************************************************************/
+
+static void hub_decimate(FAR struct hub_stream_s *st,
+                         FAR const union hub_sample_u *in, unsigned int n,
+                         uint32_t rate)
+{
+  static union hub_sample_u out[HUB_BATCH + 1];
+  FAR const uint8_t *src = (FAR const uint8_t *)in;
+  FAR const uint8_t *dst = (FAR const uint8_t *)out;
+  size_t esize = st->in->o_size;
+  unsigned int nout;
+  uint64_t ts;
+
+  if (!st->ready)
+    {
+      if (st->nin == n)
+        {
+          memcpy(&st->first, src, sizeof(st->first));
+        }
+
+      memcpy(&ts, src + (n - 1) * esize, sizeof(ts));
+      if (st->nin < HUB_RATE_SAMPLES || ts <= st->first)
+        {
+          return;
+        }
+
+      st->rate  = (uint32_t)((st->nin - 1) * 1000000ull / (ts - st->first));
+      st->ready = decim_init(&st->decim, MAX((st->rate + rate / 2) / rate,
+                                              1), st->offset, st->nch) == 0;
+      if (!st->ready)
+        {
+          return;
+        }
+
+      printf("%s: %" PRIu32 " Hz -> %" PRIu32 " Hz, %u taps\n",
+             st->in->o_name, st->rate, st->rate / st->decim.factor,
+             st->decim.ntaps);
+      return;
+    }
+
+  /* Outputs are packed at the size of the topic, not of the union */
+
+  nout = decim_process(&st->decim, src, esize, n, out);
+  for (; nout > 0; nout--, dst += esize)
+    {
+      if (orb_publish(st->out, st->pub, dst) == OK)
+        {
+          st->nout++;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: hub_fusion_accel
+ *
+ * Description:
+ *   Queue accel samples until the gyro samples of the same time come in.
+ *   On overflow the oldest become the accel in use.
+ ****************************************************************************/
+
+static void hub_fusion_accel(FAR struct hub_fusion_s *f,
+                             FAR const union hub_sample_u *in,
+                             unsigned int n)
+{
+  unsigned int i;
+
+  for (i = 0; i < n; i++)
+    {
+      if (f->naccel == HUB_FUSION_NACCEL)
+        {
+          f->cur[0] = f->accel[0].x;
+          f->cur[1] = f->accel[0].y;
+          f->cur[2] = f->accel[0].z;
+          f->naccel--;
+          memmove(f->accel, f->accel + 1, f->naccel * sizeof(f->accel[0]));
+        }
+
+      f->accel[f->naccel++] = in[i].accel;
+    }
+}
+
+/****************************************************************************
+ * Name: hub_fusion_gyro
+ *
+ * Description:
+ *   Run the filter on each gyro sample, corrected with the latest accel
+ *   sample not newer than it, and publish at the output rate.
+ ****************************************************************************/
+
+static void hub_fusion_gyro(FAR struct hub_fusion_s *f,
+                            FAR const union hub_sample_u *in,
+                            unsigned int n)
+{
+  FAR const struct sensor_gyro *g;
+  struct hub_attitude out;
+  unsigned int used = 0;
+  unsigned int i;
+
+  for (i = 0; i < n; i++)
+    {
+      g = &in[i].gyro;
+
+      while (used < f->naccel && f->accel[used].timestamp <= g->timestamp)
+        {
+          f->cur[0] = f->accel[used].x;
+          f->cur[1] = f->accel[used].y;
+          f->cur[2] = f->accel[used].z;
+          used++;
+        }
+
+      if (f->last != 0 && g->timestamp > f->last &&
+          g->timestamp - f->last < HUB_MAX_DT)
+        {
+          attitude_update(&f->att, &g->x, f->cur,
+                          (g->timestamp - f->last) * 1e-6f);
+        }
+
+      f->last = g->timestamp;
+
+      if (g->timestamp < f->next)
+        {
+          continue;
+        }
+
+      f->next = MAX(f->next + f->period, g->timestamp);
+
+      out.timestamp = g->timestamp;
+      memcpy(out.q, f->att.q, sizeof(out.q));
+      attitude_euler(&f->att, &out.roll, &out.pitch, &out.yaw);
+
+      if (orb_publish(ORB_ID(hub_attitude), f->pub, &out) == OK)
+        {
+          f->nout++;
+        }
+    }
+
+  f->naccel -= used;
+  memmove(f->accel, f->accel + used, f->naccel * sizeof(f->accel[0]));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  static union hub_sample_u buffer[HUB_BATCH];
+  struct pollfd fds[HUB_NSTREAMS];
+  FAR struct hub_stream_s *st;
+  FAR struct hub_fusion_s *fusion = &g_hub_fusion;
+  unsigned long wakeups = 0;
+  uint32_t rate = CONFIG_UORB_HUB_RATE;
+  float beta = HUB_DEFAULT_BETA;
+  bool attitude = true;
+  orb_abstime start;
+  ssize_t n;
+  int instance = 0;
+  int nfds = 0;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "r:i:b:nh")) != -1)
+    {
+      switch (opt)
+        {
+          case 'r':
+            rate = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'i':
+            instance = strtol(optarg, NULL, 0);
+            break;
+
+          case 'b':
+            beta = atof(optarg);
+            break;
+
+          case 'n':
+            attitude = false;
+            break;
+
+          default:
+            hub_usage(argv[0]);
+            return opt == 'h' ? 0 : -EINVAL;
+        }
+    }
+
+  if (rate == 0 || rate > 1000000 || instance < 0)
+    {
+      hub_usage(argv[0]);
+      return -EINVAL;
+    }
+
+  /* Subscribe to what this board has. With a batch interval of one output
+   * period, drivers that can buffer (sensor FIFOs) wake us once per output
+   * sample instead of once per raw one.
+   */
+
+  for (i = 0; i < HUB_NSTREAMS; i++)
+    {
+      st = &g_hub_streams[i];
+      st->fd  = -1;
+      st->pub = -1;
+      fds[i].fd     = -1;
+      fds[i].events = POLLIN;
+
+      if (orb_exists(st->in, instance) != 0)
+        {
+          continue;
+        }
+
+      st->fd = orb_subscribe_multi(st->in, instance);
+      if (st->fd < 0)
+        {
+          fprintf(stderr, "%s%d: subscribe failed (%d)\n", st->in->o_name,
+                  instance, errno);
+          continue;
+        }
+
+      orb_set_batch_interval(st->fd, 1000000 / rate);
+
+      st->pub = orb_advertise_multi_queue(st->out, NULL, &instance, 1);
+      if (st->pub < 0)
+        {
+          fprintf(stderr, "%s%d: advertise failed (%d)\n", st->out->o_name,
+                  instance, errno);
+          orb_unsubscribe(st->fd);
+          st->fd = -1;
+          continue;
+        }
+
+      memset(&st->batch, 0, sizeof(st->batch));
+      st->ready = false;
+      st->nin   = 0;
+      st->nout  = 0;
+      st->lost  = 0;
+      fds[i].fd = st->fd;
+      nfds++;
+    }
+
+  if (nfds == 0)
+    {
+      fprintf(stderr, "no sensor at instance %d\n", instance);
+      return -ENOENT;
+    }
+
+  if (g_hub_streams[HUB_ACCEL].fd < 0 || g_hub_streams[HUB_GYRO].fd < 0)
+    {
+      attitude = false;
+    }
+
+  if (attitude)
+    {
+      memset(fusion, 0, sizeof(*fusion));
+      attitude_init(&fusion->att, beta);
+      fusion->period = 1000000 / rate;
+      fusion->pub = orb_advertise_multi_queue(ORB_ID(hub_attitude), NULL,
+                                              &instance, 1);
+      if (fusion->pub < 0)
+        {
+          fprintf(stderr, "hub_attitude%d: advertise failed (%d)\n",
+                  instance, errno);
+          attitude = false;
+        }
+    }
+
+  g_hub_exit = false;
+  signal(SIGINT, hub_exit_handler);
+  start = orb_absolute_time();
+
+  while (!g_hub_exit)
+    {
+      if (poll(fds, HUB_NSTREAMS, HUB_POLL_TIMEOUT) <= 0)
+        {
+          continue;
+        }
+
+      wakeups++;
+
+      /* Streams are in table order, accel is queued before the gyro that
+       * consumes it.
+       */
+
+      for (i = 0; i < HUB_NSTREAMS; i++)
+        {
+          st = &g_hub_streams[i];
+          if ((fds[i].revents & POLLIN) == 0)
+            {
+              continue;
+            }
+
+          while ((n = orb_copy_batch(st->in, st->fd, buffer, HUB_BATCH,
+                                     &st->batch)) > 0)
+            {
+              st->nin  += n;
+              st->lost += st->batch.lost;
+
+              hub_decimate(st, buffer, n, rate);
+
+              if (attitude && i == HUB_ACCEL)
+                {
+                  hub_fusion_accel(fusion, buffer, n);
+                }
+              else if (attitude && i == HUB_GYRO)
+                {
+                  hub_fusion_gyro(fusion, buffer, n);
+                }
+
+              if (n < HUB_BATCH)
+                {
+                  break;
+                }
+            }
+        }
+    }
+
+  printf("%lu wakeups in %" PRIu64 " ms\n", wakeups,
+         (orb_absolute_time() - start) / 1000);
+
+  for (i = 0; i < HUB_NSTREAMS; i++)
+    {
+      st = &g_hub_streams[i];
+      if (st->fd < 0)
+        {
+          continue;
+        }
+
+      printf("  %s%d: %lu in, %lu lost, %lu out\n", st->in->o_name,
+             instance, st->nin, st->lost, st->nout);
+      orb_unadvertise(st->pub);
+      orb_unsubscribe(st->fd);
+    }
+
+  if (attitude)
+    {
+      printf("  hub_attitude%d: %lu out\n", instance, fusion->nout);
+      orb_unadvertise(fusion->pub);
+    }
+
+  return 0;
+}
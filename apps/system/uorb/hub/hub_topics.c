@@ -0,0 +1,83 @@
+/****************************************************************************
+ * apps/system/uorb/hub/hub_topics.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <hub/hub_topics.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_DEBUG_UORB
+static void print_hub_xyz_message(FAR const struct orb_metadata *meta,
+                                  FAR const void *buffer)
+{
+  FAR const struct sensor_accel *message = buffer;
+  const orb_abstime now = orb_absolute_time();
+
+  uorbinfo_raw("%s:\ttimestamp: %" PRIu64 " (%" PRIu64 " us ago) "
+               "temperature: %.2f x: %.2f y: %.2f z: %.2f",
+               meta->o_name, message->timestamp, now - message->timestamp,
+               message->temperature, message->x, message->y, message->z);
+}
+
+static void print_hub_baro_message(FAR const struct orb_metadata *meta,
+                                   FAR const void *buffer)
+{
+  FAR const struct sensor_baro *message = buffer;
+  const orb_abstime now = orb_absolute_time();
+
+  uorbinfo_raw("%s:\ttimestamp: %" PRIu64 " (%" PRIu64 " us ago) "
+               "temperature: %.2f pressure: %.2f",
+               meta->o_name, message->timestamp, now - message->timestamp,
+               message->temperature, message->pressure);
+}
+
+static void print_hub_attitude_message(FAR const struct orb_metadata *meta,
+                                       FAR const void *buffer)
+{
+  FAR const struct hub_attitude *message = buffer;
+  const orb_abstime now = orb_absolute_time();
+
+  uorbinfo_raw("%s:\ttimestamp: %" PRIu64 " (%" PRIu64 " us ago) "
+               "q: %.4f %.4f %.4f %.4f roll: %.3f pitch: %.3f yaw: %.3f",
+               meta->o_name, message->timestamp, now - message->timestamp,
+               message->q[0], message->q[1], message->q[2], message->q[3],
+               message->roll, message->pitch, message->yaw);
+}
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Hub and consumers share the address space: with CONFIG_UORB_FASTPATH,
+ * reading derived data costs no syscall at all.
+ */
+
+ORB_DEFINE_FAST(hub_accel, struct sensor_accel, print_hub_xyz_message);
+ORB_DEFINE_FAST(hub_gyro, struct sensor_gyro, print_hub_xyz_message);
+ORB_DEFINE_FAST(hub_mag, struct sensor_mag, print_hub_xyz_message);
+ORB_DEFINE_FAST(hub_baro, struct sensor_baro, print_hub_baro_message);
+ORB_DEFINE_FAST(hub_attitude, struct hub_attitude,
+                print_hub_attitude_message);
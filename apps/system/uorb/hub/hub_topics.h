@@ -0,0 +1,59 @@
+/****************************************************************************
+ * apps/system/uorb/hub/hub_topics.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_UORB_HUB_HUB_TOPICS_H
+#define __APPS_SYSTEM_UORB_HUB_HUB_TOPICS_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <uORB/uORB.h>
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Attitude fused by uorb_hub from the accel and gyro of one IMU */
+
+struct hub_attitude
+{
+  uint64_t timestamp;   /* Time of the last gyro sample fused (us) */
+  float    q[4];        /* Sensor to earth rotation, w x y z */
+  float    roll;        /* Euler angles (rad) */
+  float    pitch;
+  float    yaw;         /* Relative, drifts: no magnetometer correction */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Derived topics published by uorb_hub at its output rate. The decimated
+ * ones have the layout of the raw topic they come from.
+ */
+
+ORB_DECLARE(hub_accel);
+ORB_DECLARE(hub_gyro);
+ORB_DECLARE(hub_mag);
+ORB_DECLARE(hub_baro);
+ORB_DECLARE(hub_attitude);
+
+#endif
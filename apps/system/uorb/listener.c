@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/param.h>
 #include <unistd.h>
 #include <fcntl.h>
 
@@ -44,6 +45,7 @@
 
 #define ORB_MAX_PRINT_NAME 32
 #define ORB_TOP_WAIT_TIME  1000
+#define ORB_MAX_PRINT_BATCH 8
 
 /****************************************************************************
  * Private Types
@@ -55,6 +57,8 @@ struct listen_object_s
   struct orb_object object;       /* Object id */
   orb_abstime       timestamp;    /* Time of lastest generation  */
   unsigned long     generation;   /* Latest generation */
+  struct orb_batch  batch;        /* Gap tracking of the subscription */
+  unsigned long     lost;         /* Lost messages of the subscription */
 };
 
 /****************************************************************************
@@ -69,6 +73,9 @@ static void listener_delete_object_list(FAR struct list_node *objlist);
 static int listener_generate_object_list(FAR struct list_node *objlist,
                                          FAR const char *filter);
 static int listener_print(FAR const struct orb_metadata *meta, int fd);
+static int listener_print_batch(FAR const struct orb_metadata *meta, int fd,
+                                FAR struct listen_object_s *obj,
+                                FAR char *buffer, int nb_msgs);
 static void listener_monitor(FAR struct list_node *objlist, int nb_objects,
                              float topic_rate, int topic_latency,
                              int nb_msgs, int timeout);
@@ -473,6 +480,59 @@ static int listener_print(FAR const struct orb_metadata *meta, int fd)
   return ret;
 }
 
+/****************************************************************************
+ * Name: listener_print_batch
+ *
+ * Description:
+ *   Drain queued topic data and print each message by its print_message
+ *   callback, report messages lost since the last call.
+ *
+ * Input Parameters:
+ *   meta         The uORB metadata.
+ *   fd           Subscriber handle.
+ *   obj          Object of the subscription.
+ *   buffer       Room for ORB_MAX_PRINT_BATCH messages.
+ *   nb_msgs      Maximum number of messages to print.
+ *
+ * Returned Value:
+ *   Number of messages printed, otherwise -1
+ ****************************************************************************/
+
+static int listener_print_batch(FAR const struct orb_metadata *meta, int fd,
+                                FAR struct listen_object_s *obj,
+                                FAR char *buffer, int nb_msgs)
+{
+  int nmemb = MIN(nb_msgs, ORB_MAX_PRINT_BATCH);
+  int ret;
+
+  ret = orb_copy_batch(meta, fd, buffer, nmemb, &obj->batch);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (obj->batch.lost)
+    {
+      obj->lost += obj->batch.lost;
+      uorbinfo_raw("%s%d: %" PRIu32 " messages lost", meta->o_name,
+                   obj->object.instance, obj->batch.lost);
+    }
+
+#ifdef CONFIG_DEBUG_UORB
+  if (meta->o_cb != NULL)
+    {
+      int i;
+
+      for (i = 0; i < ret; i++)
+        {
+          meta->o_cb(meta, buffer + i * meta->o_size);
+        }
+    }
+#endif
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: listener_monitor
  *
@@ -497,6 +557,8 @@ static void listener_monitor(FAR struct list_node *objlist, int nb_objects,
 {
   FAR struct pollfd *fds;
   FAR int *recv_msgs;
+  FAR char *buffer = NULL;
+  size_t size = 0;
   float interval = topic_rate ? (1000000 / topic_rate) : 0;
   int nb_recv_msgs = 0;
   int i = 0;
@@ -522,6 +584,9 @@ static void listener_monitor(FAR struct list_node *objlist, int nb_objects,
     {
       int fd;
 
+      memset(&tmp->batch, 0, sizeof(tmp->batch));
+      tmp->lost = 0;
+
       fd = orb_subscribe_multi(tmp->object.meta, tmp->object.instance);
       if (fd < 0)
         {
@@ -560,9 +625,22 @@ static void listener_monitor(FAR struct list_node *objlist, int nb_objects,
       return;
     }
 
+  /* One batch buffer, sized for the largest topic, serves all objects */
+
+  list_for_every_entry(objlist, tmp, struct listen_object_s, node)
+    {
+      size = MAX(size, tmp->object.meta->o_size);
+    }
+
+  buffer = malloc(size * ORB_MAX_PRINT_BATCH);
+  if (!buffer)
+    {
+      uorberr("Listener buffer allocation failed");
+    }
+
   /* Loop poll and print recieved messages */
 
-  while ((!nb_msgs || nb_recv_msgs < nb_msgs) && !g_should_exit)
+  while (buffer && (!nb_msgs || nb_recv_msgs < nb_msgs) && !g_should_exit)
     {
       if (poll(&fds[0], nb_objects, timeout * 1000) > 0)
         {
@@ -571,12 +649,21 @@ static void listener_monitor(FAR struct list_node *objlist, int nb_objects,
             {
               if (fds[i].revents & POLLIN)
                 {
-                  nb_recv_msgs++;
-                  recv_msgs[i]++;
-                  if (listener_print(tmp->object.meta, fds[i].fd) != 0)
+                  int ret;
+
+                  ret = listener_print_batch(tmp->object.meta, fds[i].fd,
+                                             tmp, buffer, nb_msgs ?
+                                             nb_msgs - nb_recv_msgs :
+                                             ORB_MAX_PRINT_BATCH);
+                  if (ret < 0)
                     {
                       uorberr("Listener callback failed");
                     }
+                  else
+                    {
+                      nb_recv_msgs += ret;
+                      recv_msgs[i] += ret;
+                    }
 
                   if (nb_msgs && nb_recv_msgs >= nb_msgs)
                     {
@@ -611,9 +698,9 @@ static void listener_monitor(FAR struct list_node *objlist, int nb_objects,
             }
 
           orb_unsubscribe(fds[i].fd);
-          uorbinfo_raw("Object name:%s%d, recieved:%d",
+          uorbinfo_raw("Object name:%s%d, recieved:%d, lost:%lu",
                        tmp->object.meta->o_name, tmp->object.instance,
-                       recv_msgs[i]);
+                       recv_msgs[i], tmp->lost);
         }
 
       i++;
@@ -621,6 +708,7 @@ static void listener_monitor(FAR struct list_node *objlist, int nb_objects,
 
   uorbinfo_raw("Total number of received Message:%d/%d",
                nb_recv_msgs, nb_msgs ? nb_msgs : nb_recv_msgs);
+  free(buffer);
   free(fds);
   free(recv_msgs);
 }
@@ -0,0 +1,170 @@
+/****************************************************************************
+ * apps/system/uorb/record/host/orb_log_dump.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "orb_log.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DUMP_MAX_BYTES  16
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct dump_stat_s
+{
+  unsigned long count;
+  uint64_t      first;
+  uint64_t      last;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void dump_sample(FAR const struct orb_log_reader_s *reader,
+                        FAR const struct orb_log_entry_s *entry)
+{
+  FAR const uint8_t *data = entry->data;
+  size_t len = entry->topic->esize;
+  size_t i;
+
+  printf("%12.6f %s%u:", (entry->timestamp -
+                          reader->header.start_time) / 1e6,
+         entry->topic->name, entry->topic->instance);
+
+  for (i = 0; i < len && i < DUMP_MAX_BYTES; i++)
+    {
+      printf(" %02x", data[i]);
+    }
+
+  printf("%s\n", len > DUMP_MAX_BYTES ? " ..." : "");
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  static struct orb_log_reader_s reader;
+  static struct dump_stat_s stat[ORB_LOG_MAX_TOPICS];
+  struct orb_log_entry_s entry;
+  bool summary = false;
+  int ret;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "s")) != -1)
+    {
+      switch (opt)
+        {
+          case 's':
+            summary = true;
+            break;
+
+          default:
+            goto usage;
+        }
+    }
+
+  if (optind >= argc)
+    {
+      goto usage;
+    }
+
+  ret = orb_log_reader_open(&reader, argv[optind]);
+  if (ret < 0)
+    {
+      fprintf(stderr, "%s: %s\n", argv[optind], strerror(-ret));
+      return EXIT_FAILURE;
+    }
+
+  while ((ret = orb_log_reader_next(&reader, &entry)) > 0)
+    {
+      FAR struct dump_stat_s *st = &stat[entry.id];
+
+      if (entry.type == ORB_LOG_TOPIC)
+        {
+          if (!summary)
+            {
+              printf("topic %u: %s%u, %u bytes\n", entry.id,
+                     entry.topic->name, entry.topic->instance,
+                     entry.topic->esize);
+            }
+
+          continue;
+        }
+
+      if (st->count++ == 0)
+        {
+          st->first = entry.timestamp;
+        }
+
+      st->last = entry.timestamp;
+
+      if (!summary)
+        {
+          dump_sample(&reader, &entry);
+        }
+    }
+
+  for (i = 0; i < ORB_LOG_MAX_TOPICS; i++)
+    {
+      FAR const struct orb_log_topic_info_s *info = &reader.topics[i];
+      uint64_t span = stat[i].last - stat[i].first;
+
+      if (!info->valid)
+        {
+          continue;
+        }
+
+      printf("%s%u: %lu samples of %u bytes, %.3f s, %.1f Hz\n",
+             info->name, info->instance, stat[i].count, info->esize,
+             span / 1e6, span ? (stat[i].count - 1) * 1e6 / span : 0.0);
+    }
+
+  orb_log_reader_close(&reader);
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "%s: %s\n", argv[optind], strerror(-ret));
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+
+usage:
+  fprintf(stderr, "Usage: %s [-s] file\n"
+          "  -s  Only print the per topic summary\n", argv[0]);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,225 @@
+/****************************************************************************
+ * apps/system/uorb/record/host/orb_log_test.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "orb_log.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Enough samples to wrap the writer's block ring several times, with
+ * sizes that don't divide the block size.
+ */
+
+#define TEST_NSAMPLES   20000
+#define TEST_START      1000000ull
+#define TEST_GAP        5000000000ull /* Forces a new time base */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct test_accel_s
+{
+  uint64_t timestamp;
+  float    x;
+  float    y;
+  float    z;
+  uint32_t seq;
+};
+
+struct test_odd_s
+{
+  uint32_t seq;
+  uint8_t  data[37];
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t test_time(uint32_t seq)
+{
+  return TEST_START + seq * 1000ull + (seq >= TEST_NSAMPLES / 2 ?
+                                       TEST_GAP : 0);
+}
+
+static int test_write(FAR const char *path)
+{
+  static struct orb_log_writer_s writer;
+  struct test_accel_s accel;
+  struct test_odd_s odd;
+  uint32_t seq;
+  int ret;
+
+  ret = orb_log_writer_open(&writer, path, TEST_START);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  orb_log_writer_topic(&writer, 0, "test_accel", sizeof(accel), 0);
+  orb_log_writer_topic(&writer, 1, "test_odd", sizeof(odd), 2);
+
+  for (seq = 0; seq < TEST_NSAMPLES; seq++)
+    {
+      accel.timestamp = test_time(seq);
+      accel.x   = seq;
+      accel.y   = -(float)seq;
+      accel.z   = 9.8f;
+      accel.seq = seq;
+
+      /* The ring drops rather than blocks, give the flush thread time */
+
+      while (orb_log_writer_sample(&writer, 0, accel.timestamp, &accel,
+                                   sizeof(accel)) == -ENOBUFS)
+        {
+          usleep(100);
+        }
+
+      if (seq % 3 == 0)
+        {
+          odd.seq = seq;
+          memset(odd.data, seq & 0xff, sizeof(odd.data));
+          while (orb_log_writer_sample(&writer, 1, accel.timestamp + 1,
+                                       &odd, sizeof(odd)) == -ENOBUFS)
+            {
+              usleep(100);
+            }
+        }
+    }
+
+  ret = orb_log_writer_close(&writer);
+  printf("wrote %" PRIu64 " bytes, %" PRIu32 " dropped\n",
+         writer.written, writer.dropped);
+  return ret;
+}
+
+static int test_read(FAR const char *path)
+{
+  static struct orb_log_reader_s reader;
+  struct orb_log_entry_s entry;
+  FAR const struct test_accel_s *accel;
+  FAR const struct test_odd_s *odd;
+  uint32_t next_accel = 0;
+  uint32_t next_odd = 0;
+  int topics = 0;
+  int ret;
+
+  ret = orb_log_reader_open(&reader, path);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  while ((ret = orb_log_reader_next(&reader, &entry)) > 0)
+    {
+      if (entry.type == ORB_LOG_TOPIC)
+        {
+          topics++;
+          continue;
+        }
+
+      if ((uintptr_t)entry.data % ORB_LOG_ALIGN != 0)
+        {
+          fprintf(stderr, "unaligned sample data\n");
+          ret = -1;
+          break;
+        }
+
+      if (entry.id == 0)
+        {
+          accel = entry.data;
+          if (accel->seq != next_accel ||
+              accel->timestamp != test_time(next_accel) ||
+              entry.timestamp != accel->timestamp ||
+              accel->x != (float)next_accel)
+            {
+              fprintf(stderr, "accel %" PRIu32 ": bad sample\n",
+                      next_accel);
+              ret = -1;
+              break;
+            }
+
+          next_accel++;
+        }
+      else
+        {
+          odd = entry.data;
+          if (odd->seq != next_odd ||
+              odd->data[36] != (next_odd & 0xff) ||
+              entry.timestamp != test_time(next_odd) + 1 ||
+              strcmp(entry.topic->name, "test_odd") != 0 ||
+              entry.topic->instance != 2)
+            {
+              fprintf(stderr, "odd %" PRIu32 ": bad sample\n", next_odd);
+              ret = -1;
+              break;
+            }
+
+          next_odd += 3;
+        }
+    }
+
+  orb_log_reader_close(&reader);
+
+  if (ret == 0 && (topics != 2 || next_accel != TEST_NSAMPLES ||
+                   next_odd < TEST_NSAMPLES))
+    {
+      fprintf(stderr, "short log: %d topics, %" PRIu32 " samples\n",
+              topics, next_accel);
+      ret = -1;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  if (argc != 2)
+    {
+      fprintf(stderr, "Usage: %s file\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  if (test_write(argv[1]) < 0 || test_read(argv[1]) < 0)
+    {
+      printf("FAIL\n");
+      return EXIT_FAILURE;
+    }
+
+  printf("PASS\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,665 @@
+/****************************************************************************
+ * apps/system/uorb/record/orb_log.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "orb_log.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ORB_LOG_ROUNDUP(x)  (((x) + ORB_LOG_ALIGN - 1) & ~(ORB_LOG_ALIGN - 1))
+
+#define ORB_LOG_CLOCK_SIZE  (sizeof(struct orb_log_record_s) + \
+                             sizeof(uint64_t))
+
+/* Blocks are written as is, keep them aligned for the storage driver */
+
+#define ORB_LOG_BUFFER_ALIGN  64
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: orb_log_flush_thread
+ *
+ * Description:
+ *   Write queued blocks to the file. All blocks queued up to the end of
+ *   the buffer go out with one write(), the wrapped part with the next.
+ *   On a write error the blocks are discarded, so the producer keeps
+ *   running; the error is reported by orb_log_writer_close().
+ ****************************************************************************/
+
+static FAR void *orb_log_flush_thread(FAR void *arg)
+{
+  FAR struct orb_log_writer_s *writer = arg;
+  FAR const uint8_t *data;
+  unsigned int nblocks;
+  size_t len;
+  ssize_t ret;
+
+  pthread_mutex_lock(&writer->lock);
+
+  for (; ; )
+    {
+      while (writer->nfull == 0 && !writer->stop)
+        {
+          pthread_cond_wait(&writer->cond, &writer->lock);
+        }
+
+      if (writer->nfull == 0)
+        {
+          break;
+        }
+
+      nblocks = writer->nfull;
+      if (nblocks > ORB_LOG_NBLOCKS - writer->tail)
+        {
+          nblocks = ORB_LOG_NBLOCKS - writer->tail;
+        }
+
+      data = writer->buffer + writer->tail * ORB_LOG_BLOCK_SIZE;
+      len  = nblocks * ORB_LOG_BLOCK_SIZE;
+
+      pthread_mutex_unlock(&writer->lock);
+
+      while (len > 0 && writer->error == 0)
+        {
+          ret = write(writer->fd, data, len);
+          if (ret < 0)
+            {
+              if (errno != EINTR)
+                {
+                  writer->error = errno;
+                }
+
+              continue;
+            }
+
+          writer->written += ret;
+          data += ret;
+          len  -= ret;
+        }
+
+      pthread_mutex_lock(&writer->lock);
+      writer->tail   = (writer->tail + nblocks) % ORB_LOG_NBLOCKS;
+      writer->nfull -= nblocks;
+    }
+
+  pthread_mutex_unlock(&writer->lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: orb_log_put_clock
+ *
+ * Description:
+ *   Append a time base record, the caller made sure it fits.
+ ****************************************************************************/
+
+static void orb_log_put_clock(FAR struct orb_log_writer_s *writer,
+                              uint64_t base)
+{
+  FAR uint8_t *ptr = writer->buffer + writer->head * ORB_LOG_BLOCK_SIZE +
+                     writer->pos;
+  FAR struct orb_log_record_s *record = (FAR struct orb_log_record_s *)ptr;
+
+  record->size = ORB_LOG_CLOCK_SIZE;
+  record->type = ORB_LOG_CLOCK;
+  record->id   = 0;
+  record->time = 0;
+  memcpy(record + 1, &base, sizeof(base));
+
+  writer->base = base;
+  writer->pos += ORB_LOG_CLOCK_SIZE;
+}
+
+/****************************************************************************
+ * Name: orb_log_reserve
+ *
+ * Description:
+ *   Reserve size bytes (already rounded up) in the head block. When the
+ *   record doesn't fit, the block is queued for flush and the next one
+ *   starts with a time base of 'now'.
+ *
+ * Returned Value:
+ *   Where to build the record, NULL if every block is queued.
+ ****************************************************************************/
+
+static FAR struct orb_log_record_s *
+orb_log_reserve(FAR struct orb_log_writer_s *writer, size_t size,
+                uint64_t now)
+{
+  FAR uint8_t *block = writer->buffer + writer->head * ORB_LOG_BLOCK_SIZE;
+  bool queued = false;
+
+  if (writer->pos + size > ORB_LOG_BLOCK_SIZE)
+    {
+      if (writer->pos < ORB_LOG_BLOCK_SIZE)
+        {
+          memset(block + writer->pos, 0, ORB_LOG_BLOCK_SIZE - writer->pos);
+          writer->pos = ORB_LOG_BLOCK_SIZE;
+        }
+
+      /* Keep the head block out of the flusher's reach */
+
+      pthread_mutex_lock(&writer->lock);
+      if (writer->nfull < ORB_LOG_NBLOCKS - 1)
+        {
+          writer->head = (writer->head + 1) % ORB_LOG_NBLOCKS;
+          writer->nfull++;
+          pthread_cond_signal(&writer->cond);
+          queued = true;
+        }
+
+      pthread_mutex_unlock(&writer->lock);
+
+      if (!queued)
+        {
+          writer->dropped++;
+          return NULL;
+        }
+
+      writer->pos = 0;
+      orb_log_put_clock(writer, now);
+      block = writer->buffer + writer->head * ORB_LOG_BLOCK_SIZE;
+    }
+
+  return (FAR struct orb_log_record_s *)(block + writer->pos);
+}
+
+/****************************************************************************
+ * Name: orb_log_read_block
+ *
+ * Description:
+ *   Load the next block of the file.
+ *
+ * Returned Value:
+ *   1 on success, 0 at the end of the file, -errno on error.
+ ****************************************************************************/
+
+static int orb_log_read_block(FAR struct orb_log_reader_s *reader)
+{
+  reader->fill = fread(reader->block, 1, reader->header.block_size,
+                       reader->fp);
+  reader->pos  = 0;
+
+  if (reader->fill == 0)
+    {
+      return ferror(reader->fp) ? -EIO : 0;
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: orb_log_writer_open
+ *
+ * Description:
+ *   Create a log file and start its flush thread. The writer is meant for
+ *   one producer thread; it never blocks on the storage.
+ *
+ * Input Parameters:
+ *   writer       Writer to initialize.
+ *   path         File to create (truncated if it exists).
+ *   start_time   Recording start time, us.
+ *
+ * Returned Value:
+ *   0 on success, -errno on failure.
+ ****************************************************************************/
+
+int orb_log_writer_open(FAR struct orb_log_writer_s *writer,
+                        FAR const char *path, uint64_t start_time)
+{
+  FAR struct orb_log_header_s *header;
+  FAR void *buffer;
+  int ret;
+
+  memset(writer, 0, sizeof(*writer));
+
+  ret = posix_memalign(&buffer, ORB_LOG_BUFFER_ALIGN,
+                       ORB_LOG_NBLOCKS * ORB_LOG_BLOCK_SIZE);
+  if (ret != 0)
+    {
+      return -ret;
+    }
+
+  writer->buffer = buffer;
+  writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (writer->fd < 0)
+    {
+      ret = -errno;
+      goto err_free;
+    }
+
+  header = (FAR struct orb_log_header_s *)writer->buffer;
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, ORB_LOG_MAGIC, sizeof(header->magic));
+  header->version    = ORB_LOG_VERSION;
+  header->block_size = ORB_LOG_BLOCK_SIZE;
+  header->start_time = start_time;
+
+  writer->pos = sizeof(*header);
+  orb_log_put_clock(writer, start_time);
+
+  pthread_mutex_init(&writer->lock, NULL);
+  pthread_cond_init(&writer->cond, NULL);
+
+  ret = pthread_create(&writer->thread, NULL, orb_log_flush_thread, writer);
+  if (ret != 0)
+    {
+      ret = -ret;
+      goto err_close;
+    }
+
+  return 0;
+
+err_close:
+  pthread_cond_destroy(&writer->cond);
+  pthread_mutex_destroy(&writer->lock);
+  close(writer->fd);
+  unlink(path);
+err_free:
+  free(writer->buffer);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: orb_log_writer_topic
+ *
+ * Description:
+ *   Describe topic id, must precede its first sample.
+ *
+ * Returned Value:
+ *   0 on success, -ENOBUFS if the record was dropped, -EINVAL for a name
+ *   that is too long.
+ ****************************************************************************/
+
+int orb_log_writer_topic(FAR struct orb_log_writer_s *writer, uint8_t id,
+                         FAR const char *name, uint16_t esize,
+                         uint8_t instance)
+{
+  FAR struct orb_log_record_s *record;
+  struct orb_log_topic_s topic;
+  size_t len = strlen(name) + 1;
+  size_t size;
+
+  if (len > ORB_LOG_NAME_MAX)
+    {
+      return -EINVAL;
+    }
+
+  size = ORB_LOG_ROUNDUP(sizeof(*record) + sizeof(topic) + len);
+  record = orb_log_reserve(writer, size, writer->base);
+  if (record == NULL)
+    {
+      return -ENOBUFS;
+    }
+
+  topic.esize    = esize;
+  topic.instance = instance;
+  topic.reserved = 0;
+
+  memset(record, 0, size);
+  record->size = size;
+  record->type = ORB_LOG_TOPIC;
+  record->id   = id;
+  memcpy(record + 1, &topic, sizeof(topic));
+  memcpy((FAR uint8_t *)(record + 1) + sizeof(topic), name, len);
+
+  writer->pos += size;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: orb_log_writer_sample
+ *
+ * Description:
+ *   Append one sample of topic id, copied at timestamp (us).
+ *
+ * Returned Value:
+ *   0 on success, -ENOBUFS if the sample was dropped, -EINVAL if it can
+ *   never fit a block.
+ ****************************************************************************/
+
+int orb_log_writer_sample(FAR struct orb_log_writer_s *writer, uint8_t id,
+                          uint64_t timestamp, FAR const void *data,
+                          uint16_t esize)
+{
+  FAR struct orb_log_record_s *record;
+  size_t size = ORB_LOG_ROUNDUP(sizeof(*record) + esize);
+
+  if (size + ORB_LOG_CLOCK_SIZE > ORB_LOG_BLOCK_SIZE ||
+      size > UINT16_MAX)
+    {
+      return -EINVAL;
+    }
+
+  /* Samples are stamped relative to the block's time base, emit a new
+   * base when the offset doesn't fit 32 bits (or time went backwards).
+   */
+
+  if (timestamp < writer->base || timestamp - writer->base > UINT32_MAX)
+    {
+      if (orb_log_reserve(writer, ORB_LOG_CLOCK_SIZE, timestamp) == NULL)
+        {
+          return -ENOBUFS;
+        }
+
+      if (timestamp < writer->base ||
+          timestamp - writer->base > UINT32_MAX)
+        {
+          orb_log_put_clock(writer, timestamp);
+        }
+    }
+
+  record = orb_log_reserve(writer, size, timestamp);
+  if (record == NULL)
+    {
+      return -ENOBUFS;
+    }
+
+  record->size = size;
+  record->type = ORB_LOG_SAMPLE;
+  record->id   = id;
+  record->time = timestamp - writer->base;
+  memcpy(record + 1, data, esize);
+  memset((FAR uint8_t *)(record + 1) + esize, 0,
+         size - sizeof(*record) - esize);
+
+  writer->pos += size;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: orb_log_writer_close
+ *
+ * Description:
+ *   Flush everything, including the partial head block, and close the
+ *   file.
+ *
+ * Returned Value:
+ *   0 on success, -errno of the first write error otherwise.
+ ****************************************************************************/
+
+int orb_log_writer_close(FAR struct orb_log_writer_s *writer)
+{
+  FAR const uint8_t *data;
+  size_t len;
+  ssize_t ret;
+
+  pthread_mutex_lock(&writer->lock);
+  writer->stop = true;
+  pthread_cond_signal(&writer->cond);
+  pthread_mutex_unlock(&writer->lock);
+
+  pthread_join(writer->thread, NULL);
+
+  /* The tail of the last block is not written, the reader stops at the
+   * end of the file.
+   */
+
+  data = writer->buffer + writer->head * ORB_LOG_BLOCK_SIZE;
+  len  = writer->pos;
+
+  while (len > 0 && writer->error == 0)
+    {
+      ret = write(writer->fd, data, len);
+      if (ret < 0)
+        {
+          if (errno != EINTR)
+            {
+              writer->error = errno;
+            }
+
+          continue;
+        }
+
+      writer->written += ret;
+      data += ret;
+      len  -= ret;
+    }
+
+  if (close(writer->fd) < 0 && writer->error == 0)
+    {
+      writer->error = errno;
+    }
+
+  pthread_cond_destroy(&writer->cond);
+  pthread_mutex_destroy(&writer->lock);
+  free(writer->buffer);
+  writer->buffer = NULL;
+
+  return -writer->error;
+}
+
+/****************************************************************************
+ * Name: orb_log_reader_open
+ *
+ * Description:
+ *   Open a log file and check its header.
+ *
+ * Returned Value:
+ *   0 on success, -errno on failure (-EINVAL: not a log this reader
+ *   understands).
+ ****************************************************************************/
+
+int orb_log_reader_open(FAR struct orb_log_reader_s *reader,
+                        FAR const char *path)
+{
+  FAR struct orb_log_header_s *header = &reader->header;
+  int ret;
+
+  memset(reader, 0, sizeof(*reader));
+
+  reader->fp = fopen(path, "rb");
+  if (reader->fp == NULL)
+    {
+      return -errno;
+    }
+
+  if (fread(header, sizeof(*header), 1, reader->fp) != 1 ||
+      memcmp(header->magic, ORB_LOG_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != ORB_LOG_VERSION ||
+      header->block_size < sizeof(*header) + ORB_LOG_CLOCK_SIZE ||
+      header->block_size > UINT16_MAX + 1 ||
+      header->block_size % ORB_LOG_ALIGN != 0)
+    {
+      ret = -EINVAL;
+      goto err;
+    }
+
+  /* malloc() alignment covers the 8 bytes records are aligned to */
+
+  reader->block = malloc(header->block_size);
+  if (reader->block == NULL)
+    {
+      ret = -ENOMEM;
+      goto err;
+    }
+
+  /* The first block starts with the header */
+
+  rewind(reader->fp);
+  ret = orb_log_read_block(reader);
+  if (ret <= 0)
+    {
+      ret = ret < 0 ? ret : -EINVAL;
+      free(reader->block);
+      goto err;
+    }
+
+  reader->pos  = sizeof(*header);
+  reader->base = header->start_time;
+  return 0;
+
+err:
+  fclose(reader->fp);
+  reader->fp = NULL;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: orb_log_reader_next
+ *
+ * Description:
+ *   Return the next topic or sample record. Time base records are
+ *   consumed here; samples come with absolute timestamps.
+ *
+ *   entry->data points into the reader's block buffer and is valid until
+ *   the next call.
+ *
+ * Returned Value:
+ *   1 when entry is filled, 0 at the end of the log, -errno on a corrupt
+ *   or truncated log.
+ ****************************************************************************/
+
+int orb_log_reader_next(FAR struct orb_log_reader_s *reader,
+                        FAR struct orb_log_entry_s *entry)
+{
+  FAR const struct orb_log_record_s *record;
+  FAR struct orb_log_topic_info_s *info;
+  struct orb_log_topic_s topic;
+  FAR const char *name;
+  size_t payload;
+  int ret;
+
+  for (; ; )
+    {
+      if (reader->pos + sizeof(*record) > reader->fill)
+        {
+          ret = orb_log_read_block(reader);
+          if (ret <= 0)
+            {
+              return ret;
+            }
+
+          continue;
+        }
+
+      record = (FAR const struct orb_log_record_s *)
+               (reader->block + reader->pos);
+
+      /* Zero tail, the rest of the block is unused */
+
+      if (record->size == 0)
+        {
+          reader->pos = reader->fill;
+          continue;
+        }
+
+      if (record->size < sizeof(*record) ||
+          record->size % ORB_LOG_ALIGN != 0 ||
+          reader->pos + record->size > reader->fill)
+        {
+          return -EINVAL;
+        }
+
+      reader->pos += record->size;
+      payload = record->size - sizeof(*record);
+
+      switch (record->type)
+        {
+          case ORB_LOG_CLOCK:
+            if (payload < sizeof(uint64_t))
+              {
+                return -EINVAL;
+              }
+
+            memcpy(&reader->base, record + 1, sizeof(uint64_t));
+            break;
+
+          case ORB_LOG_TOPIC:
+            if (payload < sizeof(topic) + 1 ||
+                record->id >= ORB_LOG_MAX_TOPICS)
+              {
+                return -EINVAL;
+              }
+
+            memcpy(&topic, record + 1, sizeof(topic));
+            name = (FAR const char *)(record + 1) + sizeof(topic);
+            if (strnlen(name, payload - sizeof(topic)) >= ORB_LOG_NAME_MAX)
+              {
+                return -EINVAL;
+              }
+
+            info = &reader->topics[record->id];
+            strcpy(info->name, name);
+            info->esize    = topic.esize;
+            info->instance = topic.instance;
+            info->valid    = true;
+
+            entry->type      = ORB_LOG_TOPIC;
+            entry->id        = record->id;
+            entry->timestamp = 0;
+            entry->data      = NULL;
+            entry->topic     = info;
+            return 1;
+
+          case ORB_LOG_SAMPLE:
+            if (record->id >= ORB_LOG_MAX_TOPICS ||
+                !reader->topics[record->id].valid ||
+                payload < reader->topics[record->id].esize)
+              {
+                return -EINVAL;
+              }
+
+            entry->type      = ORB_LOG_SAMPLE;
+            entry->id        = record->id;
+            entry->timestamp = reader->base + record->time;
+            entry->data      = record + 1;
+            entry->topic     = &reader->topics[record->id];
+            return 1;
+
+          default:
+            break; /* Unknown record of a later version, skip */
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: orb_log_reader_close
+ ****************************************************************************/
+
+void orb_log_reader_close(FAR struct orb_log_reader_s *reader)
+{
+  if (reader->fp != NULL)
+    {
+      fclose(reader->fp);
+      reader->fp = NULL;
+    }
+
+  free(reader->block);
+  reader->block = NULL;
+}
@@ -0,0 +1,202 @@
+/****************************************************************************
+ * apps/system/uorb/record/orb_log.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_UORB_RECORD_ORB_LOG_H
+#define __APPS_SYSTEM_UORB_RECORD_ORB_LOG_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+/* Only standard C and POSIX here: the same reader and writer are built on
+ * the host (see host/Makefile.host) to feed recorded sessions into code
+ * under test there.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef FAR
+#  define FAR
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* File layout (native byte order, i.e. little endian on all our targets):
+ *
+ *   struct orb_log_header_s
+ *   records...
+ *
+ * The file is written in blocks of header.block_size bytes and a record
+ * never crosses a block boundary; the unused tail of a block is zero, which
+ * reads as a record of size 0 ("skip to the next block"). Records are
+ * padded to ORB_LOG_ALIGN, so sample data is aligned for direct use.
+ * Every record starts with struct orb_log_record_s:
+ *
+ *   ORB_LOG_CLOCK   uint64_t time base (us, CLOCK_MONOTONIC). First record
+ *                   of every block, and whenever a sample is out of the
+ *                   32 bit range of the current base.
+ *   ORB_LOG_TOPIC   struct orb_log_topic_s, topic name with NUL
+ *                   (announces id before its first sample)
+ *   ORB_LOG_SAMPLE  record.time is the copy time relative to the time
+ *                   base, then the topic element (esize bytes)
+ */
+
+#define ORB_LOG_MAGIC           "ORBLOG\r\n"
+#define ORB_LOG_VERSION         1
+
+#define ORB_LOG_CLOCK           'C'
+#define ORB_LOG_TOPIC           'T'
+#define ORB_LOG_SAMPLE          'S'
+
+#define ORB_LOG_ALIGN           8
+
+#define ORB_LOG_MAX_TOPICS      255
+#define ORB_LOG_NAME_MAX        32
+
+#ifdef CONFIG_UORB_RECORD_BLOCK_SIZE
+#  define ORB_LOG_BLOCK_SIZE    CONFIG_UORB_RECORD_BLOCK_SIZE
+#else
+#  define ORB_LOG_BLOCK_SIZE    4096
+#endif
+
+#ifdef CONFIG_UORB_RECORD_NBLOCKS
+#  define ORB_LOG_NBLOCKS       CONFIG_UORB_RECORD_NBLOCKS
+#else
+#  define ORB_LOG_NBLOCKS       8
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct orb_log_header_s
+{
+  char     magic[8];            /* ORB_LOG_MAGIC */
+  uint32_t version;             /* ORB_LOG_VERSION */
+  uint32_t block_size;          /* Write and record alignment unit */
+  uint64_t start_time;          /* Time of the recording start, us */
+  uint64_t reserved;
+};
+
+struct orb_log_record_s
+{
+  uint16_t size;                /* Record size including this header */
+  uint8_t  type;                /* ORB_LOG_xxx */
+  uint8_t  id;                  /* Topic id within this log */
+  uint32_t time;                /* ORB_LOG_SAMPLE: us since time base */
+};
+
+struct orb_log_topic_s
+{
+  uint16_t esize;               /* Element size, orb_metadata.o_size */
+  uint8_t  instance;            /* Recorded topic instance */
+  uint8_t  reserved;
+                                /* char name[], NUL terminated */
+};
+
+/* Writer: the caller appends records, full blocks are queued to a flush
+ * thread which writes as many contiguous blocks as are ready with one
+ * write(). When every block is queued the record is dropped, so a slow
+ * storage never stalls the caller.
+ */
+
+struct orb_log_writer_s
+{
+  int              fd;
+  FAR uint8_t     *buffer;      /* ORB_LOG_NBLOCKS blocks */
+  unsigned int     head;        /* Block being filled */
+  unsigned int     tail;        /* Oldest block queued for flush */
+  unsigned int     nfull;       /* Blocks queued for flush */
+  size_t           pos;         /* Fill position in head block */
+  uint64_t         base;        /* Time base of head block */
+  bool             stop;
+  int              error;       /* First write error (errno) */
+  uint32_t         dropped;     /* Records dropped, blocks all queued */
+  uint64_t         written;     /* Bytes written to the file */
+  pthread_t        thread;
+  pthread_mutex_t  lock;
+  pthread_cond_t   cond;
+};
+
+/* Reader */
+
+struct orb_log_topic_info_s
+{
+  char     name[ORB_LOG_NAME_MAX];
+  uint16_t esize;
+  uint8_t  instance;
+  bool     valid;
+};
+
+struct orb_log_entry_s
+{
+  uint8_t  type;                /* ORB_LOG_TOPIC, ORB_LOG_SAMPLE */
+  uint8_t  id;
+  uint64_t timestamp;           /* ORB_LOG_SAMPLE only, absolute us */
+  FAR const void *data;         /* ORB_LOG_SAMPLE only, esize bytes */
+  FAR const struct orb_log_topic_info_s *topic;
+};
+
+struct orb_log_reader_s
+{
+  FAR FILE        *fp;
+  struct orb_log_header_s header;
+  FAR uint8_t     *block;
+  size_t           fill;        /* Valid bytes in block */
+  size_t           pos;         /* Next record in block */
+  uint64_t         base;        /* Current time base */
+  struct orb_log_topic_info_s topics[ORB_LOG_MAX_TOPICS];
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+int orb_log_writer_open(FAR struct orb_log_writer_s *writer,
+                        FAR const char *path, uint64_t start_time);
+int orb_log_writer_topic(FAR struct orb_log_writer_s *writer, uint8_t id,
+                         FAR const char *name, uint16_t esize,
+                         uint8_t instance);
+int orb_log_writer_sample(FAR struct orb_log_writer_s *writer, uint8_t id,
+                          uint64_t timestamp, FAR const void *data,
+                          uint16_t esize);
+int orb_log_writer_close(FAR struct orb_log_writer_s *writer);
+
+int orb_log_reader_open(FAR struct orb_log_reader_s *reader,
+                        FAR const char *path);
+int orb_log_reader_next(FAR struct orb_log_reader_s *reader,
+                        FAR struct orb_log_entry_s *entry);
+void orb_log_reader_close(FAR struct orb_log_reader_s *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __APPS_SYSTEM_UORB_RECORD_ORB_LOG_H */
@@ -0,0 +1,340 @@
+/****************************************************************************
+ * apps/system/uorb/record/record_main.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <unistd.h>
+
+#include <uORB/uORB.h>
+
+#include "orb_log.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define RECORD_MAX_TOPICS     32
+#define RECORD_BATCH          8
+#define RECORD_POLL_TIMEOUT   100 /* ms, granularity of -t and Ctrl+C */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct record_topic_s
+{
+  FAR const struct orb_metadata *meta;
+  int               instance;
+  struct orb_batch  batch;        /* Gap tracking of the subscription */
+  unsigned long     count;        /* Samples logged */
+  unsigned long     lost;         /* Samples overwritten before copy */
+  unsigned long     dropped;      /* Samples the log had no room for */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static volatile bool g_record_exit;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void record_exit_handler(int signo)
+{
+  g_record_exit = true;
+}
+
+static void record_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-o file] [-t sec] <t1,t2,...>\n"
+         "Record uORB topics into a binary log, see uorb_replay.\n"
+         "  <topics>  Topic names, separated by ','. A trailing digit\n"
+         "            selects one instance, otherwise all instances.\n"
+         "  -o  Log file (default %s)\n"
+         "  -t  Recording time in seconds, 0 until Ctrl+C (default 0)\n",
+         progname, CONFIG_UORB_RECORD_PATH);
+}
+
+/****************************************************************************
+ * Name: record_add
+ *
+ * Description:
+ *   Add the instances of one "name[instance]" to the topic table.
+ *
+ * Returned Value:
+ *   Number of topics in the table.
+ ****************************************************************************/
+
+static int record_add(FAR struct record_topic_s *topics, int ntopics,
+                      FAR const char *name)
+{
+  FAR const struct orb_metadata *meta;
+  size_t len = strlen(name);
+  int instance;
+  int i;
+
+  meta = orb_get_meta(name);
+  if (meta == NULL)
+    {
+      fprintf(stderr, "%s: no such topic\n", name);
+      return ntopics;
+    }
+
+  instance = isdigit(name[len - 1]) ? name[len - 1] - '0' : -1;
+
+  for (i = instance < 0 ? 0 : instance;
+       ntopics < RECORD_MAX_TOPICS && orb_exists(meta, i) == 0; i++)
+    {
+      topics[ntopics].meta     = meta;
+      topics[ntopics].instance = i;
+      ntopics++;
+
+      if (instance >= 0)
+        {
+          break;
+        }
+    }
+
+  return ntopics;
+}
+
+/****************************************************************************
+ * Name: record_drain
+ *
+ * Description:
+ *   Log everything queued on one subscription, each sample stamped with
+ *   the time it was copied.
+ ****************************************************************************/
+
+static void record_drain(FAR struct orb_log_writer_s *writer,
+                         FAR struct record_topic_s *topic, uint8_t id,
+                         int fd, FAR uint8_t *buffer)
+{
+  FAR const struct orb_metadata *meta = topic->meta;
+  orb_abstime now;
+  ssize_t n;
+  ssize_t i;
+
+  while ((n = orb_copy_batch(meta, fd, buffer, RECORD_BATCH,
+                             &topic->batch)) > 0)
+    {
+      now = orb_absolute_time();
+      topic->lost += topic->batch.lost;
+
+      for (i = 0; i < n; i++)
+        {
+          if (orb_log_writer_sample(writer, id, now,
+                                    buffer + i * meta->o_size,
+                                    meta->o_size) < 0)
+            {
+              topic->dropped++;
+            }
+          else
+            {
+              topic->count++;
+            }
+        }
+
+      if (n < RECORD_BATCH)
+        {
+          break;
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct record_topic_s topics[RECORD_MAX_TOPICS];
+  struct pollfd fds[RECORD_MAX_TOPICS];
+  struct orb_log_writer_s writer;
+  FAR const char *path = CONFIG_UORB_RECORD_PATH;
+  FAR uint8_t *buffer = NULL;
+  FAR char *filter;
+  FAR char *name;
+  FAR char *save;
+  orb_abstime start;
+  orb_abstime end = 0;
+  size_t esize = 0;
+  int ntopics = 0;
+  int seconds = 0;
+  int ret;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "o:t:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 'o':
+            path = optarg;
+            break;
+
+          case 't':
+            seconds = strtol(optarg, NULL, 0);
+            break;
+
+          default:
+            record_usage(argv[0]);
+            return opt == 'h' ? 0 : -EINVAL;
+        }
+    }
+
+  if (optind >= argc || seconds < 0)
+    {
+      record_usage(argv[0]);
+      return -EINVAL;
+    }
+
+  memset(topics, 0, sizeof(topics));
+  for (i = 0; i < RECORD_MAX_TOPICS; i++)
+    {
+      fds[i].fd = -1;
+    }
+
+  filter = strdup(argv[optind]);
+  if (filter == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  for (name = strtok_r(filter, ",", &save); name != NULL;
+       name = strtok_r(NULL, ",", &save))
+    {
+      ntopics = record_add(topics, ntopics, name);
+    }
+
+  free(filter);
+
+  if (ntopics == 0)
+    {
+      fprintf(stderr, "no topic to record\n");
+      return -ENOENT;
+    }
+
+  for (i = 0; i < ntopics; i++)
+    {
+      esize = MAX(esize, topics[i].meta->o_size);
+      fds[i].events = POLLIN;
+      fds[i].fd = orb_subscribe_multi(topics[i].meta, topics[i].instance);
+      if (fds[i].fd < 0)
+        {
+          fprintf(stderr, "%s%d: subscribe failed (%d)\n",
+                  topics[i].meta->o_name, topics[i].instance, errno);
+          ret = -errno;
+          goto out;
+        }
+    }
+
+  buffer = malloc(esize * RECORD_BATCH);
+  if (buffer == NULL)
+    {
+      ret = -ENOMEM;
+      goto out;
+    }
+
+  start = orb_absolute_time();
+  ret = orb_log_writer_open(&writer, path, start);
+  if (ret < 0)
+    {
+      fprintf(stderr, "%s: open failed (%d)\n", path, ret);
+      goto out;
+    }
+
+  /* Topic ids are table indices, described up front so that every
+   * sample in the log can be decoded.
+   */
+
+  for (i = 0; i < ntopics; i++)
+    {
+      orb_log_writer_topic(&writer, i, topics[i].meta->o_name,
+                           topics[i].meta->o_size, topics[i].instance);
+    }
+
+  g_record_exit = false;
+  signal(SIGINT, record_exit_handler);
+
+  if (seconds > 0)
+    {
+      end = start + seconds * 1000000ull;
+    }
+
+  printf("recording %d topics to %s\n", ntopics, path);
+
+  while (!g_record_exit && (end == 0 || orb_absolute_time() < end))
+    {
+      if (poll(fds, ntopics, RECORD_POLL_TIMEOUT) <= 0)
+        {
+          continue;
+        }
+
+      for (i = 0; i < ntopics; i++)
+        {
+          if (fds[i].revents & POLLIN)
+            {
+              record_drain(&writer, &topics[i], i, fds[i].fd, buffer);
+            }
+        }
+    }
+
+  ret = orb_log_writer_close(&writer);
+  if (ret < 0)
+    {
+      fprintf(stderr, "%s: write failed (%d)\n", path, ret);
+    }
+
+  printf("%" PRIu64 " bytes in %" PRIu64 " ms\n", writer.written,
+         (orb_absolute_time() - start) / 1000);
+
+  for (i = 0; i < ntopics; i++)
+    {
+      printf("  %s%d: %lu samples, %lu lost, %lu dropped\n",
+             topics[i].meta->o_name, topics[i].instance, topics[i].count,
+             topics[i].lost, topics[i].dropped);
+    }
+
+out:
+  for (i = 0; i < ntopics; i++)
+    {
+      if (fds[i].fd >= 0)
+        {
+          orb_unsubscribe(fds[i].fd);
+        }
+    }
+
+  free(buffer);
+  return ret;
+}
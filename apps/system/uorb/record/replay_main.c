@@ -0,0 +1,314 @@
+/****************************************************************************
+ * apps/system/uorb/record/replay_main.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <uORB/uORB.h>
+
+#include "orb_log.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define REPLAY_DEFAULT_QUEUE  1
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct replay_topic_s
+{
+  FAR const struct orb_metadata *meta;
+  int               fd;           /* Advertiser, -1 if not replayed */
+  unsigned long     count;        /* Samples published */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static volatile bool g_replay_exit;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void replay_exit_handler(int signo)
+{
+  g_replay_exit = true;
+}
+
+static void replay_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-s speed] [-q queue] [-r] [file]\n"
+         "Publish the samples of a uorb_record log again.\n"
+         "  -s  Speed factor, 0 publishes as fast as possible "
+         "(default 1)\n"
+         "  -q  Queue size of the advertised topics (default %d)\n"
+         "  -r  Restamp: overwrite the leading uint64_t timestamp of each\n"
+         "      sample with the publish time\n"
+         "  file  Log file (default %s)\n",
+         progname, REPLAY_DEFAULT_QUEUE, CONFIG_UORB_RECORD_PATH);
+}
+
+/****************************************************************************
+ * Name: replay_advertise
+ *
+ * Description:
+ *   Advertise a logged topic at its recorded instance. A topic this image
+ *   doesn't know is published with metadata built from the log.
+ ****************************************************************************/
+
+static void replay_advertise(FAR struct replay_topic_s *topic,
+                             FAR const struct orb_log_topic_info_s *info,
+                             unsigned int queue)
+{
+  FAR struct orb_metadata *meta;
+  int instance = info->instance;
+
+  topic->fd   = -1;
+  topic->meta = orb_get_meta(info->name);
+
+  if (topic->meta == NULL)
+    {
+      /* Never freed: the node keeps a pointer to it (SNIOC_SET_USERPRIV)
+       * and may outlive us.
+       */
+
+      meta = calloc(1, sizeof(*meta) + strlen(info->name) + 1);
+      if (meta == NULL)
+        {
+          return;
+        }
+
+      strcpy((FAR char *)(meta + 1), info->name);
+      meta->o_name = (FAR const char *)(meta + 1);
+      meta->o_size = info->esize;
+      topic->meta  = meta;
+    }
+  else if (topic->meta->o_size != info->esize)
+    {
+      fprintf(stderr, "%s: size %u, logged %u, skipped\n", info->name,
+              topic->meta->o_size, info->esize);
+      return;
+    }
+
+  if (orb_exists(topic->meta, instance) == 0)
+    {
+      fprintf(stderr, "%s%d: already advertised, samples are mixed\n",
+              info->name, instance);
+    }
+
+  topic->fd = orb_advertise_multi_queue(topic->meta, NULL, &instance,
+                                        queue);
+  if (topic->fd < 0)
+    {
+      fprintf(stderr, "%s%d: advertise failed (%d)\n", info->name,
+              info->instance, errno);
+    }
+}
+
+/****************************************************************************
+ * Name: replay_wait
+ *
+ * Description:
+ *   Sleep until an absolute CLOCK_MONOTONIC time in us, the clock
+ *   orb_absolute_time() reads.
+ ****************************************************************************/
+
+static void replay_wait(orb_abstime deadline)
+{
+  struct timespec ts;
+
+  ts.tv_sec  = deadline / 1000000;
+  ts.tv_nsec = (deadline % 1000000) * 1000;
+
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+         EINTR && !g_replay_exit);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  FAR struct replay_topic_s *topics;
+  FAR struct orb_log_reader_s *reader;
+  FAR const char *path = CONFIG_UORB_RECORD_PATH;
+  struct orb_log_entry_s entry;
+  FAR uint8_t *sample = NULL;
+  orb_abstime first = 0;
+  orb_abstime start = 0;
+  orb_abstime now;
+  unsigned long total = 0;
+  unsigned int queue = REPLAY_DEFAULT_QUEUE;
+  bool restamp = false;
+  float speed = 1.0f;
+  int ret;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "s:q:rh")) != -1)
+    {
+      switch (opt)
+        {
+          case 's':
+            speed = atof(optarg);
+            break;
+
+          case 'q':
+            queue = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'r':
+            restamp = true;
+            break;
+
+          default:
+            replay_usage(argv[0]);
+            return opt == 'h' ? 0 : -EINVAL;
+        }
+    }
+
+  if (speed < 0 || queue == 0)
+    {
+      replay_usage(argv[0]);
+      return -EINVAL;
+    }
+
+  if (optind < argc)
+    {
+      path = argv[optind];
+    }
+
+  /* The reader holds the topic table of the log, keep it off the stack */
+
+  reader = malloc(sizeof(*reader));
+  topics = malloc(ORB_LOG_MAX_TOPICS * sizeof(*topics));
+  sample = malloc(UINT16_MAX);
+  if (reader == NULL || topics == NULL || sample == NULL)
+    {
+      ret = -ENOMEM;
+      goto out_free;
+    }
+
+  for (i = 0; i < ORB_LOG_MAX_TOPICS; i++)
+    {
+      topics[i].meta  = NULL;
+      topics[i].fd    = -1;
+      topics[i].count = 0;
+    }
+
+  ret = orb_log_reader_open(reader, path);
+  if (ret < 0)
+    {
+      fprintf(stderr, "%s: open failed (%d)\n", path, ret);
+      goto out_free;
+    }
+
+  g_replay_exit = false;
+  signal(SIGINT, replay_exit_handler);
+
+  while (!g_replay_exit && (ret = orb_log_reader_next(reader, &entry)) > 0)
+    {
+      FAR struct replay_topic_s *topic = &topics[entry.id];
+
+      if (entry.type == ORB_LOG_TOPIC)
+        {
+          replay_advertise(topic, entry.topic, queue);
+          continue;
+        }
+
+      if (topic->fd < 0)
+        {
+          continue;
+        }
+
+      /* Keep the recorded spacing, scaled by speed, relative to the first
+       * sample. A late publish doesn't shift the following ones.
+       */
+
+      if (start == 0)
+        {
+          first = entry.timestamp;
+          start = orb_absolute_time();
+        }
+      else if (speed > 0)
+        {
+          replay_wait(start + (orb_abstime)((entry.timestamp - first) /
+                                            speed));
+        }
+
+      /* Block buffer data is aligned but read-only for us */
+
+      memcpy(sample, entry.data, entry.topic->esize);
+
+      if (restamp && entry.topic->esize >= sizeof(uint64_t))
+        {
+          now = orb_absolute_time();
+          memcpy(sample, &now, sizeof(now));
+        }
+
+      if (orb_publish(topic->meta, topic->fd, sample) == OK)
+        {
+          topic->count++;
+          total++;
+        }
+    }
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "%s: corrupt log (%d)\n", path, ret);
+    }
+
+  printf("%lu samples in %" PRIu64 " ms\n", total,
+         start ? (orb_absolute_time() - start) / 1000 : 0);
+
+  for (i = 0; i < ORB_LOG_MAX_TOPICS; i++)
+    {
+      if (topics[i].fd >= 0)
+        {
+          printf("  %s%d: %lu samples\n", topics[i].meta->o_name,
+                 reader->topics[i].instance, topics[i].count);
+          orb_unadvertise(topics[i].fd);
+        }
+    }
+
+  orb_log_reader_close(reader);
+
+out_free:
+  free(sample);
+  free(topics);
+  free(reader);
+  return ret;
+}
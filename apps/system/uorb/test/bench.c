@@ -0,0 +1,1081 @@
+/****************************************************************************
+ * apps/system/uorb/test/bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utility.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_DEFAULT_RATE     1000
+#define BENCH_DEFAULT_COUNT    2000
+#define BENCH_DEFAULT_NSUBS    4
+#define BENCH_DEFAULT_SIZES    "16,64,256,1024"
+#define BENCH_DEFAULT_QUEUES   "1,4,16"
+#define BENCH_DEFAULT_BATCHES  "0,5000"
+#define BENCH_DEFAULT_TESTS    "lrfwb"
+
+#define BENCH_MAX_LIST         8
+#define BENCH_MAX_NSUBS        16
+#define BENCH_MAX_SIZE         4096
+#define BENCH_MAX_TOPICS       128
+#define BENCH_COPY_BATCH       16
+#define BENCH_POLL_TIMEOUT     1000 /* ms */
+#define BENCH_SPIN_RATE        1000 /* Pace faster rates by spinning */
+#define BENCH_SWEEP_TIME       200  /* ms per step of the rate sweep */
+#define BENCH_SWEEP_MAX        1024000
+#define BENCH_SEQ_STOP         UINT32_MAX
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Every bench topic starts with this, the rest is payload */
+
+struct bench_hdr_s
+{
+  uint64_t timestamp;   /* Sample generation time */
+  uint32_t seq;
+  uint32_t reserved;
+};
+
+struct bench_param_s
+{
+  unsigned rate;                      /* Publish rate of paced runs, Hz */
+  unsigned count;                     /* Samples per run */
+  unsigned nsubs;                     /* Fan-out up to this many */
+  bool     fast;                      /* Use fast path topics */
+  unsigned sizes[BENCH_MAX_LIST];
+  unsigned nsizes;
+  unsigned queues[BENCH_MAX_LIST];
+  unsigned nqueues;
+  unsigned batches[BENCH_MAX_LIST];   /* Batch intervals, us */
+  unsigned nbatches;
+};
+
+struct bench_topic_s
+{
+  struct orb_metadata meta;
+  FAR const char *tag;
+  unsigned queue;
+  bool fast;
+  char name[ORB_PATH_MAX];
+};
+
+struct bench_sub_s
+{
+  FAR const struct orb_metadata *meta;
+  FAR uint32_t     *latency;  /* us, one per received sample, or NULL */
+  unsigned          count;    /* Samples published in the run */
+  unsigned          received;
+  unsigned long     lost;
+  unsigned long     wakeups;  /* poll() returns with data */
+  orb_abstime       first;    /* Generation time of the first sample */
+  orb_abstime       last;     /* Time the last sample was copied */
+  pthread_t         thread;
+  int               fd;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_topic_s g_bench_topics[BENCH_MAX_TOPICS];
+static unsigned g_bench_ntopics;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1000000000ull * ts.tv_sec + ts.tv_nsec;
+}
+
+static int bench_compare(FAR const void *a, FAR const void *b)
+{
+  uint32_t x = *(FAR const uint32_t *)a;
+  uint32_t y = *(FAR const uint32_t *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Sort values and print "p50 x p99 y max z" */
+
+static void bench_print_dist(FAR uint32_t *values, unsigned n)
+{
+  if (n == 0)
+    {
+      printf("p50 - p99 - max -");
+      return;
+    }
+
+  qsort(values, n, sizeof(uint32_t), bench_compare);
+  printf("p50 %" PRIu32 " p99 %" PRIu32 " max %" PRIu32,
+         values[n / 2], values[n * 99 / 100], values[n - 1]);
+}
+
+static unsigned bench_parse_list(FAR const char *str, FAR unsigned *list)
+{
+  FAR char *end;
+  unsigned n = 0;
+
+  while (*str != '\0' && n < BENCH_MAX_LIST)
+    {
+      list[n++] = strtoul(str, &end, 0);
+      if (end == str)
+        {
+          return 0;
+        }
+
+      str = *end == ',' ? end + 1 : end;
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: bench_meta
+ *
+ * Description:
+ *   Metadata of a bench topic of the given size. Each queue size gets its
+ *   own topic: the first advertiser fixes the queue of a topic.
+ ****************************************************************************/
+
+static FAR const struct orb_metadata *
+bench_meta(FAR const char *tag, unsigned size, unsigned queue, bool fast)
+{
+  FAR struct bench_topic_s *topic;
+  unsigned i;
+
+  for (i = 0; i < g_bench_ntopics; i++)
+    {
+      topic = &g_bench_topics[i];
+      if (topic->meta.o_size == size && topic->queue == queue &&
+          topic->fast == fast && !strcmp(topic->tag, tag))
+        {
+          return &topic->meta;
+        }
+    }
+
+  if (g_bench_ntopics == BENCH_MAX_TOPICS)
+    {
+      return NULL;
+    }
+
+  /* Names must not end with a digit, the instance is appended */
+
+  topic = &g_bench_topics[g_bench_ntopics++];
+  snprintf(topic->name, sizeof(topic->name), "bench_%s_%u_%u_%s",
+           tag, size, queue, fast ? "fast" : "dev");
+
+  topic->tag         = tag;
+  topic->queue       = queue;
+  topic->fast        = fast;
+  topic->meta.o_name = topic->name;
+  topic->meta.o_size = size;
+#ifdef CONFIG_UORB_FASTPATH
+  topic->meta.o_fast = fast;
+#endif
+
+  return &topic->meta;
+}
+
+/****************************************************************************
+ * Name: bench_subscriber
+ *
+ * Description:
+ *   poll(), then drain everything queued and record the latency of each
+ *   sample. Ends with the last sample of the run or a poll timeout.
+ ****************************************************************************/
+
+static FAR void *bench_subscriber(FAR void *arg)
+{
+  FAR struct bench_sub_s *sub = arg;
+  FAR const struct bench_hdr_s *hdr;
+  struct orb_batch batch;
+  struct pollfd fds;
+  FAR uint8_t *buffer;
+  orb_abstime now;
+  ssize_t n;
+  ssize_t i;
+
+  buffer = malloc(sub->meta->o_size * BENCH_COPY_BATCH);
+  if (buffer == NULL)
+    {
+      return NULL;
+    }
+
+  memset(&batch, 0, sizeof(batch));
+  fds.fd     = sub->fd;
+  fds.events = POLLIN;
+
+  for (; ; )
+    {
+      if (poll(&fds, 1, BENCH_POLL_TIMEOUT) <= 0)
+        {
+          break;
+        }
+
+      sub->wakeups++;
+
+      while ((n = orb_copy_batch(sub->meta, sub->fd, buffer,
+                                 BENCH_COPY_BATCH, &batch)) > 0)
+        {
+          now = orb_absolute_time();
+          sub->lost += batch.lost;
+
+          for (i = 0; i < n; i++)
+            {
+              hdr = (FAR const struct bench_hdr_s *)
+                    (buffer + i * sub->meta->o_size);
+
+              if (sub->latency != NULL && sub->received < sub->count)
+                {
+                  sub->latency[sub->received] = now - hdr->timestamp;
+                }
+
+              if (sub->received++ == 0)
+                {
+                  sub->first = hdr->timestamp;
+                }
+
+              if (hdr->seq == sub->count - 1)
+                {
+                  sub->last = now;
+                  goto out;
+                }
+            }
+        }
+    }
+
+out:
+  free(buffer);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_sub_start
+ *
+ * Description:
+ *   Subscribe and start a subscriber thread one priority above the caller,
+ *   so that it preempts the publisher on every wakeup like a consumer of
+ *   a sensor does. The publisher then falls behind only once the CPU is
+ *   saturated.
+ ****************************************************************************/
+
+static int bench_sub_start(FAR struct bench_sub_s *sub,
+                           FAR const struct orb_metadata *meta,
+                           unsigned count, unsigned batch_interval,
+                           bool record)
+{
+  struct sched_param sparam;
+  struct orb_batch batch;
+  pthread_attr_t attr;
+  FAR uint8_t *buffer;
+  int policy;
+  int ret;
+
+  memset(sub, 0, sizeof(*sub));
+  sub->meta  = meta;
+  sub->count = count;
+
+  if (record)
+    {
+      sub->latency = malloc(count * sizeof(uint32_t));
+      if (sub->latency == NULL)
+        {
+          return -ENOMEM;
+        }
+    }
+
+  sub->fd = orb_subscribe(meta);
+  if (sub->fd < 0)
+    {
+      ret = -errno;
+      goto err;
+    }
+
+  if (batch_interval > 0 &&
+      orb_set_batch_interval(sub->fd, batch_interval) < 0)
+    {
+      ret = -errno;
+      goto err_unsub;
+    }
+
+  /* Drop what an earlier run left in the topic */
+
+  buffer = malloc(meta->o_size * BENCH_COPY_BATCH);
+  if (buffer != NULL)
+    {
+      memset(&batch, 0, sizeof(batch));
+      while (orb_copy_batch(meta, sub->fd, buffer, BENCH_COPY_BATCH,
+                            &batch) > 0);
+      free(buffer);
+    }
+
+  pthread_attr_init(&attr);
+  if (pthread_getschedparam(pthread_self(), &policy, &sparam) == 0 &&
+      sparam.sched_priority < sched_get_priority_max(policy))
+    {
+      sparam.sched_priority++;
+      pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+      pthread_attr_setschedpolicy(&attr, policy);
+      pthread_attr_setschedparam(&attr, &sparam);
+    }
+
+  ret = pthread_create(&sub->thread, &attr, bench_subscriber, sub);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      ret = -ret;
+      goto err_unsub;
+    }
+
+  return OK;
+
+err_unsub:
+  orb_unsubscribe(sub->fd);
+err:
+  free(sub->latency);
+  sub->latency = NULL;
+  return ret;
+}
+
+static void bench_sub_stop(FAR struct bench_sub_s *sub)
+{
+  pthread_join(sub->thread, NULL);
+  orb_unsubscribe(sub->fd);
+}
+
+/****************************************************************************
+ * Name: bench_publish
+ *
+ * Description:
+ *   Generate count samples at rate Hz (back to back if 0) and publish
+ *   them. With a batch interval, samples are held like in a hardware FIFO
+ *   and published in a burst once the oldest is that old.
+ *
+ * Input Parameters:
+ *   cost   If not NULL, ns spent in each orb_publish().
+ ****************************************************************************/
+
+static int bench_publish(FAR const struct orb_metadata *meta, int afd,
+                         unsigned count, unsigned rate,
+                         unsigned batch_interval, FAR uint32_t *cost)
+{
+  FAR struct bench_hdr_s *hdr;
+  FAR uint8_t *fifo;
+  struct timespec ts;
+  orb_abstime now;
+  uint64_t deadline;
+  uint64_t start;
+  unsigned depth = 1;
+  unsigned nfifo = 0;
+  unsigned i;
+  unsigned k;
+  long period = 0;
+
+  if (rate > 0)
+    {
+      period = 1000000000l / rate;
+      depth += (uint64_t)batch_interval * rate / 1000000;
+    }
+
+  fifo = zalloc(meta->o_size * depth);
+  if (fifo == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  for (i = 0; i < count; i++)
+    {
+      if (period > 0)
+        {
+          ts.tv_nsec += period;
+          if (ts.tv_nsec >= 1000000000l)
+            {
+              ts.tv_nsec -= 1000000000l;
+              ts.tv_sec++;
+            }
+
+          if (rate > BENCH_SPIN_RATE)
+            {
+              deadline = 1000000000ull * ts.tv_sec + ts.tv_nsec;
+              while (bench_ns() < deadline);
+            }
+          else
+            {
+              clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            }
+        }
+
+      now = orb_absolute_time();
+      hdr = (FAR struct bench_hdr_s *)(fifo + nfifo++ * meta->o_size);
+      hdr->timestamp = now;
+      hdr->seq       = i;
+
+      hdr = (FAR struct bench_hdr_s *)fifo;
+      if (nfifo == depth || i == count - 1 ||
+          now - hdr->timestamp >= batch_interval)
+        {
+          for (k = 0; k < nfifo; k++)
+            {
+              start = bench_ns();
+              orb_publish(meta, afd, fifo + k * meta->o_size);
+              if (cost != NULL)
+                {
+                  cost[i + 1 - nfifo + k] = bench_ns() - start;
+                }
+            }
+
+          nfifo = 0;
+        }
+
+      /* Don't burst to catch up after being held off, that measures the
+       * queue size rather than the path.
+       */
+
+      if (period > 0 && now > (orb_abstime)ts.tv_sec * 1000000 +
+                             ts.tv_nsec / 1000 + period / 1000)
+        {
+          clock_gettime(CLOCK_MONOTONIC, &ts);
+        }
+    }
+
+  free(fifo);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_run
+ *
+ * Description:
+ *   Advertise, start nsubs subscribers, publish one run and wait for the
+ *   subscribers to finish. With record, the caller frees subs[].latency.
+ ****************************************************************************/
+
+static int bench_run(FAR const struct orb_metadata *meta, unsigned queue,
+                     FAR struct bench_sub_s *subs, unsigned nsubs,
+                     unsigned count, unsigned rate, unsigned batch_interval,
+                     bool record, FAR uint32_t *cost)
+{
+  struct orb_state state;
+  int instance = 0;
+  unsigned started;
+  unsigned i;
+  int afd;
+  int ret;
+
+  if (meta == NULL)
+    {
+      return test_fail("too many bench topics");
+    }
+
+  afd = orb_advertise_multi_queue(meta, NULL, &instance, queue);
+  if (afd < 0)
+    {
+      return test_fail("%s: advertise failed (%d)", meta->o_name, errno);
+    }
+
+  for (started = 0; started < nsubs; started++)
+    {
+      ret = bench_sub_start(&subs[started], meta, count, batch_interval,
+                            record);
+      if (ret < 0)
+        {
+          test_fail("%s: subscribe failed (%d)", meta->o_name, ret);
+          goto out;
+        }
+    }
+
+  /* The publisher learns the batch interval like a sensor driver does */
+
+  if (batch_interval > 0 && orb_get_state(afd, &state) == OK)
+    {
+      batch_interval = state.min_batch_interval;
+    }
+
+  ret = bench_publish(meta, afd, count, rate, batch_interval, cost);
+
+out:
+  for (i = 0; i < started; i++)
+    {
+      bench_sub_stop(&subs[i]);
+    }
+
+  orb_unadvertise(afd);
+  return ret;
+}
+
+static FAR const char *bench_path(FAR const struct bench_param_s *param)
+{
+  return param->fast ? "fast" : "dev";
+}
+
+/****************************************************************************
+ * Name: bench_latency
+ *
+ * Description:
+ *   Publish to subscriber latency distribution per topic size, one
+ *   subscriber, paced publisher.
+ ****************************************************************************/
+
+static int bench_latency(FAR const struct bench_param_s *param)
+{
+  FAR const struct orb_metadata *meta;
+  struct bench_sub_s sub;
+  unsigned queue = param->queues[0];
+  unsigned i;
+  int ret;
+
+  printf("latency, %u Hz, queue %u, us:\n", param->rate, queue);
+
+  for (i = 0; i < param->nsizes; i++)
+    {
+      meta = bench_meta("lat", param->sizes[i], queue, param->fast);
+      ret  = bench_run(meta, queue, &sub, 1, param->count, param->rate, 0,
+                       true, NULL);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      printf("  %-4s %5u B  ", bench_path(param), param->sizes[i]);
+      bench_print_dist(sub.latency, sub.received);
+      printf("  lost %u/%u\n", param->count - sub.received,
+             param->count);
+      free(sub.latency);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_rate
+ *
+ * Description:
+ *   Maximum sustained rate per topic size and queue: double the publish
+ *   rate from the base rate until the subscriber loses samples, or the
+ *   publisher doesn't get anywhere near the pace any more. Reports the
+ *   highest rate measured at the subscriber without loss.
+ ****************************************************************************/
+
+static int bench_rate(FAR const struct bench_param_s *param)
+{
+  FAR const struct orb_metadata *meta;
+  struct bench_sub_s sub;
+  unsigned count;
+  unsigned rate;
+  unsigned i;
+  unsigned j;
+  uint64_t achieved;
+  uint64_t best;
+  int ret;
+
+  printf("sustained rate, %d ms per step, msg/s:\n", BENCH_SWEEP_TIME);
+
+  for (i = 0; i < param->nsizes; i++)
+    {
+      for (j = 0; j < param->nqueues; j++)
+        {
+          meta = bench_meta("rate", param->sizes[i], param->queues[j],
+                            param->fast);
+          best = 0;
+
+          for (rate = param->rate; rate <= BENCH_SWEEP_MAX; rate *= 2)
+            {
+              count = rate * BENCH_SWEEP_TIME / 1000;
+              ret   = bench_run(meta, param->queues[j], &sub, 1, count,
+                                rate, 0, false, NULL);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              achieved = sub.last > sub.first ?
+                         (uint64_t)(sub.received - 1) * 1000000 /
+                         (sub.last - sub.first) : 0;
+              if (sub.received < count || achieved < rate / 2)
+                {
+                  break;
+                }
+
+              best = MAX(best, achieved);
+            }
+
+          printf("  %-4s %5u B q %2u  max %8" PRIu64 " (%" PRIu64
+                 " KB/s)", bench_path(param), param->sizes[i],
+                 param->queues[j], best, best * param->sizes[i] / 1024);
+
+          if (rate <= BENCH_SWEEP_MAX)
+            {
+              printf("  at %u: %" PRIu64 ", lost %u/%u\n", rate,
+                     achieved, count - MIN(sub.received, count), count);
+            }
+          else
+            {
+              printf("  (sweep limit)\n");
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_fanout
+ *
+ * Description:
+ *   Cost of orb_publish() and delivery latency with 1..nsubs subscribers
+ *   waiting in poll().
+ ****************************************************************************/
+
+static int bench_fanout(FAR const struct bench_param_s *param)
+{
+  FAR const struct orb_metadata *meta;
+  struct bench_sub_s subs[BENCH_MAX_NSUBS];
+  FAR uint32_t *latency;
+  FAR uint32_t *cost;
+  unsigned queue = param->queues[0];
+  unsigned size = param->sizes[0];
+  unsigned lost;
+  unsigned n;
+  unsigned i;
+  unsigned j;
+  int ret = OK;
+
+  cost    = malloc(param->count * sizeof(uint32_t));
+  latency = malloc(param->count * param->nsubs * sizeof(uint32_t));
+  if (cost == NULL || latency == NULL)
+    {
+      free(cost);
+      free(latency);
+      return test_fail("no memory");
+    }
+
+  printf("fan-out, %u B, %u Hz, queue %u:\n", size, param->rate, queue);
+
+  meta = bench_meta("fan", size, queue, param->fast);
+  for (i = 1; i <= param->nsubs; i++)
+    {
+      ret = bench_run(meta, queue, subs, i, param->count, param->rate, 0,
+                      true, cost);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      /* Latency over all deliveries of the run */
+
+      for (j = 0, n = 0, lost = 0; j < i; j++)
+        {
+          memcpy(latency + n, subs[j].latency,
+                 subs[j].received * sizeof(uint32_t));
+          n    += subs[j].received;
+          lost += param->count - subs[j].received;
+          free(subs[j].latency);
+        }
+
+      printf("  %-4s %2u subs  publish ns ", bench_path(param), i);
+      bench_print_dist(cost, param->count);
+      printf("  latency us ");
+      bench_print_dist(latency, n);
+      printf("  lost %u\n", lost);
+    }
+
+  free(latency);
+  free(cost);
+  return ret;
+}
+
+static FAR void *bench_pong(FAR void *arg)
+{
+  FAR const struct orb_metadata **metas = arg;
+  struct bench_hdr_s hdr;
+  struct pollfd fds;
+  int instance = 0;
+  int afd;
+
+  fds.fd     = orb_subscribe(metas[0]);
+  fds.events = POLLIN;
+  afd = orb_advertise_multi_queue(metas[1], NULL, &instance, 1);
+
+  while (fds.fd >= 0 && afd >= 0 && poll(&fds, 1, BENCH_POLL_TIMEOUT) > 0)
+    {
+      if (orb_copy(metas[0], fds.fd, &hdr) == OK)
+        {
+          if (hdr.seq == BENCH_SEQ_STOP)
+            {
+              break;
+            }
+
+          orb_publish(metas[1], afd, &hdr);
+        }
+    }
+
+  orb_unsubscribe(fds.fd);
+  orb_unadvertise(afd);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_wake
+ *
+ * Description:
+ *   Cost of checking for data: orb_check() and poll() with a zero timeout
+ *   when nothing is new, and the poll() wakeup latency measured as half
+ *   of a ping-pong round trip between two threads.
+ ****************************************************************************/
+
+static int bench_wake(FAR const struct bench_param_s *param)
+{
+  FAR const struct orb_metadata *metas[2];
+  struct bench_hdr_s reply;
+  struct bench_hdr_s hdr;
+  struct pollfd fds;
+  FAR uint32_t *rtt;
+  pthread_t thread;
+  uint64_t check;
+  uint64_t start;
+  bool updated;
+  int instance = 0;
+  int afd;
+  unsigned i;
+  unsigned n = 0;
+  int ret;
+
+  metas[0] = bench_meta("ping", sizeof(hdr), 1, param->fast);
+  metas[1] = bench_meta("pong", sizeof(hdr), 1, param->fast);
+  if (metas[0] == NULL || metas[1] == NULL)
+    {
+      return test_fail("too many bench topics");
+    }
+
+  rtt = malloc(param->count * sizeof(uint32_t));
+  if (rtt == NULL)
+    {
+      return test_fail("no memory");
+    }
+
+  memset(&hdr, 0, sizeof(hdr));
+  afd    = orb_advertise_multi_queue(metas[0], NULL, &instance, 1);
+  fds.fd = orb_subscribe(metas[1]);
+  if (afd < 0 || fds.fd < 0)
+    {
+      ret = test_fail("ping/pong: advertise/subscribe failed (%d)", errno);
+      goto out;
+    }
+
+  fds.events = POLLIN;
+
+  /* Idle checks on an up to date subscription */
+
+  orb_copy(metas[1], fds.fd, &reply);
+  start = bench_ns();
+  for (i = 0; i < param->count; i++)
+    {
+      orb_check(fds.fd, &updated);
+    }
+
+  check = (bench_ns() - start) / param->count;
+
+  start = bench_ns();
+  for (i = 0; i < param->count; i++)
+    {
+      poll(&fds, 1, 0);
+    }
+
+  printf("wake:\n  %-4s orb_check %" PRIu64 " ns, poll(0) %" PRIu64
+         " ns\n", bench_path(param), check,
+         (bench_ns() - start) / param->count);
+
+  ret = pthread_create(&thread, NULL, bench_pong, metas);
+  if (ret != 0)
+    {
+      ret = test_fail("pthread_create failed (%d)", ret);
+      goto out;
+    }
+
+  /* Give the pong thread time to subscribe and advertise */
+
+  usleep(100000);
+
+  for (i = 0; i < param->count; i++)
+    {
+      hdr.seq       = i;
+      hdr.timestamp = orb_absolute_time();
+      orb_publish(metas[0], afd, &hdr);
+
+      reply.seq = BENCH_SEQ_STOP;
+      while (poll(&fds, 1, BENCH_POLL_TIMEOUT) > 0 &&
+             orb_copy(metas[1], fds.fd, &reply) == OK && reply.seq != i);
+
+      if (reply.seq == i)
+        {
+          rtt[n++] = (orb_absolute_time() - reply.timestamp) / 2;
+        }
+    }
+
+  hdr.seq = BENCH_SEQ_STOP;
+  orb_publish(metas[0], afd, &hdr);
+  pthread_join(thread, NULL);
+
+  printf("  %-4s poll wakeup us ", bench_path(param));
+  bench_print_dist(rtt, n);
+  printf("  (ping-pong / 2), lost %u/%u\n", param->count - n,
+         param->count);
+  ret = OK;
+
+out:
+  if (fds.fd >= 0)
+    {
+      orb_unsubscribe(fds.fd);
+    }
+
+  if (afd >= 0)
+    {
+      orb_unadvertise(afd);
+    }
+
+  free(rtt);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_batch
+ *
+ * Description:
+ *   A/B of queue sizes against batch intervals: the publisher holds
+ *   samples for the interval the subscriber asked for with
+ *   orb_set_batch_interval(). Fewer wakeups for more latency, and samples
+ *   lost once a batch no longer fits the queue.
+ ****************************************************************************/
+
+static int bench_batch(FAR const struct bench_param_s *param)
+{
+  FAR const struct orb_metadata *meta;
+  struct bench_sub_s sub;
+  unsigned size = param->sizes[0];
+  unsigned i;
+  unsigned j;
+  int ret;
+
+  printf("batching, %u B, %u Hz:\n", size, param->rate);
+
+  for (i = 0; i < param->nqueues; i++)
+    {
+      for (j = 0; j < param->nbatches; j++)
+        {
+          meta = bench_meta("batch", size, param->queues[i], param->fast);
+          ret  = bench_run(meta, param->queues[i], &sub, 1, param->count,
+                           param->rate, param->batches[j], true, NULL);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          printf("  %-4s q %2u batch %6u us  latency us ",
+                 bench_path(param), param->queues[i], param->batches[j]);
+          bench_print_dist(sub.latency, sub.received);
+          printf("  wakeups %lu  lost %u/%u\n", sub.wakeups,
+                 param->count - sub.received, param->count);
+          free(sub.latency);
+        }
+    }
+
+  return OK;
+}
+
+static void show_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-t tests] [-r rate] [-n count] [-s sizes] "
+         "[-q queues]\n"
+         "          [-b intervals] [-N subs] [-f]\n"
+         "  -t  Tests to run (default %s):\n"
+         "        l  latency per topic size\n"
+         "        r  sustained rate per topic size and queue\n"
+         "        f  fan-out to 1..N subscribers\n"
+         "        w  orb_check/poll cost and wakeup latency\n"
+         "        b  queue size x batch interval\n"
+         "  -r  Publish rate of paced runs in Hz (default %d)\n"
+         "  -n  Samples per run (default %d)\n"
+         "  -s  Topic sizes in bytes, min %zu (default %s)\n"
+         "  -q  Queue sizes, the first one for l and f (default %s)\n"
+         "  -b  Batch intervals in us (default %s)\n"
+         "  -N  Maximum subscribers of the fan-out (default %d)\n"
+#ifdef CONFIG_UORB_FASTPATH
+         "  -f  Use fast path topics (ORB_DEFINE_FAST)\n"
+#endif
+         "Rates above 1/CONFIG_USEC_PER_TICK need CONFIG_SCHED_TICKLESS.\n",
+         progname, BENCH_DEFAULT_TESTS, BENCH_DEFAULT_RATE,
+         BENCH_DEFAULT_COUNT, sizeof(struct bench_hdr_s),
+         BENCH_DEFAULT_SIZES, BENCH_DEFAULT_QUEUES, BENCH_DEFAULT_BATCHES,
+         BENCH_DEFAULT_NSUBS);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct bench_param_s param;
+  FAR const char *tests = BENCH_DEFAULT_TESTS;
+  int ret = OK;
+  unsigned i;
+  int opt;
+
+  memset(&param, 0, sizeof(param));
+  param.rate     = BENCH_DEFAULT_RATE;
+  param.count    = BENCH_DEFAULT_COUNT;
+  param.nsubs    = BENCH_DEFAULT_NSUBS;
+  param.nsizes   = bench_parse_list(BENCH_DEFAULT_SIZES, param.sizes);
+  param.nqueues  = bench_parse_list(BENCH_DEFAULT_QUEUES, param.queues);
+  param.nbatches = bench_parse_list(BENCH_DEFAULT_BATCHES, param.batches);
+
+  while ((opt = getopt(argc, argv, "t:r:n:s:q:b:N:fh")) != -1)
+    {
+      switch (opt)
+        {
+          case 't':
+            tests = optarg;
+            break;
+
+          case 'r':
+            param.rate = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'n':
+            param.count = strtoul(optarg, NULL, 0);
+            break;
+
+          case 's':
+            param.nsizes = bench_parse_list(optarg, param.sizes);
+            break;
+
+          case 'q':
+            param.nqueues = bench_parse_list(optarg, param.queues);
+            break;
+
+          case 'b':
+            param.nbatches = bench_parse_list(optarg, param.batches);
+            break;
+
+          case 'N':
+            param.nsubs = strtoul(optarg, NULL, 0);
+            break;
+
+#ifdef CONFIG_UORB_FASTPATH
+          case 'f':
+            param.fast = true;
+            break;
+#endif
+
+          default:
+            show_usage(argv[0]);
+            return opt == 'h' ? 0 : -EINVAL;
+        }
+    }
+
+  for (i = 0; i < param.nsizes; i++)
+    {
+      if (param.sizes[i] < sizeof(struct bench_hdr_s) ||
+          param.sizes[i] > BENCH_MAX_SIZE)
+        {
+          param.nsizes = 0;
+        }
+    }
+
+  for (i = 0; i < param.nqueues; i++)
+    {
+      if (param.queues[i] == 0)
+        {
+          param.nqueues = 0;
+        }
+    }
+
+  if (param.rate == 0 || param.count == 0 || param.nsizes == 0 ||
+      param.nqueues == 0 || param.nbatches == 0 || param.nsubs == 0 ||
+      param.nsubs > BENCH_MAX_NSUBS)
+    {
+      show_usage(argv[0]);
+      return -EINVAL;
+    }
+
+  for (; *tests != '\0' && ret == OK; tests++)
+    {
+      switch (*tests)
+        {
+          case 'l':
+            ret = bench_latency(&param);
+            break;
+
+          case 'r':
+            ret = bench_rate(&param);
+            break;
+
+          case 'f':
+            ret = bench_fanout(&param);
+            break;
+
+          case 'w':
+            ret = bench_wake(&param);
+            break;
+
+          case 'b':
+            ret = bench_batch(&param);
+            break;
+
+          default:
+            show_usage(argv[0]);
+            return -EINVAL;
+        }
+    }
+
+  if (ret != OK)
+    {
+      printf("FAIL\n");
+      return -1;
+    }
+
+  return 0;
+}
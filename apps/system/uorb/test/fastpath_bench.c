@@ -0,0 +1,366 @@
+/****************************************************************************
+ * apps/system/uorb/test/fastpath_bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utility.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_DEFAULT_RATE     1000
+#define BENCH_DEFAULT_COUNT    5000
+#define BENCH_DEFAULT_QUEUE    4
+#define BENCH_POLL_TIMEOUT     1000 /* ms */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_param_s
+{
+  unsigned rate;      /* Publish rate of latency run, Hz */
+  unsigned count;     /* Samples per run */
+  unsigned queue;     /* Queue size of the topic */
+};
+
+struct bench_sub_s
+{
+  FAR const struct orb_metadata *meta;
+  FAR uint32_t *latency;  /* us, one per received sample */
+  unsigned count;
+  unsigned received;
+  int fd;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int bench_compare(FAR const void *a, FAR const void *b)
+{
+  uint32_t x = *(FAR const uint32_t *)a;
+  uint32_t y = *(FAR const uint32_t *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+/****************************************************************************
+ * Name: bench_throughput
+ *
+ * Description:
+ *   Publish and copy back to back in one thread, as fast as possible.
+ *   This is the pure per-sample cost of each path.
+ ****************************************************************************/
+
+static int bench_throughput(FAR const struct orb_metadata *meta,
+                            FAR const struct bench_param_s *param)
+{
+  struct orb_bench_s sample;
+  orb_abstime start;
+  orb_abstime elapsed;
+  int instance = 0;
+  int afd;
+  int sfd;
+  unsigned i;
+
+  memset(&sample, 0, sizeof(sample));
+
+  afd = orb_advertise_multi_queue(meta, NULL, &instance, param->queue);
+  if (afd < 0)
+    {
+      return test_fail("%s: advertise failed (%d)", meta->o_name, errno);
+    }
+
+  sfd = orb_subscribe_multi(meta, instance);
+  if (sfd < 0)
+    {
+      orb_unadvertise(afd);
+      return test_fail("%s: subscribe failed (%d)", meta->o_name, errno);
+    }
+
+  start = orb_absolute_time();
+  for (i = 0; i < param->count; i++)
+    {
+      sample.seq = i;
+      if (orb_publish(meta, afd, &sample) != OK ||
+          orb_copy(meta, sfd, &sample) != OK)
+        {
+          break;
+        }
+    }
+
+  elapsed = orb_absolute_time() - start;
+
+  orb_unsubscribe(sfd);
+  orb_unadvertise(afd);
+
+  if (i != param->count)
+    {
+      return test_fail("%s: publish/copy failed at %u", meta->o_name, i);
+    }
+
+  printf("%-16s throughput %8" PRIu64 " msg/s  (%" PRIu64 " ns/msg)\n",
+         meta->o_name, elapsed ? (uint64_t)1000000 * i / elapsed : 0,
+         (uint64_t)1000 * elapsed / i);
+  return OK;
+}
+
+static FAR void *bench_subscriber(FAR void *arg)
+{
+  FAR struct bench_sub_s *sub = arg;
+  struct orb_bench_s sample;
+  struct pollfd fds;
+  uint32_t next = 0;
+
+  fds.fd     = sub->fd;
+  fds.events = POLLIN;
+
+  while (sub->received < sub->count)
+    {
+      if (poll(&fds, 1, BENCH_POLL_TIMEOUT) <= 0)
+        {
+          break;
+        }
+
+      if (orb_copy(sub->meta, sub->fd, &sample) != OK)
+        {
+          continue;
+        }
+
+      if (sample.seq < next)
+        {
+          continue; /* Latest sample again, nothing new */
+        }
+
+      sub->latency[sub->received++] = orb_elapsed_time(&sample.timestamp);
+      next = sample.seq + 1;
+      if (next == sub->count)
+        {
+          break;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_latency
+ *
+ * Description:
+ *   Publish at a fixed rate from this thread, a second thread poll()s and
+ *   copies. Latency is publish timestamp to the end of orb_copy().
+ ****************************************************************************/
+
+static int bench_latency(FAR const struct orb_metadata *meta,
+                         FAR const struct bench_param_s *param)
+{
+  struct orb_bench_s sample;
+  struct bench_sub_s sub;
+  struct timespec ts;
+  pthread_t thread;
+  uint64_t sum = 0;
+  long period;
+  int instance = 0;
+  int afd;
+  int ret;
+  unsigned i;
+
+  memset(&sample, 0, sizeof(sample));
+  memset(&sub, 0, sizeof(sub));
+
+  sub.meta    = meta;
+  sub.count   = param->count;
+  sub.latency = malloc(param->count * sizeof(uint32_t));
+  if (sub.latency == NULL)
+    {
+      return test_fail("no memory");
+    }
+
+  afd = orb_advertise_multi_queue(meta, NULL, &instance, param->queue);
+  sub.fd = orb_subscribe_multi(meta, instance);
+  if (afd < 0 || sub.fd < 0)
+    {
+      ret = test_fail("%s: advertise/subscribe failed (%d)",
+                      meta->o_name, errno);
+      goto out;
+    }
+
+  /* Drop what the throughput run left in the topic */
+
+  orb_copy(meta, sub.fd, &sample);
+
+  ret = pthread_create(&thread, NULL, bench_subscriber, &sub);
+  if (ret != 0)
+    {
+      ret = test_fail("%s: pthread_create failed (%d)", meta->o_name, ret);
+      goto out;
+    }
+
+  period = 1000000000l / param->rate;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  for (i = 0; i < param->count; i++)
+    {
+      ts.tv_nsec += period;
+      if (ts.tv_nsec >= 1000000000l)
+        {
+          ts.tv_nsec -= 1000000000l;
+          ts.tv_sec++;
+        }
+
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+      sample.seq       = i;
+      sample.timestamp = orb_absolute_time();
+      orb_publish(meta, afd, &sample);
+
+      /* Don't burst to catch up after being held off, that measures the
+       * queue size rather than the path.
+       */
+
+      if (sample.timestamp > (orb_abstime)ts.tv_sec * 1000000 +
+                             ts.tv_nsec / 1000 + period / 1000)
+        {
+          clock_gettime(CLOCK_MONOTONIC, &ts);
+        }
+    }
+
+  pthread_join(thread, NULL);
+
+  if (sub.received == 0)
+    {
+      ret = test_fail("%s: nothing received", meta->o_name);
+      goto out;
+    }
+
+  for (i = 0; i < sub.received; i++)
+    {
+      sum += sub.latency[i];
+    }
+
+  qsort(sub.latency, sub.received, sizeof(uint32_t), bench_compare);
+
+  printf("%-16s latency us: min %" PRIu32 " avg %" PRIu64
+         " p50 %" PRIu32 " p99 %" PRIu32 " max %" PRIu32
+         "  lost %u/%u\n",
+         meta->o_name, sub.latency[0], sum / sub.received,
+         sub.latency[sub.received / 2],
+         sub.latency[sub.received * 99 / 100],
+         sub.latency[sub.received - 1],
+         param->count - sub.received, param->count);
+  ret = OK;
+
+out:
+  if (sub.fd >= 0)
+    {
+      orb_unsubscribe(sub.fd);
+    }
+
+  if (afd >= 0)
+    {
+      orb_unadvertise(afd);
+    }
+
+  free(sub.latency);
+  return ret;
+}
+
+static void show_usage(FAR const char *progname)
+{
+  printf("Usage: %s [-r rate] [-n count] [-q queue]\n"
+         "  -r  Publish rate of the latency run in Hz (default %d)\n"
+         "  -n  Samples per run (default %d)\n"
+         "  -q  Topic queue size (default %d)\n"
+         "Rates above 1/CONFIG_USEC_PER_TICK need CONFIG_SCHED_TICKLESS.\n",
+         progname, BENCH_DEFAULT_RATE, BENCH_DEFAULT_COUNT,
+         BENCH_DEFAULT_QUEUE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct bench_param_s param;
+  int opt;
+
+  param.rate  = BENCH_DEFAULT_RATE;
+  param.count = BENCH_DEFAULT_COUNT;
+  param.queue = BENCH_DEFAULT_QUEUE;
+
+  while ((opt = getopt(argc, argv, "r:n:q:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 'r':
+            param.rate = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'n':
+            param.count = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'q':
+            param.queue = strtoul(optarg, NULL, 0);
+            break;
+
+          default:
+            show_usage(argv[0]);
+            return opt == 'h' ? 0 : -EINVAL;
+        }
+    }
+
+  if (param.rate == 0 || param.count == 0 || param.queue == 0)
+    {
+      show_usage(argv[0]);
+      return -EINVAL;
+    }
+
+  printf("%u samples of %zu bytes, queue %u, latency run at %u Hz\n",
+         param.count, sizeof(struct orb_bench_s), param.queue, param.rate);
+
+  /* Same message, same API; only the metadata selects the path */
+
+  if (bench_throughput(ORB_ID(orb_bench), &param) != OK ||
+      bench_throughput(ORB_ID(orb_bench_fast), &param) != OK ||
+      bench_latency(ORB_ID(orb_bench), &param) != OK ||
+      bench_latency(ORB_ID(orb_bench_fast), &param) != OK)
+    {
+      printf("FAIL\n");
+      return -1;
+    }
+
+  return 0;
+}
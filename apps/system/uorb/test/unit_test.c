@@ -23,6 +23,7 @@
  ****************************************************************************/
 
 #include <errno.h>
+#include <inttypes.h>
 #include <math.h>
 #include <poll.h>
 #include <string.h>
@@ -34,6 +35,10 @@
 
 #include "utility.h"
 
+#ifdef CONFIG_UORB_HUB
+#  include "hub/decimator.h"
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -43,6 +48,10 @@ static volatile int  g_num_messages_sent;
 static bool          g_pubsubtest_passed;
 static bool          g_pubsubtest_print;
 static int           g_pubsubtest_res;
+static volatile bool g_preempt_running;
+
+static struct orb_test_preempt_s g_preempt_samples[2];
+static struct orb_test_preempt_s g_preempt_copy;
 
 /****************************************************************************
  * Private Functions
@@ -873,6 +882,104 @@ int test_queue(void)
   return test_note("PASS orb queuing");
 }
 
+static int test_queue_batch(FAR const struct orb_metadata *meta)
+{
+  const int queue_size  = 16;
+  const int overflow_by = 5;
+  struct orb_test_medium_s sample;
+  struct orb_test_medium_s batch[16];
+  struct orb_batch state;
+  ssize_t n;
+  int instance = 0;
+  int ptopic;
+  int sfd;
+  int i;
+
+  test_note("Testing orb batch copy (%s)", meta->o_name);
+
+  memset(&sample, 0, sizeof(sample));
+  memset(&state, 0, sizeof(state));
+
+  ptopic = orb_advertise_multi_queue_persist(meta, &sample, &instance,
+                                             queue_size);
+  if (ptopic < 0)
+    {
+      return test_fail("advertise failed: %d", errno);
+    }
+
+  sfd = orb_subscribe_multi(meta, instance);
+  if (sfd < 0)
+    {
+      orb_unadvertise(ptopic);
+      return test_fail("subscribe failed: %d", errno);
+    }
+
+#define CHECK_BATCH(nmemb, expect, first, expect_lost) \
+  n = orb_copy_batch(meta, sfd, batch, nmemb, &state); \
+  if (n != (expect)) \
+    { \
+      return test_fail("batch copied %zd, should be %d", n, (expect)); \
+    } \
+  if (state.lost != (expect_lost)) \
+    { \
+      return test_fail("batch lost %" PRIu32 ", should be %d", \
+                       state.lost, (expect_lost)); \
+    } \
+  for (i = 0; i < n; i++) \
+    { \
+      if (batch[i].val != (first) + i) \
+        { \
+          return test_fail("batch element %d is %" PRId32 ", should be %d", \
+                           i, batch[i].val, (first) + i); \
+        } \
+    }
+
+  /* The initial sample, then nothing new */
+
+  CHECK_BATCH(queue_size, 1, 0, 0);
+  CHECK_BATCH(queue_size, 0, 0, 0);
+
+  test_note("  Testing to drain some elements...");
+
+  for (i = 1; i <= queue_size - 6; ++i)
+    {
+      sample.val = i;
+      orb_publish(meta, ptopic, &sample);
+    }
+
+  CHECK_BATCH(queue_size, queue_size - 6, 1, 0);
+  CHECK_BATCH(queue_size, 0, 0, 0);
+
+  test_note("  Testing overflow gap...");
+
+  for (i = 0; i < queue_size + overflow_by; ++i)
+    {
+      sample.val = 100 + i;
+      orb_publish(meta, ptopic, &sample);
+    }
+
+  CHECK_BATCH(queue_size, queue_size, 100 + overflow_by, overflow_by);
+
+  test_note("  Testing partial batches...");
+
+  for (i = 0; i < 3; ++i)
+    {
+      sample.val = 200 + i;
+      orb_publish(meta, ptopic, &sample);
+    }
+
+  CHECK_BATCH(2, 2, 200, 0);
+  CHECK_BATCH(2, 1, 202, 0);
+  CHECK_BATCH(2, 0, 0, 0);
+
+#undef CHECK_BATCH
+
+  orb_unadvertise(ptopic);
+  orb_unsubscribe(sfd);
+
+  return test_note("PASS orb batch copy");
+}
+
 static int pub_test_queue_entry(int argc, char *argv[])
 {
   const int queue_size = 50;
@@ -919,6 +1026,175 @@ static int pub_test_queue_entry(int argc, char *argv[])
   return 0;
 }
 
+static int test_late_subscribe(FAR const struct orb_metadata *meta)
+{
+  struct orb_test_medium_s sample;
+  bool updated;
+  int instance = 0;
+  int ptopic;
+  int sfd;
+
+  test_note("Testing late subscriber (%s)", meta->o_name);
+
+  memset(&sample, 0, sizeof(sample));
+
+  ptopic = orb_advertise_multi_queue(meta, &sample, &instance, 1);
+  if (ptopic < 0)
+    {
+      return test_fail("advertise failed: %d", errno);
+    }
+
+  /* The topic is not persistent, so the sample published before
+   * subscribing is not new to the subscriber.
+   */
+
+  sfd = orb_subscribe_multi(meta, instance);
+  if (sfd < 0)
+    {
+      orb_unadvertise(ptopic);
+      return test_fail("subscribe failed: %d", errno);
+    }
+
+  orb_check(sfd, &updated);
+  if (updated)
+    {
+      return test_fail("old sample is new to a late subscriber");
+    }
+
+  sample.val = 1;
+  orb_publish(meta, ptopic, &sample);
+
+  orb_check(sfd, &updated);
+  if (!updated)
+    {
+      return test_fail("new sample not reported");
+    }
+
+  orb_unsubscribe(sfd);
+  orb_unadvertise(ptopic);
+
+  return test_note("PASS late subscriber");
+}
+
+static int pub_test_preempt_entry(int argc, char *argv[])
+{
+  int instance = 0;
+  int ptopic;
+  int i;
+  int j;
+
+  for (i = 0; i < 2; i++)
+    {
+      g_preempt_samples[i].val = i;
+      for (j = 0; j < nitems(g_preempt_samples[i].payload); j++)
+        {
+          g_preempt_samples[i].payload[j] = i;
+        }
+    }
+
+  ptopic = orb_advertise_multi_queue(ORB_ID(orb_test_preempt_fast),
+                                     &g_preempt_samples[0], &instance, 1);
+  if (ptopic < 0)
+    {
+      g_preempt_running = false;
+      return test_fail("advertise failed: %d", errno);
+    }
+
+  /* Publish without a break, so that the subscriber waking up from its
+   * sleep mostly preempts a write in progress.
+   */
+
+  for (i = 1; !g_thread_should_exit; i++)
+    {
+      orb_publish(ORB_ID(orb_test_preempt_fast), ptopic,
+                  &g_preempt_samples[i & 1]);
+    }
+
+  orb_unadvertise(ptopic);
+  g_preempt_running = false;
+  return OK;
+}
+
+static int test_preempted_publish(void)
+{
+  struct pollfd fds[1];
+  int pubsub_task;
+  int ret = OK;
+  int sfd;
+  int i;
+  int j;
+
+  test_note("Testing copy while a preempted publisher writes the slot");
+
+  sfd = orb_subscribe(ORB_ID(orb_test_preempt_fast));
+  if (sfd < 0)
+    {
+      return test_fail("subscribe failed: %d", errno);
+    }
+
+  g_thread_should_exit = false;
+  g_preempt_running    = true;
+
+  /* On a single CPU the publisher only runs while the subscriber sleeps */
+
+  pubsub_task = task_create("uorb_test_preempt",
+                            SCHED_PRIORITY_MIN + 5,
+                            CONFIG_UORB_STACKSIZE,
+                            pub_test_preempt_entry,
+                            NULL);
+  if (pubsub_task < 0)
+    {
+      orb_unsubscribe(sfd);
+      return test_fail("failed launching task");
+    }
+
+  fds[0].fd     = sfd;
+  fds[0].events = POLLIN;
+
+  if (poll(fds, 1, 1000) <= 0)
+    {
+      ret = test_fail("no sample published");
+    }
+
+  for (i = 0; i < 200 && ret == OK; i++)
+    {
+      usleep(1000);
+
+      if (orb_copy(ORB_ID(orb_test_preempt_fast), sfd,
+                   &g_preempt_copy) != OK)
+        {
+          ret = test_fail("copy failed: %d", errno);
+          break;
+        }
+
+      for (j = 0; j < nitems(g_preempt_copy.payload); j++)
+        {
+          if (g_preempt_copy.payload[j] != g_preempt_copy.val)
+            {
+              ret = test_fail("torn sample: %" PRIu32 " in sample %" PRIu32,
+                              g_preempt_copy.payload[j],
+                              g_preempt_copy.val);
+              break;
+            }
+        }
+    }
+
+  g_thread_should_exit = true;
+  while (g_preempt_running)
+    {
+      usleep(1000);
+    }
+
+  orb_unsubscribe(sfd);
+
+  if (ret != OK)
+    {
+      return ret;
+    }
+
+  return test_note("PASS copy while a preempted publisher writes the slot");
+}
+
 static int test_queue_poll_notify(void)
 {
   struct pollfd fds[1];
@@ -1009,6 +1285,70 @@ static int test_queue_poll_notify(void)
   return OK;
 }
 
+#ifdef CONFIG_UORB_HUB
+static int test_decimator(void)
+{
+  const unsigned int factor = 10;
+  const unsigned int nin = 1000;
+  static struct sensor_accel in[1000];
+  static struct sensor_accel out[1000 / 10 + 1];
+  static struct decim_s decim;
+  unsigned int nout;
+  unsigned int i;
+
+  test_note("Testing sensor hub decimator");
+
+  /* 1 kHz of gravity on z and a 400 Hz tone on x, which must not alias
+   * into the 100 Hz output.
+   */
+
+  for (i = 0; i < nin; i++)
+    {
+      in[i].timestamp   = 1000000 + i * 1000;
+      in[i].x           = sinf(2.0f * (float)M_PI * 400.0f * i / 1000.0f);
+      in[i].y           = 0.0f;
+      in[i].z           = 9.8f;
+      in[i].temperature = 25.0f;
+    }
+
+  if (decim_init(&decim, factor, offsetof(struct sensor_accel, x), 4) < 0)
+    {
+      return test_fail("decim_init failed");
+    }
+
+  nout = decim_process(&decim, in, sizeof(in[0]), nin, out);
+  if (nout != nin / factor)
+    {
+      return test_fail("%u outputs, should be %u", nout, nin / factor);
+    }
+
+  /* Past the onset of the tone, which spreads over one window */
+
+  for (i = decim.ntaps / factor + 1; i < nout; i++)
+    {
+      if (fabsf(out[i].x) > 0.01f || fabsf(out[i].z - 9.8f) > 0.001f ||
+          fabsf(out[i].temperature - 25.0f) > 0.001f)
+        {
+          return test_fail("output %u is x %f z %f", i, (double)out[i].x,
+                           (double)out[i].z);
+        }
+    }
+
+  /* Stamped at the centre of the filter window */
+
+  if (out[nout - 1].timestamp !=
+      in[nin - factor].timestamp - decim.ntaps / 2 * 1000)
+    {
+      return test_fail("output stamped %" PRIu64 ", should be %" PRIu64,
+                       out[nout - 1].timestamp,
+                       in[nin - factor].timestamp -
+                       decim.ntaps / 2 * 1000);
+    }
+
+  return test_note("PASS sensor hub decimator");
+}
+#endif
+
 static int test(void)
 {
   int afds[4];
@@ -1057,6 +1397,44 @@ static int test(void)
       return ret;
     }
 
+  ret = test_queue_batch(ORB_ID(orb_test_medium_queue_batch));
+  if (ret != OK)
+    {
+      return ret;
+    }
+
+  ret = test_queue_batch(ORB_ID(orb_test_medium_queue_batch_fast));
+  if (ret != OK)
+    {
+      return ret;
+    }
+
+  ret = test_late_subscribe(ORB_ID(orb_test_medium_late));
+  if (ret != OK)
+    {
+      return ret;
+    }
+
+  ret = test_late_subscribe(ORB_ID(orb_test_medium_late_fast));
+  if (ret != OK)
+    {
+      return ret;
+    }
+
+  ret = test_preempted_publish();
+  if (ret != OK)
+    {
+      return ret;
+    }
+
+#ifdef CONFIG_UORB_HUB
+  ret = test_decimator();
+  if (ret != OK)
+    {
+      return ret;
+    }
+#endif
+
   return test_queue_poll_notify();
 }
 
@@ -64,6 +64,28 @@ static void print_orb_test_large_msg(FAR const struct orb_metadata *meta,
                meta->o_name, message->timestamp, now - message->timestamp,
                message->val);
 }
+
+static void print_orb_test_preempt_msg(FAR const struct orb_metadata *meta,
+                                       FAR const void *buffer)
+{
+  FAR const struct orb_test_preempt_s *message = buffer;
+  const orb_abstime now = orb_absolute_time();
+
+  uorbinfo_raw("%s:\ttimestamp: %"PRIu64" (%"PRIu64" us ago) val: %"PRIu32"",
+               meta->o_name, message->timestamp, now - message->timestamp,
+               message->val);
+}
+
+static void print_orb_bench_msg(FAR const struct orb_metadata *meta,
+                                FAR const void *buffer)
+{
+  FAR const struct orb_bench_s *message = buffer;
+  const orb_abstime now = orb_absolute_time();
+
+  uorbinfo_raw("%s:\ttimestamp: %"PRIu64" (%"PRIu64" us ago) seq: %"PRIu32"",
+               meta->o_name, message->timestamp, now - message->timestamp,
+               message->seq);
+}
 #endif
 
 /****************************************************************************
@@ -82,8 +104,20 @@ ORB_DEFINE(orb_test_medium_queue, struct orb_test_medium_s,
            print_orb_test_medium_msg);
 ORB_DEFINE(orb_test_medium_queue_poll, struct orb_test_medium_s,
            print_orb_test_medium_msg);
+ORB_DEFINE(orb_test_medium_queue_batch, struct orb_test_medium_s,
+           print_orb_test_medium_msg);
+ORB_DEFINE_FAST(orb_test_medium_queue_batch_fast, struct orb_test_medium_s,
+                print_orb_test_medium_msg);
+ORB_DEFINE(orb_test_medium_late, struct orb_test_medium_s,
+           print_orb_test_medium_msg);
+ORB_DEFINE_FAST(orb_test_medium_late_fast, struct orb_test_medium_s,
+                print_orb_test_medium_msg);
+ORB_DEFINE_FAST(orb_test_preempt_fast, struct orb_test_preempt_s,
+                print_orb_test_preempt_msg);
 ORB_DEFINE(orb_test_large, struct orb_test_large_s,
            print_orb_test_large_msg);
+ORB_DEFINE(orb_bench, struct orb_bench_s, print_orb_bench_msg);
+ORB_DEFINE_FAST(orb_bench_fast, struct orb_bench_s, print_orb_bench_msg);
 
 /****************************************************************************
  * Public Functions
@@ -49,6 +49,22 @@ struct orb_test_large_s
   int32_t val;
 };
 
+/* Large enough that a publisher is preempted in the middle of a sample */
+
+struct orb_test_preempt_s
+{
+  uint64_t timestamp;
+  uint32_t val;
+  uint32_t payload[1024];
+};
+
+struct orb_bench_s
+{
+  uint64_t timestamp;
+  uint32_t seq;
+  uint8_t  payload[52];
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -63,6 +79,13 @@ ORB_DECLARE(orb_test_medium_multi);
 ORB_DECLARE(orb_test_medium_wrap_around);
 ORB_DECLARE(orb_test_medium_queue);
 ORB_DECLARE(orb_test_medium_queue_poll);
+ORB_DECLARE(orb_test_medium_queue_batch);
+ORB_DECLARE(orb_test_medium_queue_batch_fast);
+ORB_DECLARE(orb_test_medium_late);
+ORB_DECLARE(orb_test_medium_late_fast);
+ORB_DECLARE(orb_test_preempt_fast);
+ORB_DECLARE(orb_bench);
+ORB_DECLARE(orb_bench_fast);
 
 /****************************************************************************
  * Public Function Prototypes
@@ -0,0 +1,811 @@
+/****************************************************************************
+ * apps/system/uorb/uORB/fastpath.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+
+#include "fastpath.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* How many times a subscriber restarts a copy that was overrun by the
+ * publisher before it takes the publisher lock to copy the slot.
+ */
+
+#define ORB_FAST_RETRY     3
+
+/* Slot sequence: odd while the publisher writes generation gen into it,
+ * ORB_FAST_SEQ(gen) once the sample is complete.
+ */
+
+#define ORB_FAST_SEQ(gen)  (2 * (uint32_t)(gen) + 2)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One per topic instance. Topics are never freed, same as the device nodes
+ * they stand for, so the last sample survives its advertiser.
+ *
+ * Subscribers read the ring without any lock. Publishers serialize on
+ * wlock, which is uncontended with a single advertiser; it also protects
+ * subs[] against concurrent unsubscribe while waking subscribers up. A
+ * subscriber that keeps losing the race to a publisher takes wlock too,
+ * so that a publisher it preempted mid-write can finish first.
+ */
+
+struct orb_fast_topic_s
+{
+  FAR struct orb_fast_topic_s    *next;
+  FAR const struct orb_metadata  *meta;
+  int                             instance;
+  unsigned int                    nadvertisers;
+  unsigned int                    nsubscribers;
+  uint32_t                        nbuffer;    /* Ring slots, 0 until
+                                               * first advertised */
+  uint32_t                        generation; /* Samples published */
+  bool                            persist;    /* New subscribers get the
+                                               * latest sample */
+  FAR uint32_t                   *seq;        /* Per slot sequence */
+  FAR uint8_t                    *data;       /* nbuffer * o_size */
+  pthread_mutex_t                 wlock;
+  FAR struct orb_fast_handle_s   *subs[CONFIG_UORB_FASTPATH_NSUBSCRIBERS];
+};
+
+struct orb_fast_handle_s
+{
+  FAR struct orb_fast_topic_s    *topic;
+  int                             fd;         /* Node fd or eventfd */
+  bool                            advertiser;
+  int                             armed;      /* Publisher must signal fd */
+  uint32_t                        generation; /* Next sample to copy */
+  unsigned                        interval;
+  unsigned                        latency;
+};
+
+/* fd -> handle map. File descriptors are per task group, hence the pid. */
+
+struct orb_fast_fd_s
+{
+  FAR struct orb_fast_handle_s   *handle;     /* NULL: free entry */
+  pid_t                           pid;
+  int                             fd;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static pthread_mutex_t g_orb_fast_lock = PTHREAD_MUTEX_INITIALIZER;
+static FAR struct orb_fast_topic_s *g_orb_fast_topics;
+static struct orb_fast_fd_s g_orb_fast_fds[CONFIG_UORB_FASTPATH_NHANDLES];
+static int g_orb_fast_nfds;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: orb_fast_get_topic
+ *
+ * Description:
+ *   Find the topic instance, create it on first use. Called with
+ *   g_orb_fast_lock held.
+ ****************************************************************************/
+
+static FAR struct orb_fast_topic_s *
+orb_fast_get_topic(FAR const struct orb_metadata *meta, int instance)
+{
+  FAR struct orb_fast_topic_s *topic;
+  pthread_mutexattr_t attr;
+
+  for (topic = g_orb_fast_topics; topic != NULL; topic = topic->next)
+    {
+      if (topic->meta == meta && topic->instance == instance)
+        {
+          return topic;
+        }
+    }
+
+  topic = zalloc(sizeof(*topic));
+  if (topic == NULL)
+    {
+      return NULL;
+    }
+
+  topic->meta     = meta;
+  topic->instance = instance;
+
+  pthread_mutexattr_init(&attr);
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+#endif
+  pthread_mutex_init(&topic->wlock, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  topic->next       = g_orb_fast_topics;
+  g_orb_fast_topics = topic;
+  return topic;
+}
+
+/****************************************************************************
+ * Name: orb_fast_add_fd / orb_fast_remove_fd
+ *
+ * Description:
+ *   Maintain the fd -> handle map. Called with g_orb_fast_lock held;
+ *   orb_fast_lookup() reads it without the lock, so the handle pointer is
+ *   stored last and cleared first.
+ ****************************************************************************/
+
+static int orb_fast_add_fd(FAR struct orb_fast_handle_s *handle)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_UORB_FASTPATH_NHANDLES; i++)
+    {
+      FAR struct orb_fast_fd_s *entry = &g_orb_fast_fds[i];
+
+      if (entry->handle == NULL)
+        {
+          entry->pid = getpid();
+          entry->fd  = handle->fd;
+          __atomic_store_n(&entry->handle, handle, __ATOMIC_RELEASE);
+          g_orb_fast_nfds++;
+          return OK;
+        }
+    }
+
+  return -EMFILE;
+}
+
+static void orb_fast_remove_fd(FAR struct orb_fast_handle_s *handle)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_UORB_FASTPATH_NHANDLES; i++)
+    {
+      FAR struct orb_fast_fd_s *entry = &g_orb_fast_fds[i];
+
+      if (entry->handle == handle)
+        {
+          __atomic_store_n(&entry->handle, NULL, __ATOMIC_RELEASE);
+          g_orb_fast_nfds--;
+          return;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: orb_fast_read_slot
+ *
+ * Description:
+ *   Seqlock read of sample gen. Returns false if the publisher overwrote
+ *   the slot before or while it was copied.
+ ****************************************************************************/
+
+static bool orb_fast_read_slot(FAR struct orb_fast_topic_s *topic,
+                               uint32_t gen, FAR void *buffer)
+{
+  uint16_t esize = topic->meta->o_size;
+  uint32_t idx = gen % topic->nbuffer;
+  uint32_t expect = ORB_FAST_SEQ(gen);
+
+  if (__atomic_load_n(&topic->seq[idx], __ATOMIC_ACQUIRE) != expect)
+    {
+      return false;
+    }
+
+  memcpy(buffer, topic->data + idx * esize, esize);
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+  return __atomic_load_n(&topic->seq[idx], __ATOMIC_RELAXED) == expect;
+}
+
+/****************************************************************************
+ * Name: orb_fast_rearm
+ *
+ * Description:
+ *   Keep the subscriber eventfd readable exactly while samples are
+ *   pending. Publishers only signal armed subscribers, so a subscriber
+ *   that keeps up costs one eventfd write per sample and a subscriber
+ *   that only uses orb_check()/orb_copy() costs no syscall at all.
+ ****************************************************************************/
+
+static void orb_fast_rearm(FAR struct orb_fast_handle_s *handle)
+{
+  FAR struct orb_fast_topic_s *topic = handle->topic;
+  eventfd_t count;
+
+  if (__atomic_load_n(&topic->generation, __ATOMIC_SEQ_CST) !=
+      handle->generation)
+    {
+      return; /* Still pending, fd stays readable */
+    }
+
+  if (__atomic_load_n(&handle->armed, __ATOMIC_SEQ_CST) != 0)
+    {
+      return; /* Nobody signaled since the last rearm */
+    }
+
+  eventfd_read(handle->fd, &count);
+  __atomic_store_n(&handle->armed, 1, __ATOMIC_SEQ_CST);
+
+  /* A sample published between the check above and arming would have
+   * found us disarmed, signal ourselves instead.
+   */
+
+  if (__atomic_load_n(&topic->generation, __ATOMIC_SEQ_CST) !=
+      handle->generation &&
+      __atomic_exchange_n(&handle->armed, 0, __ATOMIC_SEQ_CST) != 0)
+    {
+      eventfd_write(handle->fd, 1);
+    }
+}
+
+/****************************************************************************
+ * Name: orb_fast_copy_samples
+ *
+ * Description:
+ *   Copy up to nmemb samples from the subscriber cursor on. Samples the
+ *   publisher already dropped out of the ring are skipped and counted in
+ *   lost. With repeat, the latest sample is copied again if there is
+ *   nothing new, as read() on the device node does.
+ *
+ *   A slot that is overwritten again and again is copied under wlock
+ *   after ORB_FAST_RETRY attempts.  On a single CPU the publisher may be
+ *   a lower priority task preempted in the middle of the slot, which can
+ *   only finish once the subscriber blocks on the lock.
+ *
+ * Returned Value:
+ *   Number of samples copied, -1 with errno set on failure.
+ ****************************************************************************/
+
+static ssize_t orb_fast_copy_samples(FAR struct orb_fast_handle_s *handle,
+                                     FAR void *buffer, unsigned int nmemb,
+                                     bool repeat, FAR uint32_t *lost)
+{
+  FAR struct orb_fast_topic_s *topic = handle->topic;
+  FAR uint8_t *dst = buffer;
+  uint16_t esize = topic->meta->o_size;
+  uint32_t next = handle->generation;
+  uint32_t gen;
+  unsigned int n = 0;
+  bool locked = false;
+  int retry = 0;
+
+  *lost = 0;
+
+  gen = __atomic_load_n(&topic->generation, __ATOMIC_ACQUIRE);
+  if (gen == 0)
+    {
+      set_errno(ENODATA);
+      return ERROR;
+    }
+
+  if (next == gen)
+    {
+      if (!repeat)
+        {
+          return 0;
+        }
+
+      next = gen - 1;
+    }
+
+  while (n < nmemb && next != gen)
+    {
+      /* Skip samples the publisher already dropped out of the ring */
+
+      if (gen - next > topic->nbuffer)
+        {
+          *lost += gen - topic->nbuffer - next;
+          next   = gen - topic->nbuffer;
+        }
+
+      if (!orb_fast_read_slot(topic, next, dst + n * esize))
+        {
+          if (locked)
+            {
+              break;
+            }
+
+          if (++retry > ORB_FAST_RETRY)
+            {
+              pthread_mutex_lock(&topic->wlock);
+              locked = true;
+            }
+
+          gen = __atomic_load_n(&topic->generation, __ATOMIC_ACQUIRE);
+          continue;
+        }
+
+      n++;
+      next++;
+    }
+
+  if (locked)
+    {
+      pthread_mutex_unlock(&topic->wlock);
+    }
+
+  if (n == 0)
+    {
+      set_errno(EAGAIN);
+      return ERROR;
+    }
+
+  handle->generation = next;
+  orb_fast_rearm(handle);
+  return n;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+FAR struct orb_fast_handle_s *orb_fast_lookup(int fd)
+{
+  pid_t pid;
+  int i;
+
+  if (fd < 0 || __atomic_load_n(&g_orb_fast_nfds, __ATOMIC_RELAXED) == 0)
+    {
+      return NULL;
+    }
+
+  pid = getpid();
+  for (i = 0; i < CONFIG_UORB_FASTPATH_NHANDLES; i++)
+    {
+      FAR struct orb_fast_fd_s *entry = &g_orb_fast_fds[i];
+      FAR struct orb_fast_handle_s *handle;
+
+      handle = __atomic_load_n(&entry->handle, __ATOMIC_ACQUIRE);
+      if (handle != NULL && entry->fd == fd && entry->pid == pid)
+        {
+          return handle;
+        }
+    }
+
+  return NULL;
+}
+
+FAR const struct orb_metadata *orb_fast_find(FAR const char *name,
+                                             int instance)
+{
+  FAR struct orb_fast_topic_s *topic;
+  FAR const struct orb_metadata *meta = NULL;
+
+  pthread_mutex_lock(&g_orb_fast_lock);
+  for (topic = g_orb_fast_topics; topic != NULL; topic = topic->next)
+    {
+      if (topic->instance == instance &&
+          strcmp(topic->meta->o_name, name) == 0)
+        {
+          meta = topic->meta;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&g_orb_fast_lock);
+  return meta;
+}
+
+int orb_fast_advertise(FAR const struct orb_metadata *meta, int instance,
+                       unsigned int queue_size, bool persist, int fd)
+{
+  FAR struct orb_fast_topic_s *topic;
+  FAR struct orb_fast_handle_s *handle;
+  int ret = -ENOMEM;
+
+  handle = zalloc(sizeof(*handle));
+  if (handle == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  pthread_mutex_lock(&g_orb_fast_lock);
+
+  topic = orb_fast_get_topic(meta, instance);
+  if (topic == NULL)
+    {
+      goto errout;
+    }
+
+  /* Only first advertiser sets the ring size and persistence, like the
+   * buffer number and persist flag of the device node.
+   */
+
+  if (topic->nbuffer == 0)
+    {
+      uint32_t nbuffer = queue_size > 0 ? queue_size : 1;
+
+      topic->seq  = zalloc(nbuffer * sizeof(uint32_t));
+      topic->data = zalloc(nbuffer * meta->o_size);
+      if (topic->seq == NULL || topic->data == NULL)
+        {
+          free(topic->seq);
+          free(topic->data);
+          topic->seq  = NULL;
+          topic->data = NULL;
+          goto errout;
+        }
+
+      topic->nbuffer = nbuffer;
+      topic->persist = persist;
+    }
+
+  handle->topic      = topic;
+  handle->fd         = fd;
+  handle->advertiser = true;
+
+  ret = orb_fast_add_fd(handle);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  topic->nadvertisers++;
+  pthread_mutex_unlock(&g_orb_fast_lock);
+  return OK;
+
+errout:
+  pthread_mutex_unlock(&g_orb_fast_lock);
+  free(handle);
+  return ret;
+}
+
+int orb_fast_subscribe(FAR const struct orb_metadata *meta, int instance)
+{
+  FAR struct orb_fast_topic_s *topic;
+  FAR struct orb_fast_handle_s *handle;
+  uint32_t gen;
+  int ret = -ENOMEM;
+  int i;
+
+  handle = zalloc(sizeof(*handle));
+  if (handle == NULL)
+    {
+      set_errno(ENOMEM);
+      return ERROR;
+    }
+
+  handle->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (handle->fd < 0)
+    {
+      free(handle);
+      return ERROR;
+    }
+
+  pthread_mutex_lock(&g_orb_fast_lock);
+
+  topic = orb_fast_get_topic(meta, instance);
+  if (topic == NULL)
+    {
+      goto errout;
+    }
+
+  handle->topic = topic;
+  handle->armed = 1;
+
+  /* Like the device node, only a persistent topic hands its latest
+   * sample to a new subscriber.  Otherwise start after it.
+   */
+
+  gen = __atomic_load_n(&topic->generation, __ATOMIC_ACQUIRE);
+  handle->generation = topic->persist && gen > 0 ? gen - 1 : gen;
+
+  ret = orb_fast_add_fd(handle);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  pthread_mutex_lock(&topic->wlock);
+  for (i = 0; i < CONFIG_UORB_FASTPATH_NSUBSCRIBERS; i++)
+    {
+      if (topic->subs[i] == NULL)
+        {
+          topic->subs[i] = handle;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&topic->wlock);
+
+  if (i == CONFIG_UORB_FASTPATH_NSUBSCRIBERS)
+    {
+      orb_fast_remove_fd(handle);
+      ret = -EMFILE;
+      goto errout;
+    }
+
+  topic->nsubscribers++;
+  pthread_mutex_unlock(&g_orb_fast_lock);
+
+  /* Make the fd readable if a sample is already there */
+
+  if (__atomic_load_n(&topic->generation, __ATOMIC_SEQ_CST) !=
+      handle->generation &&
+      __atomic_exchange_n(&handle->armed, 0, __ATOMIC_SEQ_CST) != 0)
+    {
+      eventfd_write(handle->fd, 1);
+    }
+
+  return handle->fd;
+
+errout:
+  pthread_mutex_unlock(&g_orb_fast_lock);
+  close(handle->fd);
+  free(handle);
+  set_errno(-ret);
+  return ERROR;
+}
+
+int orb_fast_close(FAR struct orb_fast_handle_s *handle)
+{
+  FAR struct orb_fast_topic_s *topic = handle->topic;
+  int fd = handle->fd;
+  int i;
+
+  pthread_mutex_lock(&g_orb_fast_lock);
+  orb_fast_remove_fd(handle);
+
+  if (handle->advertiser)
+    {
+      topic->nadvertisers--;
+    }
+  else
+    {
+      pthread_mutex_lock(&topic->wlock);
+      for (i = 0; i < CONFIG_UORB_FASTPATH_NSUBSCRIBERS; i++)
+        {
+          if (topic->subs[i] == handle)
+            {
+              topic->subs[i] = NULL;
+              break;
+            }
+        }
+
+      pthread_mutex_unlock(&topic->wlock);
+      topic->nsubscribers--;
+    }
+
+  pthread_mutex_unlock(&g_orb_fast_lock);
+  free(handle);
+  return close(fd);
+}
+
+ssize_t orb_fast_publish(FAR struct orb_fast_handle_s *handle,
+                         FAR const void *data, size_t len)
+{
+  FAR struct orb_fast_topic_s *topic = handle->topic;
+  FAR const uint8_t *src = data;
+  uint16_t esize = topic->meta->o_size;
+  uint32_t gen;
+  size_t off;
+  int i;
+
+  if (!handle->advertiser)
+    {
+      set_errno(EBADF);
+      return ERROR;
+    }
+
+  if (len == 0 || len % esize != 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  pthread_mutex_lock(&topic->wlock);
+
+  gen = topic->generation;
+  for (off = 0; off < len; off += esize, gen++)
+    {
+      uint32_t idx = gen % topic->nbuffer;
+
+      __atomic_store_n(&topic->seq[idx], ORB_FAST_SEQ(gen) - 1,
+                       __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+      memcpy(topic->data + idx * esize, src + off, esize);
+      __atomic_store_n(&topic->seq[idx], ORB_FAST_SEQ(gen),
+                       __ATOMIC_RELEASE);
+    }
+
+  __atomic_store_n(&topic->generation, gen, __ATOMIC_SEQ_CST);
+
+  for (i = 0; i < CONFIG_UORB_FASTPATH_NSUBSCRIBERS; i++)
+    {
+      FAR struct orb_fast_handle_s *sub = topic->subs[i];
+
+      if (sub != NULL &&
+          __atomic_exchange_n(&sub->armed, 0, __ATOMIC_SEQ_CST) != 0)
+        {
+          eventfd_write(sub->fd, 1);
+        }
+    }
+
+  pthread_mutex_unlock(&topic->wlock);
+  return len;
+}
+
+ssize_t orb_fast_copy(FAR struct orb_fast_handle_s *handle,
+                      FAR void *buffer, size_t len)
+{
+  FAR struct orb_fast_topic_s *topic = handle->topic;
+  uint16_t esize = topic->meta->o_size;
+  uint32_t lost;
+  ssize_t n;
+
+  if (handle->advertiser)
+    {
+      set_errno(EBADF);
+      return ERROR;
+    }
+
+  if (buffer == NULL)
+    {
+      if (topic->generation == 0)
+        {
+          set_errno(ENODATA);
+          return ERROR;
+        }
+
+      handle->generation = __atomic_load_n(&topic->generation,
+                                           __ATOMIC_ACQUIRE);
+      orb_fast_rearm(handle);
+      return 0;
+    }
+
+  if (len < esize)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  n = orb_fast_copy_samples(handle, buffer, len / esize, true, &lost);
+  return n < 0 ? n : n * esize;
+}
+
+ssize_t orb_fast_copy_batch(FAR struct orb_fast_handle_s *handle,
+                            FAR void *buffer, unsigned int nmemb,
+                            FAR struct orb_batch *batch)
+{
+  ssize_t n;
+
+  if (handle->advertiser)
+    {
+      set_errno(EBADF);
+      return ERROR;
+    }
+
+  /* The cursor is exact here, every call is a sync point */
+
+  n = orb_fast_copy_samples(handle, buffer, nmemb, false, &batch->lost);
+  if (n < 0)
+    {
+      return errno == ENODATA ? 0 : n;
+    }
+
+  batch->generation = handle->generation;
+  batch->copied     = 0;
+  return n;
+}
+
+int orb_fast_check(FAR struct orb_fast_handle_s *handle, FAR bool *updated)
+{
+  *updated = __atomic_load_n(&handle->topic->generation, __ATOMIC_ACQUIRE)
+             != handle->generation;
+  return OK;
+}
+
+int orb_fast_get_state(FAR struct orb_fast_handle_s *handle,
+                       FAR struct orb_state *state)
+{
+  FAR struct orb_fast_topic_s *topic = handle->topic;
+  unsigned interval = 0;
+  unsigned latency = 0;
+  int i;
+
+  /* Like the device node, report the fastest request of all subscribers */
+
+  pthread_mutex_lock(&topic->wlock);
+  for (i = 0; i < CONFIG_UORB_FASTPATH_NSUBSCRIBERS; i++)
+    {
+      FAR struct orb_fast_handle_s *sub = topic->subs[i];
+
+      if (sub == NULL)
+        {
+          continue;
+        }
+
+      if (sub->interval && (!interval || sub->interval < interval))
+        {
+          interval = sub->interval;
+        }
+
+      if (sub->latency && (!latency || sub->latency < latency))
+        {
+          latency = sub->latency;
+        }
+    }
+
+  state->max_frequency      = interval ? 1000000 / interval : 0;
+  state->min_batch_interval = latency;
+  state->queue_size         = topic->nbuffer;
+  state->nsubscribers       = topic->nsubscribers;
+  state->generation         = topic->generation;
+  pthread_mutex_unlock(&topic->wlock);
+
+  return OK;
+}
+
+int orb_fast_set_interval(FAR struct orb_fast_handle_s *handle,
+                          unsigned interval)
+{
+  handle->interval = interval;
+  return OK;
+}
+
+int orb_fast_get_interval(FAR struct orb_fast_handle_s *handle,
+                          FAR unsigned *interval)
+{
+  *interval = handle->interval;
+  return OK;
+}
+
+int orb_fast_set_batch_interval(FAR struct orb_fast_handle_s *handle,
+                                unsigned batch_interval)
+{
+  handle->latency = batch_interval;
+  return OK;
+}
+
+int orb_fast_get_batch_interval(FAR struct orb_fast_handle_s *handle,
+                                FAR unsigned *batch_interval)
+{
+  *batch_interval = handle->latency;
+  return OK;
+}
+
+int orb_fast_ioctl(FAR struct orb_fast_handle_s *handle, int cmd,
+                   unsigned long arg)
+{
+  /* Advertisers still hold the device node, subscribers only an eventfd */
+
+  if (handle->advertiser)
+    {
+      return ioctl(handle->fd, cmd, arg);
+    }
+
+  set_errno(ENOTTY);
+  return ERROR;
+}
@@ -0,0 +1,86 @@
+/****************************************************************************
+ * apps/system/uorb/uORB/fastpath.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APP_SYSTEM_UORB_UORB_FASTPATH_H
+#define __APP_SYSTEM_UORB_UORB_FASTPATH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sys/types.h>
+
+#include <uORB/uORB.h>
+
+#ifdef CONFIG_UORB_FASTPATH
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Internal interface between uORB.c and fastpath.c, not for users.
+ *
+ * A fast path handle is always backed by a real file descriptor, so that
+ * the public API keeps working on plain ints:
+ *   - advertisers own the /dev/uorb node fd (keeps the topic discoverable
+ *     through orb_exists() and the listener).
+ *   - subscribers own an eventfd, which becomes readable when new samples
+ *     are published, so poll() works unchanged.
+ */
+
+struct orb_fast_handle_s;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+FAR struct orb_fast_handle_s *orb_fast_lookup(int fd);
+FAR const struct orb_metadata *orb_fast_find(FAR const char *name,
+                                             int instance);
+
+int orb_fast_advertise(FAR const struct orb_metadata *meta, int instance,
+                       unsigned int queue_size, bool persist, int fd);
+int orb_fast_subscribe(FAR const struct orb_metadata *meta, int instance);
+int orb_fast_close(FAR struct orb_fast_handle_s *handle);
+
+ssize_t orb_fast_publish(FAR struct orb_fast_handle_s *handle,
+                         FAR const void *data, size_t len);
+ssize_t orb_fast_copy(FAR struct orb_fast_handle_s *handle,
+                      FAR void *buffer, size_t len);
+ssize_t orb_fast_copy_batch(FAR struct orb_fast_handle_s *handle,
+                            FAR void *buffer, unsigned int nmemb,
+                            FAR struct orb_batch *batch);
+int orb_fast_check(FAR struct orb_fast_handle_s *handle,
+                   FAR bool *updated);
+int orb_fast_get_state(FAR struct orb_fast_handle_s *handle,
+                       FAR struct orb_state *state);
+int orb_fast_set_interval(FAR struct orb_fast_handle_s *handle,
+                          unsigned interval);
+int orb_fast_get_interval(FAR struct orb_fast_handle_s *handle,
+                          FAR unsigned *interval);
+int orb_fast_set_batch_interval(FAR struct orb_fast_handle_s *handle,
+                                unsigned batch_interval);
+int orb_fast_get_batch_interval(FAR struct orb_fast_handle_s *handle,
+                                FAR unsigned *batch_interval);
+int orb_fast_ioctl(FAR struct orb_fast_handle_s *handle, int cmd,
+                   unsigned long arg);
+
+#endif /* CONFIG_UORB_FASTPATH */
+#endif /* __APP_SYSTEM_UORB_UORB_FASTPATH_H */
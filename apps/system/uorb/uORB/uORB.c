@@ -31,6 +31,8 @@
 
 #include <uORB/uORB.h>
 
+#include "fastpath.h"
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -125,13 +127,37 @@ orb_advertise_multi_queue_flags(FAR const struct orb_metadata *meta,
 
   inst = instance ? *instance : orb_group_count(meta);
 
+#ifdef CONFIG_UORB_FASTPATH
+  /* Samples of fast topics never go through the node, it is only kept
+   * open for discovery, so don't let it allocate a queue.
+   */
+
+  fd = orb_advsub_open(meta, flags, inst, meta->o_fast ? 1 : queue_size);
+#else
   fd = orb_advsub_open(meta, flags, inst, queue_size);
+#endif
   if (fd < 0)
     {
       uorberr("%s advertise failed (%i)", meta->o_name, fd);
       return -1;
     }
 
+#ifdef CONFIG_UORB_FASTPATH
+  if (meta->o_fast)
+    {
+      int ret;
+
+      ret = orb_fast_advertise(meta, inst, queue_size,
+                               !!(flags & SENSOR_PERSIST), fd);
+      if (ret < 0)
+        {
+          uorberr("%s fast advertise failed (%i)", meta->o_name, ret);
+          close(fd);
+          return -1;
+        }
+    }
+#endif
+
   /* The advertiser may perform an initial publish to initialise the object */
 
   if (data != NULL)
@@ -159,12 +185,31 @@ int orb_open(FAR const char *name, int instance, int flags)
 {
   char path[ORB_PATH_MAX];
 
+#ifdef CONFIG_UORB_FASTPATH
+  FAR const struct orb_metadata *meta;
+
+  meta = orb_fast_find(name, instance);
+  if (meta != NULL && !(flags & O_WRONLY))
+    {
+      return orb_fast_subscribe(meta, instance);
+    }
+#endif
+
   snprintf(path, ORB_PATH_MAX, ORB_SENSOR_PATH"%s%d", name, instance);
   return open(path, O_CLOEXEC | flags);
 }
 
 int orb_close(int fd)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_close(handle);
+    }
+#endif
+
   return close(fd);
 }
 
@@ -187,30 +232,134 @@ int orb_advertise_multi_queue_persist(FAR const struct orb_metadata *meta,
 
 ssize_t orb_publish_multi(int fd, const void *data, size_t len)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_publish(handle, data, len);
+    }
+#endif
+
   return write(fd, data, len);
 }
 
 int orb_subscribe_multi(FAR const struct orb_metadata *meta,
                         unsigned instance)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  if (meta->o_fast)
+    {
+      return orb_fast_subscribe(meta, instance);
+    }
+#endif
+
   return orb_advsub_open(meta, O_RDONLY, instance, 0);
 }
 
 ssize_t orb_copy_multi(int fd, FAR void *buffer, size_t len)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_copy(handle, buffer, len);
+    }
+#endif
+
   return read(fd, buffer, len);
 }
 
+ssize_t orb_copy_multi_batch(int fd, FAR void *buffer, size_t esize,
+                             unsigned int nmemb,
+                             FAR struct orb_batch *batch)
+{
+  struct sensor_state_s state;
+  bool updated;
+  ssize_t ret;
+  size_t n;
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle;
+#endif
+
+  if (esize == 0 || nmemb == 0 || batch == NULL)
+    {
+      set_errno(EINVAL);
+      return -1;
+    }
+
+  batch->lost = 0;
+
+#ifdef CONFIG_UORB_FASTPATH
+  handle = orb_fast_lookup(fd);
+  if (handle != NULL)
+    {
+      return orb_fast_copy_batch(handle, buffer, nmemb, batch);
+    }
+#endif
+
+  /* read() would hand out the latest sample again */
+
+  ret = ioctl(fd, SNIOC_UPDATED, (unsigned long)(uintptr_t)&updated);
+  if (ret < 0 || !updated)
+    {
+      return ret;
+    }
+
+  ret = read(fd, buffer, esize * nmemb);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  n = ret / esize;
+  batch->copied += n;
+
+  /* If nothing is left unread after reading the mainline generation, the
+   * last sample copied is that generation and the gap is exact. Otherwise
+   * (queue not drained, or a publish raced) wait for a later call.
+   */
+
+  if (ioctl(fd, SNIOC_GET_STATE, (unsigned long)(uintptr_t)&state) >= 0 &&
+      ioctl(fd, SNIOC_UPDATED, (unsigned long)(uintptr_t)&updated) >= 0 &&
+      !updated)
+    {
+      if (batch->generation != 0 &&
+          state.generation - batch->generation > batch->copied)
+        {
+          batch->lost = state.generation - batch->generation -
+                        batch->copied;
+        }
+
+      batch->generation = state.generation;
+      batch->copied     = 0;
+    }
+
+  return n;
+}
+
 int orb_get_state(int fd, FAR struct orb_state *state)
 {
   struct sensor_state_s tmp;
   int ret;
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle;
+#endif
 
   if (!state)
     {
       return -EINVAL;
     }
 
+#ifdef CONFIG_UORB_FASTPATH
+  handle = orb_fast_lookup(fd);
+  if (handle != NULL)
+    {
+      return orb_fast_get_state(handle, state);
+    }
+#endif
+
   ret = ioctl(fd, SNIOC_GET_STATE, (unsigned long)(uintptr_t)&tmp);
   if (ret < 0)
     {
@@ -229,16 +378,43 @@ int orb_get_state(int fd, FAR struct orb_state *state)
 
 int orb_check(int fd, FAR bool *updated)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_check(handle, updated);
+    }
+#endif
+
   return ioctl(fd, SNIOC_UPDATED, (unsigned long)(uintptr_t)updated);
 }
 
 int orb_ioctl(int fd, int cmd, unsigned long arg)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_ioctl(handle, cmd, arg);
+    }
+#endif
+
   return ioctl(fd, cmd, arg);
 }
 
 int orb_set_interval(int fd, unsigned interval)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_set_interval(handle, interval);
+    }
+#endif
+
   return ioctl(fd, SNIOC_SET_INTERVAL, (unsigned long)interval);
 }
 
@@ -247,6 +423,15 @@ int orb_get_interval(int fd, FAR unsigned *interval)
   struct sensor_state_s tmp;
   int ret;
 
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_get_interval(handle, interval);
+    }
+#endif
+
   ret = ioctl(fd, SNIOC_GET_STATE, (unsigned long)(uintptr_t)&tmp);
   if (ret < 0)
     {
@@ -259,6 +444,15 @@ int orb_get_interval(int fd, FAR unsigned *interval)
 
 int orb_set_batch_interval(int fd, unsigned batch_interval)
 {
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_set_batch_interval(handle, batch_interval);
+    }
+#endif
+
   return ioctl(fd, SNIOC_BATCH, (unsigned long)batch_interval);
 }
 
@@ -267,6 +461,15 @@ int orb_get_batch_interval(int fd, FAR unsigned *batch_interval)
   struct sensor_state_s tmp;
   int ret;
 
+#ifdef CONFIG_UORB_FASTPATH
+  FAR struct orb_fast_handle_s *handle = orb_fast_lookup(fd);
+
+  if (handle != NULL)
+    {
+      return orb_fast_get_batch_interval(handle, batch_interval);
+    }
+#endif
+
   ret = ioctl(fd, SNIOC_GET_STATE, (unsigned long)(uintptr_t)&tmp);
   if (ret < 0)
     {
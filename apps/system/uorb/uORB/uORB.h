@@ -49,6 +49,9 @@ struct orb_metadata
 #ifdef CONFIG_DEBUG_UORB
   orb_print_message o_cb;       /* Function pointer of output topic message */
 #endif
+#ifdef CONFIG_UORB_FASTPATH
+  bool              o_fast;     /* Use the in-process fast path */
+#endif
 };
 
 typedef FAR const struct orb_metadata *orb_id_t;
@@ -64,6 +67,16 @@ struct orb_state
   uint64_t generation;          /* Mainline generation */
 };
 
+struct orb_batch
+{
+  uint64_t generation;          /* Mainline generation at the last point
+                                 * the subscriber was known to be in sync,
+                                 * 0 before the first one
+                                 */
+  uint32_t copied;              /* Samples copied since that point */
+  uint32_t lost;                /* Lost samples found by the last call */
+};
+
 struct orb_object
 {
   orb_id_t meta;                /* The metadata of topic object */
@@ -164,6 +177,40 @@ typedef uint64_t orb_abstime;
   };
 #endif
 
+/**
+ * Define (instantiate) the uORB metadata for a topic that is only
+ * published and subscribed inside this address space.
+ *
+ * With CONFIG_UORB_FASTPATH, samples of such a topic are exchanged through
+ * a shared seqlock ring instead of read()/write() on the device node; the
+ * node is still registered so that the topic can be discovered. Without
+ * it, this is the same as ORB_DEFINE().
+ *
+ * @param name    The name of the topic.
+ * @param struct  The structure the topic provides.
+ * @param cb      The function pointer of output topic message.
+ */
+#if !defined(CONFIG_UORB_FASTPATH)
+#define ORB_DEFINE_FAST(name, structure, cb) ORB_DEFINE(name, structure, cb)
+#elif defined(CONFIG_DEBUG_UORB)
+#define ORB_DEFINE_FAST(name, structure, cb) \
+  const struct orb_metadata g_orb_##name = \
+  { \
+    #name, \
+    sizeof(structure), \
+    cb, \
+    true, \
+  };
+#else
+#define ORB_DEFINE_FAST(name, structure, cb) \
+  const struct orb_metadata g_orb_##name = \
+  { \
+    #name, \
+    sizeof(structure), \
+    true, \
+  };
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -452,6 +499,43 @@ static inline int orb_copy(FAR const struct orb_metadata *meta,
   return ret == meta->o_size ? 0 : -1;
 }
 
+/****************************************************************************
+ * Name: orb_copy_multi_batch
+ *
+ * Description:
+ *   Drain up to nmemb queued samples of a topic in one call.
+ *
+ *   Unlike orb_copy_multi, nothing is copied when there is no new data,
+ *   so the samples returned are each delivered once. Samples the
+ *   publisher overwrote before they were copied are reported in
+ *   batch->lost. On the device node the gap can only be computed once
+ *   the queue is drained with no concurrent publish, so it may be reported
+ *   by a later call than the one that skipped it.
+ *
+ * Input Parameters:
+ *   fd       A fd returned from orb_subscribe.
+ *   buffer   Array receiving the samples, nmemb * esize bytes.
+ *   esize    The size of one sample (meta->o_size).
+ *   nmemb    Maximum number of samples to copy.
+ *   batch    Gap tracking state, zero it before the first call.
+ *
+ * Returned Value:
+ *   The number of samples copied, 0 if there is no new data,
+ *   -1 otherwise with errno set accordingly.
+ ****************************************************************************/
+
+ssize_t orb_copy_multi_batch(int fd, FAR void *buffer, size_t esize,
+                             unsigned int nmemb,
+                             FAR struct orb_batch *batch);
+
+static inline ssize_t orb_copy_batch(FAR const struct orb_metadata *meta,
+                                     int fd, FAR void *buffer,
+                                     unsigned int nmemb,
+                                     FAR struct orb_batch *batch)
+{
+  return orb_copy_multi_batch(fd, buffer, meta->o_size, nmemb, batch);
+}
+
 /****************************************************************************
  * Name: orb_get_state
  *